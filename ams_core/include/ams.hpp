@@ -20,7 +20,10 @@
 #include "ams/Array.hpp"
 #include "ams/concepts.hpp"
 #include "ams/config.hpp"
+#include "ams/Delegate.hpp"
+#include "ams/IdAllocator.hpp"
 #include "ams/List.hpp"
+#include "ams/MappedFile.hpp"
 #include "ams/Math.hpp"
 #include "ams/Serializable.hpp"
 #include "ams/StringExtensions.hpp"
@@ -30,7 +33,10 @@
 /*[export import ams.Array]*/
 /*[export import ams.concepts]*/
 /*[export import ams.config]*/
+/*[export import ams.Delegate]*/
+/*[export import ams.IdAllocator]*/
 /*[export import ams.List]*/
+/*[export import ams.MappedFile]*/
 /*[export import ams.Math]*/
 /*[export import ams.Serializable]*/
 /*[export import ams.StringExtensions]*/
@@ -0,0 +1,205 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[export module ams.Delegate]*/
+/*[exclude begin]*/
+#pragma once
+#include "config.hpp"
+#include "IdAllocator.hpp"
+/*[exclude end]*/
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+/*[import ams.config]*/
+/*[import ams.IdAllocator]*/
+
+/*[export]*/ namespace ams {
+
+/** The default size of the inline buffer of an ams::Delegate, which holds a lambda capturing four pointers. */
+constexpr size_t DelegateBufferSize = 4 * sizeof(void*);
+
+template<typename TSignature, size_t TBufferSize = DelegateBufferSize, bool TCopyable = true>
+class Delegate;
+
+/**
+ * @brief A move-only ams::Delegate, which can hold callables which can not be copied.
+ */
+template<typename TSignature, size_t TBufferSize = DelegateBufferSize>
+using UniqueDelegate = Delegate<TSignature, TBufferSize, false>;
+
+/**
+ * @brief A callable wrapper which never allocates.
+ * @details A Delegate stores its target in an inline buffer of TBufferSize bytes. A target which does not fit is
+ * rejected at compile time instead of being moved to the heap, so constructing, copying and calling a Delegate never
+ * allocates. Arguments are forwarded to the target as declared by the signature, so references are not copied.
+ * Each Delegate which is constructed from a callable takes a new id from ams::IdAllocator, and copies share the
+ * id of their source, so two Delegates compare equal when one is a copy of the other. This is how callbacks are
+ * unregistered.
+ * @tparam Tr - The return type.
+ * @tparam Tp - The parameter types.
+ * @tparam TBufferSize - The size of the inline buffer.
+ * @tparam TCopyable - If false, the Delegate is move-only and accepts targets which can only be moved.
+ * <p>Usage:</p>
+ * <p><code>Delegate&lt;void(int)&gt; d = [&amp;](int i) { sum += i; };<br>
+ * d(1);<br>
+ * auto m = Delegate&lt;void(int)&gt;::bind&lt;&amp;Counter::add&gt;(&amp;counter);</code></p>
+ */
+template<typename Tr, typename... Tp, size_t TBufferSize, bool TCopyable>
+class Delegate<Tr(Tp...), TBufferSize, TCopyable> {
+private:
+  struct VTable {
+    Tr (*invoke)(const void* target, Tp&&... args);
+    /** Copy constructs the target into uninitialized storage. Null for move-only Delegates. */
+    void (*copy)(void* dst, const void* src);
+    /** Move constructs the target into uninitialized storage and destroys the source. */
+    void (*move)(void* dst, void* src);
+    void (*destroy)(void* target);
+  };
+  
+  template<typename T>
+  static constexpr VTable VTableFor{
+    [](const void* target, Tp&&... args) -> Tr {
+      return std::invoke(*static_cast<T*>(const_cast<void*>(target)), std::forward<Tp>(args)...);
+    },
+    [] {
+      if constexpr (TCopyable)
+        return +[](void* dst, const void* src) { ::new(dst) T(*static_cast<const T*>(src)); };
+      else
+        return static_cast<void (*)(void*, const void*)>(nullptr);
+    }(),
+    [](void* dst, void* src) {
+      ::new(dst) T(std::move(*static_cast<T*>(src)));
+      static_cast<T*>(src)->~T();
+    },
+    [](void* target) { static_cast<T*>(target)->~T(); }
+  };
+  
+  alignas(std::max_align_t) std::byte mBuffer[TBufferSize];
+  const VTable* mVTable = nullptr;
+  uint64_t mId = 0;
+
+public:
+  Delegate() = default;
+  
+  Delegate(std::nullptr_t) {}
+  
+  /**
+   * @brief Constructs a Delegate which calls a copy of a callable.
+   * @param function - The callable. It must fit in TBufferSize bytes, and be copyable if the Delegate is.
+   */
+  template<typename TFunc>
+    requires (!std::is_same_v<std::remove_cvref_t<TFunc>, Delegate> &&
+              std::is_invocable_r_v<Tr, std::remove_cvref_t<TFunc>&, Tp...>)
+  Delegate(TFunc&& function) : mId(IdAllocator::next()) {
+    using T = std::remove_cvref_t<TFunc>;
+    static_assert(sizeof(T) <= TBufferSize, "The callable does not fit in the buffer of the Delegate");
+    static_assert(alignof(T) <= alignof(std::max_align_t), "The callable is over-aligned");
+    static_assert(!TCopyable || std::is_copy_constructible_v<T>, "The callable of a copyable Delegate must be copyable");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "The callable must be nothrow move constructible");
+    ::new(static_cast<void*>(mBuffer)) T(std::forward<TFunc>(function));
+    mVTable = &VTableFor<T>;
+  }
+  
+  Delegate(const Delegate& other) requires TCopyable : mVTable(other.mVTable), mId(other.mId) {
+    if (mVTable != nullptr)
+      mVTable->copy(mBuffer, other.mBuffer);
+  }
+  
+  Delegate(Delegate&& other) noexcept : mVTable(other.mVTable), mId(other.mId) {
+    if (mVTable != nullptr) {
+      mVTable->move(mBuffer, other.mBuffer);
+      other.mVTable = nullptr;
+      other.mId = 0;
+    }
+  }
+  
+  Delegate& operator=(const Delegate& other) requires TCopyable {
+    if (this != &other) {
+      reset();
+      if (other.mVTable != nullptr)
+        other.mVTable->copy(mBuffer, other.mBuffer);
+      mVTable = other.mVTable;
+      mId = other.mId;
+    }
+    return *this;
+  }
+  
+  Delegate& operator=(Delegate&& other) noexcept {
+    if (this != &other) {
+      reset();
+      if (other.mVTable != nullptr)
+        other.mVTable->move(mBuffer, other.mBuffer);
+      mVTable = std::exchange(other.mVTable, nullptr);
+      mId = std::exchange(other.mId, 0);
+    }
+    return *this;
+  }
+  
+  ~Delegate() {
+    reset();
+  }
+  
+  /**
+   * @brief Creates a Delegate which calls a member function on an instance.
+   * @tparam TMethod - The member function.
+   * @param instance - The instance. It must outlive the Delegate.
+   */
+  template<auto TMethod, typename T>
+  static Delegate bind(T* instance) {
+    return Delegate([instance](Tp... args) -> Tr {
+      return std::invoke(TMethod, instance, std::forward<Tp>(args)...);
+    });
+  }
+  
+  /**
+   * @brief Calls the target.
+   * @throws std::bad_function_call if the Delegate is empty.
+   */
+  Tr operator()(Tp... args) const {
+    if constexpr (AMSExceptions)
+      if (mVTable == nullptr)
+        throw std::bad_function_call();
+    return mVTable->invoke(mBuffer, std::forward<Tp>(args)...);
+  }
+  
+  /**
+   * @brief Destroys the target. The Delegate becomes empty.
+   */
+  void reset() {
+    if (mVTable != nullptr) {
+      mVTable->destroy(mBuffer);
+      mVTable = nullptr;
+    }
+    mId = 0;
+  }
+  
+  /**
+   * @brief Gets the id of the Delegate, or 0 if it is empty.
+   */
+  [[nodiscard]] uint64_t id() const { return mId; }
+  
+  explicit operator bool() const { return mVTable != nullptr; }
+  
+  bool operator==(const Delegate& other) const { return mId == other.mId; }
+  
+  bool operator!=(const Delegate& other) const { return mId != other.mId; }
+};
+
+} // ams
@@ -18,15 +18,17 @@
 /*[export module ams.Function]*/
 /*[exclude begin]*/
 #pragma once
+#include "IdAllocator.hpp"
 /*[exclude end]*/
 
 #include <functional>
-#include <random>
+/*[import ams.IdAllocator]*/
 
 /*[export]*/ namespace ams {
 
 /**
  * @brief Function is a wrapper for std::function with comparison operators.
+ * @details Function may allocate when it is created or copied. Prefer ams::Delegate for callbacks.
  * @tparam Tr - Return type of the function.
  * @tparam Tp - Parameter type(s) of the function.
  * @example 
@@ -41,22 +43,17 @@
 template <typename Tr, typename ... Tp>
 class Function {
 private:
-  // random number generator
-  inline static std::random_device rd;
-  inline static std::mt19937_64 _gen{rd()};
-  inline static std::uniform_int_distribution<uint64_t> _dis;
-private:
-  uint64_t _id = _dis(_gen);
+  uint64_t _id = IdAllocator::next();
   std::function<Tr(Tp...)> _function;
 public:
   Function() = default;
   
   explicit Function(const std::function<Tr(Tp...)>& function) : _function(function) {
-    _id = _dis(_gen);
+    _id = IdAllocator::next();
   }
   
   Function(std::function<Tr(Tp...)>&& function) : _function(std::move(function)) {
-    _id = _dis(_gen);
+    _id = IdAllocator::next();
   }
   
   Function(const Function& other) = default;
@@ -96,14 +93,14 @@ public:
   // lambda assignment operator
   Function& operator=(const std::function<Tr(Tp...)>& function) {
     _function = function;
-    _id = _dis(_gen);
+    _id = IdAllocator::next();
     return *this;
   }
   
   // lambda move assignment
   Function& operator=(std::function<Tr(Tp...)>&& function) {
     _function = std::move(function);
-    _id = _dis(_gen);
+    _id = IdAllocator::next();
     return *this;
   }
   
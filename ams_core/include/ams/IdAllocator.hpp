@@ -0,0 +1,68 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[export module ams.IdAllocator]*/
+/*[exclude begin]*/
+#pragma once
+#include "config.hpp"
+/*[exclude end]*/
+/*[ignore begin]*/
+#include "ams_core_export.hpp"
+/*[ignore end]*/
+#include <cstdint>
+/*[import ams.config]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief IdAllocator hands out process-wide unique 64-bit ids without locking.
+ * @details Each thread reserves a block of BlockSize sequence numbers from one shared atomic counter and then
+ * allocates from its block without touching shared state, so the counter is only contended once per block.
+ * Sequence numbers are offset by a seed drawn once per process and scrambled by mix(), which is a bijection, so ids
+ * never collide within a process and look random, which keeps them well distributed in hash tables.
+ * Ids are never 0, so 0 may be used as an invalid id.
+ */
+class AMS_CORE_EXPORT IdAllocator {
+public:
+  /** The number of sequence numbers a thread reserves at once. */
+  static constexpr uint64_t BlockSize = 1024;
+  
+  IdAllocator() = delete;
+  
+  /**
+   * @brief Allocates a unique id. Thread safe and lock free.
+   */
+  static uint64_t next();
+  
+  /**
+   * @brief Gets the seed of this process, drawn from std::random_device on first use.
+   */
+  static uint64_t getSeed();
+  
+  /**
+   * @brief Scrambles a value with the splitmix64 finalizer.
+   * @details The function is a bijection over 64-bit values, so distinct inputs always give distinct outputs.
+   */
+  static constexpr uint64_t mix(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ull;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebull;
+    return value ^ (value >> 31);
+  }
+};
+
+} // ams
@@ -0,0 +1,207 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[export module ams.JobSystem]*/
+/*[exclude begin]*/
+#pragma once
+#include "config.hpp"
+/*[exclude end]*/
+/*[ignore begin]*/
+#include "ams_core_export.hpp"
+/*[ignore end]*/
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+/*[import ams.config]*/
+
+/*[export]*/ namespace ams {
+
+class JobSystem;
+
+namespace internal {
+
+/**
+ * @brief The shared state of a job scheduled on an ams::JobSystem.
+ */
+struct Job {
+  std::function<void()> function;
+  /** The number of unfinished dependencies, plus one held while the job is being scheduled. */
+  std::atomic<uint32_t> pending{1};
+  std::atomic<bool> complete{false};
+  /** The exception thrown by the function, or by a dependency, in which case the function does not run. */
+  std::exception_ptr exception;
+  /** Guards done and continuations, and exception until the job is queued. */
+  std::mutex mutex;
+  bool done = false;
+  /** Jobs which depend on this job. */
+  std::vector<std::shared_ptr<Job>> continuations;
+};
+
+} // internal
+
+/**
+ * @brief A handle to a job scheduled on an ams::JobSystem.
+ * @details Handles can be copied freely and used as dependencies of other jobs. A default constructed handle
+ * references no job and is always complete.
+ */
+class AMS_CORE_EXPORT JobHandle {
+private:
+  std::shared_ptr<internal::Job> _job;
+  JobSystem* _system = nullptr;
+
+public:
+  JobHandle() = default;
+  
+  /**
+   * @brief Checks if the job has finished running.
+   */
+  [[nodiscard]] bool isComplete() const {
+    return _job == nullptr || _job->complete.load(std::memory_order_acquire);
+  }
+  
+  /**
+   * @brief Blocks until the job has finished running. The calling thread runs other jobs while it waits.
+   * @throws The exception thrown by the job, if any. See JobSystem::schedule().
+   */
+  void wait() const;
+  
+  friend class JobSystem;
+};
+
+/**
+ * @brief A work-stealing thread pool.
+ * @details Every worker thread owns a job queue. A worker pops the newest job of its own queue and, when the queue
+ * is empty, steals the oldest job of another queue. Jobs scheduled from a thread which is not a worker go to a shared
+ * queue. Waiting on a job never idles the waiting thread: it runs queued jobs until the job completes, so jobs can
+ * wait on other jobs, and a JobSystem with no workers runs every job on the waiting thread.
+ */
+class AMS_CORE_EXPORT JobSystem {
+private:
+  struct Queue {
+    std::mutex mutex;
+    std::deque<std::shared_ptr<internal::Job>> jobs;
+  };
+  
+  /** Queue 0 is shared by non-worker threads, queue i + 1 is owned by worker i. */
+  std::vector<std::unique_ptr<Queue>> _queues;
+  std::vector<std::thread> _workers;
+  /** The number of jobs waiting in all queues. */
+  std::atomic<size_t> _queued{0};
+  std::atomic<bool> _stopping{false};
+  std::mutex _sleepMutex;
+  std::condition_variable _sleepCondition;
+
+public:
+  /**
+   * @brief Constructs a JobSystem and starts its worker threads.
+   * @param workerCount - The number of worker threads. Defaults to one less than the number of hardware threads,
+   * leaving one for the thread which schedules the jobs.
+   */
+  explicit JobSystem(size_t workerCount = defaultWorkerCount());
+  
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+  
+  /**
+   * @brief Stops and joins the worker threads. Jobs which have not started are discarded.
+   */
+  ~JobSystem();
+  
+  /**
+   * @brief Gets the process-wide JobSystem, creating it on first use.
+   */
+  static JobSystem& getInstance();
+  
+  /**
+   * @brief Gets the default number of worker threads: one less than the number of hardware threads.
+   */
+  static size_t defaultWorkerCount();
+  
+  /**
+   * @brief Gets the number of worker threads.
+   */
+  [[nodiscard]] size_t getWorkerCount() const { return _workers.size(); }
+  
+  /**
+   * @brief Schedules a job.
+   * @details An exception thrown by the function completes the job, and is rethrown by every wait() on it. Jobs which
+   * depend on a job which threw do not run, and complete with the same exception.
+   * @param function - The function to run.
+   * @param dependencies - Jobs which must complete before the job starts.
+   * @return A handle to the job.
+   */
+  JobHandle schedule(std::function<void()> function, std::span<const JobHandle> dependencies = {});
+  
+  /**
+   * @brief Schedules a job.
+   * @param function - The function to run.
+   * @param dependencies - Jobs which must complete before the job starts.
+   * @return A handle to the job.
+   */
+  JobHandle schedule(std::function<void()> function, std::initializer_list<JobHandle> dependencies) {
+    return schedule(std::move(function), std::span<const JobHandle>(dependencies.begin(), dependencies.size()));
+  }
+  
+  /**
+   * @brief Schedules a function over the range [0, count), split into jobs of at most grainSize indices.
+   * @param count - The number of indices.
+   * @param grainSize - The maximum number of indices per job.
+   * @param function - The function to run for each sub-range. It receives the begin and end of the sub-range.
+   * @param dependencies - Jobs which must complete before any sub-range starts.
+   * @return A handle which completes once every sub-range has completed.
+   */
+  JobHandle parallelFor(size_t count, size_t grainSize, std::function<void(size_t, size_t)> function,
+                        std::span<const JobHandle> dependencies = {});
+  
+  /**
+   * @brief Blocks until a job completes, running queued jobs on the calling thread in the meantime.
+   * @param handle - The job to wait on.
+   * @throws The exception thrown by the job, if any.
+   */
+  void wait(const JobHandle& handle);
+  
+  /**
+   * @brief Blocks until every job completes, running queued jobs on the calling thread in the meantime.
+   * @param handles - The jobs to wait on.
+   * @throws The exception thrown by the first of the jobs which threw, once every job has completed.
+   */
+  void waitAll(std::span<const JobHandle> handles);
+
+private:
+  void push(std::shared_ptr<internal::Job> job);
+  
+  /** Runs one queued job, preferring the newest job of the given queue. */
+  bool tryRunOne(size_t queue);
+  
+  void finish(const std::shared_ptr<internal::Job>& job);
+  
+  void workerLoop(size_t queue);
+  
+  /** Gets the queue of the calling thread. */
+  size_t currentQueue() const;
+};
+
+} // ams
@@ -0,0 +1,82 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[export module ams.MappedFile]*/
+/*[exclude begin]*/
+#pragma once
+#include "config.hpp"
+/*[exclude end]*/
+/*[ignore begin]*/
+#include "ams_core_export.hpp"
+/*[ignore end]*/
+#include <cstddef>
+#include <filesystem>
+#include <span>
+/*[import ams.config]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief A read-only memory mapping of a whole file.
+ * @details The contents are paged in by the operating system on first access, so opening a large file is cheap and
+ * reading it does not copy it into a buffer first. The mapping is released when the MappedFile is destroyed.
+ */
+class AMS_CORE_EXPORT MappedFile {
+private:
+  const std::byte* mData = nullptr;
+  size_t mSize = 0;
+#if defined(_WIN32)
+  void* mFile = nullptr;
+  void* mMapping = nullptr;
+#endif
+
+public:
+  MappedFile() = default;
+  
+  /**
+   * @brief Maps a file.
+   * @param path - The file to map.
+   * @throws std::runtime_error if the file can not be opened or mapped. If exceptions are disabled, the MappedFile is
+   * left empty instead.
+   */
+  explicit MappedFile(const std::filesystem::path& path);
+  
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+  
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+  
+  ~MappedFile();
+  
+  /**
+   * @brief Gets the contents of the file.
+   */
+  [[nodiscard]] std::span<const std::byte> data() const { return {mData, mSize}; }
+  
+  [[nodiscard]] size_t size() const { return mSize; }
+  
+  [[nodiscard]] bool empty() const { return mSize == 0; }
+  
+  /**
+   * @brief Releases the mapping.
+   */
+  void close();
+};
+
+} // ams
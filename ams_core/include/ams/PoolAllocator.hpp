@@ -0,0 +1,252 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+/*[export module ams.PoolAllocator]*/
+/*[exclude begin]*/
+#pragma once
+#include "config.hpp"
+/*[exclude end]*/
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+/*[import ams.config]*/
+
+/*[export]*/ namespace ams {
+
+class PoolAllocator;
+
+/**
+ * @brief Destroys a value allocated by an ams::PoolAllocator and returns its block to the pool.
+ * @details A deleter for a base type may be constructed from a deleter for a derived type. The block of a polymorphic
+ * value is found with dynamic_cast&lt;void*&gt;, so a value may be deleted through a pointer to a base with a virtual
+ * destructor.
+ * @tparam T - The type of the value.
+ */
+template<typename T>
+struct PoolDeleter {
+  PoolAllocator* pool = nullptr;
+  
+  PoolDeleter() = default;
+  
+  explicit PoolDeleter(PoolAllocator* pool) : pool(pool) {}
+  
+  template<typename U> requires std::is_convertible_v<U*, T*>
+  PoolDeleter(const PoolDeleter<U>& other) : pool(other.pool) {}
+  
+  void operator()(T* value) const;
+};
+
+/**
+ * @brief A unique pointer to a value allocated by an ams::PoolAllocator.
+ */
+template<typename T>
+using PoolPtr = std::unique_ptr<T, PoolDeleter<T>>;
+
+/**
+ * @brief A pool of fixed size memory blocks.
+ * @details Blocks are carved out of chunks which are requested from an upstream std::pmr::memory_resource, and freed
+ * blocks are kept in an intrusive free list, so allocate and deallocate are O(1) and do not touch the upstream
+ * resource once the pool has grown to its working size. Blocks of the same pool are packed together in memory.
+ * Chunks are only returned to the upstream resource by release() or when the pool is destroyed. When the upstream
+ * resource is a std::pmr::monotonic_buffer_resource, releasing that resource frees the memory of every pool built on
+ * it at once.
+ * A PoolAllocator is not thread safe.
+ */
+class PoolAllocator {
+private:
+  struct FreeBlock {
+    FreeBlock* next;
+  };
+  
+  struct Chunk {
+    void* data;
+    size_t size;
+  };
+  
+  size_t mBlockSize;
+  size_t mBlockAlign;
+  size_t mBlocksPerChunk;
+  std::pmr::memory_resource* mUpstream;
+  std::vector<Chunk> mChunks{};
+  FreeBlock* mFreeList = nullptr;
+  /** The unused part of the last chunk. */
+  std::byte* mCursor = nullptr;
+  std::byte* mChunkEnd = nullptr;
+  size_t mSize = 0;
+  size_t mCapacity = 0;
+
+public:
+  /**
+   * @brief Constructs a pool.
+   * @param blockSize - The size of each block. Rounded up to hold at least a pointer.
+   * @param blockAlign - The alignment of each block.
+   * @param blocksPerChunk - The number of blocks requested from the upstream resource at once.
+   * @param upstream - The resource which provides the chunks.
+   */
+  explicit PoolAllocator(size_t blockSize, size_t blockAlign = alignof(std::max_align_t), size_t blocksPerChunk = 64,
+                         std::pmr::memory_resource* upstream = std::pmr::get_default_resource())
+  : mBlockAlign(blockAlign < alignof(FreeBlock) ? alignof(FreeBlock) : blockAlign),
+    mBlocksPerChunk(blocksPerChunk == 0 ? 1 : blocksPerChunk),
+    mUpstream(upstream)
+  {
+    if (blockSize < sizeof(FreeBlock))
+      blockSize = sizeof(FreeBlock);
+    // round up so that consecutive blocks stay aligned
+    mBlockSize = (blockSize + mBlockAlign - 1) / mBlockAlign * mBlockAlign;
+  }
+  
+  PoolAllocator(const PoolAllocator&) = delete;
+  PoolAllocator& operator=(const PoolAllocator&) = delete;
+  
+  ~PoolAllocator() {
+    release();
+  }
+  
+  /**
+   * @brief Allocates one block.
+   * @return An uninitialized block of getBlockSize() bytes.
+   */
+  [[nodiscard]] void* allocate() {
+    ++mSize;
+    if (mFreeList != nullptr) {
+      auto* block = mFreeList;
+      mFreeList = block->next;
+      return block;
+    }
+    if (mCursor == mChunkEnd) {
+      auto size = mBlockSize * mBlocksPerChunk;
+      auto* data = mUpstream->allocate(size, mBlockAlign);
+      mChunks.push_back({data, size});
+      mCapacity += mBlocksPerChunk;
+      mCursor = static_cast<std::byte*>(data);
+      mChunkEnd = mCursor + size;
+    }
+    auto* block = mCursor;
+    mCursor += mBlockSize;
+    return block;
+  }
+  
+  /**
+   * @brief Makes room for a number of allocations, so that they request at most one chunk from the upstream resource.
+   * @details The blocks left in the current chunk are moved to the free list, and the new chunk holds the rest of
+   * the blocks, but at least as many as a regular chunk.
+   * @param count - The number of blocks about to be allocated.
+   */
+  void reserve(size_t count) {
+    auto available = mCursor == nullptr ? 0 : static_cast<size_t>(mChunkEnd - mCursor) / mBlockSize;
+    if (count <= available)
+      return;
+    for (; mCursor != mChunkEnd; mCursor += mBlockSize) {
+      auto* free = reinterpret_cast<FreeBlock*>(mCursor);
+      free->next = mFreeList;
+      mFreeList = free;
+    }
+    auto blocks = count - available < mBlocksPerChunk ? mBlocksPerChunk : count - available;
+    auto size = mBlockSize * blocks;
+    auto* data = mUpstream->allocate(size, mBlockAlign);
+    mChunks.push_back({data, size});
+    mCapacity += blocks;
+    mCursor = static_cast<std::byte*>(data);
+    mChunkEnd = mCursor + size;
+  }
+  
+  /**
+   * @brief Returns a block to the pool.
+   * @param block - A block allocated by this pool.
+   */
+  void deallocate(void* block) {
+    auto* free = static_cast<FreeBlock*>(block);
+    free->next = mFreeList;
+    mFreeList = free;
+    --mSize;
+  }
+  
+  /**
+   * @brief Allocates a block and constructs a value of type T in it.
+   * @tparam T - The type of the value. It must fit in a block.
+   * @param args - The arguments of T's constructor.
+   * @return A unique pointer which returns the block to the pool when the value is destroyed, or null if T does not
+   * fit in a block.
+   */
+  template<typename T, typename... Args>
+  [[nodiscard]] PoolPtr<T> make(Args&&... args) {
+    if (sizeof(T) > mBlockSize || alignof(T) > mBlockAlign) {
+      if constexpr (AMSExceptions)
+        throw std::invalid_argument("Type does not fit in the blocks of the pool");
+      return nullptr;
+    }
+    auto* block = allocate();
+    try {
+      return PoolPtr<T>(::new(block) T(std::forward<Args>(args)...), PoolDeleter<T>(this));
+    } catch (...) {
+      deallocate(block);
+      throw;
+    }
+  }
+  
+  /**
+   * @brief Returns every chunk to the upstream resource.
+   * @details Values which are still alive are not destroyed, and their blocks become invalid.
+   */
+  void release() {
+    for (auto& chunk : mChunks)
+      mUpstream->deallocate(chunk.data, chunk.size, mBlockAlign);
+    mChunks.clear();
+    mFreeList = nullptr;
+    mCursor = mChunkEnd = nullptr;
+    mSize = 0;
+    mCapacity = 0;
+  }
+  
+  /**
+   * @brief Gets the size of each block.
+   */
+  [[nodiscard]] size_t getBlockSize() const { return mBlockSize; }
+  
+  /**
+   * @brief Gets the alignment of each block.
+   */
+  [[nodiscard]] size_t getBlockAlign() const { return mBlockAlign; }
+  
+  /**
+   * @brief Gets the number of allocated blocks.
+   */
+  [[nodiscard]] size_t size() const { return mSize; }
+  
+  /**
+   * @brief Gets the number of blocks which fit in the chunks requested so far.
+   */
+  [[nodiscard]] size_t capacity() const { return mCapacity; }
+};
+
+template<typename T>
+void PoolDeleter<T>::operator()(T* value) const {
+  void* block;
+  if constexpr (std::is_polymorphic_v<T>)
+    block = dynamic_cast<void*>(value);
+  else
+    block = value;
+  value->~T();
+  pool->deallocate(block);
+}
+
+} // ams
@@ -0,0 +1,264 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+/*[export module ams.SlotMap]*/
+/*[exclude begin]*/
+#pragma once
+#include "config.hpp"
+/*[exclude end]*/
+#include <compare>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+/*[import ams.config]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief A handle to a value stored in an ams::SlotMap.
+ * @details A handle stores the index of a slot and the generation of that slot at the time the value was inserted.
+ * When a value is erased, its slot's generation is incremented, so any handle to the erased value becomes stale and
+ * can be detected as such, even after the slot is reused. A default constructed handle is never valid.
+ */
+struct SlotHandle {
+  static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+  
+  uint32_t index = InvalidIndex;
+  uint32_t generation = 0;
+  
+  /**
+   * @brief Checks if the handle was default constructed.
+   * @details A non-null handle may still be stale. Use ams::SlotMap::contains() to check if it is valid.
+   */
+  [[nodiscard]] constexpr bool isNull() const { return index == InvalidIndex; }
+  
+  constexpr auto operator<=>(const SlotHandle& other) const = default;
+};
+
+/**
+ * @brief A generational slot map.
+ * @tparam T - The type of the values.
+ * @details Values are stored contiguously in a dense array, so iteration is linear. Each value is addressed by an
+ * ams::SlotHandle which indexes an indirection slot. Free slots form an intrusive free list, so insert, erase and
+ * lookup are O(1). Erasing a value moves the last value into its place, so the order of values is not stable.
+ * Pointers to values are invalidated by insert and erase; hold a handle instead.
+ */
+template<typename T>
+class SlotMap {
+protected:
+  struct Slot {
+    /** The index of the value in mData when the slot is used, or the next free slot when it is free. */
+    uint32_t index;
+    /** Incremented whenever the slot's value is erased. Never 0, so default handles never match. */
+    uint32_t generation;
+  };
+  
+  std::vector<T> mData{};
+  /** Maps an index in mData to the index of its slot. */
+  std::vector<uint32_t> mDataSlots{};
+  std::vector<Slot> mSlots{};
+  uint32_t mFreeHead = SlotHandle::InvalidIndex;
+
+public:
+  using iterator = typename std::vector<T>::iterator;
+  using const_iterator = typename std::vector<T>::const_iterator;
+  
+  SlotMap() = default;
+  
+  SlotMap(const SlotMap& other) = default;
+  
+  SlotMap& operator=(const SlotMap& other) = default;
+  
+  SlotMap(SlotMap&& other) noexcept = default;
+  
+  SlotMap& operator=(SlotMap&& other) noexcept = default;
+  
+  ~SlotMap() = default;
+  
+  /**
+   * @brief Constructs a value in place.
+   * @param args - The arguments forwarded to the constructor of T.
+   * @return A handle to the new value.
+   */
+  template<typename... TArgs>
+  SlotHandle emplace(TArgs&&... args) {
+    uint32_t slot;
+    if (mFreeHead != SlotHandle::InvalidIndex) {
+      slot = mFreeHead;
+      mFreeHead = mSlots[slot].index;
+    } else {
+      if constexpr (AMSExceptions)
+        if (mSlots.size() >= SlotHandle::InvalidIndex)
+          throw std::length_error("SlotMap is full");
+      slot = static_cast<uint32_t>(mSlots.size());
+      mSlots.push_back({0, 1});
+    }
+    mData.emplace_back(std::forward<TArgs>(args)...);
+    mDataSlots.push_back(slot);
+    mSlots[slot].index = static_cast<uint32_t>(mData.size() - 1);
+    return {slot, mSlots[slot].generation};
+  }
+  
+  /**
+   * @brief Inserts a value.
+   * @param value - The value to insert.
+   * @return A handle to the new value.
+   */
+  SlotHandle insert(T value) {
+    return emplace(std::move(value));
+  }
+  
+  /**
+   * @brief Erases the value referenced by a handle.
+   * @param handle - The handle of the value to erase.
+   * @return true if the value was erased, false if the handle is stale.
+   */
+  bool erase(SlotHandle handle) {
+    if (!contains(handle))
+      return false;
+    auto index = mSlots[handle.index].index;
+    auto last = static_cast<uint32_t>(mData.size() - 1);
+    // the erased value is destroyed on return, once the map is consistent, since its destructor may reenter the map
+    T value = std::move(mData[index]);
+    if (index != last) {
+      mData[index] = std::move(mData[last]);
+      mDataSlots[index] = mDataSlots[last];
+      mSlots[mDataSlots[index]].index = index;
+    }
+    mData.pop_back();
+    mDataSlots.pop_back();
+    release(handle.index);
+    return true;
+  }
+  
+  /**
+   * @brief Checks if a handle references a value in the map.
+   * @param handle - The handle to check.
+   * @return false if the handle is null or stale.
+   */
+  [[nodiscard]] bool contains(SlotHandle handle) const {
+    return handle.index < mSlots.size() && mSlots[handle.index].generation == handle.generation;
+  }
+  
+  /**
+   * @brief Gets the value referenced by a handle.
+   * @param handle - The handle of the value.
+   * @return A pointer to the value, or nullptr if the handle is null or stale.
+   */
+  [[nodiscard]] T* get(SlotHandle handle) {
+    return contains(handle) ? &mData[mSlots[handle.index].index] : nullptr;
+  }
+  
+  /**
+   * @brief Gets the value referenced by a handle.
+   * @param handle - The handle of the value.
+   * @return A pointer to the value, or nullptr if the handle is null or stale.
+   */
+  [[nodiscard]] const T* get(SlotHandle handle) const {
+    return contains(handle) ? &mData[mSlots[handle.index].index] : nullptr;
+  }
+  
+  /**
+   * @brief Gets the value referenced by a handle.
+   * @param handle - The handle of the value.
+   * @throws std::out_of_range if the handle is null or stale and AMSExceptions is true.
+   */
+  T& operator[](SlotHandle handle) {
+    if constexpr (AMSExceptions)
+      if (!contains(handle))
+        throw std::out_of_range("SlotMap handle is stale");
+    return mData[mSlots[handle.index].index];
+  }
+  
+  /**
+   * @brief Gets the value referenced by a handle.
+   * @param handle - The handle of the value.
+   * @throws std::out_of_range if the handle is null or stale and AMSExceptions is true.
+   */
+  const T& operator[](SlotHandle handle) const {
+    if constexpr (AMSExceptions)
+      if (!contains(handle))
+        throw std::out_of_range("SlotMap handle is stale");
+    return mData[mSlots[handle.index].index];
+  }
+  
+  /**
+   * @brief Gets the handle of the value at a dense index.
+   * @param index - The index of the value in iteration order.
+   */
+  [[nodiscard]] SlotHandle handleAt(size_t index) const {
+    auto slot = mDataSlots[index];
+    return {slot, mSlots[slot].generation};
+  }
+  
+  /**
+   * @brief Erases every value. Every handle becomes stale.
+   */
+  void clear() {
+    // move the values out first, since destroying them may reenter the map
+    auto values = std::move(mData);
+    auto slots = std::move(mDataSlots);
+    mData.clear();
+    mDataSlots.clear();
+    for (auto slot : slots)
+      release(slot);
+  }
+  
+  /**
+   * @brief Reserve space for a number of values.
+   * @param size - The number of values to reserve space for.
+   */
+  void reserve(size_t size) {
+    mData.reserve(size);
+    mDataSlots.reserve(size);
+    mSlots.reserve(size);
+  }
+  
+  [[nodiscard]] size_t size() const { return mData.size(); }
+  
+  [[nodiscard]] bool empty() const { return mData.empty(); }
+  
+  /** @brief Gets a pointer to the dense array of values. */
+  [[nodiscard]] T* data() { return mData.data(); }
+  
+  /** @brief Gets a pointer to the dense array of values. */
+  [[nodiscard]] const T* data() const { return mData.data(); }
+  
+  iterator begin() { return mData.begin(); }
+  
+  iterator end() { return mData.end(); }
+  
+  const_iterator begin() const { return mData.begin(); }
+  
+  const_iterator end() const { return mData.end(); }
+  
+  const_iterator cbegin() const { return mData.cbegin(); }
+  
+  const_iterator cend() const { return mData.cend(); }
+
+protected:
+  /** Bumps the generation of a slot and pushes it on the free list. */
+  void release(uint32_t slot) {
+    auto& s = mSlots[slot];
+    if (++s.generation == 0)
+      s.generation = 1;
+    s.index = mFreeHead;
+    mFreeHead = slot;
+  }
+};
+
+} // ams
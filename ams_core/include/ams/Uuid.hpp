@@ -24,29 +24,32 @@
 /*[ignore end]*/
 /*[exclude begin]*/
 #include "ams/config.hpp"
+#include "ams/IdAllocator.hpp"
 /*[exclude end]*/
 
 /*[export module ams.Uuid]*/
 #include <cstdint>
 #include <cstddef>
 #include <array>
-#include <random>
 #include <sstream>
 #include <ranges>
 #include <algorithm>
 /*[import ams.config]*/
+/*[import ams.IdAllocator]*/
 
 
 /*[export]*/ namespace ams {
 
 /**
  * @brief This class is a 128-bit UUID based on the RFC 4122 standard.
+ * @details The low half is allocated by ams::IdAllocator, so uuids never collide within a process. The high half
+ * mixes in the seed of the process, so uuids generated by different runs differ as well.
  * @see https://tools.ietf.org/html/rfc4122
  */
 struct AMS_CORE_EXPORT Uuid final {
 public:
-  uint64_t low = dis(gen);
-  uint64_t high = dis(gen);
+  uint64_t low = IdAllocator::next();
+  uint64_t high = IdAllocator::mix(low ^ IdAllocator::getSeed());
   /**
    * @brief Construct a new uuid object
    */
@@ -163,20 +166,6 @@ public:
     unformatted.erase(std::remove(unformatted.begin(), unformatted.end(), '-'), unformatted.end());
     return fromStr(unformatted);
   }
-  
-private:
-  /**
-   * The random device used to generate the uuid
-   */
-  inline static std::random_device rd = std::random_device();
-  /**
-   * The random engine used to generate the uuid
-   */
-  inline static std::mt19937_64 gen = std::mt19937_64(rd());
-  /**
-   * The distribution used to generate the uuid
-   */
-  inline static std::uniform_int_distribution<uint64_t> dis = std::uniform_int_distribution<uint64_t>(0, UINT64_MAX);
 };
 
 } // ams
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/IdAllocator.hpp"
+#else
+import ams.IdAllocator;
+#endif
+
+#include <atomic>
+#include <random>
+
+namespace ams {
+
+namespace {
+/** The next block of sequence numbers to hand out. */
+std::atomic_uint64_t blockCounter{0};
+/** The sequence numbers left in the calling thread's block. */
+thread_local uint64_t tlsNext = 0;
+thread_local uint64_t tlsEnd = 0;
+}
+
+uint64_t IdAllocator::getSeed() {
+  static const uint64_t seed = [] {
+    std::random_device rd;
+    return (static_cast<uint64_t>(rd()) << 32) ^ rd();
+  }();
+  return seed;
+}
+
+uint64_t IdAllocator::next() {
+  static const uint64_t seed = getSeed();
+  uint64_t id;
+  do {
+    if (tlsNext == tlsEnd) {
+      tlsNext = blockCounter.fetch_add(BlockSize, std::memory_order_relaxed);
+      tlsEnd = tlsNext + BlockSize;
+    }
+    id = mix(seed + tlsNext++);
+  } while (id == 0);
+  return id;
+}
+
+} // ams
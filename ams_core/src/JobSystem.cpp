@@ -0,0 +1,213 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/JobSystem.hpp"
+#else
+import ams.JobSystem;
+#endif
+
+#include <algorithm>
+
+namespace ams {
+
+namespace {
+/** The JobSystem which owns the calling thread, and the index of the thread's queue in it. */
+thread_local JobSystem* tlsSystem = nullptr;
+thread_local size_t tlsQueue = 0;
+}
+
+void JobHandle::wait() const {
+  if (_system != nullptr)
+    _system->wait(*this);
+}
+
+JobSystem::JobSystem(size_t workerCount) {
+  _queues.reserve(workerCount + 1);
+  for (size_t i = 0; i < workerCount + 1; ++i)
+    _queues.push_back(std::make_unique<Queue>());
+  _workers.reserve(workerCount);
+  for (size_t i = 0; i < workerCount; ++i)
+    _workers.emplace_back(&JobSystem::workerLoop, this, i + 1);
+}
+
+JobSystem::~JobSystem() {
+  {
+    std::scoped_lock lock(_sleepMutex);
+    _stopping = true;
+  }
+  _sleepCondition.notify_all();
+  for (auto& worker : _workers)
+    worker.join();
+}
+
+JobSystem& JobSystem::getInstance() {
+  static JobSystem instance;
+  return instance;
+}
+
+size_t JobSystem::defaultWorkerCount() {
+  auto threads = static_cast<size_t>(std::thread::hardware_concurrency());
+  return std::max<size_t>(threads, 1) - 1;
+}
+
+JobHandle JobSystem::schedule(std::function<void()> function, std::span<const JobHandle> dependencies) {
+  auto job = std::make_shared<internal::Job>();
+  job->function = std::move(function);
+  for (auto& dependency : dependencies) {
+    if (dependency._job == nullptr)
+      continue;
+    std::scoped_lock lock(dependency._job->mutex);
+    if (!dependency._job->done) {
+      job->pending.fetch_add(1, std::memory_order_relaxed);
+      dependency._job->continuations.push_back(job);
+    } else if (dependency._job->exception != nullptr) {
+      // the dependencies which are still running may pass theirs on concurrently
+      std::scoped_lock jobLock(job->mutex);
+      if (job->exception == nullptr)
+        job->exception = dependency._job->exception;
+    }
+  }
+  JobHandle handle;
+  handle._job = job;
+  handle._system = this;
+  // release the scheduling count; the job is queued now unless a dependency is still running
+  if (job->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    push(std::move(job));
+  return handle;
+}
+
+JobHandle JobSystem::parallelFor(size_t count, size_t grainSize, std::function<void(size_t, size_t)> function,
+                                 std::span<const JobHandle> dependencies) {
+  grainSize = std::max<size_t>(grainSize, 1);
+  auto shared = std::make_shared<std::function<void(size_t, size_t)>>(std::move(function));
+  std::vector<JobHandle> chunks;
+  chunks.reserve((count + grainSize - 1) / grainSize);
+  for (size_t begin = 0; begin < count; begin += grainSize) {
+    auto end = std::min(begin + grainSize, count);
+    chunks.push_back(schedule([shared, begin, end] { (*shared)(begin, end); }, dependencies));
+  }
+  if (chunks.empty())
+    return schedule([] {}, dependencies);
+  if (chunks.size() == 1)
+    return chunks.front();
+  return schedule([] {}, chunks);
+}
+
+void JobSystem::wait(const JobHandle& handle) {
+  waitAll({&handle, 1});
+}
+
+void JobSystem::waitAll(std::span<const JobHandle> handles) {
+  auto queue = currentQueue();
+  for (auto& handle : handles) {
+    while (!handle.isComplete()) {
+      if (!tryRunOne(queue))
+        std::this_thread::yield();
+    }
+  }
+  // the other jobs may still use the caller's state, so nothing is thrown until all of them are complete
+  for (auto& handle : handles) {
+    if (handle._job != nullptr && handle._job->exception != nullptr)
+      std::rethrow_exception(handle._job->exception);
+  }
+}
+
+void JobSystem::push(std::shared_ptr<internal::Job> job) {
+  auto& queue = *_queues[currentQueue()];
+  {
+    std::scoped_lock lock(queue.mutex);
+    queue.jobs.push_back(std::move(job));
+  }
+  _queued.fetch_add(1, std::memory_order_release);
+  {
+    // synchronize with a worker which is about to sleep, so the notification is not lost
+    std::scoped_lock lock(_sleepMutex);
+  }
+  _sleepCondition.notify_one();
+}
+
+bool JobSystem::tryRunOne(size_t queue) {
+  std::shared_ptr<internal::Job> job;
+  {
+    auto& own = *_queues[queue];
+    std::scoped_lock lock(own.mutex);
+    if (!own.jobs.empty()) {
+      job = std::move(own.jobs.back());
+      own.jobs.pop_back();
+    }
+  }
+  for (size_t i = 1; job == nullptr && i < _queues.size(); ++i) {
+    auto& victim = *_queues[(queue + i) % _queues.size()];
+    std::scoped_lock lock(victim.mutex);
+    if (!victim.jobs.empty()) {
+      job = std::move(victim.jobs.front());
+      victim.jobs.pop_front();
+    }
+  }
+  if (job == nullptr)
+    return false;
+  _queued.fetch_sub(1, std::memory_order_relaxed);
+  // a throwing job still completes, or the threads waiting on it would spin forever
+  if (job->exception == nullptr) {
+    try {
+      job->function();
+    } catch (...) {
+      job->exception = std::current_exception();
+    }
+  }
+  finish(job);
+  return true;
+}
+
+void JobSystem::finish(const std::shared_ptr<internal::Job>& job) {
+  std::vector<std::shared_ptr<internal::Job>> continuations;
+  {
+    std::scoped_lock lock(job->mutex);
+    job->done = true;
+    continuations.swap(job->continuations);
+  }
+  job->function = nullptr; // release captured state before waiters resume
+  job->complete.store(true, std::memory_order_release);
+  for (auto& continuation : continuations) {
+    if (job->exception != nullptr) {
+      std::scoped_lock lock(continuation->mutex);
+      if (continuation->exception == nullptr)
+        continuation->exception = job->exception;
+    }
+    if (continuation->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+      push(std::move(continuation));
+  }
+}
+
+void JobSystem::workerLoop(size_t queue) {
+  tlsSystem = this;
+  tlsQueue = queue;
+  while (!_stopping.load(std::memory_order_acquire)) {
+    if (tryRunOne(queue))
+      continue;
+    std::unique_lock lock(_sleepMutex);
+    _sleepCondition.wait(lock, [this] {
+      return _stopping.load(std::memory_order_acquire) || _queued.load(std::memory_order_acquire) > 0;
+    });
+  }
+}
+
+size_t JobSystem::currentQueue() const {
+  return tlsSystem == this ? tlsQueue : 0;
+}
+
+} // ams
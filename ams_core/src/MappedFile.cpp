@@ -0,0 +1,145 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/MappedFile.hpp"
+#else
+import ams.MappedFile;
+#endif
+
+#include <stdexcept>
+#include <utility>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ams {
+
+namespace {
+void fail(const std::filesystem::path& path, const char* what) {
+  if constexpr (AMSExceptions)
+    throw std::runtime_error(std::string(what) + ": " + path.string());
+}
+}
+
+MappedFile::MappedFile(const std::filesystem::path& path) {
+#if defined(_WIN32)
+  mFile = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                      FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (mFile == INVALID_HANDLE_VALUE) {
+    mFile = nullptr;
+    fail(path, "Could not open file");
+    return;
+  }
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(mFile, &size)) {
+    close();
+    fail(path, "Could not get the size of file");
+    return;
+  }
+  if (size.QuadPart == 0)
+    return;
+  mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mMapping == nullptr) {
+    close();
+    fail(path, "Could not map file");
+    return;
+  }
+  auto* view = MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0);
+  if (view == nullptr) {
+    close();
+    fail(path, "Could not map file");
+    return;
+  }
+  mData = static_cast<const std::byte*>(view);
+  mSize = static_cast<size_t>(size.QuadPart);
+#else
+  int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    fail(path, "Could not open file");
+    return;
+  }
+  struct stat info{};
+  if (::fstat(fd, &info) != 0) {
+    ::close(fd);
+    fail(path, "Could not get the size of file");
+    return;
+  }
+  if (info.st_size == 0) {
+    ::close(fd);
+    return;
+  }
+  // the mapping keeps its own reference to the file, so the descriptor is not needed afterwards
+  auto* view = ::mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (view == MAP_FAILED) {
+    fail(path, "Could not map file");
+    return;
+  }
+  mData = static_cast<const std::byte*>(view);
+  mSize = static_cast<size_t>(info.st_size);
+#endif
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+  *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    close();
+    mData = std::exchange(other.mData, nullptr);
+    mSize = std::exchange(other.mSize, 0);
+#if defined(_WIN32)
+    mFile = std::exchange(other.mFile, nullptr);
+    mMapping = std::exchange(other.mMapping, nullptr);
+#endif
+  }
+  return *this;
+}
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+void MappedFile::close() {
+#if defined(_WIN32)
+  if (mData != nullptr)
+    UnmapViewOfFile(mData);
+  if (mMapping != nullptr)
+    CloseHandle(mMapping);
+  if (mFile != nullptr)
+    CloseHandle(mFile);
+  mMapping = nullptr;
+  mFile = nullptr;
+#else
+  if (mData != nullptr)
+    ::munmap(const_cast<std::byte*>(mData), mSize);
+#endif
+  mData = nullptr;
+  mSize = 0;
+}
+
+} // ams
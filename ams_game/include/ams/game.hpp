@@ -20,19 +20,35 @@
 #pragma once
 #include "game/SystemInfo.hpp"
 #include "game/Object.hpp"
+#include "game/EventBus.hpp"
 #include "game/Entity.hpp"
 #include "game/Transform.hpp"
 #include "game/Behavior.hpp"
+#include "game/ComponentAccess.hpp"
+#include "game/CommandBuffer.hpp"
+#include "game/Prefab.hpp"
+#include "game/Query.hpp"
+#include "game/SpatialIndex.hpp"
+#include "game/System.hpp"
 #include "game/Camera.hpp"
 #include "game/Scene.hpp"
+#include "game/SceneSnapshot.hpp"
 #include "game/Application.hpp"
 /*[exclude end]*/
 /*[export module ams.spatial]*/
 /*[export import ams.game.SystemInfo]*/
 /*[export import ams.game.Object]*/
+/*[export import ams.game.EventBus]*/
 /*[export import ams.game.Entity]*/
 /*[export import ams.game.Transform]*/
 /*[export import ams.game.Behavior]*/
+/*[export import ams.game.ComponentAccess]*/
+/*[export import ams.game.CommandBuffer]*/
+/*[export import ams.game.Prefab]*/
+/*[export import ams.game.Query]*/
+/*[export import ams.game.SpatialIndex]*/
+/*[export import ams.game.System]*/
 /*[export import ams.game.Camera]*/
 /*[export import ams.game.Scene]*/
+/*[export import ams.game.SceneSnapshot]*/
 /*[export import ams.game.Application]*/
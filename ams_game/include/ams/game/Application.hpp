@@ -26,6 +26,8 @@
 #include <vector>
 #include <chrono>
 #include <filesystem>
+#include <future>
+#include <memory>
 
 /*[export module ams.game.Application]*/
 
@@ -47,6 +49,18 @@
 
 class Scene;
 
+/**
+ * @brief Published to the ams::EventBus of the Application when the current scene changes.
+ * @details The scenes are identified by id rather than by address, because a scene replaced by
+ * Application::loadSceneAsync() is destroyed on another thread before the event is delivered.
+ */
+struct SceneChangeEvent {
+  /** The id of the previous scene, or 0 if there was none. */
+  uuid_t previous;
+  /** The id of the current scene, or 0 if there is none. */
+  uuid_t current;
+};
+
 const WindowConfig kDefaultWindowConfig = {
   .title="Application",
   .size={ 800, 600 },
@@ -68,9 +82,20 @@ private:
   inline static Application* _instance;
   inline static std::vector<std::unique_ptr<Window>> _windows;
   Scene* _currentScene;
+  /** A scene change requested while the current scene was updating, applied at the next sync point. */
+  Scene* _pendingScene = nullptr;
+  /** Set when exit() is called while the current scene is updating. run() exits once the frame is finished. */
+  bool _exitRequested = false;
+  /** The fraction of a fixed step elapsed since the last fixed step, as of the last frame. */
+  decimal_t _interpolationAlpha = 0;
   std::vector<Display> _displays;
   const WindowConfig _windowConfig = kDefaultWindowConfig;
-  std::vector<Function<void, Scene*, Scene*>> _onSceneChangeListeners;
+  /** Dispatched once per frame, after the windows have polled their events. */
+  EventBus _events;
+  /** The scene being built by loadSceneAsync(). It becomes the current scene at the end of the frame it is built in. */
+  std::future<std::unique_ptr<Scene>> _loadingScene;
+  /** Scenes replaced by an asynchronously loaded scene, which are being destroyed in the background. */
+  std::vector<std::future<void>> _unloadingScenes;
   
 protected:
   /** Determines if the game loop should continue. */
@@ -85,6 +110,8 @@ protected:
   time_unit fixedFrameTime = time_unit_1s / 60;
   /** Frame synchronization time. When this value is 0us (the default value), the game will run as fast as possible. */
   time_unit vsyncTime = time_unit_1s * 0;
+  /** The maximum number of fixed steps run per frame. Time beyond it is dropped, so that slow steps can not snowball. */
+  uint32_t maxFixedSteps = 8;
   
   /** Basic info about the application. */
   const ApplicationInfo info;
@@ -117,6 +144,8 @@ public:
   
   /**
    * @brief Stops any threads and closes the game window.
+   * @details When called from a ams::Behavior while the current scene is updating, the game loop finishes the frame
+   * and the scenes exit when run() returns.
    */
   virtual void exit();
   
@@ -138,10 +167,40 @@ public:
    */
   Scene* getScene(const std::string& name) const;
   
+  /**
+   * @brief Exits the current scene and enters another one.
+   * @details When called from a ams::Behavior while the current scene is updating, the change is applied at the next
+   * sync point of the game loop. The current scene can not change while a scene started by loadSceneAsync() is
+   * loading.
+   * @param name - The name of the scene to enter.
+   * @return The scene which is or will become the current scene, or nullptr if a scene is loading.
+   * @throws ams::Exception if a scene is loading.
+   */
   [[maybe_unused]] Scene* setCurrentScene(const std::string& name);
   
   [[maybe_unused]] Scene* createScene(const std::string& name);
   
+  /**
+   * @brief Builds a new scene on a background thread while the current scene keeps running, then switches to it.
+   * @details The builder is called on the loading thread with the new, empty scene, and creates its Entities,
+   * Components and meshes. It must not touch the current scene or anything which is only safe on the main thread.
+   * The loaded scene becomes the current scene at the end of the first frame after it is built, so a frame never
+   * sees both scenes. Until then, setCurrentScene() is rejected. The previous current scene is removed from the
+   * Application: its Behaviors are disabled on the main thread, then the scene is destroyed on a std::async thread,
+   * so the destructors of its Components run on that thread and must not touch anything which is only safe on the
+   * main thread. An exception thrown by the builder is rethrown by run() at the switch.
+   * @param name - The name of the scene to create.
+   * @param builder - The function which populates the scene.
+   * @return true if the scene is loading, false if a scene with that name exists, another scene is still loading,
+   * or a change of the current scene is waiting for the next sync point.
+   */
+  bool loadSceneAsync(const std::string& name, const Delegate<void(Scene*)>& builder);
+  
+  /**
+   * @brief Tests if a scene started by loadSceneAsync() has not become the current scene yet.
+   */
+  bool isLoadingScene() const;
+  
   /**
    * @brief Gets the time since the game loop started.
    */
@@ -201,8 +260,37 @@ public:
    */
   time_unit getFixedFrameTime() const;
   
+  /**
+   * @brief Sets the maximum number of fixed steps run per frame. The default is 8.
+   * @param steps - The maximum number of steps. Values less than 1 will be ignored.
+   * @details When a frame falls behind by more steps, the remaining time is dropped and the game runs slower than
+   * real time instead of spending ever longer frames catching up.
+   */
+  void setMaxFixedSteps(uint32_t steps);
+  
+  /**
+   * @brief Gets the maximum number of fixed steps run per frame.
+   */
+  uint32_t getMaxFixedSteps() const;
+  
+  /**
+   * @brief Gets the fraction of a fixed step elapsed since the last fixed step of the current frame, from 0 to 1.
+   * @details Rendering blends the state at the start of the last fixed step with the current one by this factor,
+   * see Transform::getInterpolatedWorldMatrix(), so that motion stays smooth when the fixed rate is lower than the
+   * frame rate.
+   */
+  decimal_t getInterpolationAlpha() const;
+  
   ApplicationInfo getInfo() const;
   
+  /**
+   * @brief Gets the event bus of the Application.
+   * @details The windows of the Application publish their input events to it, and the Application publishes a
+   * SceneChangeEvent when the current scene changes. The bus is dispatched once per frame, after the windows have
+   * polled their events and before the next frame starts, so handlers run on the main thread outside of any update.
+   */
+  EventBus& getEventBus();
+  
   /**
    * @brief Gets the primary window.
    */
@@ -217,20 +305,6 @@ public:
 
   std::filesystem::path getAppDataDir() const;
   
-  /**
-   * @brief Registers a listener to be called when the scene changes.
-   * @param callback - The function to call when the scene changes.
-   * @return true if the listener was added, false otherwise.
-   */
-  bool registerOnSceneChangeCallback(const Function<void, Scene*, Scene*>& callback);
-  
-  /**
-   * @brief Unregisters a listener to be called when the scene changes.
-   * @param callback - The function to call when the scene changes.
-   * @return true if the listener was removed, false otherwise.
-   */
-  bool unregisterOnSceneChangeCallback(const Function<void, Scene*, Scene*>& callback);
-  
 protected:
   /**
    * @brief This event fires when run is called.
@@ -265,6 +339,17 @@ protected:
 private:
   Scene* getDefaultScene();
   
+  /**
+   * @brief A sync point of the game loop. Applies the commands recorded by the current scene, updates its world
+   * matrices and applies any pending scene change.
+   */
+  void sync();
+  
+  /**
+   * @brief A frame boundary. Switches to the scene built by loadSceneAsync() if it is ready.
+   */
+  void finishSceneLoad();
+  
   /**
    * @brief Generates a Window and pushes it to the window vector.
    * @param cfg - The configuration of the Window.
@@ -35,21 +35,51 @@ private:
 
 /*[export module ams.game.Behavior]*/
 /*[exclude begin]*/
+#include <ams/SlotMap.hpp>
 #include "internal/ActiveComponent.hpp"
 /*[exclude end]*/
+/*[import ams.SlotMap]*/
 /*[import ams.game.ActiveComponent]*/
 
 /*[export]*/ namespace ams {
 
+namespace internal {
+struct BehaviorHooks;
+class BehaviorDispatchList;
+}
+
 /**
  * @brief A ams::Behavior is a ams::Component with event methods which can be overridden to add behavioral
  * functionality to a ams::Entity.
  */
 class AMS_GAME_EXPORT Behavior : public internal::ActiveComponent {
+private:
+  /** The handle of this Behavior in its Scene's behavior registry. */
+  SlotHandle _sceneHandle{};
+  /** The event methods overridden by the concrete type of this Behavior. Set by Entity::addComponent(). */
+  const internal::BehaviorHooks* _hooks = nullptr;
+  /** The position of this Behavior in each of its Scene's dispatch lists, one per ams::internal::BehaviorHook. */
+  uint32_t _dispatchIndices[3]{};
+  /** true while this Behavior is in the enabled range of its Scene, i.e. onEnable() was called last. */
+  bool _active = false;
+  /** true once onStart() has been called. */
+  bool _started = false;
+  
 public:
+  using ComponentBases = ComponentBaseList<Behavior, internal::ActiveComponent, Component>;
+  
   explicit Behavior(Entity* entity);
 
   ~Behavior() override = default;
+  
+  /**
+   * @brief Enables or disables the ams::Behavior. A disabled ams::Behavior is not updated and costs nothing per frame.
+   * @details onEnable() or onDisable() is called when the state changes. onStart() is called the first time the
+   * ams::Behavior is enabled. While the ams::Scene is updating its Behaviors the change is recorded and applied, with
+   * its event, at the next sync point; the ams::Behavior may still be updated until then.
+   * @param enabled - The enabled state of the ams::Behavior.
+   */
+  void setEnabled(bool enabled) override;
 
   /**
 * @brief onStart is called when the ams::Entity is created.
@@ -57,17 +87,17 @@ public:
   virtual void onStart() {}
 
   /**
-   * @brief onUpdate is called every frame.
+   * @brief onUpdate is called once every frame, after the fixed updates of the frame.
    */
   virtual void onUpdate() {}
 
   /**
-   * @brief onFixedUpdate is called every fixed frame.
+   * @brief onFixedUpdate is called every fixed frame, at the Application's fixed frame rate.
    */
   virtual void onFixedUpdate() {}
 
   /**
-   * @brief onLateUpdate is called every late frame.
+   * @brief onLateUpdate is called once every frame, after onUpdate has been called on every ams::Behavior.
    */
   virtual void onLateUpdate() {}
 
@@ -77,6 +107,8 @@ public:
   virtual void onDestroy() {}
 
   friend class Entity;
+  friend class Scene;
+  friend class internal::BehaviorDispatchList;
 };
 
 } // ams
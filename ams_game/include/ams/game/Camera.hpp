@@ -25,14 +25,20 @@
 /*[ignore end]*/
 /*[exclude begin]*/
 #include <ams/spatial/Matrix.hpp>
+#include <ams/SlotMap.hpp>
 #include "internal/ActiveComponent.hpp"
 /*[exclude end]*/
+/*[import ams.SlotMap]*/
 /*[import ams.spatial.Matrix]*/
 /*[import ams.game.ActiveComponent]*/
 
 /*[export]*/ namespace ams {
 
 class AMS_GAME_EXPORT Camera : public internal::ActiveComponent {
+private:
+  /** The handle of this Camera in its Scene's camera registry. */
+  SlotHandle _sceneHandle{};
+  
 protected:
   Matrix4 projectionMatrix = Matrix4::identity();
   /** The camera's field of view in degrees. */
@@ -50,6 +56,8 @@ protected:
 public:
   explicit Camera(Entity* entity);
   
+  ~Camera() override;
+  
   void setProjectionMatrix(const Matrix4& matrix);
   
   const Matrix4& getProjectionMatrix() const;
@@ -70,6 +78,7 @@ public:
   
   decimal_t getFarPlane() const;
   
+  friend class Scene;
 };
 
 } // ams
@@ -0,0 +1,155 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.CommandBuffer]*/
+/*[exclude begin]*/
+#pragma once
+#include "Entity.hpp"
+/*[exclude end]*/
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+/*[import ams.game.Entity]*/
+
+/*[export]*/ namespace ams {
+
+class Scene;
+
+/**
+ * @brief A CommandBuffer records structural changes to a ams::Scene so they can be applied later, in one batch.
+ * @details Creating or destroying Entities, and adding or removing Components, changes the containers a Scene iterates
+ * while it updates its Behaviors. Instead of changing them in place, a Behavior records the change in the command
+ * buffer of its thread, which is returned by Scene::getCommandBuffer(), and the Scene applies every recorded change at
+ * the next sync point of the game loop. Each thread records into its own buffer, so recording does not lock and is
+ * safe from Behaviors which are updated in parallel.
+ * When the buffers are flushed, the changes are sorted: Entities are created first, then the Component changes of
+ * each Entity are applied together so that the Entity moves to its final archetype once, and finally Entities are
+ * destroyed. Changes recorded against an Entity which is destroyed in the same batch are dropped.
+ */
+class AMS_GAME_EXPORT CommandBuffer {
+public:
+  /**
+   * @brief The kinds of commands which can be recorded.
+   */
+  enum class CommandType : uint8_t {
+    CreateEntity,
+    AddComponent,
+    RemoveComponent,
+    SetEnabled,
+    DestroyEntity
+  };
+
+private:
+  struct Command {
+    CommandType type;
+    /** The target of the command. Null for CreateEntity. */
+    EntityHandle entity{};
+    /** Applies the command to its Entity. For CreateEntity, initializes the new Entity and may be empty. */
+    std::function<void(Entity*)> apply{};
+    /** The name of the Entity to create. */
+    std::string name{};
+  };
+  
+  std::vector<Command> _commands{};
+
+public:
+  CommandBuffer() = default;
+  CommandBuffer(const CommandBuffer&) = delete;
+  CommandBuffer& operator=(const CommandBuffer&) = delete;
+  
+  /**
+   * @brief Records the creation of an Entity.
+   * @param name - The name of the Entity.
+   * @param init - Called with the new Entity once it has been created, e.g. to add its Components. May be empty.
+   */
+  void createEntity(const std::string& name, std::function<void(Entity*)> init = {}) {
+    _commands.push_back({CommandType::CreateEntity, {}, std::move(init), name});
+  }
+  
+  /**
+   * @brief Records the destruction of an Entity. Destroying the same Entity more than once in a batch is allowed.
+   * @param entity - The handle of the Entity to destroy.
+   */
+  void destroyEntity(EntityHandle entity) {
+    _commands.push_back({CommandType::DestroyEntity, entity});
+  }
+  
+  /**
+   * @brief Records the addition of a Component to an Entity.
+   * @tparam TComp - The type of Component to add.
+   * @param entity - The handle of the Entity which receives the Component.
+   * @param init - Called with the new Component once it has been added. May be empty.
+   */
+  template<TComponent TComp>
+  void addComponent(EntityHandle entity, std::function<void(TComp*)> init = {}) {
+    _commands.push_back({CommandType::AddComponent, entity, [init = std::move(init)](Entity* pEntity) {
+      auto* component = pEntity->addComponent<TComp>();
+      if (init && component != nullptr)
+        init(component);
+    }});
+  }
+  
+  /**
+   * @brief Records the removal of a Component from an Entity. See Entity::removeComponent().
+   * @tparam TComp - The type of Component to remove.
+   * @param entity - The handle of the Entity which owns the Component.
+   */
+  template<TComponent TComp>
+  void removeComponent(EntityHandle entity) {
+    _commands.push_back({CommandType::RemoveComponent, entity, [](Entity* pEntity) {
+      pEntity->removeComponent<TComp>();
+    }});
+  }
+  
+  /**
+   * @brief Gets the number of recorded commands.
+   */
+  [[nodiscard]] size_t size() const { return _commands.size(); }
+  
+  /**
+   * @brief Checks if no commands have been recorded.
+   */
+  [[nodiscard]] bool empty() const { return _commands.empty(); }
+  
+  /**
+   * @brief Discards every recorded command.
+   */
+  void clear() { _commands.clear(); }
+
+private:
+  /**
+   * Records the removal of a specific Component, used when Entity::removeComponent() is called while dispatching. The
+   * Component is identified by its id, because a Component stored by value moves when its Entity changes.
+   */
+  void removeComponent(EntityHandle entity, uuid_t component) {
+    _commands.push_back({CommandType::RemoveComponent, entity, [component](Entity* pEntity) {
+      if (auto* pComponent = pEntity->findComponent(component); pComponent != nullptr)
+        pEntity->removeComponent(pComponent);
+    }});
+  }
+  
+  friend class Scene;
+  friend class Entity;
+};
+
+} // ams
@@ -21,30 +21,52 @@
 #include "ams_game_export.hpp"
 #include "Object.hpp"
 /*[exclude end]*/
+#include <type_traits>
 /*[import ams.game.Object]*/
 
 /*[export]*/ namespace ams {
 
 class Entity;
 
+/**
+ * @brief Lists the component types which a component type can be looked up as. See Component::ComponentBases.
+ */
+template<typename... TBases>
+struct ComponentBaseList {};
+
 /**
  * @brief The Component class is the base class for all components.
  * @details Components are the building blocks of a ams::Entity. They are used to add core 
  * functionality to a ams::Entity. The lifetime of a component is tied to the lifetime of the ams::Entity
  * it is attached to. When the ams::Entity is destroyed, all of its components are destroyed.
  * Components are attached to a ams::Entity using ams::Entity::addComponent().
+ * Components are allocated from pools owned by their Scene and keep their address for their whole lifetime, unless
+ * their type opts into being stored by value with ams::StoreByValue.
  * Components do not have any event handlers and as such they can not be used for behavioral scripting. For
  * scripting, use ams::Behavior.
  */
 class AMS_GAME_EXPORT Component : public Object {
 protected:
   Entity* entity = nullptr;
+  
+  /**
+   * Used by the Scene to relocate components which are stored by value in their archetype. The moved component keeps
+   * the id and the Entity of the source, which is destroyed right after. See ams::StoreByValue.
+   */
+  Component(Component&& other) noexcept = default;
 public:
+    /**
+     * The component types which a component of this type is found as by ams::Entity::getComponent(), besides its own
+     * type: this type and its bases. A type derived from this one inherits the list, so a component type which other
+     * component types are looked up as declares its own, e.g.
+     * <code>using ComponentBases = ComponentBaseList&lt;Weapon, Component&gt;;</code>
+     */
+    using ComponentBases = ComponentBaseList<Component>;
+    
     explicit Component(Entity* entity) : entity(entity) {}
     virtual ~Component() = default;
     
     Component(const Component& other) = delete;
-    Component(Component&& other) noexcept = delete;
     Component& operator=(const Component& other) = delete;
     Component& operator=(Component&& other) noexcept = delete;
     
@@ -55,4 +77,18 @@ public:
     [[nodiscard]] Entity* getEntity() const { return entity; }
 };
 
+/**
+ * @brief Opts a component type into being stored by value in the archetype tables of its Scene.
+ * @details Specialize it as std::true_type for a component type which can be moved without throwing, e.g. one which
+ * does not declare a destructor or a copy or move operation of its own. Components of such a type are packed in the
+ * rows of their archetype, so iterating over them with ams::Scene::query() does not chase a pointer per component.
+ * In exchange, such a component moves whenever its ams::Entity gains or loses a component type, which invalidates the
+ * pointers to it returned by ams::Entity::addComponent() and ams::Entity::getComponent(). Look it up again after
+ * such a change, or keep the ams::EntityHandle instead.
+ * @example
+ * <code>template<> struct ams::StoreByValue&lt;Health&gt; : std::true_type {};</code>
+ */
+template<typename T>
+struct StoreByValue : std::false_type {};
+
 } // ams
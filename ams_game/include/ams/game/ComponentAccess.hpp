@@ -0,0 +1,102 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.ComponentAccess]*/
+/*[exclude begin]*/
+#pragma once
+#include "internal/ComponentType.hpp"
+/*[exclude end]*/
+#include <concepts>
+/*[import ams.game.internal.ComponentType]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief Lists the component types read by a ams::Behavior. See ams::ComponentAccess.
+ */
+template<typename... TComps>
+struct Read {};
+
+/**
+ * @brief Lists the component types written by a ams::Behavior. See ams::ComponentAccess.
+ */
+template<typename... TComps>
+struct Write {};
+
+/**
+ * @brief Declares the component types which a ams::Behavior reads and writes in its update methods.
+ * @details A Behavior type opts into parallel updates by declaring a public member type named Access:
+ * <p><code>using Access = ams::ComponentAccess&lt;ams::Read&lt;MeshComponent&gt;, ams::Write&lt;Transform&gt;&gt;;
+ * </code></p>
+ * By declaring it, the type promises that its update methods only touch the declared components of its own
+ * ams::Entity, and that they record any creation or destruction of Entities or Components in the command buffer of
+ * their thread, see Scene::getCommandBuffer(). When parallel updates are enabled with
+ * Scene::setParallelUpdate(), instances of the type are updated concurrently with each other, and concurrently with
+ * other types whose declared access does not conflict. Types without an Access declaration are always updated on
+ * the main thread.
+ * @tparam TRead - An ams::Read list of component types.
+ * @tparam TWrite - An ams::Write list of component types.
+ */
+template<typename TRead = Read<>, typename TWrite = Write<>>
+struct ComponentAccess;
+
+template<typename... TReads, typename... TWrites>
+struct ComponentAccess<Read<TReads...>, Write<TWrites...>> {
+  /**
+   * @brief Gets the mask of the component types which are read.
+   */
+  static internal::ComponentMask reads() {
+    internal::ComponentMask mask;
+    (mask.set(internal::ComponentType<TReads>::id()), ...);
+    return mask;
+  }
+  
+  /**
+   * @brief Gets the mask of the component types which are written.
+   */
+  static internal::ComponentMask writes() {
+    internal::ComponentMask mask;
+    (mask.set(internal::ComponentType<TWrites>::id()), ...);
+    return mask;
+  }
+};
+
+namespace internal {
+
+/* TDeclaresAccess is a type which declares the components it reads and writes with an ams::ComponentAccess */
+template<typename T>
+concept TDeclaresAccess = requires {
+  { T::Access::reads() } -> std::same_as<ComponentMask>;
+  { T::Access::writes() } -> std::same_as<ComponentMask>;
+};
+
+/**
+ * @brief Checks if two declared accesses conflict, which is when either one writes a type the other reads or writes.
+ */
+constexpr bool accessConflicts(const ComponentMask& readsA, const ComponentMask& writesA,
+                               const ComponentMask& readsB, const ComponentMask& writesB) {
+  return writesA.intersects(readsB) || writesA.intersects(writesB) || readsA.intersects(writesB);
+}
+
+} // internal
+
+} // ams
@@ -45,6 +45,10 @@ public:
   const Mesh* getMesh() const;
   
   void setMesh(Mesh* mesh);
+
+private:
+  /** Updates the bounds of the Entity in the spatial index of its Scene. */
+  void onMeshChanged();
 };
 
 } // ams
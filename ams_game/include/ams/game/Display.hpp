@@ -32,6 +32,7 @@
 /*[export module ams.game.Display]*/
 
 #include <memory>
+#include <vector>
 /*[import ams.spatial.Vec2]*/
 /*[import ams.spatial.Vec3]*/
 /*[import ams.game.Object]*/
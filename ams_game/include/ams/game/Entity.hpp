@@ -24,12 +24,23 @@
 #include "ams_game_export.hpp"
 /*[ignore end]*/
 /*[exclude begin]*/
-#include "internal/CallbackList.hpp"
+#include "internal/Archetype.hpp"
+#include "internal/ComponentType.hpp"
+#include "internal/BehaviorDispatch.hpp"
+#include <ams/PoolAllocator.hpp>
+#include <ams/SlotMap.hpp>
+#include "Util.hpp"
 #include "Object.hpp"
 #include "Transform.hpp"
 #include "Behavior.hpp"
 /*[exclude end]*/
-/*[import ams.game.CallbackList]*/
+#include <memory_resource>
+/*[import ams.game.internal.Archetype]*/
+/*[import ams.game.internal.ComponentType]*/
+/*[import ams.game.internal.BehaviorDispatch]*/
+/*[import ams.PoolAllocator]*/
+/*[import ams.SlotMap]*/
+/*[import ams.game.Util]*/
 /*[import ams.Object]*/
 /*[import ams.Transform]*/
 /*[import ams.Behavior]*/
@@ -40,6 +51,13 @@
 class Component;
 class Scene;
 class Behavior;
+class CommandBuffer;
+
+/**
+ * @brief A handle to an ams::Entity. Unlike an Entity pointer, a handle to a destroyed Entity can be detected as
+ * stale with Scene::isValid().
+ */
+using EntityHandle = SlotHandle;
 
 /* TComponent is a type which inherits from Component */
 template<typename T>
@@ -50,21 +68,42 @@ concept TComponent = std::is_base_of_v<Component, T>;
  * @details An Entity is composed of a ams::Transform and a list of ams::Components. Entities are the basic
  * building blocks of a ams::Scene and their lifecycle is managed by the scene. Entities cannot be directly
  * constructed and are instead created by the Scene::createEntity() method.
+ * The Entity owns its Components, which the Scene stores in the columns of an ams::internal::Archetype so that
+ * Components of the same type can be iterated contiguously. Components, and Entities themselves, are allocated from
+ * pools owned by the Scene, one pool per Component type, and never move. Only the component types which opt in with
+ * ams::StoreByValue live in the archetype's rows, and move with the Entity when it gains or loses a Component.
+ * Component lookups by type cost a bit test in the Entity's component mask and an indexed load. Looking up a base type
+ * which the Entity has no component of exactly also tests the types recorded as derived from it, one bit per type.
+ * A type is recorded as derived from the types listed by its Component::ComponentBases.
  */
 class AMS_GAME_EXPORT Entity final : public Object {
 private:
   Scene* _scene;
-  std::vector<std::unique_ptr<Component>> _components{};
+  EntityHandle _handle{};
+  /** Every Component of this Entity. See destroyComponent() for where each one is stored. */
+  std::pmr::vector<Component*> _components;
+  /** The type id of each Component in _components. */
+  std::pmr::vector<internal::ComponentTypeId> _componentTypes;
   Transform* _transform = nullptr;
 
-  internal::CallbackList<Behavior*> _behaviors;
+  /** The Behaviors in _components, which are registered with the Scene while this Entity owns them. */
+  std::pmr::vector<Behavior*> _behaviors;
+  
+  /** The types of this Entity's Components. */
+  internal::ComponentMask _mask{};
+  /** The first Component of each type in _mask, in type id order. Indexed by _mask.rank(). */
+  std::pmr::vector<Component*> _slots;
+  
+  /** The archetype table which holds this Entity's row, and the index of that row. */
+  internal::Archetype* _archetype = nullptr;
+  size_t _row = 0;
 
   /** private constructor */
   explicit Entity(Scene* scene);
 
   /** private constructor */
   Entity(Scene* scene, const std::string& name) : Entity(scene) {
-    this->name = name;
+    setName(name);
   }
   
   /** private constructor */
@@ -77,9 +116,13 @@ public:
   Entity(const Entity&) = delete;
   Entity& operator=(const Entity&) = delete;
   
+  ~Entity();
+  
 public:
   /**
    * @brief Adds a Component to the Entity.
+   * @details The returned pointer is valid until the Component is removed, unless TComp opts into ams::StoreByValue:
+   * then it is only valid until the Entity gains or loses a Component.
    * @tparam TComp - The type of Component to add.
    * @return A pointer to the newly created Component.
    */
@@ -89,12 +132,15 @@ public:
     if constexpr (std::is_same_v<TComp, Transform>)
       if (_transform != nullptr)
         return throwOrDefault<std::invalid_argument, TComp*>("Entity already has a Transform", nullptr);
-    auto comp = std::make_unique<TComp>(this);
-    auto ptr = comp.get();
-    _components.emplace_back(std::move(comp));
-    auto pBehavior = dynamic_cast<Behavior*>(ptr);
-    if (pBehavior != nullptr) {
-      _behaviors.add(pBehavior);
+    auto* ptr = getComponentPool(internal::ComponentType<TComp>::id(), sizeof(TComp), alignof(TComp))
+      .template make<TComp>(this).release();
+    _components.push_back(ptr);
+    _componentTypes.push_back(internal::ComponentType<TComp>::id());
+    ptr = static_cast<TComp*>(
+      onComponentAdded(internal::ComponentType<TComp>::id(), ptr, internal::ComponentStorage::of<TComp>()));
+    if constexpr (std::is_base_of_v<Behavior, TComp>) {
+      ptr->_hooks = internal::BehaviorTraits<TComp>::hooks();
+      onBehaviorAdded(ptr);
     }
     return ptr;
   }
@@ -118,16 +164,20 @@ public:
   
   /**
    * @brief Get the component of type TComp.
+   * @details The returned pointer is valid until the Component is removed, unless TComp opts into ams::StoreByValue:
+   * then it is only valid until the Entity gains or loses a Component.
    * @tparam TComp - The type of component to get.
    * @return A pointer to the component of type TComp, or nullptr if the component does not exist.
    */
   template<TComponent TComp>
   TComp* getComponent() {
-    for (auto& component : _components) {
-      auto comp = dynamic_cast<TComp*>(component.get());
-      if (comp != nullptr) {
-        return comp;
-      }
+    auto type = internal::ComponentType<TComp>::id();
+    if (_mask.test(type))
+      return static_cast<TComp*>(_slots[_mask.rank(type)]);
+    // a non-final TComp may still be a base of one of the components
+    if constexpr (!std::is_final_v<TComp>) {
+      if (auto* component = findDerived(type); component != nullptr)
+        return static_cast<TComp*>(component);
     }
     if constexpr (AMSExceptions) {
       throw std::runtime_error("Component not found");
@@ -135,6 +185,52 @@ public:
     return nullptr;
   }
   
+  /**
+   * @brief Removes a Component of type TComp from the Entity and destroys it.
+   * @details If the Entity has more than one Component of type TComp, the first one is removed. The Transform can
+   * not be removed. While the Scene is updating its Behaviors, the removal is recorded in the Scene's command buffer
+   * and applied at the next sync point instead. See ams::CommandBuffer.
+   * @tparam TComp - The type of Component to remove.
+   * @return true if a Component was removed or its removal was recorded, false if the Entity has no such Component.
+   */
+  template<TComponent TComp>
+  bool removeComponent() {
+    if constexpr (std::is_same_v<TComp, Transform>) {
+      return throwOrDefault<std::invalid_argument, bool>("The Transform of an Entity can not be removed", false);
+    } else {
+      auto type = internal::ComponentType<TComp>::id();
+      if (_mask.test(type))
+        return removeComponent(_slots[_mask.rank(type)]);
+      if constexpr (!std::is_final_v<TComp>) {
+        if (auto* component = findDerived(type); component != nullptr)
+          return removeComponent(component);
+      }
+      return false;
+    }
+  }
+  
+  /**
+   * @brief Checks if the Entity has a component of type TComp.
+   * @tparam TComp - The type of component to check.
+   * @return true if the Entity has a component of type TComp.
+   */
+  template<TComponent TComp>
+  [[nodiscard]] bool hasComponent() const {
+    auto type = internal::ComponentType<TComp>::id();
+    if (_mask.test(type))
+      return true;
+    if constexpr (!std::is_final_v<TComp>)
+      return findDerived(type) != nullptr;
+    return false;
+  }
+  
+  /**
+   * @brief Gets the handle of the Entity in its Scene.
+   */
+  [[nodiscard]] EntityHandle getHandle() const {
+    return _handle;
+  }
+  
   [[nodiscard]] Transform* getTransform() const {
     return _transform;
   }
@@ -143,7 +239,99 @@ public:
   
   [[nodiscard]] Scene* getScene() const;
   
+private:
+  /**
+   * @brief Records a new component in the component mask and moves this Entity's row to the archetype which
+   * includes the component's type.
+   * @param storage - The storage of the component's type, or nullptr if it is not stored by value.
+   * @return The component, which has been relocated into the row if its type is stored by value.
+   */
+  Component* onComponentAdded(internal::ComponentTypeId type, Component* component,
+                              const internal::ComponentStorage* storage);
+  
+  /**
+   * @brief Lists a new Behavior and registers it with the Scene.
+   */
+  void onBehaviorAdded(Behavior* behavior);
+  
+  /**
+   * @brief Tests if a component is constructed in this Entity's archetype row rather than allocated from its pool.
+   * @details That is the case of the first component of each type which is stored by value, while the Entity is in an
+   * archetype.
+   */
+  [[nodiscard]] bool isStoredInRow(internal::ComponentTypeId type, const Component* component) const;
+  
+  /**
+   * @brief Destroys a component which is no longer listed by this Entity, in its row or in its pool.
+   * @param inRow - The result of isStoredInRow() before the component was unlisted.
+   */
+  void destroyComponent(internal::ComponentTypeId type, Component* component, bool inRow);
+  
+  /**
+   * @brief Updates the slot and the component list after a component was relocated.
+   * @param slot - The slot of the component.
+   * @param component - The new address of the component.
+   */
+  void onComponentRelocated(size_t slot, Component* component);
+  
+  /**
+   * @brief Finds the component of a type derived from a component type. Derived types are recorded when component
+   * types are registered, so this does not cast any component.
+   * @param base - The id of the component type, which is not in the component mask.
+   * @return The first component of the derived type with the lowest id, or nullptr if there is none.
+   */
+  [[nodiscard]] Component* findDerived(internal::ComponentTypeId base) const {
+    auto type = internal::findDerivedComponentType(base, _mask);
+    return type != internal::AMSMaxComponentTypes ? _slots[_mask.rank(type)] : nullptr;
+  }
+  
+  /**
+   * @brief Finds a component by its id, which survives relocations.
+   * @return The component, or nullptr if this Entity does not own it.
+   */
+  [[nodiscard]] Component* findComponent(uuid_t id) const;
+  
+  /**
+   * @brief Adds a Component without registering it with the Scene if it is a Behavior. Used by Scene::instantiate(),
+   * which places its Entities in their archetype and registers their Behaviors in bulk.
+   * @details A Behavior is listed in _behaviors without going through onBehaviorAdded(), which would register it with
+   * the Scene, enable and start it one by one. Scene::instantiate() registers every Behavior of its Entities before it
+   * returns. Unregistering a Behavior which is not registered does nothing, so a Behavior which is destroyed first is
+   * simply never registered.
+   * @param pool - The Scene's pool for TComp.
+   */
+  template<TComponent TComp>
+  TComp* addComponentDeferred(PoolAllocator& pool) {
+    auto* ptr = pool.template make<TComp>(this).release();
+    _components.push_back(ptr);
+    _componentTypes.push_back(internal::ComponentType<TComp>::id());
+    ptr = static_cast<TComp*>(
+      onComponentAdded(internal::ComponentType<TComp>::id(), ptr, internal::ComponentStorage::of<TComp>()));
+    if constexpr (std::is_base_of_v<Behavior, TComp>) {
+      ptr->_hooks = internal::BehaviorTraits<TComp>::hooks();
+      _behaviors.push_back(ptr);
+    }
+    return ptr;
+  }
+  
+  /**
+   * @brief Removes and destroys a component, or records its removal if the Scene is dispatching.
+   * @return false if the component is not owned by this Entity.
+   */
+  bool removeComponent(Component* component);
+  
+  /**
+   * @brief Gets the Scene's pool for a component type.
+   */
+  PoolAllocator& getComponentPool(internal::ComponentTypeId type, size_t size, size_t align);
+  
+  /** The memory resource of the Scene, which stores the component lists of its Entities. */
+  static std::pmr::memory_resource* getMetadataResource(Scene* scene);
+  
+public:
   friend class Scene; // Constructs Entities
+  friend class CommandBuffer;
+  friend class Prefab;
 };
 
 } // ams
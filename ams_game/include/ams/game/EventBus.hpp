@@ -0,0 +1,287 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.EventBus]*/
+/*[exclude begin]*/
+#pragma once
+#include "internal/ComponentType.hpp"
+#include <ams/SlotMap.hpp>
+/*[exclude end]*/
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <vector>
+/*[import ams.game.internal.ComponentType]*/
+/*[import ams.SlotMap]*/
+
+/*[export]*/ namespace ams {
+
+/* TEvent is a plain data type which can be queued by an ams::EventBus */
+template<typename T>
+concept TEvent = std::is_trivially_copyable_v<T> && std::is_default_constructible_v<T>;
+
+/**
+ * @brief A handle to a handler subscribed to an ams::EventBus. A default constructed handle is never valid.
+ */
+struct EventHandle {
+  uint32_t type = SlotHandle::InvalidIndex;
+  SlotHandle handler{};
+  
+  [[nodiscard]] constexpr bool isNull() const { return handler.isNull(); }
+};
+
+namespace internal {
+
+/**
+ * @brief Maps a type hash to a dense event type id, in registration order.
+ * @param hash - The hash of the event type. See ams::internal::typeHash().
+ */
+AMS_GAME_EXPORT uint32_t registerEventType(uint64_t hash);
+
+/**
+ * @brief Compile-time information about an event type.
+ * @tparam T - The event type.
+ */
+template<typename T>
+struct EventType {
+  static uint32_t id() {
+    static const uint32_t value = registerEventType(typeHash<T>());
+    return value;
+  }
+};
+
+class EventChannelBase {
+public:
+  virtual ~EventChannelBase() = default;
+  virtual size_t dispatch() = 0;
+  virtual bool unsubscribe(SlotHandle handler) = 0;
+  virtual void clear() = 0;
+};
+
+/**
+ * @brief The queue and the handlers of one event type.
+ * @details Events are queued in a ring buffer whose capacity is a power of two and doubles when it is full.
+ * dispatch() moves the queued events into a batch under the lock, then calls each handler once with the whole batch,
+ * so events published meanwhile, including by the handlers themselves, are queued for the next dispatch.
+ */
+template<TEvent T>
+class EventChannel final : public EventChannelBase {
+public:
+  struct Handler {
+    std::function<void(std::span<const T>)> function;
+    bool removed = false;
+  };
+  
+private:
+  std::mutex _mutex{};
+  std::vector<T> _ring = std::vector<T>(64);
+  size_t _head = 0;
+  size_t _size = 0;
+  std::vector<T> _batch{};
+  /** Handlers are boxed so that subscribing from a handler does not move the handler which is running. */
+  SlotMap<std::unique_ptr<Handler>> _handlers{};
+  std::vector<SlotHandle> _removed{};
+  bool _dispatching = false;
+  
+public:
+  void publish(const T& event) {
+    std::lock_guard lock(_mutex);
+    if (_size == _ring.size())
+      grow();
+    _ring[(_head + _size) & (_ring.size() - 1)] = event;
+    ++_size;
+  }
+  
+  SlotHandle subscribe(std::function<void(std::span<const T>)> function) {
+    return _handlers.insert(std::make_unique<Handler>(Handler{std::move(function)}));
+  }
+  
+  bool unsubscribe(SlotHandle handler) override {
+    auto* upHandler = _handlers.get(handler);
+    if (upHandler == nullptr || (*upHandler)->removed)
+      return false;
+    if (!_dispatching)
+      return _handlers.erase(handler);
+    // erasing would move the last handler into the place of this one while the handlers are being iterated
+    (*upHandler)->removed = true;
+    _removed.push_back(handler);
+    return true;
+  }
+  
+  size_t dispatch() override {
+    if (_dispatching)
+      return 0;
+    {
+      std::lock_guard lock(_mutex);
+      _batch.resize(_size);
+      auto first = std::min(_size, _ring.size() - _head);
+      std::copy_n(_ring.begin() + static_cast<ptrdiff_t>(_head), first, _batch.begin());
+      std::copy_n(_ring.begin(), _size - first, _batch.begin() + static_cast<ptrdiff_t>(first));
+      _head = 0;
+      _size = 0;
+    }
+    if (_batch.empty())
+      return 0;
+    _dispatching = true;
+    std::span<const T> batch = _batch;
+    // handlers subscribed meanwhile are appended, and receive the next batch
+    for (size_t i = 0, count = _handlers.size(); i < count; ++i) {
+      auto* handler = _handlers.data()[i].get();
+      if (!handler->removed)
+        handler->function(batch);
+    }
+    _dispatching = false;
+    for (auto handle : _removed)
+      _handlers.erase(handle);
+    _removed.clear();
+    return batch.size();
+  }
+  
+  void clear() override {
+    std::lock_guard lock(_mutex);
+    _head = 0;
+    _size = 0;
+  }
+  
+  [[nodiscard]] size_t pending() {
+    std::lock_guard lock(_mutex);
+    return _size;
+  }
+  
+private:
+  void grow() {
+    std::vector<T> ring(_ring.size() * 2);
+    auto first = _ring.size() - _head;
+    std::copy(_ring.begin() + static_cast<ptrdiff_t>(_head), _ring.end(), ring.begin());
+    std::copy_n(_ring.begin(), _head, ring.begin() + static_cast<ptrdiff_t>(first));
+    _ring = std::move(ring);
+    _head = 0;
+  }
+};
+
+} // internal
+
+/**
+ * @brief An EventBus queues typed events and delivers them in batches at a defined point of the frame.
+ * @details Producers publish plain data events, which are queued per event type. Consumers subscribe a handler per
+ * event type, which dispatch() calls once per type with every event queued since the last dispatch, instead of
+ * calling every listener for every event as it happens. Handlers therefore never run inside the code which publishes
+ * the event, and events published by a handler are delivered at the next dispatch.
+ * Subscribing and unsubscribing are O(1) by handle, and may be done from a handler.
+ * publish() may be called from any thread. subscribe(), unsubscribe() and dispatch() must be called from the thread
+ * which dispatches, which is the main thread for the bus of the ams::Application.
+ */
+class AMS_GAME_EXPORT EventBus {
+public:
+  /** The maximum number of event types. */
+  static constexpr size_t MaxEventTypes = 256;
+
+private:
+  /** The channel of each event type id, created on first use. Read without locking. */
+  std::array<std::atomic<internal::EventChannelBase*>, MaxEventTypes> _channels{};
+  /** Owns the channels, in creation order, which is the dispatch order. */
+  std::vector<std::unique_ptr<internal::EventChannelBase>> _channelStorage{};
+  std::mutex _channelsMutex{};
+  std::vector<internal::EventChannelBase*> _dispatchOrder{};
+
+public:
+  EventBus() = default;
+  EventBus(const EventBus&) = delete;
+  EventBus& operator=(const EventBus&) = delete;
+  ~EventBus();
+  
+  /**
+   * @brief Queues an event until the next dispatch(). Thread safe.
+   * @param event - The event.
+   */
+  template<TEvent T>
+  void publish(const T& event) {
+    getChannel<T>().publish(event);
+  }
+  
+  /**
+   * @brief Subscribes a handler to an event type.
+   * @param handler - Called by dispatch() with the events of type T queued since the last dispatch. Not called if
+   * there are none.
+   * @return The handle of the handler.
+   */
+  template<TEvent T>
+  EventHandle subscribe(std::function<void(std::span<const T>)> handler) {
+    return {internal::EventType<T>::id(), getChannel<T>().subscribe(std::move(handler))};
+  }
+  
+  /**
+   * @brief Unsubscribes a handler. A handler which unsubscribes while its batch is being dispatched is not called
+   * again.
+   * @param handle - The handle returned by subscribe().
+   * @return false if the handle is stale.
+   */
+  bool unsubscribe(const EventHandle& handle);
+  
+  /**
+   * @brief Delivers the queued events of one type.
+   * @return The number of events delivered.
+   */
+  template<TEvent T>
+  size_t dispatch() {
+    return getChannel<T>().dispatch();
+  }
+  
+  /**
+   * @brief Delivers the queued events of every type, in the order the types were first used.
+   * @return The number of events delivered.
+   */
+  size_t dispatch();
+  
+  /**
+   * @brief Gets the number of queued events of a type.
+   */
+  template<TEvent T>
+  [[nodiscard]] size_t pending() {
+    return getChannel<T>().pending();
+  }
+  
+  /**
+   * @brief Drops the queued events of every type. Handlers stay subscribed.
+   */
+  void clear();
+
+private:
+  template<TEvent T>
+  internal::EventChannel<T>& getChannel() {
+    auto type = internal::EventType<T>::id();
+    auto* channel = _channels[type].load(std::memory_order_acquire);
+    if (channel == nullptr)
+      channel = addChannel(type, [] { return std::unique_ptr<internal::EventChannelBase>(new internal::EventChannel<T>()); });
+    return *static_cast<internal::EventChannel<T>*>(channel);
+  }
+  
+  /** Creates the channel of a type unless another thread did first. */
+  internal::EventChannelBase* addChannel(uint32_t type, std::unique_ptr<internal::EventChannelBase> (*make)());
+};
+
+} // ams
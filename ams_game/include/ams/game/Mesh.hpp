@@ -25,6 +25,7 @@
 #include <ams/Serializable.hpp>
 #include <ams/spatial/internal/config.hpp>
 #include <ams/spatial/Vec.hpp>
+#include <ams/spatial/Bounds.hpp>
 #include "Object.hpp"
 /*[exclude end]*/
 #include <string>
@@ -34,6 +35,7 @@
 /*[import ams.Serializable]*/
 /*[import ams.spatial.internal.config]*/
 /*[import ams.spatial.Vec]*/
+/*[import ams.spatial.Bounds]*/
 /*[import ams.game.Object]*/
 
 /*[export]*/ namespace ams {
@@ -142,6 +144,10 @@ protected:
    * @details Each submesh is a list of faces.
    */
   submeshes_t submeshes;
+  /**
+   * @brief The box which contains the vertices of the mesh, updated with them.
+   */
+  AABB bounds;
   
   inline static std::map<const std::string, std::unique_ptr<IMeshLoader>> meshLoaders{};
 
@@ -165,6 +171,12 @@ public:
    */
   void setVertices(const vertices_t& vertices);
   
+  /**
+   * @brief Gets the box which contains the vertices of the mesh. The box is empty if the mesh has no vertices.
+   * @details The box is computed when the vertices are set, so getting it does not visit the vertices.
+   */
+  [[nodiscard]] const AABB& getBounds() const;
+  
   /**
    * @brief Get the normals of the mesh.
    */
@@ -351,6 +363,10 @@ public:
   }
 
   static normals_t generateNormals(vertices_t vts, faces_t faces);
+
+private:
+  /** Recomputes bounds from the vertices. */
+  void updateBounds();
 };
 
 } // ams
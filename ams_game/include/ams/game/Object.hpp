@@ -21,9 +21,12 @@
 #include "ams_game_export.hpp"
 #include "ams/game/Exceptions.hpp"
 #include "ams/game/Logger.hpp"
+#include <ams/IdAllocator.hpp>
 /*[exclude end]*/
+#include <atomic>
+#include <mutex>
 /*[export]*/ #include <string>
-#include <random>
+/*[import ams.IdAllocator]*/
 /*[export import ams.game.Exceptions]*/
 /*[export import ams.game.Logger]*/
 
@@ -36,25 +39,53 @@ using uuid_t = uint64_t;
 /**
  * @brief The Object class is the base class for all objects in the game engine.
  * @details The Object class is the base class for all objects in the game engine.
- * It stores the a name and a unique identifier.
+ * It stores the a name and a unique identifier, allocated by ams::IdAllocator.
+ * An Object which is not given a name is named "Object_<id>". That name is only built the first time getName() is
+ * called, so that creating unnamed Entities and Components does not allocate a string each.
  */
 class AMS_GAME_EXPORT Object {
 protected:
   const uuid_t id;
-  std::string name;
+private:
+  mutable std::string name;
+  /** true once name holds the name of the Object. */
+  mutable std::atomic<bool> named;
+  
 public:
-  Object() : id(dis(gen)) {
-    name = "Object_" + std::to_string(id);
+  Object() : id(IdAllocator::next()), named(false) {}
+  explicit Object(const std::string& name) : id(IdAllocator::next()), name(name), named(true) {}
+  Object(const Object& other) : id(other.id), name(other.getName()), named(true) {}
+  Object(Object&& other) noexcept
+  : id(other.id), name(std::move(other.name)), named(other.named.load(std::memory_order_relaxed)) {}
+  
+protected:
+  /**
+   * @brief Sets the name of the Object. It must not be called while another thread reads the name.
+   * @param value - The new name.
+   */
+  void setName(std::string value) {
+    name = std::move(value);
+    named.store(true, std::memory_order_release);
   }
-  explicit Object(const std::string& name) : id(dis(gen)), name(name) {}
 
+public:
   [[nodiscard]] const uuid_t& getId() const { return id; }
-  [[nodiscard]] const std::string& getName() const { return name; }
   
+  [[nodiscard]] const std::string& getName() const {
+    if (!named.load(std::memory_order_acquire))
+      nameDefault();
+    return name;
+  }
+
 private:
-  inline static std::random_device rd{};
-  inline static std::mt19937 gen{rd()};
-  inline static std::uniform_int_distribution<uint64_t> dis{};
+  void nameDefault() const {
+    static std::mutex mutex;
+    std::lock_guard lock(mutex);
+    if (named.load(std::memory_order_relaxed))
+      return;
+    name = "Object_" + std::to_string(id);
+    named.store(true, std::memory_order_release);
+  }
 };
 
 } // ams
@@ -0,0 +1,160 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.Prefab]*/
+/*[exclude begin]*/
+#pragma once
+#include "Entity.hpp"
+#include "SceneSnapshot.hpp"
+#include "Transform.hpp"
+#include "internal/ComponentType.hpp"
+/*[exclude end]*/
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+/*[import ams.game.Entity]*/
+/*[import ams.game.SceneSnapshot]*/
+/*[import ams.game.Transform]*/
+/*[import ams.game.internal.ComponentType]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief A Prefab is a template of an ams::Entity: the types of its Components and their initial values.
+ * @details A Prefab is described once and instantiated many times with Scene::instantiate(), which allocates the
+ * storage of all instances in bulk, places them in their archetype directly and registers their Behaviors in one
+ * batch. Components are polymorphic and can not be copied, so the initial value of a Component is its
+ * SnapshotState (see ams::TSnapshotComponent), which is copied into each instance with memcpy and applied with
+ * loadSnapshot(). Components added without a state are default constructed.
+ * <p><code>Prefab enemy("Enemy");<br>
+ * enemy.add&lt;Health&gt;({100}).add&lt;EnemyAI&gt;();<br>
+ * scene->instantiate(enemy, 5000);</code></p>
+ */
+class AMS_GAME_EXPORT Prefab {
+private:
+  struct ComponentEntry {
+    internal::ComponentTypeId (*id)();
+    size_t size;
+    size_t align;
+    /** The hooks of the component type if it is a Behavior, or nullptr. */
+    const internal::BehaviorHooks* hooks;
+    Component* (*add)(Entity* entity, PoolAllocator& pool);
+    /** Applies the state stored at stateOffset, or nullptr if the component has no state. */
+    void (*load)(Component* component, const std::byte* state);
+    size_t stateOffset;
+  };
+  
+  std::string _name;
+  Vec3<decimal_t> _position = Vec3(0.0, 0.0, 0.0);
+  Quaternion _rotation = Quaternion::identity();
+  Vec3<decimal_t> _scale = Vec3(1.0, 1.0, 1.0);
+  std::vector<ComponentEntry> _components{};
+  /** The states of the components, back to back. */
+  std::vector<std::byte> _states{};
+
+public:
+  /**
+   * @brief Creates an empty Prefab. Its instances only have a Transform.
+   * @param name - The name of the instances. If empty, each instance gets the default name of an ams::Object.
+   */
+  explicit Prefab(std::string name = "") : _name(std::move(name)) {}
+  
+  /**
+   * @brief Adds a default constructed Component to the Prefab.
+   * @tparam TComp - The type of the Component.
+   * @return This Prefab, to chain calls.
+   */
+  template<TComponent TComp> requires (!std::is_same_v<TComp, Transform>)
+  Prefab& add() {
+    _components.push_back(makeEntry<TComp>());
+    return *this;
+  }
+  
+  /**
+   * @brief Adds a Component to the Prefab with an initial state.
+   * @tparam TComp - The type of the Component.
+   * @param state - The state applied with TComp::loadSnapshot() to the Component of each instance.
+   * @return This Prefab, to chain calls.
+   */
+  template<TSnapshotComponent TComp> requires (!std::is_same_v<TComp, Transform>)
+  Prefab& add(const typename TComp::SnapshotState& state) {
+    using State = typename TComp::SnapshotState;
+    auto entry = makeEntry<TComp>();
+    entry.stateOffset = _states.size();
+    entry.load = [](Component* component, const std::byte* src) {
+      State value;
+      std::memcpy(&value, src, sizeof(State));
+      static_cast<TComp*>(component)->loadSnapshot(value);
+    };
+    _states.resize(_states.size() + sizeof(State));
+    std::memcpy(_states.data() + entry.stateOffset, &state, sizeof(State));
+    _components.push_back(entry);
+    return *this;
+  }
+  
+  /**
+   * @brief Sets the initial position of the Transform of each instance.
+   */
+  Prefab& setPosition(const Vec3<decimal_t>& position) { _position = position; return *this; }
+  
+  /**
+   * @brief Sets the initial rotation of the Transform of each instance.
+   */
+  Prefab& setRotation(const Quaternion& rotation) { _rotation = rotation; return *this; }
+  
+  /**
+   * @brief Sets the initial scale of the Transform of each instance.
+   */
+  Prefab& setScale(const Vec3<decimal_t>& scale) { _scale = scale; return *this; }
+  
+  [[nodiscard]] const std::string& getName() const { return _name; }
+  
+  /**
+   * @brief Gets the number of Components of each instance, not counting its Transform.
+   */
+  [[nodiscard]] size_t getComponentCount() const { return _components.size(); }
+
+private:
+  template<typename TComp>
+  static ComponentEntry makeEntry() {
+    const internal::BehaviorHooks* hooks = nullptr;
+    if constexpr (std::is_base_of_v<Behavior, TComp>)
+      hooks = internal::BehaviorTraits<TComp>::hooks();
+    return ComponentEntry{
+      &internal::ComponentType<TComp>::id,
+      sizeof(TComp),
+      alignof(TComp),
+      hooks,
+      [](Entity* entity, PoolAllocator& pool) -> Component* {
+        return entity->template addComponentDeferred<TComp>(pool);
+      },
+      nullptr,
+      0
+    };
+  }
+  
+  friend class Scene;
+};
+
+} // ams
@@ -0,0 +1,174 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.Query]*/
+/*[exclude begin]*/
+#pragma once
+#include "Component.hpp"
+#include "internal/Archetype.hpp"
+#include "internal/ComponentType.hpp"
+/*[exclude end]*/
+#include <algorithm>
+#include <new>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+/*[import ams.game.Component]*/
+/*[import ams.game.internal.Archetype]*/
+/*[import ams.game.internal.ComponentType]*/
+
+/*[export]*/ namespace ams {
+class Entity;
+class Scene;
+}
+
+/*[export]*/ namespace ams::internal {
+
+/**
+ * @brief The archetypes matched by a query, and the columns of the query's component types in each of them.
+ * @details The cache is owned by the ams::Scene, which matches every archetype it creates against every cache, so
+ * the set of archetypes only grows and never needs to be recomputed. Entities which gain or lose components move
+ * between archetypes, so they join or leave the query without the cache being touched.
+ */
+struct AMS_GAME_EXPORT QueryCache {
+  /** Every component type of the query. */
+  ComponentMask mask;
+  /** The component types of the query, in the order of the query's template arguments. */
+  std::vector<ComponentTypeId> types;
+  /** The archetypes whose signature contains the mask, in creation order. */
+  std::vector<Archetype*> archetypes{};
+  /** The column of each type in each matched archetype: types.size() columns per archetype. */
+  std::vector<uint32_t> columns{};
+  
+  explicit QueryCache(std::span<const ComponentTypeId> types);
+  
+  /**
+   * @brief Adds an archetype to the cache if it stores every component type of the query.
+   * @return true if the archetype was added.
+   */
+  bool match(Archetype* archetype);
+};
+
+/**
+ * @brief The components of type T in one chunk of an archetype column, indexed by row within the chunk.
+ * @details Components stored by value are addressed at a fixed stride from the start of the column in the chunk, the
+ * others through the column's pointers.
+ */
+template<typename T>
+class ChunkColumn {
+private:
+  std::conditional_t<IsStoredByValue<T>, std::byte*, Component* const*> _data;
+
+public:
+  ChunkColumn(const Archetype& archetype, size_t column, size_t chunk) {
+    if constexpr (IsStoredByValue<T>)
+      _data = archetype.getChunkColumn(chunk, column);
+    else
+      _data = archetype.getPointerColumn(column).data() + chunk * Archetype::RowsPerChunk;
+  }
+  
+  T& operator[](size_t row) const {
+    if constexpr (IsStoredByValue<T>)
+      return *std::launder(reinterpret_cast<T*>(_data + row * sizeof(T)));
+    else
+      return static_cast<T&>(*_data[row]);
+  }
+};
+
+} // ams::internal
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief A Query visits every ams::Entity of a Scene which has all of the component types TComps.
+ * @details A Query is a cheap handle to a cache owned by the Scene, obtained with ams::Scene::query(). It may be kept
+ * and reused for the lifetime of the Scene. Iterating streams over the matching archetypes' columns one chunk at a
+ * time and does not allocate. Like ams::Scene::forEach(), only the exact types are matched, not types derived from them.
+ * Entities must not gain or lose components while they are being iterated. Record such changes in the Scene's
+ * ams::CommandBuffer instead, which Behaviors do implicitly.
+ * @tparam TComps - The component types.
+ */
+template<typename... TComps> requires (sizeof...(TComps) > 0 && (std::is_base_of_v<Component, TComps> && ...))
+class Query {
+private:
+  static constexpr size_t TypeCount = sizeof...(TComps);
+  const internal::QueryCache* _cache;
+
+public:
+  explicit Query(const internal::QueryCache& cache) : _cache(&cache) {}
+  
+  /**
+   * @brief Calls a function for every matching ams::Entity, archetype by archetype, in row order.
+   * @param fn - The function to call. It receives a reference to each component, in the order of TComps, optionally
+   * preceded by a reference to the ams::Entity.
+   */
+  template<typename TFunc>
+  void each(TFunc&& fn) const {
+    // archetypes created by fn are appended to the cache, so it is indexed rather than iterated
+    for (size_t i = 0; i < _cache->archetypes.size(); ++i)
+      eachRow(*_cache->archetypes[i], &_cache->columns[i * TypeCount], fn, std::index_sequence_for<TComps...>{});
+  }
+  
+  /**
+   * @brief Gets the number of matching Entities.
+   */
+  [[nodiscard]] size_t size() const {
+    size_t count = 0;
+    for (auto* archetype : _cache->archetypes)
+      count += archetype->size();
+    return count;
+  }
+  
+  [[nodiscard]] bool empty() const { return size() == 0; }
+  
+  /**
+   * @brief Gets the archetypes matched by the query.
+   */
+  [[nodiscard]] std::span<internal::Archetype* const> getArchetypes() const { return _cache->archetypes; }
+
+private:
+  template<typename TFunc, size_t... Is>
+  static void eachRow(const internal::Archetype& archetype, const uint32_t* columns, TFunc& fn,
+                      std::index_sequence<Is...>) {
+    constexpr size_t RowsPerChunk = internal::Archetype::RowsPerChunk;
+    auto entities = archetype.getEntities();
+    for (size_t chunk = 0; chunk * RowsPerChunk < entities.size(); ++chunk) {
+      const std::tuple<internal::ChunkColumn<TComps>...> data{
+        internal::ChunkColumn<TComps>(archetype, columns[Is], chunk)...};
+      auto* rows = entities.data() + chunk * RowsPerChunk;
+      auto count = std::min(RowsPerChunk, entities.size() - chunk * RowsPerChunk);
+      for (size_t row = 0; row < count; ++row) {
+        // free rows are skipped
+        if (rows[row] == nullptr)
+          continue;
+        if constexpr (std::is_invocable_v<TFunc&, Entity&, TComps&...>)
+          fn(*rows[row], std::get<Is>(data)[row]...);
+        else
+          fn(std::get<Is>(data)[row]...);
+      }
+    }
+  }
+};
+
+} // ams
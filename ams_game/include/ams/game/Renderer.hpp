@@ -22,12 +22,12 @@
 /*[export module ams.Renderer]*/
 /*[exclude begin]*/
 #pragma once
-#include <ams/Function.hpp>
 #include "Object.hpp"
+#include "EventBus.hpp"
 #include "internal/RendererBackend.hpp"
 /*[exclude end]*/
-/*[import ams.Function]*/
 /*[import ams.game.Object]*/
+/*[import ams.game.EventBus]*/
 /*[import ams.game.internal.RendererBackend]*/
 
 /*[export]*/ namespace ams {
@@ -45,7 +45,8 @@ private:
   Window* _window;
   Scene* _scene;
   std::unique_ptr<internal::RendererBackend> _rendererImpl;
-  Function<void,Scene*,Scene*> _sceneChangeCallback;
+  /** Keeps _scene up to date with the current scene of the Application. */
+  EventHandle _sceneChangeHandle{};
 public:
   /**
    * @brief Construct a new Renderer object
@@ -28,13 +28,47 @@
 #include "Object.hpp"
 #include "Camera.hpp"
 #include "Entity.hpp"
+#include "CommandBuffer.hpp"
+#include "Prefab.hpp"
+#include "Query.hpp"
+#include "SpatialIndex.hpp"
+#include "System.hpp"
+#include "internal/Archetype.hpp"
+#include "internal/BehaviorDispatch.hpp"
+#include "internal/SystemScheduler.hpp"
+#include "internal/TransformHierarchy.hpp"
+#include <ams/Delegate.hpp>
+#include <ams/JobSystem.hpp>
+#include <ams/PoolAllocator.hpp>
+#include <ams/SlotMap.hpp>
 /*[exclude end]*/
+#include <array>
 #include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
 /*[import <chrono>]*/
 /*[import ams.game.config]*/
 /*[import ams.game.Object]*/
 /*[import ams.game.Camera]*/
 /*[import ams.game.Entity]*/
+/*[import ams.game.CommandBuffer]*/
+/*[import ams.game.Prefab]*/
+/*[import ams.game.Query]*/
+/*[import ams.game.SpatialIndex]*/
+/*[import ams.game.System]*/
+/*[import ams.game.internal.Archetype]*/
+/*[import ams.game.internal.BehaviorDispatch]*/
+/*[import ams.game.internal.SystemScheduler]*/
+/*[import ams.game.internal.TransformHierarchy]*/
+/*[import ams.Delegate]*/
+/*[import ams.JobSystem]*/
+/*[import ams.PoolAllocator]*/
+/*[import ams.SlotMap]*/
 
 enum class EntityCfg {
   Camera,
@@ -59,6 +93,9 @@ class Behavior;
  * @brief A Scene is a collection of Entities.
  * @details A Scene is a collection of Entities. It is the main container for all instantiated Entities in a game.
  * Its lifecycle is managed by the Application class.
+ * The Scene owns the memory of its Entities and Components: Entities and each type of Component are allocated from
+ * their own ams::PoolAllocator, and every pool draws its chunks from a scene-wide monotonic arena, so creating an
+ * Entity does not reach the heap once the pools have grown, and exiting the Scene frees all of it at once.
  */
 class AMS_GAME_EXPORT Scene : public Object {
 private:
@@ -69,15 +106,54 @@ private:
   };
   
   Application* _application;
-  std::map<uuid_t, std::unique_ptr<Entity>> _entities{};
-  std::map<uuid_t, Behavior*> _behaviors{};
-  std::map<uuid_t, EntityCam> _cameras{};
+  /** Backs every pool below. Declared first so that it outlives them. */
+  std::pmr::monotonic_buffer_resource _arena{};
+  /** Stores the component lists of the Entities. */
+  std::pmr::unsynchronized_pool_resource _metadata{&_arena};
+  PoolAllocator _entityPool{sizeof(Entity), alignof(Entity), 256, &_arena};
+  /** One pool per component type, indexed by type id. */
+  std::vector<std::unique_ptr<PoolAllocator>> _componentPools{};
+  /** The storage of each component type stored by value, indexed by type id. nullptr for the other types. */
+  std::vector<const internal::ComponentStorage*> _componentStorages{};
+  /** Archetype tables keyed by their signature. Declared before _entities so that they outlive the Entities. */
+  std::map<internal::ArchetypeSignature, std::unique_ptr<internal::Archetype>> _archetypes{};
+  /** The caches of every query made on the Scene. Archetypes are matched against them as they are created. */
+  std::vector<std::unique_ptr<internal::QueryCache>> _queries{};
+  /** Guards _queries, since Systems running on the JobSystem's workers may make queries. */
+  std::mutex _queriesMutex{};
+  /** Computes the world matrices of the Entities' Transforms. Declared before _entities so that it outlives them. */
+  internal::TransformHierarchy _transformHierarchy{};
+  SpatialIndex _spatialIndex{};
+  bool _spatialIndexEnabled = false;
+  SlotMap<PoolPtr<Entity>> _entities{};
+  SlotMap<Behavior*> _behaviors{};
+  SlotMap<EntityCam> _cameras{};
+  /** Behaviors grouped by concrete type, holding only the types which override the list's hook. */
+  internal::BehaviorDispatchList _updateList{internal::BehaviorHook::Update};
+  internal::BehaviorDispatchList _fixedUpdateList{internal::BehaviorHook::FixedUpdate};
+  internal::BehaviorDispatchList _lateUpdateList{internal::BehaviorHook::LateUpdate};
   
-  /**
-   * if this becomes false in the middle of a tick,
-   * something has requested that the scene be destroyed. Break out of the tick loop.
-   */
-  std::atomic_bool _frameIsValid{true};
+  /** A set of dispatch groups whose declared component accesses do not conflict. */
+  struct ParallelBatch {
+    internal::ComponentMask reads;
+    internal::ComponentMask writes;
+    std::vector<internal::BehaviorDispatchList::Group*> groups;
+  };
+  bool _parallelUpdate = false;
+  std::vector<ParallelBatch> _parallelBatches{};
+  std::vector<JobHandle> _parallelJobs{};
+  
+  /** The Systems of the Scene, in the order they were added, and the scheduler of each ams::SystemPhase. */
+  std::vector<std::unique_ptr<System>> _systems{};
+  std::array<internal::SystemScheduler, 3> _systemSchedulers{};
+  
+  /** true while Behavior hooks are being called. Structural changes made meanwhile are deferred. */
+  bool _dispatching = false;
+  /** One command buffer per thread which has recorded commands, flushed at the sync points of the game loop. */
+  std::unordered_map<std::thread::id, std::unique_ptr<CommandBuffer>> _commandBuffers{};
+  std::mutex _commandBuffersMutex{};
+  /** The commands being applied by flushCommands(). Kept to reuse its storage. */
+  std::vector<CommandBuffer::Command> _flushQueue{};
   
 protected:
   const std::chrono::time_point<clk_t> startTime = clk_t::now();
@@ -85,7 +161,7 @@ protected:
 public:
   Scene(Application* app, const std::string& name);
 
-  virtual ~Scene() = default;
+  virtual ~Scene();
 
   /**
    * @brief Creates a Entity in the Scene.
@@ -101,31 +177,253 @@ public:
   /**
    * @brief Creates a Entity in the Scene.
    * @param name The name of the Entity.
-   * @param parent The parent Transform of the Entity.
+   * @param parent The parent Transform of the Entity, or nullptr to create a root Entity.
    */
   Entity* createEntity(const std::string& name, Transform* parent);
   
   /**
    * @brief Creates a Entity in the Scene.
    * @param name The name of the Entity.
-   * @param parent The parent Entity of the Entity.
    * @param cfg The configuration of the Entity.
+   * @param parent The parent Transform of the Entity, or nullptr to create a root Entity.
    */
   Entity* createEntity(const std::string& name, EntityCfg cfg = EntityCfg::Default, Transform* parent = nullptr);
   
+  /**
+   * @brief Creates Entities from a Prefab in bulk.
+   * @details The storage of every instance is allocated up front, the instances are placed in the archetype of the
+   * Prefab directly, and their Behaviors are registered in one batch, then enabled and started.
+   * @param prefab The Prefab.
+   * @param count The number of Entities to create.
+   * @param init Called with each Entity and its index once its Components are initialized, before its Behaviors are
+   * enabled and started. It may destroy any instance created so far. Optional.
+   * @return The created Entities which init did not destroy.
+   * @throws std::logic_error if the Scene is updating. Use createEntity() from the command buffer instead.
+   */
+  std::vector<Entity*> instantiate(const Prefab& prefab, size_t count, const Delegate<void(Entity*, size_t)>& init = {});
+  
   /**
    * @brief Destroys a Entity in the Scene. The same as Entity::destroy().
+   * @details While the Scene is updating its Behaviors, the Entity is not destroyed immediately. Its destruction is
+   * recorded in the command buffer of the calling thread and applied at the next sync point.
    * @param entity The Entity to destroy.
-   * @return true if the Entity was destroyed, false otherwise.
+   * @return true if the Entity was destroyed or its destruction was recorded, false otherwise.
    */
   bool destroyEntity(Entity* entity);
   
+  /**
+   * @brief Destroys a Entity in the Scene.
+   * @param handle The handle of the Entity to destroy.
+   * @return true if the Entity was destroyed, false if the handle is stale.
+   */
+  bool destroyEntity(EntityHandle handle);
+  
+  /**
+   * @brief Gets the Entity referenced by a handle.
+   * @param handle The handle of the Entity.
+   * @return The Entity, or nullptr if the handle is stale.
+   */
+  [[nodiscard]] Entity* getEntity(EntityHandle handle) const;
+  
+  /**
+   * @brief Checks if a handle references a live Entity in the Scene.
+   * @param handle The handle of the Entity.
+   * @return false if the Entity was destroyed.
+   */
+  [[nodiscard]] bool isValid(EntityHandle handle) const;
+  
+  /**
+   * @brief Gets the command buffer of the calling thread.
+   * @details Commands recorded in the buffer are applied at the next sync point of the game loop: after each fixed
+   * update, after the update and after the late update. Behaviors which are updated in parallel must record their
+   * structural changes here instead of changing the Scene directly. See ams::CommandBuffer.
+   */
+  CommandBuffer& getCommandBuffer();
+  
+  /**
+   * @brief Applies the commands recorded in every command buffer of the Scene.
+   * @details This is called by the Application at each sync point of the game loop, and must not be called while
+   * the Scene is updating its Behaviors. Commands recorded while flushing are applied by the next flush.
+   */
+  void flushCommands();
+  
+  /**
+   * @brief Recomputes the world matrices of the Transforms which changed since the last call.
+   * @details This is called by the Application at each sync point of the game loop, after the recorded commands are
+   * applied. Only the subtrees of changed Transforms are visited, parents before children, so a Scene whose Transforms
+   * did not change pays nothing. The spatial index, if enabled, is refit afterwards.
+   */
+  void updateTransforms();
+  
+  /**
+   * @brief Gets the world matrices of every Transform in the Scene, as of the last updateTransforms().
+   * @details The matrices are stored contiguously, in depth first order: every parent comes before its children.
+   */
+  [[nodiscard]] std::span<const Matrix4> getWorldMatrices() const;
+  
+  /**
+   * @brief Stores the position, rotation and scale of every Transform as the state to interpolate from.
+   * @details This is called by the Application at the start of each fixed step.
+   */
+  void storeTransformStates();
+  
+  /**
+   * @brief Computes the world matrices of every Transform, interpolated between the start of the last fixed step and
+   * now.
+   * @details This is called by the Application before the Scene renders. See Application::getInterpolationAlpha().
+   * @param alpha - The blend factor, from 0 for the start of the last fixed step to 1 for now.
+   */
+  void interpolateTransforms(decimal_t alpha);
+  
+  /**
+   * @brief Gets the interpolated world matrices of every Transform, as of the last interpolateTransforms(), in the
+   * order of getWorldMatrices().
+   */
+  [[nodiscard]] std::span<const Matrix4> getInterpolatedWorldMatrices() const;
+  
+  /**
+   * @brief Enables or disables parallel updates.
+   * @details When enabled, the update methods of Behaviors which declare an ams::ComponentAccess run on the
+   * ams::JobSystem, concurrently wherever their declared accesses do not conflict. Other Behaviors are still
+   * updated on the main thread, after the parallel ones.
+   * @param parallel - true to enable parallel updates.
+   */
+  void setParallelUpdate(bool parallel);
+  
+  /**
+   * @brief Checks if parallel updates are enabled.
+   */
+  [[nodiscard]] bool isParallelUpdate() const;
+  
+  /**
+   * @brief Enables or disables the spatial index of the Scene.
+   * @details While enabled, every Entity is indexed by its bounds, and the index is refit with the world matrices at
+   * each sync point. Enabling the index builds it immediately, unless the Scene is updating its Behaviors, in which
+   * case it is built at the next sync point. A disabled index is empty and costs nothing.
+   * @param enabled - true to enable the spatial index.
+   */
+  void setSpatialIndexEnabled(bool enabled);
+  
+  /**
+   * @brief Checks if the spatial index is enabled.
+   */
+  [[nodiscard]] bool isSpatialIndexEnabled() const;
+  
+  /**
+   * @brief Gets the spatial index of the Scene, to find Entities by location. See setSpatialIndexEnabled().
+   */
+  [[nodiscard]] SpatialIndex& getSpatialIndex() { return _spatialIndex; }
+  
+  [[nodiscard]] const SpatialIndex& getSpatialIndex() const { return _spatialIndex; }
+  
   [[nodiscard]] Application* getApplication() const;
   
+  /**
+   * @brief Adds a System to the Scene.
+   * @details The System runs at every step of its ams::SystemPhase, after the Behaviors. A Scene has at most one
+   * System of each type, and Systems can not be added while the Scene is updating. A System whose runBefore() and
+   * runAfter() constraints would form a cycle with those of the Scene's Systems is rejected.
+   * @tparam TSys - The type of the System.
+   * @param args - The arguments of the System's constructor.
+   * @return The System, or nullptr if it could not be added.
+   */
+  template<TSystem TSys, typename... Args>
+  TSys* addSystem(Args&&... args) {
+    if (_dispatching)
+      return throwOrDefault<std::logic_error, TSys*>("Systems can not be added while the Scene is updating", nullptr);
+    if (getSystem<TSys>() != nullptr)
+      return throwOrDefault<std::invalid_argument, TSys*>("The Scene already has a System of this type", nullptr);
+    auto system = std::make_unique<TSys>(std::forward<Args>(args)...);
+    auto* pSystem = system.get();
+    pSystem->_scene = this;
+    pSystem->_type = internal::typeHash<TSys>();
+    if constexpr (internal::TDeclaresAccess<TSys>) {
+      pSystem->_concurrent = true;
+      pSystem->_reads = TSys::Access::reads();
+      pSystem->_writes = TSys::Access::writes();
+    }
+    auto& scheduler = _systemSchedulers[static_cast<size_t>(pSystem->_phase)];
+    if (!scheduler.canAdd(pSystem))
+      return throwOrDefault<std::invalid_argument, TSys*>(
+          "The runBefore and runAfter constraints of the System form a cycle with those of the Scene", nullptr);
+    _systems.push_back(std::move(system));
+    scheduler.add(pSystem);
+    pSystem->onCreate();
+    return pSystem;
+  }
+  
+  /**
+   * @brief Gets the System of type TSys.
+   * @return The System, or nullptr if the Scene has none.
+   */
+  template<TSystem TSys>
+  [[nodiscard]] TSys* getSystem() const {
+    for (auto& system : _systems) {
+      if (system->_type == internal::typeHash<TSys>())
+        return static_cast<TSys*>(system.get());
+    }
+    return nullptr;
+  }
+  
+  /**
+   * @brief Removes and destroys the System of type TSys. Systems can not be removed while the Scene is updating.
+   * @return true if the System was removed, false if the Scene has none.
+   */
+  template<TSystem TSys>
+  bool removeSystem() {
+    return removeSystem(getSystem<TSys>());
+  }
+  
+  /**
+   * @brief Gets the Systems of a phase in the order they are scheduled. See ams::System::getLastRunTime().
+   * @param phase - The phase.
+   */
+  [[nodiscard]] std::span<System* const> getSystems(SystemPhase phase);
+  
+  /**
+   * @brief Calls a function for every Component of type TComp in the Scene.
+   * @details Components are visited archetype by archetype, streaming over each archetype's TComp column.
+   * Only the exact type TComp is matched; Components of types derived from TComp are not visited.
+   * @tparam TComp - The type of Component to visit.
+   * @param fn - The function to call. It receives a TComp*.
+   */
+  template<TComponent TComp, typename TFunc>
+  void forEach(TFunc&& fn) const {
+    for (auto& [signature, archetype] : _archetypes)
+      archetype->template each<TComp>(fn);
+  }
+  
+  /**
+   * @brief Gets a query over every Entity which has all of the component types TComps.
+   * @details The matching archetypes are cached the first time a set of types is queried and kept up to date as
+   * archetypes are created, so later calls only look the cache up. The returned ams::Query can be kept for the
+   * lifetime of the Scene. Queries may be made concurrently, e.g. by Systems running on the ams::JobSystem.
+   * @example
+   * <code>scene->query&lt;Transform, MeshComponent&gt;().each([](Transform& transform, MeshComponent& mesh) { });</code>
+   * @tparam TComps - The component types.
+   */
+  template<TComponent... TComps> requires (sizeof...(TComps) > 0)
+  Query<TComps...> query() {
+    const std::array<internal::ComponentTypeId, sizeof...(TComps)> types{internal::ComponentType<TComps>::id()...};
+    return Query<TComps...>(getQueryCache(types));
+  }
+  
 protected:
   virtual void onEnter();
 
   virtual void onExit();
+  
+  /**
+   * @brief Calls onDisable() on every Behavior of the Scene. The first half of onExit().
+   */
+  void disableBehaviors();
+  
+  /**
+   * @brief Destroys every Entity and releases the storage of the Scene. The second half of onExit().
+   * @details Only touches the Scene itself, so a Scene which was removed from the Application can be unloaded on a
+   * background thread once its Behaviors have been disabled.
+   */
+  void unload();
 
   /**
  * @brief Gets all cameras in the Scene. This method creates a new vector each time it is called. Use sparingly.
@@ -139,39 +437,167 @@ protected:
 
   /**
    * @brief Gets all Entities in the Scene. This method creates a new vector each time it is called. Use sparingly.
+   * To visit the Entities which have some components, use query() instead.
    */
   [[nodiscard]] std::vector<Entity*> getEntities() const;
   
 private:
+  void onFixedUpdate();
+  
   void onUpdate();
   
   void onRender();
   
+  /** Runs the Systems of a phase. */
+  void runSystems(SystemPhase phase);
+  
+  /** Removes and destroys a System. */
+  bool removeSystem(System* system);
+  
+  /** Calls the hook of every Behavior in a dispatch list, one concrete type at a time. */
+  void dispatch(internal::BehaviorDispatchList& list);
+  
+  /**
+   * Calls the hook of every Behavior in a dispatch list. Groups which declare their accesses run on the JobSystem in
+   * batches of non-conflicting groups, and the remaining groups run on the calling thread.
+   */
+  void dispatchParallel(internal::BehaviorDispatchList& list);
+  
   [[maybe_unused]] bool registerBehavior(Behavior* behavior);
   
   [[maybe_unused]] bool unregisterBehavior(Behavior* behavior);
   
+  /**
+   * Moves a registered Behavior to the enabled or the disabled range of the dispatch lists to match its enabled state.
+   * While dispatching, the move is recorded in the command buffer of the calling thread instead.
+   */
+  void updateBehaviorState(Behavior* behavior);
+  
+  /** Moves a registered Behavior to the enabled or the disabled range now, and calls onEnable() or onDisable(). */
+  void setBehaviorActive(Behavior* behavior, bool active);
+  
   /**
    * @brief Registers a camera with the Scene.
-   * @param entity - The Entity that owns the camera.
-   * @return true if successful, false if Entity was already registered or if Entity does not have a camera.
+   * @param camera - The camera to register.
+   * @return true if successful, false if the camera was already registered.
    */
   [[maybe_unused]] bool registerCamera(Camera* camera);
 
   /**
    * @brief Unregisters a camera from the Scene.
-   * @param entity - The Entity that owns the camera.
-   * @return true if successful, false if Entity was not registered.
+   * @param camera - The camera to unregister.
+   * @return true if successful, false if the camera was not registered.
    */
   [[maybe_unused]] bool unregisterCamera(Camera* camera);
   
+  /**
+   * @brief Gets the archetype which stores a signature, creating it if it does not exist.
+   * @param signature - The component types of the archetype.
+   */
+  internal::Archetype* getArchetype(const internal::ArchetypeSignature& signature);
+  
+  /**
+   * @brief Gets the cache of a query, creating it and matching it against every archetype if it does not exist.
+   * @param types - The component types of the query, in order.
+   */
+  internal::QueryCache& getQueryCache(std::span<const internal::ComponentTypeId> types);
+  
+  /**
+   * @brief Places an Entity which is not in an archetype in the archetype matching its components.
+   * @param entity - The Entity to place.
+   */
+  void addToArchetype(Entity* entity);
+  
+  /**
+   * @brief Places an Entity which is not in an archetype in a row of an archetype, and relocates its components which
+   * are stored by value from their pool into the row.
+   * @param entity - The Entity to place.
+   * @param archetype - The archetype. Its signature must be the component mask of the Entity.
+   */
+  void placeInArchetype(Entity* entity, internal::Archetype* archetype);
+  
+  /**
+   * @brief Places the component of a type which was allocated from its pool in the row of its Entity, if the Entity is
+   * in an archetype.
+   * @param entity - The Entity.
+   * @param type - The type of the component, whose slot holds the component.
+   */
+  void placeInRow(Entity* entity, internal::ComponentTypeId type);
+  
+  /**
+   * @brief Moves an Entity's row to the archetype matching its component mask after a component type was added or
+   * removed.
+   * @param entity - The Entity which received or lost the component.
+   * @param type - The id of the added or removed component type.
+   */
+  void moveToArchetype(Entity* entity, internal::ComponentTypeId type);
+  
+  /**
+   * @brief Removes an Entity's row from its archetype, and relocates its components which are stored by value to
+   * their pool.
+   * @param entity - The Entity to remove.
+   */
+  void removeFromArchetype(Entity* entity);
+  
+  /**
+   * @brief Grows the stores of the Scene once for a number of Entities about to be created.
+   * @param count - The number of Entities.
+   */
+  void reserveEntities(size_t count);
+  
+  /**
+   * @brief Creates an Entity which is not placed in an archetype yet, so that components added to it do not move it
+   * from archetype to archetype. It must be placed with placeEntities() before the Scene updates.
+   * @param name - The name of the Entity.
+   * @param parent - The parent Transform of the Entity, or nullptr.
+   */
+  Entity* createUnplacedEntity(const std::string& name, Transform* parent);
+  
+  /**
+   * @brief Places Entities created by createUnplacedEntity() in their archetypes, growing each archetype once.
+   * @param entities - The Entities.
+   */
+  void placeEntities(std::span<Entity* const> entities);
+  
+  /**
+   * @brief Adds an Entity constructed by makeEntity() to the Scene, places it in its archetype and indexes it.
+   * @details Every createEntity() overload goes through here.
+   * @param upEntity - The Entity.
+   * @return The Entity.
+   */
+  Entity* addEntity(PoolPtr<Entity> upEntity);
+  
+  /**
+   * @brief Constructs an Entity in the Entity pool.
+   * @param args - The arguments of the Entity's constructor, after the Scene.
+   */
+  template<typename... Args>
+  PoolPtr<Entity> makeEntity(Args&&... args);
+  
+  /**
+   * @brief Gets the pool of a component type, creating it if it does not exist.
+   * @param type - The id of the component type.
+   * @param size - The size of the component type.
+   * @param align - The alignment of the component type.
+   */
+  PoolAllocator& getComponentPool(internal::ComponentTypeId type, size_t size, size_t align);
+  
+  /**
+   * @brief Sets the storage of a component type before the first archetype which stores the type is created.
+   * @param type - The id of the component type.
+   * @param storage - The storage of the component type, or nullptr if it is not stored by value.
+   */
+  void setComponentStorage(internal::ComponentTypeId type, const internal::ComponentStorage* storage);
+  
   /** Modifies an Entity to conform to a configuration */
   static void autoConfigureEntity(Entity* entity, EntityCfg cfg);
 
 public:
   friend class Application;
+  friend class Behavior;
   friend class Camera;
   friend class Entity;
+  friend class SceneSnapshot;
 };
 
 } // ams
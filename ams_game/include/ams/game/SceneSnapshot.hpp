@@ -0,0 +1,146 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.SceneSnapshot]*/
+/*[exclude begin]*/
+#pragma once
+#include "Component.hpp"
+#include "Entity.hpp"
+#include "internal/ComponentType.hpp"
+/*[exclude end]*/
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+/*[import ams.game.Component]*/
+/*[import ams.game.Entity]*/
+/*[import ams.game.internal.ComponentType]*/
+
+/*[export]*/ namespace ams {
+
+class Scene;
+
+/* TSnapshotComponent is a component type which can store its state in an ams::SceneSnapshot */
+template<typename T>
+concept TSnapshotComponent = std::is_base_of_v<Component, T> &&
+  std::is_trivially_copyable_v<typename T::SnapshotState> && alignof(typename T::SnapshotState) <= 16 &&
+  requires(T& comp, typename T::SnapshotState& state) {
+    std::as_const(comp).saveSnapshot(state);
+    comp.loadSnapshot(std::as_const(state));
+  };
+
+/**
+ * @brief SceneSnapshot saves the Entities of a Scene to a binary snapshot, and restores them from it.
+ * @details A snapshot stores the Entities in depth first order of their Transforms, so that parents come first,
+ * followed by one block per table: Entity records, names, Transforms, and one column per registered component type.
+ * Every block is aligned to BlockAlignment and stores fixed-size records, so a snapshot is read where it lies,
+ * typically in a memory-mapped file, without being parsed. Restoring creates the Entities in bulk: the stores of the
+ * Scene grow once, and each Entity is placed in its archetype once its components are loaded.
+ * Components are polymorphic, so their memory is never copied as is. Instead, a component type opts in by
+ * declaring a trivially copyable SnapshotState type and the methods which fill it and apply it:
+ * <p><code>struct SnapshotState { float health; };<br>
+ * void saveSnapshot(SnapshotState&amp; state) const;<br>
+ * void loadSnapshot(const SnapshotState&amp; state);</code></p>
+ * and by being registered with registerComponent() before a snapshot is captured or restored. Component types are
+ * identified by ams::internal::typeHash(), so a snapshot can be restored by another build of the same application.
+ * Only the first component of each type of an Entity is stored. Snapshots store numbers in the byte order of the
+ * machine which captured them.
+ */
+class AMS_GAME_EXPORT SceneSnapshot {
+public:
+  /** The version of the format. Snapshots of other versions are rejected. */
+  static constexpr uint32_t Version = 1;
+  /** The alignment of every block, from the start of the snapshot. */
+  static constexpr size_t BlockAlignment = 64;
+  
+  SceneSnapshot() = delete;
+  
+  /**
+   * @brief Registers a component type, so that it is stored in snapshots.
+   * @details Registration is not thread safe. Register component types at startup.
+   */
+  template<TSnapshotComponent TComp>
+  static void registerComponent() {
+    using State = typename TComp::SnapshotState;
+    registerComponent(internal::ComponentType<TComp>::hash, ComponentEntry{
+      &internal::ComponentType<TComp>::id,
+      sizeof(State),
+      [](const Component* component, std::byte* dst) {
+        State state{};
+        static_cast<const TComp*>(component)->saveSnapshot(state);
+        std::memcpy(dst, &state, sizeof(State));
+      },
+      [](Entity* entity, const std::byte* src) {
+        State state;
+        std::memcpy(&state, src, sizeof(State));
+        if (auto* component = entity->template addComponent<TComp>(); component != nullptr)
+          component->loadSnapshot(state);
+      }
+    });
+  }
+  
+  /**
+   * @brief Captures every Entity of a Scene, with its Transform and registered components.
+   * @param scene - The Scene. Its Transforms are updated first.
+   * @return The snapshot.
+   */
+  static std::vector<std::byte> capture(Scene& scene);
+  
+  /**
+   * @brief Creates the Entities stored in a snapshot in a Scene, next to the Entities it already has.
+   * @details Must not be called while the Scene is updating. Component types which are not registered are skipped.
+   * @param scene - The Scene.
+   * @param snapshot - The snapshot, as returned by capture() or mapped from a file written by save().
+   * @return The number of Entities created.
+   * @throws std::runtime_error if the snapshot is invalid. If exceptions are disabled, nothing is created instead.
+   */
+  static size_t restore(Scene& scene, std::span<const std::byte> snapshot);
+  
+  /**
+   * @brief Captures a Scene and writes the snapshot to a file.
+   * @throws std::runtime_error if the file can not be written.
+   */
+  static void save(Scene& scene, const std::filesystem::path& path);
+  
+  /**
+   * @brief Memory-maps a file written by save() and restores it in a Scene. See restore().
+   * @return The number of Entities created.
+   */
+  static size_t load(Scene& scene, const std::filesystem::path& path);
+
+private:
+  struct ComponentEntry {
+    internal::ComponentTypeId (*id)();
+    uint32_t stateSize;
+    void (*save)(const Component* component, std::byte* dst);
+    void (*load)(Entity* entity, const std::byte* src);
+  };
+  
+  static std::map<uint64_t, ComponentEntry>& getRegistry();
+  static void registerComponent(uint64_t hash, const ComponentEntry& entry);
+};
+
+} // ams
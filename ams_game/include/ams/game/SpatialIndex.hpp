@@ -0,0 +1,221 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.SpatialIndex]*/
+/*[exclude begin]*/
+#pragma once
+#include "Entity.hpp"
+#include "internal/TransformHierarchy.hpp"
+#include <ams/spatial/AABBTree.hpp>
+/*[exclude end]*/
+#include <span>
+#include <vector>
+/*[import ams.game.Entity]*/
+/*[import ams.game.internal.TransformHierarchy]*/
+/*[import ams.spatial.AABBTree]*/
+
+/*[export]*/ namespace ams {
+
+class Mesh;
+class Scene;
+
+/**
+ * @brief The SpatialIndex of a ams::Scene finds its Entities by location, without scanning every Entity.
+ * @details Each Entity is bounded by the bounds of its mesh, or by setLocalBounds(), transformed by the world matrix
+ * of its Transform. An Entity without bounds is a point at the position of its Transform. The bounds are stored in an
+ * ams::AABBTree keyed by ams::EntityHandle.
+ * The Scene adds each Entity it creates and removes each Entity it destroys. The index is refit after the world
+ * matrices, at each sync point: only the Entities whose world matrix changed are refit, and an Entity which moves less
+ * than the margin of its proxy costs nothing. When the order of the Transforms was rebuilt, every indexed Entity is
+ * refit. When more than RebuildThreshold Entities are added or refit at once, the tree is rebuilt instead, on the
+ * ams::JobSystem for large Scenes. The bounds of a mesh are cached by the ams::Mesh, and are read when its Entity is
+ * indexed and whenever its ams::MeshComponent is added or changes its mesh. Every Transform is only indexed at once
+ * when the index is enabled.
+ * Queries report exact matches for the bounds, and may run concurrently with each other, e.g. from Behaviors which are
+ * updated in parallel. See Scene::setSpatialIndexEnabled().
+ */
+class AMS_GAME_EXPORT SpatialIndex {
+public:
+  /** The number of changed Entities above which the tree is rebuilt rather than updated one Entity at a time. */
+  static constexpr size_t RebuildThreshold = 1024;
+
+private:
+  struct Entry {
+    uint32_t generation = 0;
+    uint32_t proxy = AABBTree::NullProxy;
+    /** The bounds of the Entity in the space of its Transform. Empty for a point. */
+    AABB localBounds{};
+    bool customBounds = false;
+    /** The sync which last saw the Entity. */
+    uint32_t stamp = 0;
+    /** The Transform of the Entity, while it is indexed. */
+    const Transform* transform = nullptr;
+  };
+  
+  AABBTree _tree;
+  /** The entry of each Entity, indexed by the index of its handle. */
+  std::vector<Entry> _entries{};
+  /** The exact world bounds of each proxy, indexed by proxy id. */
+  std::vector<AABB> _bounds{};
+  /** The Entities whose mesh changed since the last update, to refit. */
+  std::vector<EntityHandle> _meshChanges{};
+  uint32_t _stamp = 0;
+  /** true until every Transform has been indexed by sync(). */
+  bool _stale = true;
+
+public:
+  /**
+   * @param margin - The distance an Entity can move before its proxy is moved in the tree.
+   */
+  explicit SpatialIndex(decimal_t margin = 0.1) : _tree(margin) {}
+  SpatialIndex(const SpatialIndex&) = delete;
+  SpatialIndex& operator=(const SpatialIndex&) = delete;
+  
+  /**
+   * @brief Calls a function with every Entity whose bounds intersect a sphere.
+   * @param center - The center of the sphere.
+   * @param radius - The radius of the sphere.
+   * @param fn - The function to call. It receives an ams::EntityHandle.
+   */
+  template<typename TFunc>
+  void queryRadius(const Vec3<decimal_t>& center, decimal_t radius, TFunc&& fn) const {
+    _tree.query(center, radius, [&](uint32_t proxy) {
+      if (_bounds[proxy].intersects(center, radius))
+        fn(getHandle(proxy));
+    });
+  }
+  
+  /**
+   * @brief Calls a function with every Entity whose bounds intersect a box.
+   * @param box - The box, in world space.
+   * @param fn - The function to call. It receives an ams::EntityHandle.
+   */
+  template<typename TFunc>
+  void queryBox(const AABB& box, TFunc&& fn) const {
+    _tree.query(box, [&](uint32_t proxy) {
+      if (_bounds[proxy].intersects(box))
+        fn(getHandle(proxy));
+    });
+  }
+  
+  /**
+   * @brief Calls a function with every Entity whose bounds are at least partially inside a frustum.
+   * @param frustum - The frustum, e.g. from Frustum::fromMatrix() with the view projection matrix of a camera.
+   * @param fn - The function to call. It receives an ams::EntityHandle.
+   */
+  template<typename TFunc>
+  void queryFrustum(const Frustum& frustum, TFunc&& fn) const {
+    _tree.query(frustum, [&](uint32_t proxy) {
+      if (frustum.intersects(_bounds[proxy]))
+        fn(getHandle(proxy));
+    });
+  }
+  
+  /**
+   * @brief Calls a function with the Entities whose bounds are hit by a ray. See AABBTree::raycast().
+   * @param ray - The ray, in world space.
+   * @param maxDistance - The length of the ray.
+   * @param fn - The function to call. It receives an ams::EntityHandle and the distance at which the ray enters its
+   * bounds, and returns the new length of the ray.
+   */
+  template<typename TFunc>
+  void raycast(const Ray& ray, decimal_t maxDistance, TFunc&& fn) const {
+    auto inverseDirection = ray.inverseDirection();
+    _tree.raycast(ray, maxDistance, [&](uint32_t proxy, decimal_t) {
+      decimal_t distance;
+      if (!ray.intersects(_bounds[proxy], inverseDirection, maxDistance, distance))
+        return maxDistance;
+      maxDistance = fn(getHandle(proxy), distance);
+      return maxDistance;
+    });
+  }
+  
+  /**
+   * @brief Finds the Entity whose bounds are hit first by a ray.
+   * @param ray - The ray, in world space.
+   * @param maxDistance - The length of the ray.
+   * @param distance - Receives the distance at which the ray enters the bounds of the Entity. Optional.
+   * @return The handle of the Entity, or a null handle if the ray hits nothing.
+   */
+  [[nodiscard]] EntityHandle raycast(const Ray& ray, decimal_t maxDistance, decimal_t* distance = nullptr) const;
+  
+  /**
+   * @brief Gets the world bounds of an Entity, as of the last update.
+   * @return The bounds, or nullptr if the Entity is not indexed.
+   */
+  [[nodiscard]] const AABB* getBounds(EntityHandle entity) const;
+  
+  /**
+   * @brief Sets the bounds of an Entity in the space of its Transform, replacing the bounds of its mesh.
+   * @details The Entity is refit immediately if it is already indexed, and is indexed with these bounds otherwise.
+   * @param entity - The Entity.
+   * @param bounds - The bounds. An empty box makes the Entity a point.
+   */
+  void setLocalBounds(const Entity* entity, const AABB& bounds);
+  
+  /**
+   * @brief Gets the number of indexed Entities.
+   */
+  [[nodiscard]] size_t size() const { return _tree.size(); }
+
+private:
+  /** Refits the Entities whose Transform or mesh changed, or every indexed Entity after the order was rebuilt. */
+  void update(internal::TransformHierarchy& hierarchy);
+  
+  /** Indexes every Transform, removes the Entities which are gone and rebuilds the tree. */
+  void sync(std::span<Transform* const> transforms);
+  
+  /** Indexes Entities which were created, at once. See RebuildThreshold. */
+  void add(std::span<Entity* const> entities);
+  
+  /** Removes an Entity which is destroyed. */
+  void remove(EntityHandle entity);
+  
+  /**
+   * @brief Replaces the bounds of the mesh of an Entity, unless it has custom bounds. The Entity is refit at the next
+   * update.
+   * @param mesh - The new mesh, or nullptr if the Entity no longer has one.
+   */
+  void setMesh(const Entity* entity, const Mesh* mesh);
+  
+  /** Removes every Entity. The next update indexes every Transform again. */
+  void clear();
+  
+  /** Gets the entry of an Entity, resetting entries left by a destroyed Entity which had the same index. */
+  Entry& getEntry(EntityHandle entity);
+  
+  /** Reads the bounds of the mesh of an Entity into its entry, unless it has custom bounds. */
+  static void readMeshBounds(Entry& entry, Entity* entity);
+  
+  /** Stores the world bounds of an Entity in its proxy, creating the proxy if needed. */
+  void place(Entry& entry, EntityHandle entity, const Transform* transform, bool link);
+  
+  [[nodiscard]] EntityHandle getHandle(uint32_t proxy) const {
+    auto value = _tree.getValue(proxy);
+    return {static_cast<uint32_t>(value >> 32), static_cast<uint32_t>(value)};
+  }
+  
+  friend class Scene;
+  friend class MeshComponent;
+};
+
+} // ams
@@ -0,0 +1,141 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.System]*/
+/*[exclude begin]*/
+#pragma once
+#include "config.hpp"
+#include "ComponentAccess.hpp"
+#include "internal/ComponentType.hpp"
+/*[exclude end]*/
+#include <type_traits>
+#include <vector>
+/*[import <chrono>]*/
+/*[import ams.game.config]*/
+/*[import ams.game.ComponentAccess]*/
+/*[import ams.game.internal.ComponentType]*/
+
+/*[export]*/ namespace ams {
+
+class Scene;
+
+namespace internal {
+class SystemScheduler;
+}
+
+/**
+ * @brief The step of the game loop in which a ams::System runs.
+ */
+enum class SystemPhase : uint8_t {
+  /** After the Behaviors' onFixedUpdate, every fixed frame. */
+  FixedUpdate,
+  /** After the Behaviors' onUpdate, once every frame. */
+  Update,
+  /** After the Behaviors' onLateUpdate, once every frame, before the frame is drawn. */
+  Render
+};
+
+/**
+ * @brief A System updates the Components of many Entities at once, once per step of its ams::SystemPhase.
+ * @details Systems are added to a Scene with Scene::addSystem(), which owns them. Like a Behavior, a System type opts
+ * into running on the ams::JobSystem by declaring a public member type named Access:
+ * <p><code>using Access = ams::ComponentAccess&lt;ams::Read&lt;MeshComponent&gt;, ams::Write&lt;Transform&gt;&gt;;
+ * </code></p>
+ * Systems whose declared accesses do not conflict run concurrently, and systems which conflict run in the order they
+ * were added. By declaring the access, the type promises to only touch the declared component types, and to record
+ * the creation or destruction of Entities or Components in the command buffer of its thread, see
+ * Scene::getCommandBuffer(). Systems without an Access declaration run on the main thread, alone.
+ * The order can be constrained further with runBefore() and runAfter(), typically called by the constructor.
+ */
+class AMS_GAME_EXPORT System {
+private:
+  Scene* _scene = nullptr;
+  /** The hash of the concrete type, set by Scene::addSystem(). */
+  uint64_t _type = 0;
+  SystemPhase _phase;
+  bool _concurrent = false;
+  internal::ComponentMask _reads{};
+  internal::ComponentMask _writes{};
+  /** The hashes of the system types this System must run before and after. */
+  std::vector<uint64_t> _runBefore{};
+  std::vector<uint64_t> _runAfter{};
+  clk_t::duration _lastRunTime{};
+
+protected:
+  explicit System(SystemPhase phase = SystemPhase::Update) : _phase(phase) {}
+  
+  /**
+   * @brief Makes this System run before the System of type TSystem, if the Scene has one in the same phase.
+   */
+  template<typename TSystem> requires std::is_base_of_v<System, TSystem>
+  void runBefore() { _runBefore.push_back(internal::typeHash<TSystem>()); }
+  
+  /**
+   * @brief Makes this System run after the System of type TSystem, if the Scene has one in the same phase.
+   */
+  template<typename TSystem> requires std::is_base_of_v<System, TSystem>
+  void runAfter() { _runAfter.push_back(internal::typeHash<TSystem>()); }
+
+public:
+  System(const System&) = delete;
+  System& operator=(const System&) = delete;
+  
+  virtual ~System() = default;
+  
+  /**
+   * @brief onCreate is called once the System is added to its Scene.
+   */
+  virtual void onCreate() {}
+  
+  /**
+   * @brief onRun is called once every step of the System's phase.
+   */
+  virtual void onRun() = 0;
+  
+  /**
+   * @brief onDestroy is called when the System is removed from its Scene, or when the Scene is destroyed.
+   */
+  virtual void onDestroy() {}
+  
+  [[nodiscard]] Scene* getScene() const { return _scene; }
+  
+  [[nodiscard]] SystemPhase getPhase() const { return _phase; }
+  
+  /**
+   * @brief Checks if the System runs on the ams::JobSystem, which is when its type declares an Access.
+   */
+  [[nodiscard]] bool isConcurrent() const { return _concurrent; }
+  
+  /**
+   * @brief Gets the time taken by the last call to onRun().
+   */
+  [[nodiscard]] clk_t::duration getLastRunTime() const { return _lastRunTime; }
+  
+  friend class Scene;
+  friend class internal::SystemScheduler;
+};
+
+/* TSystem is a type which is a ams::System */
+template<typename T>
+concept TSystem = std::is_base_of_v<System, T>;
+
+} // ams
@@ -20,15 +20,23 @@
 #include "ams_game_export.hpp"
 #include <ams/spatial.hpp>
 #include "Component.hpp"
+#include "internal/TransformHierarchy.hpp"
 /*[exclude end]*/
 /*[import ams.internal.config]*/
 /*[import ams.spatial]*/
 /*[import ams.game.Component]*/
+/*[import ams.game.internal.TransformHierarchy]*/
 
 class Entity;
 
 /*[export]*/ namespace ams {
 
+/**
+ * @brief A Transform stores the position, rotation and scale of an ams::Entity, relative to its parent Transform.
+ * @details Changing the position, rotation, scale or parent of a Transform marks it dirty. The Scene recomputes the
+ * model matrices of dirty Transforms, and the world matrices of their subtrees, at each sync point of the game loop.
+ * See getModelMatrix() and getWorldMatrix().
+ */
 class AMS_GAME_EXPORT Transform final : public Component {
 private:
   Vec3<decimal_t> m_position = Vec3(0.0, 0.0, 0.0);
@@ -37,24 +45,47 @@ private:
   Matrix4 m_modelMatrix = Matrix4::identity();
   Transform* m_parent = nullptr;
   std::vector<Transform*> m_children;
+  
+  /** The hierarchy of the Scene, which computes the world matrix. Null until the Entity is added to the Scene. */
+  internal::TransformHierarchy* m_hierarchy = nullptr;
+  /** The position of this Transform in the hierarchy's registry and in its depth first order. */
+  uint32_t m_hierarchySlot = internal::TransformHierarchy::InvalidIndex;
+  uint32_t m_hierarchyIndex = internal::TransformHierarchy::InvalidIndex;
+  /** true if the position, rotation or scale changed since the model matrix was last computed. */
+  bool m_dirty = true;
+  /** The position, rotation and scale at the start of the current fixed step, used to interpolate rendering. */
+  Vec3<decimal_t> m_previousPosition = Vec3(0.0, 0.0, 0.0);
+  Quaternion m_previousRotation = Quaternion::identity();
+  Vec3<decimal_t> m_previousScale = Vec3(1.0, 1.0, 1.0);
+  /** false until the first fixed step after the Transform was created. Until then, it is not interpolated. */
+  bool m_hasPreviousState = false;
+  /** true while the hierarchy lists this Transform as moved since the states were last stored. */
+  bool m_moved = false;
+  
 public:
   explicit Transform(Entity* entity) : Component(entity) {}
+  
+  ~Transform() override;
 
-  constexpr void setPosition(decimal_t x, decimal_t y, decimal_t z) { m_position.x = x; m_position.y = y; m_position.z = z; }
+  void setPosition(decimal_t x, decimal_t y, decimal_t z) { m_position.x = x; m_position.y = y; m_position.z = z; markDirty(); }
 
-  constexpr void setPosition(const Vec3<decimal_t>& position) { m_position = position; }
+  void setPosition(const Vec3<decimal_t>& position) { m_position = position; markDirty(); }
 
-  constexpr void setRotation(decimal_t x, decimal_t y, decimal_t z) { m_rotation = Vec3<decimal_t>(x, y, z); }
+  void setRotation(decimal_t x, decimal_t y, decimal_t z) { m_rotation = Vec3<decimal_t>(x, y, z); markDirty(); }
 
-  constexpr void setRotation(const Vec3<decimal_t>& rotation) { m_rotation = rotation; }
+  void setRotation(const Vec3<decimal_t>& rotation) { m_rotation = rotation; markDirty(); }
 
-  constexpr void setScale(decimal_t x, decimal_t y, decimal_t z) { m_scale.x = x; m_scale.y = y; m_scale.z = z; }
+  void setRotation(const Quaternion& rotation) { m_rotation = rotation; markDirty(); }
 
-  constexpr void setScale(const Vec3<decimal_t>& scale) { m_scale = scale; }
+  void setScale(decimal_t x, decimal_t y, decimal_t z) { m_scale.x = x; m_scale.y = y; m_scale.z = z; markDirty(); }
 
-  constexpr void translate(const Vec3<decimal_t>& translation) { m_position += translation; }
+  void setScale(const Vec3<decimal_t>& scale) { m_scale = scale; markDirty(); }
 
-  constexpr void translate(decimal_t x, decimal_t y, decimal_t z) { m_position.x += x; m_position.y += y; m_position.z += z; }
+  void translate(const Vec3<decimal_t>& translation) { m_position += translation; markDirty(); }
+
+  void translate(decimal_t x, decimal_t y, decimal_t z) {
+    m_position.x += x; m_position.y += y; m_position.z += z; markDirty();
+  }
 
   /**
    * @brief rotate the transform by the given euler angles in degrees.
@@ -62,19 +93,21 @@ public:
    * @param y - The rotation around the y axis in degrees.
    * @param z - The rotation around the z axis in degrees.
    */
-  constexpr void rotate(decimal_t x, decimal_t y, decimal_t z) { m_rotation *= Quaternion::fromEuler(radians(Vec3<decimal_t>(x, y, z))); }
+  void rotate(decimal_t x, decimal_t y, decimal_t z) {
+    m_rotation *= Quaternion::fromEuler(radians(Vec3<decimal_t>(x, y, z))); markDirty();
+  }
 
   /**
    * @brief rotate the transform by the given euler angles in degrees.
    * @param rotation - The rotation around the x, y, and z axis in degrees.
    */
-  constexpr void rotate(const Vec3<decimal_t>& rotation) { m_rotation *= Quaternion::fromEuler(radians(rotation)); }
+  void rotate(const Vec3<decimal_t>& rotation) { m_rotation *= Quaternion::fromEuler(radians(rotation)); markDirty(); }
 
   /**
    * @brief rotate the transform by the given quaternion.
    * @param rotation - The rotation quaternion.
    */
-  constexpr void rotate(const Quaternion& q) { m_rotation *= q; }
+  void rotate(const Quaternion& q) { m_rotation *= q; markDirty(); }
 
   /**
    * @brief scale the transform by the given scale factors.
@@ -82,13 +115,13 @@ public:
    * @param y - The scale factor along the y axis.
    * @param z - The scale factor along the z axis.
    */
-  constexpr void scale(decimal_t x, decimal_t y, decimal_t z) { m_scale.x *= x; m_scale.y *= y; m_scale.z *= z; }
+  void scale(decimal_t x, decimal_t y, decimal_t z) { m_scale.x *= x; m_scale.y *= y; m_scale.z *= z; markDirty(); }
 
   /**
    * @brief scale the transform by the given vector.
    * @param scale - The scale vector.
    */
-  constexpr void scale(const Vec3<decimal_t>& scale) { m_scale *= scale; }
+  void scale(const Vec3<decimal_t>& scale) { m_scale *= scale; markDirty(); }
   
   /**
    * @brief Set the parent of this transform.
@@ -103,6 +136,8 @@ public:
     if (parent != nullptr && !parent->hasChild(this)) {
       parent->m_children.push_back(this);
     }
+    if (m_hierarchy != nullptr)
+      m_hierarchy->markStructureDirty();
   }
 
   [[nodiscard]] const Vec3<decimal_t>& getPosition() const { return m_position; }
@@ -111,8 +146,32 @@ public:
 
   [[nodiscard]] const Vec3<decimal_t>& getScale() const { return m_scale; }
 
+  /**
+   * @brief Gets the local model matrix, relative to the parent, as of the last call to updateModelMatrix().
+   */
   [[nodiscard]] const Matrix4& getModelMatrix() const { return m_modelMatrix; }
   
+  /**
+   * @brief Gets the world matrix, which includes the transforms of every parent, as of the last sync point.
+   */
+  [[nodiscard]] const Matrix4& getWorldMatrix() const {
+    return m_hierarchy != nullptr ? m_hierarchy->getWorldMatrix(this) : m_modelMatrix;
+  }
+  
+  /**
+   * @brief Gets the world matrix interpolated between the last two fixed steps, as of the last render.
+   * @details Rendering with this matrix instead of getWorldMatrix() hides the stutter of a fixed rate lower than the
+   * frame rate. See Application::getInterpolationAlpha().
+   */
+  [[nodiscard]] const Matrix4& getInterpolatedWorldMatrix() const {
+    return m_hierarchy != nullptr ? m_hierarchy->getInterpolatedWorldMatrix(this) : m_modelMatrix;
+  }
+  
+  /**
+   * @brief Checks if the position, rotation or scale changed since the model matrix was last computed by the Scene.
+   */
+  [[nodiscard]] bool isDirty() const { return m_dirty; }
+  
   [[nodiscard]] const Transform* getParent() const { return m_parent; }
   
   [[nodiscard]] const std::vector<Transform*>& getChildren() const { return m_children; }
@@ -121,11 +180,26 @@ public:
     return std::find(m_children.begin(), m_children.end(), child) != m_children.end();
   }
 
+  /**
+   * @brief Recomputes the local model matrix from the position, rotation and scale.
+   */
   void updateModelMatrix() {
+    m_modelMatrix = Matrix4::identity();
     m_modelMatrix.scale(m_scale);
     m_modelMatrix.rotate(m_rotation);
     m_modelMatrix.translate(m_position);
   }
+
+private:
+  void markDirty() {
+    if (m_dirty)
+      return;
+    m_dirty = true;
+    if (m_hierarchy != nullptr)
+      m_hierarchy->markDirty(this);
+  }
+  
+  friend class internal::TransformHierarchy;
 };
 
 } // ams
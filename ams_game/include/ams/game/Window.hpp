@@ -23,24 +23,28 @@
 #include "ams_game_export.hpp"
 /*[ignore end]*/
 /*[exclude begin]*/
-#include <ams/Function.hpp>
+#include <ams/Delegate.hpp>
 #include <ams/spatial/Vec/Vec2.hpp>
 #include "Object.hpp"
 #include "Display.hpp"
 #include "Key.hpp"
 #include "Mouse.hpp"
+#include "EventBus.hpp"
 /*[exclude end]*/
 
 /*[export module ams.game.Window]*/
 #include <memory>
 #include <functional>
+#include <span>
+#include <string>
 #include <vector>
 #include <map>
-/*[import ams.Function]*/
+/*[import ams.Delegate]*/
 /*[import ams.game.Object]*/
 /*[import ams.game.Display]*/
 /*[import ams.game.Key]*/
 /*[import ams.game.MouseButton]*/
+/*[import ams.game.EventBus]*/
 
 typedef struct GLFWwindow GLFWwindow;
 
@@ -49,7 +53,7 @@ typedef struct GLFWwindow GLFWwindow;
 class Application;
 class Window;
 
-using WindowCallbackFunc = Function<void, const Window*>;
+using WindowCallbackFunc = Delegate<void(const Window*)>;
 
 /**
  * @brief Window configuration options.
@@ -71,6 +75,113 @@ struct WindowConfig {
   Vec2<int> maxSize={-1, -1}; // The maximum size of the window, if it is resizable. A value of <= 0 means no limit.
 };
 
+/** Published to the ams::EventBus of a Window when a key is pressed, repeated or released. */
+struct KeyEvent {
+  const Window* window;
+  KeyPress press;
+  /** Press, Repeat or Release. */
+  MouseAction action;
+};
+
+/** Published to the ams::EventBus of a Window when a unicode character is input. */
+struct CharEvent {
+  const Window* window;
+  uint32_t codepoint;
+};
+
+/** Published to the ams::EventBus of a Window when a mouse button is pressed or released. */
+struct MouseButtonEvent {
+  const Window* window;
+  MousePress press;
+};
+
+/** Published to the ams::EventBus of a Window when the mouse wheel or the touchpad is scrolled. */
+struct MouseScrollEvent {
+  const Window* window;
+  double x;
+  double y;
+};
+
+/** Published to the ams::EventBus of a Window when the cursor moves, in screen coordinates. */
+struct MousePositionEvent {
+  const Window* window;
+  double x;
+  double y;
+};
+
+/** Published to the ams::EventBus of a Window when its size or the size of its framebuffer changes. */
+struct WindowSizeEvent {
+  const Window* window;
+  int width;
+  int height;
+  bool framebuffer;
+};
+
+/** Published to the ams::EventBus of a Window when it gains or loses focus. */
+struct WindowFocusEvent {
+  const Window* window;
+  bool focused;
+};
+
+/** Published to the ams::EventBus of a Window when the user asks to close it. */
+struct WindowCloseEvent {
+  const Window* window;
+};
+
+/** Published to the ams::EventBus of a Window when a unicode character is input with modifier keys. */
+struct CharModsEvent {
+  const Window* window;
+  uint32_t codepoint;
+  int mods;
+};
+
+/** Published to the ams::EventBus of a Window when the cursor enters or leaves it. */
+struct CursorEnterEvent {
+  const Window* window;
+  bool entered;
+};
+
+/**
+ * Published to the ams::EventBus of a Window when paths are dropped on it. The paths are
+ * window->getDroppedPaths().subspan(first, count), which is valid until the next Window::update().
+ */
+struct DropEvent {
+  const Window* window;
+  size_t first;
+  size_t count;
+};
+
+/** Published to the ams::EventBus of a Window when it is iconified or restored. */
+struct WindowIconifyEvent {
+  const Window* window;
+  bool iconified;
+};
+
+/** Published to the ams::EventBus of a Window when it moves, in screen coordinates. */
+struct WindowPositionEvent {
+  const Window* window;
+  int x;
+  int y;
+};
+
+/** Published to the ams::EventBus of a Window when its content needs to be redrawn. */
+struct WindowRefreshEvent {
+  const Window* window;
+};
+
+/** Published to the ams::EventBus of a Window when it is maximized or restored. */
+struct WindowMaximizeEvent {
+  const Window* window;
+  bool maximized;
+};
+
+/** Published to the ams::EventBus of a Window when its content scale changes. */
+struct WindowContentScaleEvent {
+  const Window* window;
+  float x;
+  float y;
+};
+
 /**
  * @brief Window is a c++ wrapper of a GLFW window. It manages the window and its events.
  */
@@ -93,24 +204,12 @@ private:
   bool _isCreated = false;
   bool _isClosing = false;
 
-  // Callbacks
-  std::vector<Function<void, Key>> _charCallbacks{};
-  std::vector<Function<void, const KeyPress&>> _charModsCallbacks{};
-  std::vector<Function<void, const KeyPress&>> _keyCallbacks{};
-  std::vector<Function<void, const MousePress&>> _mouseButtonCallbacks{};
-  std::vector<Function<void, const Vec2<decimal_t>&>> _mouseScrollCallbacks{};
-  std::vector<Function<void, const Vec2<decimal_t>&>> _mousePositionCallbacks{};
-  std::vector<Function<void, bool>> _cursorEnterCallbacks{};
-  std::vector<Function<void, std::vector<std::string>>> _dropCallbacks{};
-  std::vector<Function<void>> _windowCloseCallbacks{};
-  std::vector<Function<void, bool>> _windowFocusCallbacks{};
-  std::vector<Function<void, bool>> _windowIconifyCallbacks{};
-  std::vector<Function<void, const Vec2<int>&>> _windowPositionCallbacks{};
-  std::vector<Function<void, const Vec2<int>&>> _windowSizeCallbacks{};
-  std::vector<Function<void, const Vec2<int>&>> _framebufferSizeCallbacks{};
-  std::vector<Function<void>> _windowRefreshCallbacks{};
-  std::vector<Function<void, bool>> _windowMaximizeCallbacks{};
-  std::vector<Function<void, const Vec2<decimal_t>&>> _windowContentScaleCallbacks{};
+  /** The bus of the window, used until another bus is set. Dispatched by update(). */
+  EventBus _events;
+  /** Receives the input and window events as they are polled. */
+  EventBus* _eventBus = &_events;
+  /** The paths dropped on the window since the last update(). See DropEvent. */
+  std::vector<std::string> _droppedPaths{};
   
   /** @brief Any active Window instance will be in this vector. */
   inline static std::map<GLFWwindow*, Window*> _windows;
@@ -119,6 +218,22 @@ public:
   Window(Display& display, const WindowConfig& options={"Window"});
   ~Window();
   
+  /**
+   * @brief Sets the bus which the events of the window are published to. The Application sets its own bus.
+   * @details The events are queued as they are polled and delivered when the bus is dispatched, once per frame for the
+   * bus of the Application. The window's own bus is dispatched by update(). Callbacks registered before the bus is
+   * changed stay subscribed to the previous bus.
+   * @param bus - The bus, or nullptr to publish to the window's own bus.
+   */
+  void setEventBus(EventBus* bus) { _eventBus = bus != nullptr ? bus : &_events; }
+  
+  [[nodiscard]] EventBus* getEventBus() const { return _eventBus; }
+  
+  /**
+   * @brief Gets the paths dropped on the window since the last update(). See DropEvent.
+   */
+  [[nodiscard]] std::span<const std::string> getDroppedPaths() const { return _droppedPaths; }
+  
   /**
    * @brief Creates the window with the given title and size.
    * @param isResizable - If the window is resizable.
@@ -131,7 +246,7 @@ public:
   
   /**
    * @brief Updates the window.
-   * @details Updates the window by polling events. 
+   * @details Updates the window by polling events, then dispatches the window's own bus if it is the one in use.
    * @see glfwPollEvents
    */
   void update();
@@ -269,56 +384,32 @@ public:
 #pragma endregion Operators
 
 #pragma region CallbackRegistration
-  void registerCharCallback(Function<void, Key>& callback) { _charCallbacks.push_back(callback); }
-  void unregisterCharCallback(Function<void, Key>& callback) { _charCallbacks.erase(std::remove(_charCallbacks.begin(), _charCallbacks.end(), callback), _charCallbacks.end()); }
-
-  void registerCharModsCallback(Function<void, const KeyPress&>& callback) { _charModsCallbacks.push_back(callback); }
-  void unregisterCharModsCallback(Function<void, const KeyPress&>& callback) { _charModsCallbacks.erase(std::remove(_charModsCallbacks.begin(), _charModsCallbacks.end(), callback), _charModsCallbacks.end()); }
-
-  void registerKeyCallback(Function<void, const KeyPress&>& callback) { _keyCallbacks.push_back(callback); }
-  void unregisterKeyCallback(Function<void, const KeyPress&>& callback) { _keyCallbacks.erase(std::remove(_keyCallbacks.begin(), _keyCallbacks.end(), callback), _keyCallbacks.end()); }
-
-  void registerMouseButtonCallback(Function<void, const MousePress&>& callback) { _mouseButtonCallbacks.push_back(callback); }
-  void unregisterMouseButtonCallback(Function<void, const MousePress&>& callback) { _mouseButtonCallbacks.erase(std::remove(_mouseButtonCallbacks.begin(), _mouseButtonCallbacks.end(), callback), _mouseButtonCallbacks.end()); }
-
-  void registerMouseScrollCallback(Function<void, const Vec2<decimal_t>&>& callback) { _mouseScrollCallbacks.push_back(callback); }
-  void unregisterMouseScrollCallback(Function<void, const Vec2<decimal_t>&>& callback) { _mouseScrollCallbacks.erase(std::remove(_mouseScrollCallbacks.begin(), _mouseScrollCallbacks.end(), callback), _mouseScrollCallbacks.end()); }
-
-  void registerMousePositionCallback(Function<void, const Vec2<decimal_t>&>& callback) { _mousePositionCallbacks.push_back(callback); }
-  void unregisterMousePositionCallback(Function<void, const Vec2<decimal_t>&>& callback) { _mousePositionCallbacks.erase(std::remove(_mousePositionCallbacks.begin(), _mousePositionCallbacks.end(), callback), _mousePositionCallbacks.end()); }
-
-  void registerCursorEnterCallback(Function<void, bool>& callback) { _cursorEnterCallbacks.push_back(callback); }
-  void unregisterCursorEnterCallback(Function<void, bool>& callback) { _cursorEnterCallbacks.erase(std::remove(_cursorEnterCallbacks.begin(), _cursorEnterCallbacks.end(), callback), _cursorEnterCallbacks.end()); }
-
-  void registerDropCallback(Function<void, std::vector<std::string>>& callback) { _dropCallbacks.push_back(callback); }
-  void unregisterDropCallback(Function<void, std::vector<std::string>>& callback) { _dropCallbacks.erase(std::remove(_dropCallbacks.begin(), _dropCallbacks.end(), callback), _dropCallbacks.end()); }
-
-  void registerWindowCloseCallback(Function<void> callback) { _windowCloseCallbacks.push_back(callback); }
-  void unregisterWindowCloseCallback(Function<void> callback) { _windowCloseCallbacks.erase(std::remove(_windowCloseCallbacks.begin(), _windowCloseCallbacks.end(), callback), _windowCloseCallbacks.end()); }
-
-  void registerWindowFocusCallback(Function<void, bool>& callback) { _windowFocusCallbacks.push_back(callback); }
-  void unregisterWindowFocusCallback(Function<void, bool>& callback) { _windowFocusCallbacks.erase(std::remove(_windowFocusCallbacks.begin(), _windowFocusCallbacks.end(), callback), _windowFocusCallbacks.end()); }
-
-  void registerWindowIconifyCallback(Function<void, bool>& callback) { _windowIconifyCallbacks.push_back(callback); }
-  void unregisterWindowIconifyCallback(Function<void, bool>& callback) { _windowIconifyCallbacks.erase(std::remove(_windowIconifyCallbacks.begin(), _windowIconifyCallbacks.end(), callback), _windowIconifyCallbacks.end()); }
-
-  void registerWindowPositionCallback(Function<void, const Vec2<int>&>& callback) { _windowPositionCallbacks.push_back(callback); }
-  void unregisterWindowPositionCallback(Function<void, const Vec2<int>&>& callback) { _windowPositionCallbacks.erase(std::remove(_windowPositionCallbacks.begin(), _windowPositionCallbacks.end(), callback), _windowPositionCallbacks.end()); }
-
-  void registerWindowSizeCallback(Function<void, const Vec2<int>&>& callback) { _windowSizeCallbacks.push_back(callback); }
-  void unregisterWindowSizeCallback(Function<void, const Vec2<int>&>& callback) { _windowSizeCallbacks.erase(std::remove(_windowSizeCallbacks.begin(), _windowSizeCallbacks.end(), callback), _windowSizeCallbacks.end()); }
-
-  void registerFramebufferSizeCallback(Function<void, const Vec2<int>&>& callback) { _framebufferSizeCallbacks.push_back(callback); }
-  void unregisterFramebufferSizeCallback(Function<void, const Vec2<int>&>& callback) { _framebufferSizeCallbacks.erase(std::remove(_framebufferSizeCallbacks.begin(), _framebufferSizeCallbacks.end(), callback), _framebufferSizeCallbacks.end()); }
-
-  void registerWindowRefreshCallback(Function<void>& callback) { _windowRefreshCallbacks.push_back(callback); }
-  void unregisterWindowRefreshCallback(Function<void>& callback) { _windowRefreshCallbacks.erase(std::remove(_windowRefreshCallbacks.begin(), _windowRefreshCallbacks.end(), callback), _windowRefreshCallbacks.end()); }
-
-  void registerWindowMaximizeCallback(Function<void, bool>& callback) { _windowMaximizeCallbacks.push_back(callback); }
-  void unregisterWindowMaximizeCallback(Function<void, bool>& callback) { _windowMaximizeCallbacks.erase(std::remove(_windowMaximizeCallbacks.begin(), _windowMaximizeCallbacks.end(), callback), _windowMaximizeCallbacks.end()); }
-
-  void registerWindowContentScaleCallback(Function<void, const Vec2<decimal_t>&>& callback) { _windowContentScaleCallbacks.push_back(callback); }
-  void unregisterWindowContentScaleCallback(Function<void, const Vec2<decimal_t>&>& callback) { _windowContentScaleCallbacks.erase(std::remove(_windowContentScaleCallbacks.begin(), _windowContentScaleCallbacks.end(), callback), _windowContentScaleCallbacks.end()); }
+  // Each callback subscribes a handler to the bus of the window, which calls it for each event of this window when
+  // the bus is dispatched. Unregister it with unregisterCallback() while the bus is the same.
+  EventHandle registerCharCallback(const Delegate<void(Key)>& callback);
+  EventHandle registerCharModsCallback(const Delegate<void(const KeyPress&)>& callback);
+  EventHandle registerKeyCallback(const Delegate<void(const KeyPress&)>& callback);
+  EventHandle registerMouseButtonCallback(const Delegate<void(const MousePress&)>& callback);
+  EventHandle registerMouseScrollCallback(const Delegate<void(const Vec2<decimal_t>&)>& callback);
+  EventHandle registerMousePositionCallback(const Delegate<void(const Vec2<decimal_t>&)>& callback);
+  EventHandle registerCursorEnterCallback(const Delegate<void(bool)>& callback);
+  EventHandle registerDropCallback(const Delegate<void(std::vector<std::string>)>& callback);
+  EventHandle registerWindowCloseCallback(const Delegate<void()>& callback);
+  EventHandle registerWindowFocusCallback(const Delegate<void(bool)>& callback);
+  EventHandle registerWindowIconifyCallback(const Delegate<void(bool)>& callback);
+  EventHandle registerWindowPositionCallback(const Delegate<void(const Vec2<int>&)>& callback);
+  EventHandle registerWindowSizeCallback(const Delegate<void(const Vec2<int>&)>& callback);
+  EventHandle registerFramebufferSizeCallback(const Delegate<void(const Vec2<int>&)>& callback);
+  EventHandle registerWindowRefreshCallback(const Delegate<void()>& callback);
+  EventHandle registerWindowMaximizeCallback(const Delegate<void(bool)>& callback);
+  EventHandle registerWindowContentScaleCallback(const Delegate<void(const Vec2<decimal_t>&)>& callback);
+  
+  /**
+   * @brief Unregisters a callback.
+   * @param handle - The handle returned when the callback was registered.
+   * @return false if the handle is stale.
+   */
+  bool unregisterCallback(const EventHandle& handle) { return _eventBus->unsubscribe(handle); }
 #pragma endregion CallbackRegistration
 
 private:
@@ -38,6 +38,8 @@ class AMS_GAME_EXPORT ActiveComponent : public Component {
 protected:
   bool enabled = true;
 public:
+  using ComponentBases = ComponentBaseList<ActiveComponent, Component>;
+  
   ActiveComponent(Entity* entity) : Component(entity) {}
 
   /**
@@ -60,7 +62,7 @@ public:
    * @brief setEnabled sets the enabled state of the ams::Behavior.
    * @param enabled the enabled state of the ams::Behavior.
    */
-  void setEnabled(bool enabled) { this->enabled = enabled; }
+  virtual void setEnabled(bool enabled) { this->enabled = enabled; }
 };
 
 } // ams
@@ -0,0 +1,301 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.internal.Archetype]*/
+/*[exclude begin]*/
+#pragma once
+#include "ams/game/Component.hpp"
+#include "ComponentType.hpp"
+/*[exclude end]*/
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+/*[import ams.game.Component]*/
+/*[import ams.game.internal.ComponentType]*/
+
+/*[export]*/ namespace ams {
+class Entity;
+class Scene;
+}
+
+/*[export]*/ namespace ams::internal {
+
+/**
+ * @brief The set of component types shared by every ams::Entity stored in an ams::internal::Archetype.
+ */
+using ArchetypeSignature = ComponentMask;
+
+/**
+ * @brief Tests if the components of type T are stored by value in the columns of their archetype.
+ * @details A component type is stored by value if it opts in with ams::StoreByValue. The other types, among which
+ * Behaviors, Transforms and Cameras, are registered by address and are never moved.
+ */
+template<typename T>
+constexpr bool IsStoredByValue = std::is_base_of_v<Component, T> && StoreByValue<T>::value;
+
+/**
+ * @brief Type-erased operations on a component type which is stored by value in archetype columns.
+ */
+struct ComponentStorage {
+  size_t size;
+  size_t align;
+  /** Move constructs the component at src into the uninitialized memory at dst, then destroys src. */
+  Component* (*relocate)(void* dst, Component* src) noexcept;
+  /** Gets the component constructed at a cell of a column. */
+  Component* (*get)(void* cell) noexcept;
+  
+  /**
+   * @brief Gets the storage of a component type.
+   * @return The storage, or nullptr if the component type is not stored by value.
+   */
+  template<typename T>
+  static const ComponentStorage* of() {
+    static_assert(!IsStoredByValue<T> || std::is_nothrow_move_constructible_v<T>,
+                  "A component type stored by value must be nothrow move constructible");
+    if constexpr (IsStoredByValue<T>) {
+      static constexpr ComponentStorage storage{
+        sizeof(T),
+        alignof(T),
+        [](void* dst, Component* src) noexcept -> Component* {
+          auto* value = static_cast<T*>(src);
+          auto* moved = ::new(dst) T(std::move(*value));
+          value->~T();
+          return moved;
+        },
+        [](void* cell) noexcept -> Component* { return std::launder(static_cast<T*>(cell)); }
+      };
+      return &storage;
+    } else {
+      return nullptr;
+    }
+  }
+};
+
+/**
+ * @brief An Archetype is a table which stores every ams::Entity that has the same set of component types.
+ * @details Each component type in the signature owns one column, ordered by type id, and each ams::Entity owns one
+ * row across all columns, so a system interested in a single component type can stream over that column linearly
+ * instead of walking each ams::Entity's component list.
+ * Component types which are stored by value (see IsStoredByValue) are constructed in the table itself. Rows are
+ * grouped in chunks of RowsPerChunk, and each chunk lays the by-value columns out one after the other, so the
+ * components of a column are packed with a stride of their size. Chunks never move, and removing a row leaves a hole
+ * which the next added row reuses, so a component stays at the same address for as long as its ams::Entity stays in
+ * the archetype. The other component types are polymorphic objects which are registered by address, so their column
+ * stores pointers to components allocated from the Scene's pools. If an ams::Entity has more than one component of
+ * the same type, the column holds the first one and the others are allocated from the pool.
+ * The archetype does not construct or destroy components: the ams::Scene relocates them into a row when an
+ * ams::Entity joins the archetype, and out of it or destroys them before the row is removed.
+ * Archetypes are owned by the ams::Scene and are not meant to be used directly.
+ */
+class AMS_GAME_EXPORT Archetype {
+public:
+  /** The number of rows of a chunk. */
+  static constexpr size_t RowsPerChunk = 64;
+
+private:
+  struct Column {
+    /** The storage of a by-value column, or nullptr if the column stores pointers. */
+    const ComponentStorage* storage = nullptr;
+    /** The offset of a by-value column in each chunk. */
+    size_t offset = 0;
+    /** The components of a pointer column, one per row. */
+    std::vector<Component*> components{};
+  };
+  
+  ArchetypeSignature _signature;
+  /** The Entity of each row, or nullptr if the row is free. */
+  std::vector<Entity*> _entities{};
+  /** The free rows, reused last freed first. */
+  std::vector<size_t> _freeRows{};
+  size_t _size = 0;
+  std::vector<Column> _columns;
+  /** The chunks which store the by-value columns. */
+  std::vector<std::byte*> _chunks{};
+  size_t _chunkSize = 0;
+  size_t _chunkAlign = alignof(std::max_align_t);
+  /** cached archetype transitions taken when a component type is added to a row of this archetype. */
+  std::map<ComponentTypeId, Archetype*> _addEdges{};
+  /** cached archetype transitions taken when a component type is removed from a row of this archetype. */
+  std::map<ComponentTypeId, Archetype*> _removeEdges{};
+
+public:
+  /**
+   * @brief Constructs an empty archetype.
+   * @param signature - The component types of the archetype.
+   * @param storages - The storage of each component type, in type id order. nullptr for types stored by pointer.
+   */
+  Archetype(ArchetypeSignature signature, std::span<const ComponentStorage* const> storages);
+  
+  ~Archetype();
+
+  Archetype(const Archetype&) = delete;
+  Archetype& operator=(const Archetype&) = delete;
+
+  /**
+   * @brief Gets the component types stored by this archetype.
+   */
+  [[nodiscard]] const ArchetypeSignature& getSignature() const { return _signature; }
+
+  /**
+   * @brief Gets the number of Entities stored by this archetype.
+   */
+  [[nodiscard]] size_t size() const { return _size; }
+  
+  /**
+   * @brief Gets the number of rows of this archetype, including the free ones.
+   */
+  [[nodiscard]] size_t getRowCount() const { return _entities.size(); }
+
+  /**
+   * @brief Gets the Entity of each row, in row order. Free rows hold nullptr.
+   */
+  [[nodiscard]] std::span<Entity* const> getEntities() const { return _entities; }
+
+  /**
+   * @brief Gets the column index of a component type.
+   * @param type - The id of the component type.
+   * @return The column index, or -1 if the archetype does not store the component type.
+   */
+  [[nodiscard]] int64_t getColumnIndex(ComponentTypeId type) const {
+    return _signature.test(type) ? static_cast<int64_t>(_signature.rank(type)) : -1;
+  }
+
+  /**
+   * @brief Tests if the archetype stores a component type.
+   * @param type - The id of the component type.
+   */
+  [[nodiscard]] bool has(ComponentTypeId type) const { return _signature.test(type); }
+  
+  /**
+   * @brief Tests if a column stores its components by value.
+   * @param column - The column index.
+   */
+  [[nodiscard]] bool isStoredByValue(size_t column) const { return _columns[column].storage != nullptr; }
+  
+  /**
+   * @brief Gets the memory of a by-value column in a chunk. The component of row r is at offset
+   * (r % RowsPerChunk) * the size of the component type.
+   * @param chunk - The chunk index, which is the row index divided by RowsPerChunk.
+   * @param column - The column index.
+   */
+  [[nodiscard]] std::byte* getChunkColumn(size_t chunk, size_t column) const {
+    return _chunks[chunk] + _columns[column].offset;
+  }
+  
+  /**
+   * @brief Gets the components of a pointer column, in row order. Free rows hold nullptr.
+   * @param column - The column index.
+   */
+  [[nodiscard]] std::span<Component* const> getPointerColumn(size_t column) const {
+    return _columns[column].components;
+  }
+
+  /**
+   * @brief Gets the component stored at a row and column.
+   * @param row - The row index. The row must not be free.
+   * @param column - The column index.
+   */
+  [[nodiscard]] Component* at(size_t row, size_t column) const {
+    auto& col = _columns[column];
+    return col.storage != nullptr ? col.storage->get(cell(row, column)) : col.components[row];
+  }
+  
+  /**
+   * @brief Gets the component of type TComp stored at a row and column.
+   * @details Unlike at(), the address of a by-value component is computed without calling through its storage.
+   */
+  template<typename TComp> requires std::is_base_of_v<Component, TComp>
+  [[nodiscard]] TComp* get(size_t row, size_t column) const {
+    if constexpr (IsStoredByValue<TComp>)
+      return std::launder(reinterpret_cast<TComp*>(cell(row, column)));
+    else
+      return static_cast<TComp*>(_columns[column].components[row]);
+  }
+
+  /**
+   * @brief Calls a function for every component of type TComp stored by this archetype, in row order.
+   * @tparam TComp - The component type.
+   * @param fn - The function to call. It receives a TComp*.
+   */
+  template<typename TComp, typename TFunc> requires std::is_base_of_v<Component, TComp>
+  void each(TFunc&& fn) const {
+    auto col = getColumnIndex(ComponentType<TComp>::id());
+    if (col < 0)
+      return;
+    for (size_t row = 0; row < _entities.size(); ++row) {
+      if (_entities[row] != nullptr)
+        fn(get<TComp>(row, static_cast<size_t>(col)));
+    }
+  }
+
+  /**
+   * @brief Adds a row to the archetype, reusing a free row if there is one. Its components are placed with place().
+   * @param entity - The Entity which owns the row.
+   * @return The index of the new row.
+   */
+  size_t addRow(Entity* entity);
+  
+  /**
+   * @brief Places a component in a row.
+   * @details The component of a by-value column is relocated into the row: it is moved, and the source is destroyed
+   * but its memory is not released.
+   * @param row - The row index.
+   * @param column - The column index.
+   * @param component - The component. Its type must be the type of the column.
+   * @return The component in the row, which is a new address for a by-value column.
+   */
+  Component* place(size_t row, size_t column, Component* component);
+
+  /**
+   * @brief Reserves storage for a number of rows.
+   * @param rows - The total number of rows.
+   */
+  void reserve(size_t rows);
+
+  /**
+   * @brief Frees a row. Its by-value components must have been relocated or destroyed.
+   * @param row - The index of the row to remove.
+   */
+  void removeRow(size_t row);
+
+  /**
+   * @brief Removes every row from the archetype and releases its chunks. Its by-value components must have been
+   * destroyed.
+   */
+  void clear();
+  
+private:
+  [[nodiscard]] std::byte* cell(size_t row, size_t column) const {
+    auto& col = _columns[column];
+    return _chunks[row / RowsPerChunk] + col.offset + (row % RowsPerChunk) * col.storage->size;
+  }
+
+public:
+  friend class ams::Scene;
+};
+
+} // ams::internal
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.internal.BehaviorDispatch]*/
+/*[exclude begin]*/
+#pragma once
+#include "ams/game/Behavior.hpp"
+#include "ams/game/ComponentAccess.hpp"
+#include "ComponentType.hpp"
+/*[exclude end]*/
+#include <type_traits>
+#include <vector>
+/*[import ams.game.Behavior]*/
+/*[import ams.game.ComponentAccess]*/
+/*[import ams.game.internal.ComponentType]*/
+
+/*[export]*/ namespace ams::internal {
+
+/**
+ * @brief Calls one event method of a ams::Behavior.
+ */
+using BehaviorInvoker = void(*)(Behavior*);
+
+/**
+ * @brief The per-frame event methods of a ams::Behavior which are dispatched through dispatch lists.
+ */
+enum class BehaviorHook : uint8_t {
+  Update,
+  FixedUpdate,
+  LateUpdate,
+  Count
+};
+
+/**
+ * @brief Describes the concrete type of a ams::Behavior: its component type id, and one invoker for each hook the
+ * type overrides. Hooks which are not overridden have a null invoker.
+ * If the type declares an ams::ComponentAccess, it may be updated concurrently and its accesses are recorded.
+ */
+struct BehaviorHooks {
+  ComponentTypeId type;
+  BehaviorInvoker invokers[static_cast<size_t>(BehaviorHook::Count)];
+  bool concurrent = false;
+  ComponentMask reads{};
+  ComponentMask writes{};
+  
+  [[nodiscard]] BehaviorInvoker get(BehaviorHook hook) const { return invokers[static_cast<size_t>(hook)]; }
+};
+
+/* A hook which is declared public by T can be called and compared directly */
+template<typename T> concept TPublicUpdate = requires { &T::onUpdate; };
+template<typename T> concept TPublicFixedUpdate = requires { &T::onFixedUpdate; };
+template<typename T> concept TPublicLateUpdate = requires { &T::onLateUpdate; };
+
+/**
+ * @brief Compile-time override detection and direct invokers for a concrete ams::Behavior type.
+ * @details A hook is overridden when &T::hook is not a pointer to a member of ams::Behavior. A hook which is not
+ * accessible from outside T must have been redeclared by T, since ams::Behavior declares them public, so it is
+ * treated as overridden. Invokers call the override with a qualified call, which the compiler can devirtualize
+ * because T is the exact type the ams::Behavior was constructed with.
+ * @tparam T - The concrete ams::Behavior type.
+ */
+template<typename T> requires std::is_base_of_v<Behavior, T>
+struct BehaviorTraits {
+  static constexpr bool overridesUpdate = [] {
+    if constexpr (TPublicUpdate<T>)
+      return !std::is_same_v<decltype(&T::onUpdate), void (Behavior::*)()>;
+    else
+      return true;
+  }();
+  
+  static constexpr bool overridesFixedUpdate = [] {
+    if constexpr (TPublicFixedUpdate<T>)
+      return !std::is_same_v<decltype(&T::onFixedUpdate), void (Behavior::*)()>;
+    else
+      return true;
+  }();
+  
+  static constexpr bool overridesLateUpdate = [] {
+    if constexpr (TPublicLateUpdate<T>)
+      return !std::is_same_v<decltype(&T::onLateUpdate), void (Behavior::*)()>;
+    else
+      return true;
+  }();
+  
+  static void update(Behavior* behavior) {
+    if constexpr (TPublicUpdate<T>)
+      static_cast<T*>(behavior)->T::onUpdate();
+    else
+      behavior->onUpdate();
+  }
+  
+  static void fixedUpdate(Behavior* behavior) {
+    if constexpr (TPublicFixedUpdate<T>)
+      static_cast<T*>(behavior)->T::onFixedUpdate();
+    else
+      behavior->onFixedUpdate();
+  }
+  
+  static void lateUpdate(Behavior* behavior) {
+    if constexpr (TPublicLateUpdate<T>)
+      static_cast<T*>(behavior)->T::onLateUpdate();
+    else
+      behavior->onLateUpdate();
+  }
+  
+  /**
+   * @brief Gets the hooks of T. The hooks are created on first use and live for the rest of the program.
+   */
+  static const BehaviorHooks* hooks() {
+    static const BehaviorHooks value = [] {
+      BehaviorHooks hooks {
+        ComponentType<T>::id(),
+        {
+          overridesUpdate ? &update : nullptr,
+          overridesFixedUpdate ? &fixedUpdate : nullptr,
+          overridesLateUpdate ? &lateUpdate : nullptr
+        }
+      };
+      if constexpr (TDeclaresAccess<T>) {
+        hooks.concurrent = true;
+        hooks.reads = T::Access::reads();
+        hooks.writes = T::Access::writes();
+      }
+      return hooks;
+    }();
+    return &value;
+  }
+};
+
+/**
+ * @brief A list of Behaviors which receive one hook, grouped by concrete type.
+ * @details Each group holds the Behaviors of a single concrete type and that type's invoker, so dispatching a group
+ * calls the same function back to back. The Behaviors of a group are partitioned: the first `enabled` Behaviors are
+ * enabled and are the only ones dispatched, and the disabled ones follow. Adding, removing, enabling and disabling a
+ * Behavior is O(1) and swaps at most two Behaviors; the position of each Behavior is stored in the Behavior itself.
+ */
+class AMS_GAME_EXPORT BehaviorDispatchList {
+public:
+  struct Group {
+    const BehaviorHooks* hooks;
+    BehaviorInvoker invoker;
+    std::vector<Behavior*> behaviors;
+    /** The number of enabled Behaviors, which are stored at the front of behaviors. */
+    size_t enabled = 0;
+  };
+  
+private:
+  BehaviorHook _hook;
+  std::vector<Group> _groups{};
+  /** The index of each type's group in _groups, indexed by type id. */
+  std::vector<uint32_t> _groupIndices{};
+  
+public:
+  explicit BehaviorDispatchList(BehaviorHook hook) : _hook(hook) {}
+  
+  /**
+   * @brief Adds a Behavior to the list if its type overrides the list's hook. The Behavior is added disabled.
+   * @param behavior - The Behavior to add. Its hooks must be set.
+   * @return true if the Behavior was added.
+   */
+  bool add(Behavior* behavior);
+  
+  /**
+   * @brief Moves a Behavior of the list to the enabled or the disabled range of its group.
+   * @param behavior - The Behavior to move.
+   * @param enabled - true to move the Behavior to the enabled range.
+   * @return true if the Behavior was moved.
+   */
+  bool setEnabled(Behavior* behavior, bool enabled);
+  
+  /**
+   * @brief Reserves room for a number of Behaviors of one type, if the type overrides the list's hook.
+   * @param hooks - The hooks of the type.
+   * @param count - The number of Behaviors about to be added.
+   */
+  void reserve(const BehaviorHooks* hooks, size_t count);
+  
+  /**
+   * @brief Removes a Behavior from the list by moving the last Behavior of its range into its place.
+   * @param behavior - The Behavior to remove.
+   * @return true if the Behavior was removed.
+   */
+  bool remove(Behavior* behavior);
+  
+  /**
+   * @brief Gets the groups of the list. Groups may be empty.
+   */
+  [[nodiscard]] std::vector<Group>& getGroups() { return _groups; }
+  
+  /**
+   * @brief Gets the number of Behaviors in the list.
+   */
+  [[nodiscard]] size_t size() const;
+  
+  /**
+   * @brief Gets the number of enabled Behaviors in the list.
+   */
+  [[nodiscard]] size_t enabledSize() const;
+  
+  /**
+   * @brief Removes every Behavior from the list.
+   */
+  void clear();
+
+private:
+  /** Gets the group of a type, creating it on first use. */
+  Group& getGroup(const BehaviorHooks* hooks);
+  
+  /** Gets the group which holds a Behavior, or nullptr if the Behavior is not in the list. */
+  Group* find(Behavior* behavior);
+  
+  /** Swaps two Behaviors of a group and updates their positions. */
+  void swap(Group& group, size_t a, size_t b);
+};
+
+} // ams::internal
@@ -0,0 +1,267 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.internal.ComponentType]*/
+/*[exclude begin]*/
+#pragma once
+#include <ams/config.hpp>
+/*[exclude end]*/
+#include <array>
+#include <bit>
+#include <compare>
+#include <span>
+#include <string_view>
+#include <type_traits>
+/*[import ams.config]*/
+
+/*[export]*/ namespace ams::internal {
+
+/**
+ * @brief The dense index of a component type. It is used as a bit position in an ams::internal::ComponentMask.
+ */
+using ComponentTypeId = uint32_t;
+
+/**
+ * @brief The maximum number of distinct component types which can be used by an application.
+ * @details Define AMS_MAX_COMPONENT_TYPES to raise the limit. Each ams::internal::ComponentMask stores one bit per type.
+ */
+constexpr size_t AMSMaxComponentTypes =
+#ifdef AMS_MAX_COMPONENT_TYPES
+  AMS_MAX_COMPONENT_TYPES;
+#else
+  128;
+#endif
+
+/**
+ * @brief Computes a compile-time hash of a type from its name.
+ * @details The hash is an FNV-1a hash of the compiler generated function signature, which contains the fully
+ * qualified type name. It is stable across modules, so it can identify a type across the library boundary.
+ * @tparam T - The type to hash.
+ */
+template<typename T>
+constexpr uint64_t typeHash() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  constexpr std::string_view signature = __FUNCSIG__;
+#else
+  constexpr std::string_view signature = __PRETTY_FUNCTION__;
+#endif
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : signature) {
+    hash ^= static_cast<uint8_t>(c);
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+/**
+ * @brief Maps a type hash to a dense ams::internal::ComponentTypeId.
+ * @details Ids are handed out in registration order. Registering the same hash twice returns the same id. A new type
+ * is recorded as derived from each of its bases, which must have been registered before it.
+ * @param hash - The hash of the component type. See ams::internal::typeHash().
+ * @param bases - The ids of the component types which the type can be looked up as, other than itself.
+ * @return The id of the component type.
+ * @throws ams::Exception if AMSMaxComponentTypes types are already registered. Aborts instead when exceptions are
+ * disabled.
+ */
+AMS_GAME_EXPORT ComponentTypeId registerComponentType(uint64_t hash, std::span<const ComponentTypeId> bases);
+
+template<typename T>
+struct ComponentType;
+
+/**
+ * @brief Registers the component types listed by a ams::ComponentBaseList, except T itself, and collects their ids.
+ * @tparam T - The component type.
+ * @tparam TList - T::ComponentBases. See ams::Component.
+ */
+template<typename T, typename TList>
+struct ComponentBaseIds;
+
+template<typename T, template<typename...> class TList, typename... TBases>
+struct ComponentBaseIds<T, TList<TBases...>> {
+  static_assert((std::is_base_of_v<TBases, T> && ...), "ComponentBases must only list bases of the component type");
+  
+  std::array<ComponentTypeId, sizeof...(TBases)> ids{};
+  size_t count = 0;
+  
+  ComponentBaseIds() {
+    ([this] {
+      if constexpr (!std::is_same_v<TBases, T>)
+        ids[count++] = ComponentType<TBases>::id();
+    }(), ...);
+  }
+  
+  [[nodiscard]] std::span<const ComponentTypeId> get() const { return {ids.data(), count}; }
+};
+
+/**
+ * @brief Compile-time information about a component type.
+ * @tparam T - The component type.
+ */
+template<typename T>
+struct ComponentType {
+  /** The compile-time hash of the component type. */
+  static constexpr uint64_t hash = typeHash<T>();
+  
+  /**
+   * @brief Gets the dense id of the component type.
+   * @details The id is registered on first use, after the ids of the bases of the type, and cached, so this costs a
+   * single guarded load afterwards.
+   */
+  static ComponentTypeId id() {
+    static const ComponentTypeId value = [] {
+      if constexpr (requires { typename T::ComponentBases; }) {
+        ComponentBaseIds<T, typename T::ComponentBases> bases;
+        return registerComponentType(hash, bases.get());
+      } else {
+        return registerComponentType(hash, {});
+      }
+    }();
+    return value;
+  }
+};
+
+/**
+ * @brief A fixed-size bit set with one bit per ams::internal::ComponentTypeId.
+ * @details Besides set membership, a ComponentMask can compute the rank of a type, which is the number of set types
+ * with a lower id. Storing one value per set type in id order therefore gives each type a dense index.
+ */
+class ComponentMask {
+private:
+  static constexpr size_t WordCount = (AMSMaxComponentTypes + 63) / 64;
+  std::array<uint64_t, WordCount> _words{};
+
+public:
+  constexpr ComponentMask() = default;
+
+  /**
+   * @brief Tests if a type is in the mask.
+   * @param id - The id of the type.
+   */
+  [[nodiscard]] constexpr bool test(ComponentTypeId id) const {
+    return (_words[id / 64] >> (id % 64)) & 1u;
+  }
+
+  /**
+   * @brief Adds a type to the mask.
+   * @param id - The id of the type.
+   */
+  constexpr void set(ComponentTypeId id) {
+    _words[id / 64] |= uint64_t(1) << (id % 64);
+  }
+
+  /**
+   * @brief Removes a type from the mask.
+   * @param id - The id of the type.
+   */
+  constexpr void reset(ComponentTypeId id) {
+    _words[id / 64] &= ~(uint64_t(1) << (id % 64));
+  }
+
+  /**
+   * @brief Gets the number of types in the mask with an id lower than id.
+   * @param id - The id of the type.
+   */
+  [[nodiscard]] constexpr size_t rank(ComponentTypeId id) const {
+    size_t r = 0;
+    for (size_t w = 0; w < id / 64; ++w)
+      r += std::popcount(_words[w]);
+    return r + std::popcount(_words[id / 64] & ((uint64_t(1) << (id % 64)) - 1));
+  }
+
+  /**
+   * @brief Gets the number of types in the mask.
+   */
+  [[nodiscard]] constexpr size_t count() const {
+    size_t c = 0;
+    for (auto word : _words)
+      c += std::popcount(word);
+    return c;
+  }
+
+  /**
+   * @brief Tests if every type of other is also in this mask.
+   * @param other - The mask to test.
+   */
+  [[nodiscard]] constexpr bool contains(const ComponentMask& other) const {
+    for (size_t w = 0; w < WordCount; ++w)
+      if ((_words[w] & other._words[w]) != other._words[w])
+        return false;
+    return true;
+  }
+
+  /**
+   * @brief Tests if this mask and other have at least one type in common.
+   * @param other - The mask to test.
+   */
+  [[nodiscard]] constexpr bool intersects(const ComponentMask& other) const {
+    for (size_t w = 0; w < WordCount; ++w)
+      if ((_words[w] & other._words[w]) != 0)
+        return true;
+    return false;
+  }
+
+  /**
+   * @brief Calls a function with the id of every type in the mask, in ascending order.
+   * @param fn - The function to call. It receives a ams::internal::ComponentTypeId.
+   */
+  template<typename TFunc>
+  constexpr void forEach(TFunc&& fn) const {
+    for (size_t w = 0; w < WordCount; ++w) {
+      for (auto word = _words[w]; word != 0; word &= word - 1)
+        fn(static_cast<ComponentTypeId>(w * 64 + std::countr_zero(word)));
+    }
+  }
+
+  /**
+   * @brief Gets the union of two masks.
+   */
+  constexpr ComponentMask operator|(const ComponentMask& other) const {
+    ComponentMask result;
+    for (size_t w = 0; w < WordCount; ++w)
+      result._words[w] = _words[w] | other._words[w];
+    return result;
+  }
+  
+  /**
+   * @brief Gets the intersection of two masks.
+   */
+  constexpr ComponentMask operator&(const ComponentMask& other) const {
+    ComponentMask result;
+    for (size_t w = 0; w < WordCount; ++w)
+      result._words[w] = _words[w] & other._words[w];
+    return result;
+  }
+  
+  constexpr auto operator<=>(const ComponentMask& other) const = default;
+};
+
+/**
+ * @brief Finds a type of a mask which derives from a component type, not counting the component type itself.
+ * @details Derived types are recorded when types are registered, so this only tests one bit per type of the mask.
+ * Thread safe.
+ * @param base - The id of the component type.
+ * @param mask - The types to search, typically the component mask of an ams::Entity.
+ * @return The lowest id of a derived type in the mask, or AMSMaxComponentTypes if there is none.
+ */
+AMS_GAME_EXPORT ComponentTypeId findDerivedComponentType(ComponentTypeId base, const ComponentMask& mask);
+
+} // ams::internal
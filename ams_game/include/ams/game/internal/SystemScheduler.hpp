@@ -0,0 +1,108 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.internal.SystemScheduler]*/
+/*[exclude begin]*/
+#pragma once
+#include <ams/JobSystem.hpp>
+#include "ams/game/System.hpp"
+/*[exclude end]*/
+#include <span>
+#include <vector>
+/*[import ams.JobSystem]*/
+/*[import ams.game.System]*/
+
+/*[export]*/ namespace ams::internal {
+
+/**
+ * @brief The SystemScheduler runs the Systems of one ams::SystemPhase of a ams::Scene.
+ * @details The execution graph is built once, and again only after Systems are added or removed. The Systems are
+ * ordered by their runBefore() and runAfter() constraints, ties being broken by the order they were added, and each
+ * System then depends on every earlier System which it has a constraint with or whose access conflicts with its own.
+ * run() schedules the concurrent Systems on the ams::JobSystem along those dependencies, runs the others on the
+ * calling thread in order, and returns once every System has run.
+ * The scheduler is owned by the ams::Scene and is not meant to be used directly.
+ */
+class AMS_GAME_EXPORT SystemScheduler {
+private:
+  /** The Systems in the order they were added. */
+  std::vector<System*> _systems{};
+  /** The Systems in execution order, and for each of them, */
+  std::vector<System*> _order{};
+  /** the indices in _order of the Systems it waits for. */
+  std::vector<std::vector<uint32_t>> _dependencies{};
+  bool _dirty = false;
+  std::vector<JobHandle> _handles{};
+  std::vector<JobHandle> _waitList{};
+
+public:
+  SystemScheduler() = default;
+  SystemScheduler(const SystemScheduler&) = delete;
+  SystemScheduler& operator=(const SystemScheduler&) = delete;
+  
+  void add(System* system);
+  
+  /**
+   * @brief Tests if a System can be added without its runBefore() and runAfter() constraints forming a cycle with
+   * those of the scheduled Systems.
+   * @param system - The System, which is not scheduled yet.
+   */
+  [[nodiscard]] bool canAdd(const System* system) const;
+  
+  /**
+   * @return true if the System was scheduled by this scheduler.
+   */
+  bool remove(System* system);
+  
+  /**
+   * @brief Runs every System once.
+   * @param jobs - The JobSystem which runs the concurrent Systems.
+   */
+  void run(JobSystem& jobs);
+  
+  /**
+   * @brief Gets the Systems in execution order, building the graph if it is out of date.
+   */
+  std::span<System* const> getOrder();
+  
+  [[nodiscard]] bool empty() const { return _systems.empty(); }
+
+private:
+  /** Orders the Systems and computes their dependencies. */
+  void build();
+  
+  /**
+   * @brief Orders Systems by their constraints, ties being broken by their order in systems.
+   * @param systems - The Systems.
+   * @param constrained - Receives, for each pair of indices in systems, if the first must run before the second.
+   * @param sorted - Receives the indices in systems, in execution order. If the constraints form a cycle, the
+   * constraints of the Systems in the cycle are ignored.
+   * @return false if the constraints form a cycle.
+   */
+  static bool sort(std::span<const System* const> systems, std::vector<std::vector<bool>>& constrained,
+                   std::vector<size_t>& sorted);
+  
+  /** Runs a System and records the time it took. */
+  static void runTimed(System* system);
+};
+
+} // ams::internal
@@ -0,0 +1,222 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+
+/*[ignore begin]*/
+#include "ams_game_export.hpp"
+/*[ignore end]*/
+
+/*[export module ams.game.internal.TransformHierarchy]*/
+/*[exclude begin]*/
+#pragma once
+#include <ams/spatial.hpp>
+/*[exclude end]*/
+#include <atomic>
+#include <limits>
+#include <span>
+#include <utility>
+#include <vector>
+/*[import ams.spatial]*/
+
+/*[export]*/ namespace ams {
+class Transform;
+}
+
+/*[export]*/ namespace ams::internal {
+
+/**
+ * @brief The TransformHierarchy of a ams::Scene computes the world matrices of its Transforms.
+ * @details The Transforms are ordered depth first, so that every parent comes before its children and every subtree
+ * occupies a contiguous range, and their world matrices are stored in the same order in one contiguous buffer.
+ * A Transform which is moved, rotated or scaled marks itself dirty and is queued once; update() then recomputes only
+ * the queued subtrees, parents first. When nothing was queued, update() returns immediately, so static Transforms cost
+ * nothing per frame. The local matrices of the queued Transforms are rebuilt together by ams::composeTRS().
+ * Adding, removing or re-parenting a Transform invalidates the order, which is rebuilt by the next update().
+ * For rendering between fixed steps, storeStates() keeps the position, rotation and scale of the Transforms at the
+ * start of each fixed step, and interpolate() blends them with the current ones into a second set of world matrices.
+ * Both only visit the Transforms which moved since the last storeStates(), and interpolate() their subtrees: every
+ * other interpolated matrix is the world matrix, so static Transforms cost nothing there either.
+ * Transforms may be marked dirty concurrently, but only one thread may change a given Transform at a time.
+ * The hierarchy is owned by the ams::Scene and is not meant to be used directly.
+ */
+class AMS_GAME_EXPORT TransformHierarchy {
+public:
+  static constexpr uint32_t InvalidIndex = std::numeric_limits<uint32_t>::max();
+
+private:
+  /** Every registered Transform, in no particular order. */
+  std::vector<Transform*> _transforms{};
+  /** The registered Transforms in depth first order, and for each of them: */
+  std::vector<Transform*> _order{};
+  /** the index of its parent in _order, or InvalidIndex for roots, */
+  std::vector<uint32_t> _parents{};
+  /** the number of Transforms in its subtree, including itself, */
+  std::vector<uint32_t> _subtreeSizes{};
+  /** and its world matrix. */
+  std::vector<Matrix4> _world{};
+  /** Indices in _order of the Transforms marked dirty since the last update. Sized to hold every Transform once. */
+  std::vector<uint32_t> _dirty{};
+  std::atomic_uint32_t _dirtyCount{0};
+  std::atomic_bool _structureDirty{false};
+  /**
+   * Indices in _order of the Transforms which moved since the last storeStates(), or which have no stored state yet.
+   * Sized to hold every Transform once. If there are none, the interpolated matrices are _world.
+   */
+  std::vector<uint32_t> _moved{};
+  std::atomic_uint32_t _movedCount{0};
+  /** The interpolated world matrices, in the order of _order. Used when _interpolating is true. */
+  std::vector<Matrix4> _interpolated{};
+  bool _interpolating = false;
+  /**
+   * The ranges of _order where _interpolated may differ from _world: the last interpolated subtrees, and the subtrees
+   * updated since.
+   */
+  std::vector<std::pair<uint32_t, uint32_t>> _staleInterpolated{};
+  /** true if every interpolated matrix may differ from _world, e.g. after the order was rebuilt. */
+  bool _interpolatedStale = true;
+  /** Scratch space used to rebuild the local matrices of the dirty Transforms of a range in one batch. */
+  TransformBatch _batch{};
+  std::vector<Transform*> _batchTransforms{};
+  std::vector<Matrix4> _batchMatrices{};
+  /** The Transforms whose world matrix was recomputed since the last clearChanges(), if changes are tracked. */
+  std::vector<Transform*> _changed{};
+  /** true if the order was rebuilt since the last clearChanges(), so that every Transform changed. */
+  bool _allChanged = false;
+  bool _trackChanges = false;
+
+public:
+  TransformHierarchy() = default;
+  TransformHierarchy(const TransformHierarchy&) = delete;
+  TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+  
+  /**
+   * @brief Registers a Transform.
+   */
+  void add(Transform* transform);
+  
+  /**
+   * @brief Unregisters a Transform. Called when the Transform is destroyed.
+   */
+  void remove(Transform* transform);
+  
+  /**
+   * @brief Unregisters every Transform at once.
+   */
+  void clear();
+  
+  /**
+   * @brief Queues a Transform whose local matrix changed.
+   */
+  void markDirty(Transform* transform);
+  
+  /**
+   * @brief Invalidates the order of the Transforms after a parent changed.
+   */
+  void markStructureDirty() {
+    _structureDirty.store(true, std::memory_order_relaxed);
+  }
+  
+  /**
+   * @brief Recomputes the world matrices of the dirty subtrees.
+   */
+  void update();
+  
+  /**
+   * @brief Enables or disables the tracking of the Transforms whose world matrix changes, for getChanges().
+   * @details Enabling the tracking reports every Transform as changed.
+   */
+  void setTrackChanges(bool track);
+  
+  /**
+   * @brief Gets the Transforms whose world matrix changed since the last clearChanges(). A Transform may be listed
+   * more than once. Only valid while allChanged() is false: rebuilding the order may destroy listed Transforms.
+   */
+  [[nodiscard]] std::span<Transform* const> getChanges() const { return _changed; }
+  
+  /**
+   * @brief Checks if every Transform changed since the last clearChanges(), so that getChanges() does not apply.
+   */
+  [[nodiscard]] bool allChanged() const { return _allChanged; }
+  
+  /**
+   * @brief Forgets the tracked changes.
+   */
+  void clearChanges() {
+    _changed.clear();
+    _allChanged = false;
+  }
+  
+  /**
+   * @brief Stores the position, rotation and scale of the Transforms which moved since the last call as the state to
+   * interpolate from. The other Transforms already hold their current state.
+   */
+  void storeStates();
+  
+  /**
+   * @brief Computes the world matrices interpolated between the stored and the current states.
+   * @details The stored states are blended with the current ones by alpha, with a normalized linear interpolation
+   * for the rotations. Only the subtrees of the Transforms which moved since the states were stored are recomputed.
+   * Transforms created since the states were stored are not interpolated. Must be called after update().
+   * @param alpha - The blend factor, from 0 for the stored states to 1 for the current states.
+   */
+  void interpolate(decimal_t alpha);
+  
+  /**
+   * @brief Gets the world matrix of a Transform as of the last update.
+   * @return The world matrix, or the Transform's model matrix if it has not been through an update yet.
+   */
+  [[nodiscard]] const Matrix4& getWorldMatrix(const Transform* transform) const;
+  
+  /**
+   * @brief Gets the world matrices of every Transform, in the order of getTransforms().
+   */
+  [[nodiscard]] std::span<const Matrix4> getWorldMatrices() const { return _world; }
+  
+  /**
+   * @brief Gets the interpolated world matrix of a Transform as of the last interpolate().
+   */
+  [[nodiscard]] const Matrix4& getInterpolatedWorldMatrix(const Transform* transform) const;
+  
+  /**
+   * @brief Gets the interpolated world matrices of every Transform, in the order of getTransforms().
+   */
+  [[nodiscard]] std::span<const Matrix4> getInterpolatedWorldMatrices() const {
+    return _interpolating ? _interpolated : _world;
+  }
+  
+  /**
+   * @brief Gets every Transform in depth first order, as of the last update.
+   */
+  [[nodiscard]] std::span<Transform* const> getTransforms() const { return _order; }
+  
+  /**
+   * @brief Gets the number of registered Transforms.
+   */
+  [[nodiscard]] size_t size() const { return _transforms.size(); }
+
+private:
+  /** Orders the Transforms depth first and recomputes every world matrix. */
+  void rebuild();
+  
+  /** Recomputes the world matrices of a range of _order whose parents are up to date. */
+  void updateRange(uint32_t begin, uint32_t end);
+  
+  /** Recomputes the interpolated world matrices of a subtree whose parent is up to date. */
+  void interpolateRange(uint32_t begin, uint32_t end, decimal_t alpha);
+};
+
+} // ams::internal
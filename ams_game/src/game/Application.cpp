@@ -30,6 +30,7 @@ import ams.game.Util;
 import ams.game.MeshLoaders;
 import ams.game.Renderer;
 #endif
+#include <algorithm>
 #include <cstdlib>
 #include <thread>
 #include <iostream>
@@ -50,11 +51,16 @@ Vec2<int> calcDisplayWindowCenter(const Display& disp, const Vec2<int>& winSize)
   return Vec2<int>(dispSize.x / 2 - winSize.x / 2, dispSize.y / 2 - winSize.y / 2);
 }
 
+/** Gets the id of a scene for a SceneChangeEvent, which is 0 if there is no scene. */
+uuid_t sceneId(const Scene* scene) {
+  return scene != nullptr ? scene->getId() : 0;
+}
+
 Application::Application(const ApplicationInfo& appinfo, const WindowConfig& cfg)
 : Object(appinfo.name),
   _windowConfig(cfg),
   info(appinfo),
-  appDataDir(SystemInfo::localDataDirectory / name)
+  appDataDir(SystemInfo::localDataDirectory / getName())
 {
   assert(glfwInit() == GLFW_TRUE);
 
@@ -93,6 +99,9 @@ Application::Application(const std::string& name, const WindowConfig& cfg)
 {}
 
 Application::~Application() {
+  // the loading and unloading threads use the scenes and the allocators of the Application
+  _loadingScene = {};
+  _unloadingScenes.clear();
   if (_instance == this) {
     _instance = nullptr;
   }
@@ -106,6 +115,15 @@ Scene* Application::getCurrentScene() const {
 }
 
 Scene* Application::setCurrentScene(const std::string& name) {
+  // the loaded scene replaces and removes the current scene, so a change made meanwhile could not be kept
+  if (isLoadingScene())
+    return throwOrDefault<Exception, Scene*>("The current scene can not change while a scene is loading", nullptr);
+  // the current scene can not exit while it is updating, so the change waits for the next sync point
+  if (_currentScene != nullptr && _currentScene->_dispatching) {
+    _pendingScene = getScene(name);
+    return _pendingScene;
+  }
+  auto* pPrevious = _currentScene;
   if (_currentScene != nullptr) {
     _currentScene->onExit();
   }
@@ -113,6 +131,7 @@ Scene* Application::setCurrentScene(const std::string& name) {
   if (_currentScene != nullptr) {
     _currentScene->onEnter();
   }
+  _events.publish(SceneChangeEvent{sceneId(pPrevious), sceneId(_currentScene)});
   return _currentScene;
 }
 
@@ -151,6 +170,54 @@ Scene* Application::createScene(const std::string& name) {
   return pScene;
 }
 
+bool Application::loadSceneAsync(const std::string& name, const Delegate<void(Scene*)>& builder) {
+  if (_loadingScene.valid())
+    return throwOrDefault<Exception, bool>("Another scene is already loading", false);
+  if (_pendingScene != nullptr)
+    return throwOrDefault<Exception, bool>("A scene can not load while a scene change is pending", false);
+  Scene* pExisting = nullptr;
+  if (tryGetScene(name, pExisting))
+    return throwOrDefault<ArgumentException, bool>("Scene already exists", false);
+  _loadingScene = std::async(std::launch::async, [this, name, builder]() {
+    auto upScene = std::make_unique<Scene>(this, name);
+    builder(upScene.get());
+    return upScene;
+  });
+  return true;
+}
+
+bool Application::isLoadingScene() const {
+  return _loadingScene.valid();
+}
+
+void Application::finishSceneLoad() {
+  if (!_loadingScene.valid() || _loadingScene.wait_for(0s) != std::future_status::ready)
+    return;
+  auto upScene = _loadingScene.get();
+  auto* pScene = upScene.get();
+  scenes.push_back(std::move(upScene));
+  
+  auto* pPrevious = _currentScene;
+  _currentScene = pScene;
+  if (pPrevious != nullptr) {
+    pPrevious->disableBehaviors();
+    auto it = std::find_if(scenes.begin(), scenes.end(), [pPrevious](auto& upPrev) {
+      return upPrev.get() == pPrevious;
+    });
+    auto upPrevious = std::move(*it);
+    scenes.erase(it);
+    std::erase_if(_unloadingScenes, [](auto& unloading) {
+      return unloading.wait_for(0s) == std::future_status::ready;
+    });
+    _unloadingScenes.push_back(std::async(std::launch::async, [upPrevious = std::move(upPrevious)]() mutable {
+      upPrevious->unload();
+      upPrevious.reset();
+    }));
+  }
+  _currentScene->onEnter();
+  _events.publish(SceneChangeEvent{sceneId(pPrevious), sceneId(_currentScene)});
+}
+
 time_unit Application::getElapsedTime() const {
   return duration_cast<time_unit>(clk_t::now() - startTime);
 }
@@ -181,14 +248,33 @@ void Application::run() {
     lag += deltaTime;
 
     // fixed update
+    uint32_t steps = 0;
     while (lag >= fixedFrameTime && running) {
+      if (steps == maxFixedSteps) {
+        // drop the time which can not be caught up with
+        lag %= fixedFrameTime;
+        break;
+      }
       onFixedFrameStart(); // virtual method - noop unless overridden
-      _currentScene->onUpdate();
+      _currentScene->storeTransformStates();
+      _currentScene->onFixedUpdate();
+      sync();
       lag -= fixedFrameTime;
+      ++steps;
       onFixedFrameEnd(); // virtual method - noop unless overridden
     }
+    _interpolationAlpha = static_cast<decimal_t>(lag.count()) / static_cast<decimal_t>(fixedFrameTime.count());
+
+    // variable update
+    if (running) {
+      _currentScene->onUpdate();
+      sync();
+    }
 
+    _currentScene->interpolateTransforms(_interpolationAlpha);
     _currentScene->onRender();
+    sync();
+    finishSceneLoad();
     for (auto& win : _windows) {
       win->update();
       if (win->getShouldClose()) {
@@ -197,6 +283,7 @@ void Application::run() {
           stop();
       }
     }
+    _events.dispatch();
     // limit frame rate (vsync)
     if (vsyncTime > tu0s) {
       auto sleepTime = vsyncTime - duration_cast<time_unit>(clk_t::now() - lastFrameTime);
@@ -207,7 +294,18 @@ void Application::run() {
     onFrameEnd(); // virtual method - noop unless overridden
   }
   onRunEnd(); // virtual method - noop unless overridden
-  // exit();
+  if (_exitRequested)
+    exit();
+}
+
+void Application::sync() {
+  _currentScene->flushCommands();
+  _currentScene->updateTransforms();
+  if (_pendingScene != nullptr) {
+    auto* pScene = _pendingScene;
+    _pendingScene = nullptr;
+    setCurrentScene(pScene->getName());
+  }
 }
 
 void Application::stop() {
@@ -216,8 +314,17 @@ void Application::stop() {
 
 void Application::exit() {
   stop();
+  // the scenes can not exit while one of them is updating, so run() exits once the frame is finished
+  if (_currentScene != nullptr && _currentScene->_dispatching) {
+    _exitRequested = true;
+    return;
+  }
+  _exitRequested = false;
+  _pendingScene = nullptr;
+  // a scene which is still loading is discarded once it is built
+  _loadingScene = {};
+  _unloadingScenes.clear();
   if (_currentScene != nullptr) {
-    _currentScene->_frameIsValid = false;
     _currentScene->onExit();
   }
   _currentScene = nullptr;
@@ -228,7 +335,7 @@ void Application::exit() {
 }
 
 Scene* Application::getDefaultScene() {
-  const auto defaultSceneName = name + "_default_" + std::to_string(id);
+  const auto defaultSceneName = getName() + "_default_" + std::to_string(id);
   Scene* pScene = nullptr;
   auto hasScene = tryGetScene(defaultSceneName, pScene);
   if (!hasScene) {
@@ -260,6 +367,19 @@ time_unit Application::getFixedFrameTime() const {
   return fixedFrameTime;
 }
 
+void Application::setMaxFixedSteps(uint32_t steps) {
+  if (steps < 1) steps = 1;
+  maxFixedSteps = steps;
+}
+
+uint32_t Application::getMaxFixedSteps() const {
+  return maxFixedSteps;
+}
+
+decimal_t Application::getInterpolationAlpha() const {
+  return _interpolationAlpha;
+}
+
 Window* Application::getWindow() {
   if (_windows.empty()) {
     if constexpr (AMSExceptions) {
@@ -291,31 +411,12 @@ std::filesystem::path Application::getAppDataDir() const {
   return appDataDir;
 }
 
-bool Application::registerOnSceneChangeCallback(const Function<void, ams::Scene*, ams::Scene*>& callback) {
-  bool result = std::find_if(_onSceneChangeListeners.begin(), _onSceneChangeListeners.end(), [&](const auto& cb) {
-    return cb == callback;
-  }) == _onSceneChangeListeners.end();
-  if (result)
-    _onSceneChangeListeners.push_back(callback);
-  return result;
-}
-
-bool Application::unregisterOnSceneChangeCallback(const Function<void, ams::Scene*, ams::Scene*>& callback) {
-  auto it = std::find_if(_onSceneChangeListeners.begin(), _onSceneChangeListeners.end(), [&](const auto& cb) {
-    return cb == callback;
-  });
-  if (it != _onSceneChangeListeners.end()) {
-    _onSceneChangeListeners.erase(it);
-    return true;
-  }
-  return false;
-}
-
 Window* Application::createWindow(const WindowConfig& cfg) {
   _windows.push_back(std::make_unique<Window>(_displays.front(), _windowConfig));
   auto* win = _windows[_windows.size()-1].get();
   if (win == nullptr)
     return win; // errors handled in App constructor.
+  win->setEventBus(&_events);
   if (!_windowConfig.fullscreen) {
     win->setPosition(calcDisplayWindowCenter(_displays.front(), _windowConfig.size));
   }
@@ -341,5 +442,9 @@ ApplicationInfo Application::getInfo() const {
   return info;
 }
 
+EventBus& Application::getEventBus() {
+  return _events;
+}
+
 } // ams
 
@@ -18,9 +18,11 @@
 #ifndef AMS_MODULES
 #include "ams/game/Behavior.hpp"
 #include "ams/game/Entity.hpp"
+#include "ams/game/Scene.hpp"
 #else
 import ams.game.Behavior;
 import ams.game.Entity;
+import ams.game.Scene;
 #endif
 
 namespace ams {
@@ -29,4 +31,14 @@ using namespace ams::internal;
 
 Behavior::Behavior(Entity* entity) : ActiveComponent(entity) {}
 
+void Behavior::setEnabled(bool enabled) {
+  if (enabled == this->enabled)
+    return;
+  ActiveComponent::setEnabled(enabled);
+  // Behaviors which are not registered yet are placed by their Scene when they are registered
+  auto* scene = getEntity()->getScene();
+  if (scene != nullptr)
+    scene->updateBehaviorState(this);
+}
+
 } // ams
\ No newline at end of file
@@ -35,6 +35,10 @@ Camera::Camera(ams::Entity* entity)
   entity->getScene()->registerCamera(this);
 }
 
+Camera::~Camera() {
+  entity->getScene()->unregisterCamera(this);
+}
+
 void Camera::setProjectionMatrix(const Matrix4& matrix) {
   projectionMatrix = matrix;
   // extract fov, aspect ratio, near and far planes
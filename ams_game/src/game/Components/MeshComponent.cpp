@@ -18,9 +18,11 @@
 #ifndef AMS_MODULES
 #include "ams/game/Components/MeshComponent.hpp"
 #include "ams/game/internal/Meshes.hpp"
+#include "ams/game/Scene.hpp"
 #else
 import ams.game.Components.MeshComponent;
 import ams.game.internal.Meshes;
+import ams.game.Scene;
 #endif
 
 
@@ -32,11 +34,14 @@ MeshComponent::MeshComponent(Entity* entity, Mesh* mesh)
   if (!_sharedMesh) {
     _sharedMesh = &internal::Meshes::BoxMesh; // todo: shared mesh || instanced mesh
   }
+  onMeshChanged();
 }
 
 MeshComponent::~MeshComponent() {
   if (_mesh)
     delete _mesh;
+  // the Entity is a point again, unless it is being destroyed and is no longer indexed
+  getEntity()->getScene()->getSpatialIndex().setMesh(getEntity(), nullptr);
 }
 
 const Mesh* MeshComponent::getMesh() const {
@@ -45,6 +50,11 @@ const Mesh* MeshComponent::getMesh() const {
 
 void MeshComponent::setMesh(Mesh* mesh) {
   _sharedMesh = mesh;
+  onMeshChanged();
+}
+
+void MeshComponent::onMeshChanged() {
+  getEntity()->getScene()->getSpatialIndex().setMesh(getEntity(), getMesh());
 }
 
 } // ams
\ No newline at end of file
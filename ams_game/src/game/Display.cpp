@@ -44,7 +44,7 @@ Display::Display(GLFWmonitor* monitor)
       return;
   }
   _mode = glfwGetVideoMode(_monitor);
-  name = glfwGetMonitorName(_monitor);
+  setName(glfwGetMonitorName(_monitor));
   _size = { _mode->width, _mode->height };
   glfwGetMonitorPos(_monitor, &_position.x, &_position.y);
   
@@ -73,7 +73,7 @@ Vec3<int> Display::getBitDepth() const {
 }
 
 const std::string& Display::getName() const {
-  return name;
+  return Object::getName();
 }
 
 const uuid_t& Display::getId() const {
@@ -19,26 +19,50 @@
 #include "ams/game/Entity.hpp"
 #include "ams/game/Component.hpp"
 #include "ams/game/Scene.hpp"
+#include "ams/game/CommandBuffer.hpp"
+#include "ams/game/internal/Archetype.hpp"
 #else
 import ams.game.Entity;
 import ams.game.Component;
 import ams.game.Scene;
+import ams.game.CommandBuffer;
+import ams.game.internal.Archetype;
 #endif
+#include <algorithm>
+#include <memory>
 
 namespace ams {
 
-Entity::Entity(Scene* scene) : Object(), _behaviors(
-  [&](Behavior* pB) { _scene->registerBehavior(pB); },
-  [&](Behavior* pB) { _scene->unregisterBehavior(pB); }
-  )
+using namespace ams::internal;
+
+Entity::Entity(Scene* scene) : Object(),
+  _components(getMetadataResource(scene)),
+  _componentTypes(getMetadataResource(scene)),
+  _behaviors(getMetadataResource(scene)),
+  _slots(getMetadataResource(scene))
 {
   if constexpr (AMSExceptions)
     if (scene == nullptr)
       throw NullPointerException("Scene is null");
   this->_scene = scene;
-  auto xform = std::make_unique<Transform>(this);
-  _transform = xform.get();
-  _components.emplace_back(std::move(xform));
+  _transform = getComponentPool(ComponentType<Transform>::id(), sizeof(Transform), alignof(Transform))
+    .make<Transform>(this).release();
+  _components.push_back(_transform);
+  _componentTypes.push_back(ComponentType<Transform>::id());
+  // the Scene places the Entity in its archetype once construction completes
+  _mask.set(ComponentType<Transform>::id());
+  _slots.push_back(_transform);
+}
+
+Entity::~Entity() {
+  // the Behaviors are unregistered while they are alive
+  for (auto* behavior : _behaviors)
+    _scene->unregisterBehavior(behavior);
+  _behaviors.clear();
+  for (size_t i = 0; i < _components.size(); ++i)
+    destroyComponent(_componentTypes[i], _components[i], isStoredInRow(_componentTypes[i], _components[i]));
+  if (_archetype != nullptr)
+    _archetype->removeRow(_row);
 }
 
 void Entity::destroy() {
@@ -49,4 +73,98 @@ Scene* Entity::getScene() const {
   return _scene;
 }
 
+void Entity::onBehaviorAdded(Behavior* behavior) {
+  _behaviors.push_back(behavior);
+  _scene->registerBehavior(behavior);
+}
+
+Component* Entity::onComponentAdded(ComponentTypeId type, Component* component, const ComponentStorage* storage) {
+  // repeated types keep the first component in their slot, and the others in the pool
+  if (_mask.test(type))
+    return component;
+  _scene->setComponentStorage(type, storage);
+  auto rank = _mask.rank(type);
+  _slots.insert(_slots.begin() + static_cast<ptrdiff_t>(rank), component);
+  _mask.set(type);
+  _scene->moveToArchetype(this, type);
+  return _slots[rank];
+}
+
+bool Entity::isStoredInRow(ComponentTypeId type, const Component* component) const {
+  if (_archetype == nullptr || !_mask.test(type))
+    return false;
+  auto rank = _mask.rank(type);
+  return _slots[rank] == component && _archetype->isStoredByValue(rank);
+}
+
+void Entity::destroyComponent(ComponentTypeId type, Component* component, bool inRow) {
+  if (inRow)
+    std::destroy_at(component);
+  else
+    PoolDeleter<Component>(_scene->_componentPools[type].get())(component);
+}
+
+void Entity::onComponentRelocated(size_t slot, Component* component) {
+  auto* previous = _slots[slot];
+  _slots[slot] = component;
+  *std::find(_components.begin(), _components.end(), previous) = component;
+}
+
+Component* Entity::findComponent(uuid_t id) const {
+  auto it = std::find_if(_components.begin(), _components.end(), [id](const Component* component) {
+    return component->getId() == id;
+  });
+  return it != _components.end() ? *it : nullptr;
+}
+
+PoolAllocator& Entity::getComponentPool(ComponentTypeId type, size_t size, size_t align) {
+  return _scene->getComponentPool(type, size, align);
+}
+
+std::pmr::memory_resource* Entity::getMetadataResource(Scene* scene) {
+  return scene != nullptr ? &scene->_metadata : std::pmr::get_default_resource();
+}
+
+bool Entity::removeComponent(Component* component) {
+  auto it = std::find(_components.begin(), _components.end(), component);
+  if (it == _components.end() || component == _transform)
+    return false;
+  if (_scene->_dispatching) {
+    _scene->getCommandBuffer().removeComponent(_handle, component->getId());
+    return true;
+  }
+  // the Behaviors are listed already, so the component is looked up by address rather than cast
+  if (auto behavior = std::find(_behaviors.begin(), _behaviors.end(), component); behavior != _behaviors.end()) {
+    _scene->unregisterBehavior(*behavior);
+    _behaviors.erase(behavior);
+  }
+  auto index = it - _components.begin();
+  auto type = _componentTypes[index];
+  auto inRow = isStoredInRow(type, component);
+  _components.erase(it);
+  _componentTypes.erase(_componentTypes.begin() + index);
+  
+  auto rank = _mask.rank(type);
+  if (_slots[rank] != component) {
+    destroyComponent(type, component, false);
+    return true;
+  }
+  // another component of the same type takes over the slot
+  auto other = std::find(_componentTypes.begin(), _componentTypes.end(), type);
+  if (other != _componentTypes.end()) {
+    auto* next = _components[other - _componentTypes.begin()];
+    // the row is freed first, so that a by-value column can take the next component in
+    destroyComponent(type, component, inRow);
+    _slots[rank] = next;
+    _scene->placeInRow(this, type);
+    return true;
+  }
+  _slots.erase(_slots.begin() + static_cast<ptrdiff_t>(rank));
+  _mask.reset(type);
+  // the component stays behind in the row of the previous archetype, which is no longer used
+  _scene->moveToArchetype(this, type);
+  destroyComponent(type, component, inRow);
+  return true;
+}
+
 } // ams
@@ -0,0 +1,84 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/game/EventBus.hpp"
+#include "ams/game/Exceptions.hpp"
+#else
+import ams.game.EventBus;
+import ams.game.Exceptions;
+#endif
+
+#include <unordered_map>
+
+namespace ams {
+
+namespace internal {
+
+uint32_t registerEventType(uint64_t hash) {
+  static std::mutex mutex;
+  static std::unordered_map<uint64_t, uint32_t> ids;
+  std::scoped_lock lock(mutex);
+  auto [it, inserted] = ids.try_emplace(hash, static_cast<uint32_t>(ids.size()));
+  if constexpr (AMSExceptions)
+    if (inserted && it->second >= EventBus::MaxEventTypes)
+      throw Exception("Too many event types");
+  return it->second;
+}
+
+} // internal
+
+EventBus::~EventBus() = default;
+
+bool EventBus::unsubscribe(const EventHandle& handle) {
+  if (handle.type >= MaxEventTypes)
+    return false;
+  auto* channel = _channels[handle.type].load(std::memory_order_acquire);
+  return channel != nullptr && channel->unsubscribe(handle.handler);
+}
+
+size_t EventBus::dispatch() {
+  {
+    // handlers may publish events of a new type, which adds a channel while the channels are being dispatched
+    std::scoped_lock lock(_channelsMutex);
+    _dispatchOrder.clear();
+    for (auto& channel : _channelStorage)
+      _dispatchOrder.push_back(channel.get());
+  }
+  size_t count = 0;
+  for (auto* channel : _dispatchOrder)
+    count += channel->dispatch();
+  return count;
+}
+
+void EventBus::clear() {
+  std::scoped_lock lock(_channelsMutex);
+  for (auto& channel : _channelStorage)
+    channel->clear();
+}
+
+internal::EventChannelBase* EventBus::addChannel(uint32_t type,
+                                                 std::unique_ptr<internal::EventChannelBase> (*make)()) {
+  std::scoped_lock lock(_channelsMutex);
+  auto* channel = _channels[type].load(std::memory_order_relaxed);
+  if (channel != nullptr)
+    return channel;
+  auto& upChannel = _channelStorage.emplace_back(make());
+  _channels[type].store(upChannel.get(), std::memory_order_release);
+  return upChannel.get();
+}
+
+} // ams
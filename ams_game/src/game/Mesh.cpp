@@ -38,7 +38,9 @@ Mesh::Mesh(const vertices_t& vertices, const normals_t& normals, const tangents_
            const uvs_t& uv, const uvs_t& uv2, const uvs_t& uv3, const uvs_t& uv4,
            const colors_t& colors, const faces_t& faces, const submeshes_t& submeshes)
   : vertices(vertices), normals(normals), tangents(tangents), uv(uv),
-    uv2(uv2), uv3(uv3), uv4(uv4), colors(colors), faces(faces), submeshes(submeshes) {}
+    uv2(uv2), uv3(uv3), uv4(uv4), colors(colors), faces(faces), submeshes(submeshes) {
+  updateBounds();
+}
 
 #pragma region GetterSetters
 
@@ -48,6 +50,17 @@ const Mesh::vertices_t& Mesh::getVertices() const {
 
 void Mesh::setVertices(const vertices_t& vertices) {
   this->vertices = vertices;
+  updateBounds();
+}
+
+const AABB& Mesh::getBounds() const {
+  return bounds;
+}
+
+void Mesh::updateBounds() {
+  bounds = {};
+  for (auto& vertex : vertices)
+    bounds.expand(vertex);
 }
 
 const Mesh::normals_t& Mesh::getNormals() const {
@@ -199,7 +212,8 @@ void Mesh::saveToFile(const Mesh& mesh, const std::filesystem::path& path, bool
   // write header
   file << ams_file_header << std::endl;
   file << "version " << ams_file_version << std::endl;
-  file << (binary ? "binary" : "ascii") << std::endl;
+  // binary data is stored in the precision of decimal_t
+  file << (binary ? (sizeof(decimal_t) == sizeof(float) ? "binary32" : "binary") : "ascii") << std::endl;
   file << "vertex_count "   << mesh.getVertexCount() << std::endl;
   file << "normal_count "   << mesh.getNormalCount() << std::endl;
   file << "tangent_count "  << mesh.getTangentCount() << std::endl;
@@ -34,6 +34,32 @@ import ams.game.Util;
 
 namespace ams {
 
+namespace {
+
+/**
+ * Reads the binary elements of an attribute. Files written with a different decimal_t (see AMS_DECIMAL_FLOAT) store
+ * decimalSize bytes per component, and are converted to the precision of this build.
+ */
+template<typename TElem>
+void readDecimals(std::ifstream& file, std::vector<TElem>& out, size_t decimalSize) {
+  constexpr size_t components = sizeof(TElem) / sizeof(decimal_t);
+  auto* dst = reinterpret_cast<decimal_t*>(out.data());
+  auto convert = [&]<typename TFile>(TFile) {
+    std::vector<TFile> values(out.size() * components);
+    file.read(reinterpret_cast<char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(TFile)));
+    for (size_t i = 0; i < values.size(); ++i)
+      dst[i] = static_cast<decimal_t>(values[i]);
+  };
+  if (decimalSize == sizeof(decimal_t))
+    file.read(reinterpret_cast<char*>(dst), static_cast<std::streamsize>(out.size() * sizeof(TElem)));
+  else if (decimalSize == sizeof(float))
+    convert(float{});
+  else
+    convert(double{});
+}
+
+} // namespace
+
 const std::string AMSMeshLoader::filetype() const {
   return "ams";
 }
@@ -64,7 +90,9 @@ Mesh AMSMeshLoader::load(const std::filesystem::path& path) const {
 // ascii or binary
     std::string format;
     std::getline(file, format);
-    bool binary = format == "binary";
+    // "binary" files store doubles, "binary32" files store floats
+    bool binary = format.starts_with("binary");
+    size_t decimalSize = format == "binary32" ? sizeof(float) : sizeof(double);
 // get vertex count
     std::string vertexCountStr;
     std::getline(file, vertexCountStr);
@@ -117,7 +145,7 @@ Mesh AMSMeshLoader::load(const std::filesystem::path& path) const {
           return fail("vertex_count > 0 but vertices not found");
       vertices.resize(vertexCount);
       if (binary) {
-        file.read(reinterpret_cast<char*>(vertices.data()), vertexCount * sizeof(Mesh::vertex_elem_t));
+        readDecimals(file, vertices, decimalSize);
       } else {
         for (Mesh::index_t i = 0; i < vertexCount; ++i) {
           file >> vertices[i].x >> vertices[i].y >> vertices[i].z;
@@ -136,7 +164,7 @@ Mesh AMSMeshLoader::load(const std::filesystem::path& path) const {
           return fail("normal_count > 0 but normals not found");
       normals.resize(normalCount);
       if (binary) {
-        file.read(reinterpret_cast<char*>(normals.data()), normalCount * sizeof(Mesh::normal_elem_t));
+        readDecimals(file, normals, decimalSize);
       } else {
         for (Mesh::index_t i = 0; i < normalCount; ++i) {
           file >> normals[i].x >> normals[i].y >> normals[i].z;
@@ -155,7 +183,7 @@ Mesh AMSMeshLoader::load(const std::filesystem::path& path) const {
           return fail("tangent_count > 0 but tangents not found");
       tangents.resize(tangentCount);
       if (binary) {
-        file.read(reinterpret_cast<char*>(tangents.data()), tangentCount * sizeof(Mesh::tangent_elem_t));
+        readDecimals(file, tangents, decimalSize);
       } else {
         for (Mesh::index_t i = 0; i < tangentCount; ++i) {
           file >> tangents[i].x >> tangents[i].y >> tangents[i].z;
@@ -174,7 +202,7 @@ Mesh AMSMeshLoader::load(const std::filesystem::path& path) const {
           return fail("uv_count > 0 but uv not found");
       uvs.resize(uvCount);
       if (binary) {
-        file.read(reinterpret_cast<char*>(uvs.data()), uvCount * sizeof(Mesh::uv_elem_t));
+        readDecimals(file, uvs, decimalSize);
       } else {
         for (Mesh::index_t i = 0; i < uvCount; ++i) {
           file >> uvs[i].x >> uvs[i].y;
@@ -193,7 +221,7 @@ Mesh AMSMeshLoader::load(const std::filesystem::path& path) const {
           return fail("uv2_count > 0 but uv2 not found");
       uv2s.resize(uv2Count);
       if (binary) {
-        file.read(reinterpret_cast<char*>(uv2s.data()), uv2Count * sizeof(Mesh::uv_elem_t));
+        readDecimals(file, uv2s, decimalSize);
       } else {
         for (Mesh::index_t i = 0; i < uv2Count; ++i) {
           file >> uv2s[i].x >> uv2s[i].y;
@@ -212,7 +240,7 @@ Mesh AMSMeshLoader::load(const std::filesystem::path& path) const {
           return fail("uv3_count > 0 but uv3 not found");
       uv3s.resize(uv3Count);
       if (binary) {
-        file.read(reinterpret_cast<char*>(uv3s.data()), uv3Count * sizeof(Mesh::uv_elem_t));
+        readDecimals(file, uv3s, decimalSize);
       } else {
         for (Mesh::index_t i = 0; i < uv3Count; ++i) {
           file >> uv3s[i].x >> uv3s[i].y;
@@ -231,7 +259,7 @@ Mesh AMSMeshLoader::load(const std::filesystem::path& path) const {
           return fail("uv4_count > 0 but uv4 not found");
       uv4s.resize(uv4Count);
       if (binary) {
-        file.read(reinterpret_cast<char*>(uv4s.data()), uv4Count * sizeof(Mesh::uv_elem_t));
+        readDecimals(file, uv4s, decimalSize);
       } else {
         for (Mesh::index_t i = 0; i < uv4Count; ++i) {
           file >> uv4s[i].x >> uv4s[i].y;
@@ -250,7 +278,7 @@ Mesh AMSMeshLoader::load(const std::filesystem::path& path) const {
           return fail("color_count > 0 but colors not found");
       colors.resize(colorCount);
       if (binary) {
-        file.read(reinterpret_cast<char*>(colors.data()), colorCount * sizeof(Mesh::color_elem_t));
+        readDecimals(file, colors, decimalSize);
       } else {
         for (Mesh::index_t i = 0; i < colorCount; ++i) {
           file >> colors[i].x >> colors[i].y >> colors[i].z >> colors[i].w;
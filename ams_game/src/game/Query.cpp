@@ -0,0 +1,41 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/game/Query.hpp"
+#else
+import ams.game.Query;
+#endif
+
+namespace ams::internal {
+
+QueryCache::QueryCache(std::span<const ComponentTypeId> types)
+: types(types.begin(), types.end())
+{
+  for (auto type : types)
+    mask.set(type);
+}
+
+bool QueryCache::match(Archetype* archetype) {
+  if (!archetype->getSignature().contains(mask))
+    return false;
+  archetypes.push_back(archetype);
+  for (auto type : types)
+    columns.push_back(static_cast<uint32_t>(archetype->getColumnIndex(type)));
+  return true;
+}
+
+} // ams::internal
@@ -34,10 +34,9 @@ namespace ams {
 Renderer::Renderer(Application* application) {
   _application = application;
   _scene = application->getCurrentScene();
-  _sceneChangeCallback = [this](Scene* oldScene, Scene* newScene) {
-    this->_scene = newScene;
-  };
-  _application->registerOnSceneChangeCallback(_sceneChangeCallback);
+  _sceneChangeHandle = _application->getEventBus().subscribe<SceneChangeEvent>([this](std::span<const SceneChangeEvent>) {
+    _scene = _application->getCurrentScene();
+  });
   
   #ifndef AMS_REQUIRE_OPENGL
   auto appInfo = _application->getInfo();
@@ -54,7 +53,7 @@ Renderer::Renderer(Application* application) {
 Renderer::~Renderer() {
   if (_rendererImpl)
     _rendererImpl->shutdown();
-  _application->unregisterOnSceneChangeCallback(_sceneChangeCallback);
+  _application->getEventBus().unsubscribe(_sceneChangeHandle);
 }
 
 void Renderer::render() {
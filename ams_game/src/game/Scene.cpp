@@ -23,6 +23,10 @@
 #include "ams/game/Behavior.hpp"
 #include "ams/game/Application.hpp"
 #include "ams/game/Components/MeshComponent.hpp"
+#include "ams/game/internal/Archetype.hpp"
+#include "ams/game/CommandBuffer.hpp"
+#include "ams/game/System.hpp"
+#include "ams/game/Prefab.hpp"
 
 
 #else
@@ -33,100 +37,502 @@ import ams.game.Behavior;
 import ams.game.Application;
 import ams.game.Camera;
 import ams.game.Exceptions;
+import ams.game.internal.Archetype;
+import ams.game.CommandBuffer;
+import ams.game.System;
+import ams.game.Prefab;
 #endif
+#include <algorithm>
 
 using namespace ams::internal;
 
 namespace ams {
 
+namespace {
+/** The command buffer last returned to this thread, so that repeated lookups do not lock. */
+struct CommandBufferCache {
+  const Scene* scene = nullptr;
+  uuid_t sceneId = 0;
+  CommandBuffer* buffer = nullptr;
+};
+thread_local CommandBufferCache tlsCommandBuffer{};
+
+/**
+ * Commands are applied by phase, then grouped by Entity. Adding and removing Components share a phase. Enabling a
+ * Behavior does not change the archetype of its Entity, so it has a phase of its own.
+ */
+int commandPhase(CommandBuffer::CommandType type) {
+  switch (type) {
+    case CommandBuffer::CommandType::CreateEntity: return 0;
+    case CommandBuffer::CommandType::SetEnabled: return 2;
+    case CommandBuffer::CommandType::DestroyEntity: return 3;
+    default: return 1;
+  }
+}
+} // namespace
+
 Scene::Scene(Application* app, const std::string& name)
 : Object(name), _application(app)
 {
   if constexpr (AMSExceptions)
     if (app == nullptr)
       throw NullPointerException("Application is null");
-  _entities = std::map<uint64_t, std::unique_ptr<Entity>>();
+}
+
+Scene::~Scene() {
+  for (auto& system : _systems)
+    system->onDestroy();
+  // destroy Entities while the behavior and camera registries are still alive
+  _entities.clear();
 }
 
 Entity* Scene::createEntity() {
-  auto* pEntity = new Entity(this);
-  auto upEntity = std::unique_ptr<Entity>(pEntity);
-  for (auto* behavior : upEntity->_behaviors)
-    registerBehavior(behavior);
-  _entities[upEntity->id] = std::move(upEntity);
-  return pEntity;
+  return addEntity(makeEntity());
 }
 
 Entity* Scene::createEntity(const std::string& name) {
-  auto* pEntity = new Entity(this, name);
-  auto upEntity = std::unique_ptr<Entity>(pEntity);
-  for (auto* behavior : upEntity->_behaviors)
-    registerBehavior(behavior);
-  _entities[upEntity->id] = std::move(upEntity);
-  return pEntity;
+  return addEntity(makeEntity(name));
 }
 
 Entity* Scene::createEntity(const std::string& name, Transform* parent) {
-  if constexpr (AMSExceptions)
-    if (parent == nullptr)
-      throw NullPointerException("Parent is null");
-  auto upEntity = std::unique_ptr<Entity>(new Entity(this, name, parent));
-  auto pEntity = upEntity.get();
-  _entities[upEntity->id] = std::move(upEntity);
-  for (auto* behavior : pEntity->_behaviors)
-    registerBehavior(behavior);
-  return pEntity;
+  return addEntity(parent != nullptr ? makeEntity(name, parent) : makeEntity(name));
 }
 
 Entity* Scene::createEntity(const std::string& name, EntityCfg cfg, Transform* parent) {
-  auto pEntity = createEntity(name, parent);
+  auto* pEntity = createEntity(name, parent);
   autoConfigureEntity(pEntity, cfg);
   return pEntity;
 }
 
+Entity* Scene::addEntity(PoolPtr<Entity> upEntity) {
+  auto* pEntity = upEntity.get();
+  pEntity->_handle = _entities.insert(std::move(upEntity));
+  addToArchetype(pEntity);
+  if (_spatialIndexEnabled)
+    _spatialIndex.add({&pEntity, 1});
+  return pEntity;
+}
+
+std::vector<Entity*> Scene::instantiate(const Prefab& prefab, size_t count, const Delegate<void(Entity*, size_t)>& init) {
+  if (_dispatching)
+    return throwOrDefault<std::logic_error, std::vector<Entity*>>(
+      "A Prefab can not be instantiated while the Scene is updating", {});
+  std::vector<Entity*> entities;
+  entities.reserve(count);
+  if (count == 0)
+    return entities;
+  std::vector<EntityHandle> handles;
+  handles.reserve(count);
+  
+  // grow every store once instead of once per Entity
+  _entityPool.reserve(count);
+  _entities.reserve(_entities.size() + count);
+  getComponentPool(ComponentType<Transform>::id(), sizeof(Transform), alignof(Transform)).reserve(count);
+  std::vector<PoolAllocator*> pools;
+  pools.reserve(prefab._components.size());
+  size_t behaviorCount = 0;
+  for (auto& entry : prefab._components) {
+    auto& pool = getComponentPool(entry.id(), entry.size, entry.align);
+    pool.reserve(count);
+    pools.push_back(&pool);
+    if (entry.hooks != nullptr) {
+      behaviorCount += count;
+      _updateList.reserve(entry.hooks, count);
+      _fixedUpdateList.reserve(entry.hooks, count);
+      _lateUpdateList.reserve(entry.hooks, count);
+    }
+  }
+  std::vector<Behavior*> behaviors;
+  behaviors.reserve(behaviorCount);
+  Archetype* archetype = nullptr;
+  
+  for (size_t i = 0; i < count; ++i) {
+    auto upEntity = prefab._name.empty() ? makeEntity() : makeEntity(prefab._name);
+    auto* pEntity = upEntity.get();
+    auto* transform = pEntity->_transform;
+    transform->setPosition(prefab._position);
+    transform->setRotation(prefab._rotation);
+    transform->setScale(prefab._scale);
+    for (size_t c = 0; c < prefab._components.size(); ++c) {
+      auto& entry = prefab._components[c];
+      auto* component = entry.add(pEntity, *pools[c]);
+      if (entry.load != nullptr)
+        entry.load(component, prefab._states.data() + entry.stateOffset);
+    }
+    // every instance has the prefab's signature until init runs
+    if (archetype == nullptr) {
+      archetype = getArchetype(pEntity->_mask);
+      archetype->reserve(archetype->size() + count);
+    }
+    // init sees a complete Entity, so the Components it adds are placed and registered like any other
+    placeInArchetype(pEntity, archetype);
+    pEntity->_handle = _entities.insert(std::move(upEntity));
+    handles.push_back(pEntity->_handle);
+    if (init)
+      init(pEntity, i);
+  }
+  // init may destroy any instance created so far, which are then skipped
+  for (auto handle : handles) {
+    auto* pEntity = getEntity(handle);
+    if (pEntity == nullptr)
+      continue;
+    for (auto* behavior : pEntity->_behaviors)
+      behaviors.push_back(behavior);
+    entities.push_back(pEntity);
+  }
+  if (_spatialIndexEnabled)
+    _spatialIndex.add(entities);
+  
+  // Behaviors which init added were registered by addComponent()
+  std::erase_if(behaviors, [this](Behavior* behavior) {
+    return _behaviors.contains(behavior->_sceneHandle);
+  });
+  _behaviors.reserve(_behaviors.size() + behaviors.size());
+  for (auto* behavior : behaviors) {
+    behavior->_sceneHandle = _behaviors.insert(behavior);
+    _updateList.add(behavior);
+    _fixedUpdateList.add(behavior);
+    _lateUpdateList.add(behavior);
+  }
+  // disabled Behaviors stay in the disabled range, and start when they are first enabled
+  std::erase_if(behaviors, [](Behavior* behavior) { return !behavior->isEnabled(); });
+  for (auto* behavior : behaviors) {
+    behavior->_active = true;
+    _updateList.setEnabled(behavior, true);
+    _fixedUpdateList.setEnabled(behavior, true);
+    _lateUpdateList.setEnabled(behavior, true);
+  }
+  for (auto* behavior : behaviors)
+    behavior->onEnable();
+  for (auto* behavior : behaviors) {
+    behavior->_started = true;
+    behavior->onStart();
+  }
+  return entities;
+}
+
 bool Scene::destroyEntity(Entity* entity) {
   if constexpr (AMSExceptions)
     if (entity == nullptr)
       throw NullPointerException("Entity is null");
-  if (_entities.find(entity->id) != _entities.end()) {
-    for (auto* behavior : entity->_behaviors)
-      unregisterBehavior(behavior);
-    _entities.erase(entity->id);
+  if (getEntity(entity->_handle) != entity)
+    return false;
+  if (_dispatching) {
+    getCommandBuffer().destroyEntity(entity->_handle);
     return true;
   }
-  return false;
+  for (auto* behavior : entity->_behaviors)
+    unregisterBehavior(behavior);
+  if (_spatialIndexEnabled)
+    _spatialIndex.remove(entity->_handle);
+  // the Entity destroys the components in its row, then frees the row
+  _entities.erase(entity->_handle);
+  return true;
+}
+
+bool Scene::destroyEntity(EntityHandle handle) {
+  auto* pEntity = getEntity(handle);
+  return pEntity != nullptr && destroyEntity(pEntity);
+}
+
+Entity* Scene::getEntity(EntityHandle handle) const {
+  auto* upEntity = _entities.get(handle);
+  return upEntity != nullptr ? upEntity->get() : nullptr;
+}
+
+bool Scene::isValid(EntityHandle handle) const {
+  return _entities.contains(handle);
 }
 
 void Scene::onEnter() {
-  for (auto& [id, behavior] : _behaviors)
-    behavior->onEnable();
+  for (auto* behavior : _behaviors)
+    if (behavior->_active)
+      behavior->onEnable();
 }
 
 void Scene::onExit() {
-  _frameIsValid.store(false);
-  for (auto& [id, behavior] : _behaviors)
-    behavior->onDisable();
+  disableBehaviors();
+  unload();
+}
+
+void Scene::disableBehaviors() {
+  for (auto* behavior : _behaviors)
+    if (behavior->_active)
+      behavior->onDisable();
+}
+
+void Scene::unload() {
+  {
+    // pending commands would target Entities which no longer exist
+    std::lock_guard lock(_commandBuffersMutex);
+    for (auto& [thread, buffer] : _commandBuffers)
+      buffer->clear();
+  }
+  // drop the registries in bulk, so that destroying the Entities does not unregister their Components one by one
+  _updateList.clear();
+  _fixedUpdateList.clear();
+  _lateUpdateList.clear();
+  _behaviors.clear();
+  _cameras.clear();
+  _spatialIndex.clear();
+  _transformHierarchy.clear();
   _entities.clear();
+  for (auto& [signature, archetype] : _archetypes)
+    archetype->clear();
+  // every block is free again, so the storage is returned at once
+  for (auto& pool : _componentPools) {
+    if (pool != nullptr)
+      pool->release();
+  }
+  _entityPool.release();
+  _metadata.release();
+  _arena.release();
+}
+
+void Scene::onFixedUpdate() {
+  _dispatching = true;
+  if (_parallelUpdate)
+    dispatchParallel(_fixedUpdateList);
+  else
+    dispatch(_fixedUpdateList);
+  runSystems(SystemPhase::FixedUpdate);
+  _dispatching = false;
 }
 
 void Scene::onUpdate() {
-  _frameIsValid = true;
+  _dispatching = true;
+  if (_parallelUpdate)
+    dispatchParallel(_updateList);
+  else
+    dispatch(_updateList);
+  runSystems(SystemPhase::Update);
+  _dispatching = false;
+}
+
+void Scene::onRender() {
+  _dispatching = true;
+  dispatch(_lateUpdateList);
+  runSystems(SystemPhase::Render);
+  _dispatching = false;
+}
+
+void Scene::runSystems(SystemPhase phase) {
+  auto& scheduler = _systemSchedulers[static_cast<size_t>(phase)];
+  if (!scheduler.empty())
+    scheduler.run(JobSystem::getInstance());
+}
+
+std::span<System* const> Scene::getSystems(SystemPhase phase) {
+  return _systemSchedulers[static_cast<size_t>(phase)].getOrder();
+}
+
+bool Scene::removeSystem(System* system) {
+  if (system == nullptr)
+    return false;
+  if (_dispatching)
+    return throwOrDefault<std::logic_error, bool>("Systems can not be removed while the Scene is updating", false);
+  _systemSchedulers[static_cast<size_t>(system->_phase)].remove(system);
+  system->onDestroy();
+  std::erase_if(_systems, [system](auto& s) { return s.get() == system; });
+  return true;
+}
+
+void Scene::dispatch(BehaviorDispatchList& list) {
+  // index based, since behaviors and groups may be added while dispatching. Only the enabled range is visited.
+  auto& groups = list.getGroups();
+  for (size_t g = 0; g < groups.size(); ++g) {
+    auto invoker = groups[g].invoker;
+    for (size_t i = 0; i < groups[g].enabled; ++i)
+      invoker(groups[g].behaviors[i]);
+  }
+}
+
+void Scene::dispatchParallel(BehaviorDispatchList& list) {
+  constexpr size_t grainSize = 256;
+  auto& jobs = JobSystem::getInstance();
+  auto& groups = list.getGroups();
+  // first-fit packing of groups into batches without conflicting accesses. Within a group every Behavior only
+  // touches its own Entity, so a whole group fits in one batch.
+  for (auto& batch : _parallelBatches)
+    batch.groups.clear();
+  size_t batchCount = 0;
+  for (auto& group : groups) {
+    if (!group.hooks->concurrent || group.enabled == 0)
+      continue;
+    size_t b = 0;
+    for (; b < batchCount; ++b) {
+      auto& batch = _parallelBatches[b];
+      if (!accessConflicts(batch.reads, batch.writes, group.hooks->reads, group.hooks->writes))
+        break;
+    }
+    if (b == batchCount) {
+      if (batchCount == _parallelBatches.size())
+        _parallelBatches.emplace_back();
+      _parallelBatches[b].reads = {};
+      _parallelBatches[b].writes = {};
+      ++batchCount;
+    }
+    auto& batch = _parallelBatches[b];
+    batch.reads = batch.reads | group.hooks->reads;
+    batch.writes = batch.writes | group.hooks->writes;
+    batch.groups.push_back(&group);
+  }
   
-  for (auto& [id, behavior] : _behaviors) {
-    behavior->onUpdate();
-    if (!_frameIsValid) // something is requesting to stop the frame
-      break;
+  for (size_t b = 0; b < batchCount; ++b) {
+    _parallelJobs.clear();
+    for (auto* group : _parallelBatches[b].groups) {
+      _parallelJobs.push_back(jobs.parallelFor(group->enabled, grainSize, [group](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+          group->invoker(group->behaviors[i]);
+      }));
+    }
+    jobs.waitAll(_parallelJobs);
+  }
+  
+  // the remaining groups may touch anything, so they run here
+  for (size_t g = 0; g < groups.size(); ++g) {
+    if (groups[g].hooks->concurrent)
+      continue;
+    auto invoker = groups[g].invoker;
+    for (size_t i = 0; i < groups[g].enabled; ++i)
+      invoker(groups[g].behaviors[i]);
   }
+}
 
-  _frameIsValid = false;
+CommandBuffer& Scene::getCommandBuffer() {
+  auto& cache = tlsCommandBuffer;
+  if (cache.scene == this && cache.sceneId == id)
+    return *cache.buffer;
+  std::lock_guard lock(_commandBuffersMutex);
+  auto& buffer = _commandBuffers[std::this_thread::get_id()];
+  if (buffer == nullptr)
+    buffer = std::make_unique<CommandBuffer>();
+  cache = {this, id, buffer.get()};
+  return *buffer;
 }
 
-void Scene::onRender() {
-  for (auto& [id, behavior] : _behaviors) {
-    behavior->onLateUpdate();
-    if (!_frameIsValid) // something is requesting to stop the frame
-      break;
+void Scene::flushCommands() {
+  using Command = CommandBuffer::Command;
+  {
+    // take the commands out of the buffers, so that commands recorded while flushing wait for the next flush
+    std::lock_guard lock(_commandBuffersMutex);
+    for (auto& [thread, buffer] : _commandBuffers) {
+      if (_flushQueue.empty()) {
+        std::swap(_flushQueue, buffer->_commands);
+      } else {
+        std::move(buffer->_commands.begin(), buffer->_commands.end(), std::back_inserter(_flushQueue));
+        buffer->_commands.clear();
+      }
+    }
+  }
+  if (_flushQueue.empty())
+    return;
+  
+  // order by phase, then by Entity. The sort is stable so each Entity's changes keep the order they were recorded in.
+  std::stable_sort(_flushQueue.begin(), _flushQueue.end(), [](const Command& a, const Command& b) {
+    auto phaseA = commandPhase(a.type), phaseB = commandPhase(b.type);
+    if (phaseA != phaseB)
+      return phaseA < phaseB;
+    return phaseA != 0 && a.entity < b.entity;
+  });
+  auto changesBegin = std::find_if(_flushQueue.begin(), _flushQueue.end(), [](const Command& command) {
+    return commandPhase(command.type) != 0;
+  });
+  auto enablesBegin = std::find_if(changesBegin, _flushQueue.end(), [](const Command& command) {
+    return commandPhase(command.type) > 1;
+  });
+  auto destroysBegin = std::find_if(enablesBegin, _flushQueue.end(), [](const Command& command) {
+    return command.type == CommandBuffer::CommandType::DestroyEntity;
+  });
+  auto isDestroyed = [&](EntityHandle handle) {
+    auto it = std::lower_bound(destroysBegin, _flushQueue.end(), handle, [](const Command& command, EntityHandle h) {
+      return command.entity < h;
+    });
+    return it != _flushQueue.end() && it->entity == handle;
+  };
+  
+  _entities.reserve(_entities.size() + static_cast<size_t>(changesBegin - _flushQueue.begin()));
+  for (auto it = _flushQueue.begin(); it != changesBegin; ++it) {
+    auto* pEntity = createEntity();
+    pEntity->setName(std::move(it->name));
+    if (it->apply)
+      it->apply(pEntity);
   }
+  
+  // the Entity leaves its archetype while its changes are applied, and joins its final archetype once
+  for (auto it = changesBegin; it != enablesBegin;) {
+    auto handle = it->entity;
+    auto last = std::find_if(it, enablesBegin, [&](const Command& command) { return command.entity != handle; });
+    auto* pEntity = getEntity(handle);
+    if (pEntity != nullptr && !isDestroyed(handle)) {
+      removeFromArchetype(pEntity);
+      // a command may destroy the Entity, e.g. from the onStart of an added Behavior
+      for (; it != last && getEntity(handle) == pEntity; ++it)
+        it->apply(pEntity);
+      if (getEntity(handle) == pEntity)
+        addToArchetype(pEntity);
+    }
+    it = last;
+  }
+  
+  // the Entity keeps its archetype, and its Components stay where they are
+  for (auto it = enablesBegin; it != destroysBegin; ++it) {
+    auto* pEntity = getEntity(it->entity);
+    if (pEntity != nullptr && !isDestroyed(it->entity))
+      it->apply(pEntity);
+  }
+  
+  for (auto it = destroysBegin; it != _flushQueue.end(); ++it) {
+    if (it == destroysBegin || (it - 1)->entity != it->entity)
+      destroyEntity(it->entity);
+  }
+  _flushQueue.clear();
+}
+
+void Scene::updateTransforms() {
+  _transformHierarchy.update();
+  if (_spatialIndexEnabled)
+    _spatialIndex.update(_transformHierarchy);
+}
+
+std::span<const Matrix4> Scene::getWorldMatrices() const {
+  return _transformHierarchy.getWorldMatrices();
+}
+
+void Scene::storeTransformStates() {
+  _transformHierarchy.storeStates();
+}
+
+void Scene::interpolateTransforms(decimal_t alpha) {
+  _transformHierarchy.update();
+  _transformHierarchy.interpolate(alpha);
+}
+
+std::span<const Matrix4> Scene::getInterpolatedWorldMatrices() const {
+  return _transformHierarchy.getInterpolatedWorldMatrices();
+}
+
+void Scene::setParallelUpdate(bool parallel) {
+  _parallelUpdate = parallel;
+}
+
+bool Scene::isParallelUpdate() const {
+  return _parallelUpdate;
+}
+
+void Scene::setSpatialIndexEnabled(bool enabled) {
+  if (enabled == _spatialIndexEnabled)
+    return;
+  _spatialIndexEnabled = enabled;
+  _transformHierarchy.setTrackChanges(enabled);
+  if (!enabled)
+    _spatialIndex.clear();
+  else if (!_dispatching)
+    updateTransforms();
+}
+
+bool Scene::isSpatialIndexEnabled() const {
+  return _spatialIndexEnabled;
 }
 
 bool Scene::registerBehavior(Behavior* behavior) {
@@ -135,17 +541,14 @@ bool Scene::registerBehavior(Behavior* behavior) {
       throw NullPointerException("Behavior is null");
     return false;
   }
-  if (!behavior->isEnabled())
+  if (_behaviors.contains(behavior->_sceneHandle))
     return false;
-  auto eid = behavior->getEntity()->getId();
-  auto bid = behavior->getId();
-  if (_behaviors.find(bid) != _behaviors.end())
-    return false;
-  _behaviors[bid] = behavior;
-  auto behaviors = std::vector<Behavior*>();
-  behaviors.push_back(behavior);
-  behavior->onEnable();
-  behavior->onStart();
+  behavior->_sceneHandle = _behaviors.insert(behavior);
+  _updateList.add(behavior);
+  _fixedUpdateList.add(behavior);
+  _lateUpdateList.add(behavior);
+  if (behavior->isEnabled())
+    setBehaviorActive(behavior, true);
   return true;
 }
 
@@ -153,27 +556,68 @@ bool Scene::unregisterBehavior(Behavior* behavior) {
   if constexpr (AMSExceptions)
     if (behavior == nullptr)
       throw NullPointerException("Behavior is null");
-  auto bid = behavior->getId();
-  if (_behaviors.find(bid) == _behaviors.end())
+  if (!_behaviors.contains(behavior->_sceneHandle))
     return false;
-  behavior->onDisable();
-  _behaviors.erase(bid);
+  if (behavior->_active) {
+    behavior->_active = false;
+    behavior->onDisable();
+  }
+  _updateList.remove(behavior);
+  _fixedUpdateList.remove(behavior);
+  _lateUpdateList.remove(behavior);
+  _behaviors.erase(behavior->_sceneHandle);
   return true;
 }
 
+void Scene::updateBehaviorState(Behavior* behavior) {
+  if (!_behaviors.contains(behavior->_sceneHandle) || behavior->_active == behavior->isEnabled())
+    return;
+  if (!_dispatching) {
+    setBehaviorActive(behavior, behavior->isEnabled());
+    return;
+  }
+  // toggling it back before the flush makes the command a no-op, so only the final state fires an event
+  getCommandBuffer()._commands.push_back({CommandBuffer::CommandType::SetEnabled, behavior->getEntity()->_handle,
+    [this, behavior](Entity* pEntity) {
+      // the Behavior may have been removed by an earlier command of the batch
+      if (std::find(pEntity->_behaviors.begin(), pEntity->_behaviors.end(), behavior) != pEntity->_behaviors.end())
+        setBehaviorActive(behavior, behavior->isEnabled());
+    }});
+}
+
+void Scene::setBehaviorActive(Behavior* behavior, bool active) {
+  if (behavior->_active == active)
+    return;
+  behavior->_active = active;
+  _updateList.setEnabled(behavior, active);
+  _fixedUpdateList.setEnabled(behavior, active);
+  _lateUpdateList.setEnabled(behavior, active);
+  if (!active) {
+    behavior->onDisable();
+    return;
+  }
+  behavior->onEnable();
+  if (!behavior->_started) {
+    behavior->_started = true;
+    behavior->onStart();
+  }
+}
+
 bool Scene::registerCamera(Camera* camera) {
   if constexpr(AMSExceptions) {
     if (camera == nullptr)
       throw NullPointerException("Camera is null");
   }
   auto* entity = camera->getEntity();
-  if (_entities.find(entity->id) == _entities.end()) {
+  if (getEntity(entity->_handle) != entity) {
     if constexpr (AMSExceptions)
       throw std::runtime_error("Camera is not attached to a valid entity");
     return false;
   }
-  EntityCam cam {entity, entity->getTransform(), camera};
-  return _cameras.try_emplace(entity->getId(), cam).second;
+  if (_cameras.contains(camera->_sceneHandle))
+    return false;
+  camera->_sceneHandle = _cameras.insert({entity, entity->getTransform(), camera});
+  return true;
 }
 
 bool Scene::unregisterCamera(Camera* camera) {
@@ -181,7 +625,7 @@ bool Scene::unregisterCamera(Camera* camera) {
     if (camera == nullptr)
       throw NullPointerException("Camera is null");
   }
-  return _cameras.erase(camera->getEntity()->getId()) > 0;
+  return _cameras.erase(camera->_sceneHandle);
 }
 
 Application* Scene::getApplication() const {
@@ -189,26 +633,186 @@ Application* Scene::getApplication() const {
 }
 
 std::vector<Scene::EntityCam> Scene::getCameras() const {
-  auto cameras = std::vector<EntityCam>();
-  for (auto& [id, cam] : _cameras)
-    cameras.push_back(cam);
-  return cameras;
+  return {_cameras.begin(), _cameras.end()};
 }
 
 std::vector<Behavior*> Scene::getBehaviors() const {
-  auto behaviors = std::vector<Behavior*>();
-  for (auto& [id, behavior] : _behaviors)
-    behaviors.push_back(behavior);
-  return behaviors;
+  return {_behaviors.begin(), _behaviors.end()};
 }
 
 std::vector<Entity*> Scene::getEntities() const {
   auto entities = std::vector<Entity*>();
-  for (auto& [id, entity] : _entities)
+  entities.reserve(_entities.size());
+  for (auto& entity : _entities)
     entities.push_back(entity.get());
   return entities;
 }
 
+void Scene::reserveEntities(size_t count) {
+  _entityPool.reserve(count);
+  _entities.reserve(_entities.size() + count);
+  getComponentPool(ComponentType<Transform>::id(), sizeof(Transform), alignof(Transform)).reserve(count);
+}
+
+Entity* Scene::createUnplacedEntity(const std::string& name, Transform* parent) {
+  auto upEntity = parent != nullptr ? makeEntity(name, parent) : makeEntity(name);
+  auto* pEntity = upEntity.get();
+  pEntity->_handle = _entities.insert(std::move(upEntity));
+  return pEntity;
+}
+
+void Scene::placeEntities(std::span<Entity* const> entities) {
+  std::map<ArchetypeSignature, size_t> counts;
+  for (auto* entity : entities)
+    ++counts[entity->_mask];
+  for (auto& [signature, count] : counts) {
+    auto* archetype = getArchetype(signature);
+    archetype->reserve(archetype->size() + count);
+  }
+  Archetype* archetype = nullptr;
+  for (auto* entity : entities) {
+    if (archetype == nullptr || archetype->getSignature() != entity->_mask)
+      archetype = getArchetype(entity->_mask);
+    placeInArchetype(entity, archetype);
+    for (auto* behavior : entity->_behaviors)
+      registerBehavior(behavior);
+  }
+  if (_spatialIndexEnabled)
+    _spatialIndex.add(entities);
+}
+
+template<typename... Args>
+PoolPtr<Entity> Scene::makeEntity(Args&&... args) {
+  // Entity's constructors are private, so it is not built by PoolAllocator::make()
+  auto* block = _entityPool.allocate();
+  PoolPtr<Entity> upEntity;
+  try {
+    upEntity = PoolPtr<Entity>(::new(block) Entity(this, std::forward<Args>(args)...), PoolDeleter<Entity>(&_entityPool));
+  } catch (...) {
+    _entityPool.deallocate(block);
+    throw;
+  }
+  _transformHierarchy.add(upEntity->_transform);
+  return upEntity;
+}
+
+PoolAllocator& Scene::getComponentPool(ComponentTypeId type, size_t size, size_t align) {
+  if (type >= _componentPools.size())
+    _componentPools.resize(type + 1);
+  auto& pool = _componentPools[type];
+  if (pool == nullptr)
+    pool = std::make_unique<PoolAllocator>(size, align, 64, &_arena);
+  return *pool;
+}
+
+Archetype* Scene::getArchetype(const ArchetypeSignature& signature) {
+  auto it = _archetypes.find(signature);
+  if (it != _archetypes.end())
+    return it->second.get();
+  std::vector<const ComponentStorage*> storages;
+  storages.reserve(signature.count());
+  signature.forEach([&](ComponentTypeId type) {
+    storages.push_back(type < _componentStorages.size() ? _componentStorages[type] : nullptr);
+  });
+  auto archetype = std::make_unique<Archetype>(signature, storages);
+  auto* pArchetype = archetype.get();
+  std::lock_guard lock(_queriesMutex);
+  _archetypes.emplace(signature, std::move(archetype));
+  for (auto& query : _queries)
+    query->match(pArchetype);
+  return pArchetype;
+}
+
+QueryCache& Scene::getQueryCache(std::span<const ComponentTypeId> types) {
+  std::lock_guard lock(_queriesMutex);
+  for (auto& query : _queries) {
+    if (std::ranges::equal(query->types, types))
+      return *query;
+  }
+  auto& query = _queries.emplace_back(std::make_unique<QueryCache>(types));
+  for (auto& [signature, archetype] : _archetypes)
+    query->match(archetype.get());
+  return *query;
+}
+
+void Scene::setComponentStorage(ComponentTypeId type, const ComponentStorage* storage) {
+  if (type >= _componentStorages.size())
+    _componentStorages.resize(type + 1, nullptr);
+  _componentStorages[type] = storage;
+}
+
+void Scene::addToArchetype(Entity* entity) {
+  placeInArchetype(entity, getArchetype(entity->_mask));
+}
+
+void Scene::placeInArchetype(Entity* entity, Archetype* archetype) {
+  entity->_archetype = archetype;
+  entity->_row = archetype->addRow(entity);
+  entity->_mask.forEach([&](ComponentTypeId type) { placeInRow(entity, type); });
+}
+
+void Scene::placeInRow(Entity* entity, ComponentTypeId type) {
+  auto* archetype = entity->_archetype;
+  if (archetype == nullptr)
+    return;
+  auto slot = entity->_mask.rank(type);
+  auto* component = entity->_slots[slot];
+  if (!archetype->isStoredByValue(slot)) {
+    archetype->place(entity->_row, slot, component);
+    return;
+  }
+  // the block is found before the component is relocated out of it
+  auto* block = dynamic_cast<void*>(component);
+  entity->onComponentRelocated(slot, archetype->place(entity->_row, slot, component));
+  _componentPools[type]->deallocate(block);
+}
+
+void Scene::moveToArchetype(Entity* entity, ComponentTypeId type) {
+  auto* src = entity->_archetype;
+  // Entities are placed once construction completes, or once a batch of commands has been applied
+  if (src == nullptr)
+    return;
+  auto added = entity->_mask.test(type);
+  auto& edges = added ? src->_addEdges : src->_removeEdges;
+  Archetype* dst;
+  if (auto edge = edges.find(type); edge != edges.end()) {
+    dst = edge->second;
+  } else {
+    dst = getArchetype(entity->_mask);
+    edges[type] = dst;
+    (added ? dst->_removeEdges : dst->_addEdges)[type] = src;
+  }
+  auto srcRow = entity->_row;
+  entity->_archetype = dst;
+  entity->_row = dst->addRow(entity);
+  size_t slot = 0;
+  entity->_mask.forEach([&](ComponentTypeId t) {
+    // components stored by value move from row to row, and an added one from its pool
+    if (t == type || !dst->isStoredByValue(slot))
+      placeInRow(entity, t);
+    else
+      entity->onComponentRelocated(slot, dst->place(entity->_row, slot, entity->_slots[slot]));
+    ++slot;
+  });
+  src->removeRow(srcRow);
+}
+
+void Scene::removeFromArchetype(Entity* entity) {
+  auto* archetype = entity->_archetype;
+  if (archetype == nullptr)
+    return;
+  size_t slot = 0;
+  entity->_mask.forEach([&](ComponentTypeId type) {
+    if (archetype->isStoredByValue(slot)) {
+      auto* block = _componentPools[type]->allocate();
+      entity->onComponentRelocated(slot, _componentStorages[type]->relocate(block, entity->_slots[slot]));
+    }
+    ++slot;
+  });
+  archetype->removeRow(entity->_row);
+  entity->_archetype = nullptr;
+}
+
 void Scene::autoConfigureEntity(Entity* entity, EntityCfg cfg) {
   switch(cfg) {
     case EntityCfg::Default:
@@ -0,0 +1,329 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/game/SceneSnapshot.hpp"
+#include "ams/game/Scene.hpp"
+#include "ams/game/Transform.hpp"
+#include "ams/game/Util.hpp"
+#include <ams/MappedFile.hpp>
+#else
+import ams.game.SceneSnapshot;
+import ams.game.Scene;
+import ams.game.Transform;
+import ams.game.Util;
+import ams.MappedFile;
+#endif
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace ams {
+
+namespace {
+
+constexpr char Magic[4] = {'A', 'M', 'S', 'S'};
+constexpr uint32_t ByteOrderMark = 0x01020304;
+constexpr uint32_t NoParent = std::numeric_limits<uint32_t>::max();
+
+enum class BlockKind : uint32_t {
+  Entities = 1,
+  Names = 2,
+  Transforms = 3,
+  /** The Entity indices of a component column, followed by the states of its components at a 16 byte boundary. */
+  Component = 4
+};
+
+struct Header {
+  char magic[4];
+  uint32_t byteOrder;
+  uint32_t version;
+  uint32_t blockCount;
+  uint64_t entityCount;
+  uint64_t size;
+};
+
+struct Block {
+  BlockKind kind;
+  uint32_t stride;
+  uint64_t typeHash;
+  uint64_t offset;
+  uint64_t count;
+};
+
+struct EntityRecord {
+  uint32_t nameOffset;
+  uint32_t nameLength;
+  uint32_t parent;
+  uint32_t reserved;
+};
+
+/** Stored as double whatever decimal_t is, so that snapshots do not depend on the build. */
+struct TransformRecord {
+  double position[3];
+  double rotation[4];
+  double scale[3];
+};
+
+static_assert(sizeof(Header) == 32 && sizeof(Block) == 32 && sizeof(EntityRecord) == 16);
+
+constexpr size_t alignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+/** Gets the offset of the states of a component column from the offset of the column. */
+constexpr size_t statesOffset(size_t offset, size_t count) {
+  return alignUp(offset + count * sizeof(uint32_t), 16);
+}
+
+template<typename T>
+T readAt(const std::byte* data, size_t offset) {
+  T value;
+  std::memcpy(&value, data + offset, sizeof(T));
+  return value;
+}
+
+} // namespace
+
+std::map<uint64_t, SceneSnapshot::ComponentEntry>& SceneSnapshot::getRegistry() {
+  static std::map<uint64_t, SceneSnapshot::ComponentEntry> registry;
+  return registry;
+}
+
+void SceneSnapshot::registerComponent(uint64_t hash, const ComponentEntry& entry) {
+  getRegistry()[hash] = entry;
+}
+
+std::vector<std::byte> SceneSnapshot::capture(Scene& scene) {
+  scene.updateTransforms();
+  auto transforms = scene._transformHierarchy.getTransforms();
+  auto entityCount = transforms.size();
+  
+  std::unordered_map<const Entity*, uint32_t> indices;
+  indices.reserve(entityCount);
+  std::vector<EntityRecord> entities(entityCount);
+  std::vector<TransformRecord> transformRecords(entityCount);
+  std::string names;
+  for (size_t i = 0; i < entityCount; ++i) {
+    auto* transform = transforms[i];
+    auto* entity = transform->getEntity();
+    indices.emplace(entity, static_cast<uint32_t>(i));
+    auto& name = entity->getName();
+    auto* parent = transform->getParent();
+    // parents come first in depth first order
+    entities[i] = {static_cast<uint32_t>(names.size()), static_cast<uint32_t>(name.size()),
+                   parent != nullptr ? indices.at(parent->getEntity()) : NoParent, 0};
+    names += name;
+    auto& p = transform->getPosition();
+    auto& r = transform->getRotation();
+    auto& s = transform->getScale();
+    transformRecords[i] = {{p.x, p.y, p.z}, {r.x, r.y, r.z, r.w}, {s.x, s.y, s.z}};
+  }
+  
+  struct Column {
+    uint64_t hash;
+    const ComponentEntry* entry;
+    std::vector<uint32_t> entities;
+    std::vector<const Component*> components;
+  };
+  std::vector<Column> columns;
+  for (auto& [hash, entry] : getRegistry()) {
+    Column column{hash, &entry, {}, {}};
+    auto type = entry.id();
+    for (auto& [signature, archetype] : scene._archetypes) {
+      auto col = archetype->getColumnIndex(type);
+      if (col < 0)
+        continue;
+      auto rowEntities = archetype->getEntities();
+      for (size_t row = 0; row < rowEntities.size(); ++row) {
+        if (rowEntities[row] == nullptr)
+          continue;
+        column.entities.push_back(indices.at(rowEntities[row]));
+        column.components.push_back(archetype->at(row, static_cast<size_t>(col)));
+      }
+    }
+    if (!column.entities.empty())
+      columns.push_back(std::move(column));
+  }
+  
+  // lay the blocks out
+  std::vector<Block> blocks;
+  blocks.reserve(3 + columns.size());
+  size_t offset = alignUp(sizeof(Header) + (3 + columns.size()) * sizeof(Block), BlockAlignment);
+  auto addBlock = [&](BlockKind kind, uint32_t stride, uint64_t hash, size_t count, size_t size) {
+    blocks.push_back({kind, stride, hash, offset, count});
+    offset = alignUp(offset + size, BlockAlignment);
+  };
+  addBlock(BlockKind::Entities, sizeof(EntityRecord), 0, entityCount, entityCount * sizeof(EntityRecord));
+  addBlock(BlockKind::Names, 1, 0, names.size(), names.size());
+  addBlock(BlockKind::Transforms, sizeof(TransformRecord), 0, entityCount, entityCount * sizeof(TransformRecord));
+  for (auto& column : columns) {
+    auto count = column.entities.size();
+    auto size = statesOffset(offset, count) - offset + count * column.entry->stateSize;
+    addBlock(BlockKind::Component, column.entry->stateSize, column.hash, count, size);
+  }
+  
+  std::vector<std::byte> snapshot(offset);
+  auto* data = snapshot.data();
+  Header header{{Magic[0], Magic[1], Magic[2], Magic[3]}, ByteOrderMark, Version, static_cast<uint32_t>(blocks.size()),
+                entityCount, snapshot.size()};
+  std::memcpy(data, &header, sizeof(Header));
+  std::memcpy(data + sizeof(Header), blocks.data(), blocks.size() * sizeof(Block));
+  std::memcpy(data + blocks[0].offset, entities.data(), entities.size() * sizeof(EntityRecord));
+  std::memcpy(data + blocks[1].offset, names.data(), names.size());
+  std::memcpy(data + blocks[2].offset, transformRecords.data(), transformRecords.size() * sizeof(TransformRecord));
+  for (size_t c = 0; c < columns.size(); ++c) {
+    auto& block = blocks[3 + c];
+    auto& column = columns[c];
+    std::memcpy(data + block.offset, column.entities.data(), column.entities.size() * sizeof(uint32_t));
+    auto* states = data + statesOffset(block.offset, block.count);
+    for (size_t i = 0; i < column.components.size(); ++i)
+      column.entry->save(column.components[i], states + i * block.stride);
+  }
+  return snapshot;
+}
+
+size_t SceneSnapshot::restore(Scene& scene, std::span<const std::byte> snapshot) {
+  if (scene._dispatching)
+    return throwOrDefault<std::logic_error, size_t>("A snapshot can not be restored while the Scene is updating", 0);
+  auto invalid = [](const char* reason) {
+    return throwOrDefault<std::runtime_error, size_t>(std::string("Invalid scene snapshot: ") + reason, 0);
+  };
+  auto* data = snapshot.data();
+  if (snapshot.size() < sizeof(Header))
+    return invalid("too small");
+  auto header = readAt<Header>(data, 0);
+  if (std::memcmp(header.magic, Magic, sizeof(Magic)) != 0)
+    return invalid("not a snapshot");
+  if (header.byteOrder != ByteOrderMark)
+    return invalid("captured with another byte order");
+  if (header.version != Version)
+    return invalid("unsupported version");
+  if (header.size > snapshot.size() || header.size < sizeof(Header) ||
+      header.blockCount > (header.size - sizeof(Header)) / sizeof(Block))
+    return invalid("truncated");
+  
+  // check every block before creating anything. Sizes are compared by division, so that corrupt counts can not
+  // overflow the checks.
+  auto fits = [size = header.size](uint64_t offset, uint64_t count, uint64_t recordSize) {
+    return offset <= size && (recordSize == 0 || count <= (size - offset) / recordSize);
+  };
+  const Block* entityBlock = nullptr;
+  const Block* nameBlock = nullptr;
+  const Block* transformBlock = nullptr;
+  std::vector<Block> blocks(header.blockCount);
+  std::memcpy(blocks.data(), data + sizeof(Header), blocks.size() * sizeof(Block));
+  for (auto& block : blocks) {
+    bool inBounds;
+    switch (block.kind) {
+      case BlockKind::Entities:
+        entityBlock = &block;
+        inBounds = fits(block.offset, block.count, sizeof(EntityRecord));
+        break;
+      case BlockKind::Names:
+        nameBlock = &block;
+        inBounds = fits(block.offset, block.count, 1);
+        break;
+      case BlockKind::Transforms:
+        transformBlock = &block;
+        inBounds = fits(block.offset, block.count, sizeof(TransformRecord));
+        break;
+      case BlockKind::Component:
+        // the states offset can only be computed once the entity indices are known to fit
+        inBounds = fits(block.offset, block.count, sizeof(uint32_t)) &&
+                   fits(statesOffset(block.offset, block.count), block.count, block.stride);
+        break;
+      default: return invalid("unknown block");
+    }
+    if (!inBounds)
+      return invalid("block out of bounds");
+  }
+  // the entity count is bounded by the size of the entity block, which fits in the snapshot
+  if (entityBlock == nullptr || nameBlock == nullptr || transformBlock == nullptr ||
+      entityBlock->count != header.entityCount || transformBlock->count != header.entityCount)
+    return invalid("missing entity tables");
+  for (auto& block : blocks) {
+    if (block.kind != BlockKind::Component)
+      continue;
+    for (size_t i = 0; i < block.count; ++i) {
+      if (readAt<uint32_t>(data, block.offset + i * sizeof(uint32_t)) >= header.entityCount)
+        return invalid("component of an unknown entity");
+    }
+  }
+  
+  std::vector<EntityRecord> records(header.entityCount);
+  std::memcpy(records.data(), data + entityBlock->offset, records.size() * sizeof(EntityRecord));
+  for (size_t i = 0; i < records.size(); ++i) {
+    auto& record = records[i];
+    if (uint64_t(record.nameOffset) + record.nameLength > nameBlock->count || (record.parent != NoParent &&
+        record.parent >= i))
+      return invalid("corrupt entity record");
+  }
+  
+  // the Entities are placed in their archetypes once their components are loaded, so that each Entity is stored once
+  scene.reserveEntities(records.size());
+  std::vector<Entity*> created(records.size());
+  std::string name;
+  for (size_t i = 0; i < created.size(); ++i) {
+    auto& record = records[i];
+    name.assign(reinterpret_cast<const char*>(data + nameBlock->offset + record.nameOffset), record.nameLength);
+    auto* parent = record.parent != NoParent ? created[record.parent]->getTransform() : nullptr;
+    auto* entity = scene.createUnplacedEntity(name, parent);
+    auto t = readAt<TransformRecord>(data, transformBlock->offset + i * sizeof(TransformRecord));
+    auto* transform = entity->getTransform();
+    transform->setPosition(t.position[0], t.position[1], t.position[2]);
+    transform->setRotation(Quaternion(t.rotation[0], t.rotation[1], t.rotation[2], t.rotation[3]));
+    transform->setScale(t.scale[0], t.scale[1], t.scale[2]);
+    created[i] = entity;
+  }
+  
+  auto& registry = getRegistry();
+  for (auto& block : blocks) {
+    if (block.kind != BlockKind::Component)
+      continue;
+    auto it = registry.find(block.typeHash);
+    if (it == registry.end() || it->second.stateSize != block.stride) {
+      Logger::log("Skipped a component type of a scene snapshot which is not registered or has changed",
+                  LogLevel::Warning);
+      continue;
+    }
+    auto* states = data + statesOffset(block.offset, block.count);
+    for (size_t i = 0; i < block.count; ++i) {
+      auto entity = readAt<uint32_t>(data, block.offset + i * sizeof(uint32_t));
+      it->second.load(created[entity], states + i * block.stride);
+    }
+  }
+  scene.placeEntities(created);
+  return created.size();
+}
+
+void SceneSnapshot::save(Scene& scene, const std::filesystem::path& path) {
+  auto snapshot = capture(scene);
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  file.write(reinterpret_cast<const char*>(snapshot.data()), static_cast<std::streamsize>(snapshot.size()));
+  if (!file)
+    throwOrDefault<std::runtime_error>("Could not write scene snapshot " + path.string());
+}
+
+size_t SceneSnapshot::load(Scene& scene, const std::filesystem::path& path) {
+  MappedFile file(path);
+  return restore(scene, file.data());
+}
+
+} // ams
@@ -0,0 +1,212 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/game/SpatialIndex.hpp"
+#include "ams/game/Transform.hpp"
+#include "ams/game/Components/MeshComponent.hpp"
+#else
+import ams.game.SpatialIndex;
+import ams.game.Transform;
+import ams.game.MeshComponent;
+#endif
+
+namespace ams {
+
+namespace {
+
+/** Transforms local bounds by a world matrix. Empty bounds become the point at the origin of the Transform. */
+AABB worldBounds(const AABB& local, const Matrix4& world) {
+  if (local.empty()) {
+    auto translation = world[3];
+    Vec3<decimal_t> position(translation[0], translation[1], translation[2]);
+    return {position, position};
+  }
+  return local.transformed(world);
+}
+
+uint64_t packHandle(EntityHandle entity) {
+  return static_cast<uint64_t>(entity.index) << 32 | entity.generation;
+}
+
+} // namespace
+
+EntityHandle SpatialIndex::raycast(const Ray& ray, decimal_t maxDistance, decimal_t* distance) const {
+  EntityHandle closest{};
+  decimal_t closestDistance = maxDistance;
+  raycast(ray, maxDistance, [&](EntityHandle entity, decimal_t hitDistance) {
+    closest = entity;
+    closestDistance = hitDistance;
+    return hitDistance;
+  });
+  if (distance != nullptr && !closest.isNull())
+    *distance = closestDistance;
+  return closest;
+}
+
+const AABB* SpatialIndex::getBounds(EntityHandle entity) const {
+  if (entity.index >= _entries.size())
+    return nullptr;
+  auto& entry = _entries[entity.index];
+  if (entry.generation != entity.generation || entry.proxy == AABBTree::NullProxy)
+    return nullptr;
+  return &_bounds[entry.proxy];
+}
+
+void SpatialIndex::setLocalBounds(const Entity* entity, const AABB& bounds) {
+  auto handle = entity->getHandle();
+  auto& entry = getEntry(handle);
+  entry.localBounds = bounds;
+  entry.customBounds = true;
+  if (entry.proxy != AABBTree::NullProxy)
+    place(entry, handle, entity->getTransform(), true);
+}
+
+void SpatialIndex::update(internal::TransformHierarchy& hierarchy) {
+  if (_stale) {
+    sync(hierarchy.getTransforms());
+    _meshChanges.clear();
+    hierarchy.clearChanges();
+    return;
+  }
+  // rebuilding the order recomputed every world matrix, so every indexed Entity is refit
+  auto changes = hierarchy.allChanged() ? hierarchy.getTransforms() : hierarchy.getChanges();
+  // many moved proxies are cheaper to rebuild from scratch than to reinsert one by one
+  bool rebuild = changes.size() + _meshChanges.size() > RebuildThreshold;
+  for (auto* transform : changes) {
+    if (transform == nullptr)
+      continue;
+    auto handle = transform->getEntity()->getHandle();
+    if (handle.index >= _entries.size())
+      continue;
+    auto& entry = _entries[handle.index];
+    if (entry.generation == handle.generation && entry.proxy != AABBTree::NullProxy)
+      place(entry, handle, transform, !rebuild);
+  }
+  for (auto handle : _meshChanges) {
+    auto& entry = _entries[handle.index];
+    if (entry.generation == handle.generation && entry.proxy != AABBTree::NullProxy)
+      place(entry, handle, entry.transform, !rebuild);
+  }
+  _meshChanges.clear();
+  if (rebuild)
+    _tree.rebuild();
+  hierarchy.clearChanges();
+}
+
+void SpatialIndex::sync(std::span<Transform* const> transforms) {
+  ++_stamp;
+  _stale = false;
+  bool rebuild = transforms.size() > RebuildThreshold;
+  for (auto* transform : transforms) {
+    if (transform == nullptr)
+      continue;
+    auto* entity = transform->getEntity();
+    auto handle = entity->getHandle();
+    auto& entry = getEntry(handle);
+    readMeshBounds(entry, entity);
+    entry.stamp = _stamp;
+    place(entry, handle, transform, !rebuild);
+  }
+  // the Entities which were not seen are gone
+  for (auto& entry : _entries) {
+    if (entry.proxy != AABBTree::NullProxy && entry.stamp != _stamp) {
+      _tree.remove(entry.proxy);
+      entry = {};
+    }
+  }
+  if (rebuild)
+    _tree.rebuild();
+}
+
+void SpatialIndex::add(std::span<Entity* const> entities) {
+  // every Transform is indexed by the next sync
+  if (_stale)
+    return;
+  bool rebuild = entities.size() > RebuildThreshold;
+  for (auto* entity : entities) {
+    auto handle = entity->getHandle();
+    auto& entry = getEntry(handle);
+    readMeshBounds(entry, entity);
+    place(entry, handle, entity->getTransform(), !rebuild);
+  }
+  if (rebuild)
+    _tree.rebuild();
+}
+
+void SpatialIndex::remove(EntityHandle entity) {
+  if (entity.index >= _entries.size())
+    return;
+  auto& entry = _entries[entity.index];
+  if (entry.generation != entity.generation)
+    return;
+  if (entry.proxy != AABBTree::NullProxy)
+    _tree.remove(entry.proxy);
+  entry = {};
+}
+
+void SpatialIndex::setMesh(const Entity* entity, const Mesh* mesh) {
+  auto handle = entity->getHandle();
+  if (handle.isNull() || handle.index >= _entries.size())
+    return;
+  auto& entry = _entries[handle.index];
+  if (entry.generation != handle.generation || entry.proxy == AABBTree::NullProxy || entry.customBounds)
+    return;
+  entry.localBounds = mesh != nullptr ? mesh->getBounds() : AABB{};
+  _meshChanges.push_back(handle);
+}
+
+void SpatialIndex::clear() {
+  _tree.clear();
+  _entries.clear();
+  _bounds.clear();
+  _meshChanges.clear();
+  _stale = true;
+}
+
+SpatialIndex::Entry& SpatialIndex::getEntry(EntityHandle entity) {
+  if (entity.index >= _entries.size())
+    _entries.resize(entity.index + 1);
+  auto& entry = _entries[entity.index];
+  if (entry.generation != entity.generation) {
+    if (entry.proxy != AABBTree::NullProxy)
+      _tree.remove(entry.proxy);
+    entry = {};
+    entry.generation = entity.generation;
+  }
+  return entry;
+}
+
+void SpatialIndex::readMeshBounds(Entry& entry, Entity* entity) {
+  if (entry.customBounds)
+    return;
+  auto* mesh = entity->hasComponent<MeshComponent>() ? entity->getComponent<MeshComponent>()->getMesh() : nullptr;
+  entry.localBounds = mesh != nullptr ? mesh->getBounds() : AABB{};
+}
+
+void SpatialIndex::place(Entry& entry, EntityHandle entity, const Transform* transform, bool link) {
+  auto bounds = worldBounds(entry.localBounds, transform->getWorldMatrix());
+  if (entry.proxy == AABBTree::NullProxy)
+    entry.proxy = _tree.insert(bounds, packHandle(entity), link);
+  else
+    _tree.move(entry.proxy, bounds, link);
+  entry.transform = transform;
+  if (entry.proxy >= _bounds.size())
+    _bounds.resize(entry.proxy + 1);
+  _bounds[entry.proxy] = bounds;
+}
+
+} // ams
@@ -24,4 +24,14 @@ import ams.game.Entity
 #endif
 
 namespace ams {
+
+Transform::~Transform() {
+  setParent(nullptr);
+  // orphaned children become roots
+  for (auto* child : m_children)
+    child->m_parent = nullptr;
+  if (m_hierarchy != nullptr)
+    m_hierarchy->remove(this);
+}
+
 } // ams
\ No newline at end of file
@@ -98,9 +98,9 @@ void Window::create() {
   glfwWindowHint(GLFW_RESIZABLE, _isResizable ? GLFW_TRUE : GLFW_FALSE);
 
   if (_isFullscreen)
-    _window.reset(glfwCreateWindow(_size.x, _size.y, name.c_str(), _display.getHandle(), nullptr));
+    _window.reset(glfwCreateWindow(_size.x, _size.y, getName().c_str(), _display.getHandle(), nullptr));
   else
-    _window.reset(glfwCreateWindow(_size.x, _size.y, name.c_str(), nullptr, nullptr));
+    _window.reset(glfwCreateWindow(_size.x, _size.y, getName().c_str(), nullptr, nullptr));
   if constexpr (AMSExceptions) {
     if (!_window)
       throw std::runtime_error("Failed to create window");
@@ -129,7 +129,10 @@ void Window::destroy() {
 }
 
 void Window::update() {
+  _droppedPaths.clear();
   glfwPollEvents();
+  if (_eventBus == &_events)
+    _events.dispatch();
 }
 
 #pragma region Accessors
@@ -147,11 +150,11 @@ Vec2<int> Window::getSize() {
 void Window::setTitle(const std::string& title) {
   checkTitle(title);
   if (_window)
-    glfwSetWindowTitle(_window.get(), name.c_str());
+    glfwSetWindowTitle(_window.get(), getName().c_str());
 }
 
 std::string Window::getTitle() const {
-  return name;
+  return getName();
 }
 
 void Window::setPosition(const Vec2<int>& position) {
@@ -268,9 +271,9 @@ void Window::checkTitle(const std::string& title) {
     if constexpr (AMSExceptions)
       throw std::invalid_argument("Window title must begin with a letter or number and must be alphanumeric.");
     else
-      name = "INVALID TITLE";
+      setName("INVALID TITLE");
   }
-  name = title;
+  setName(title);
 }
 
 
@@ -316,152 +319,203 @@ bool Window::operator!=(const GLFWwindow* other) const {
 #pragma endregion Operators
 
 
-// handleCharEvent
-// std::vector<Function<void, Key>> _charCallbacks{};
-// handleCharModsEvent
-// std::vector<Function<void, KeyPress>> _charModsCallbacks{};
-// handleKeyEvent
-// std::vector<Function<void, KeyPress>> _keyCallbacks{};
-// handleMouseButtonEvent
-// std::vector<Function<void, MousePress>> _mouseButtonCallbacks{};
-// handleMouseScrollEvent
-// std::vector<Function<void, Vec2<decimal_t>>> _mouseScrollCallbacks{};
-// handleMousePositionEvent
-// std::vector<Function<void, Vec2<decimal_t>>> _mousePositionCallbacks{};
-// handleCursorEnterEvent
-// std::vector<Function<void, bool>> _cursorEnterCallbacks{};
-// handleDropEvent
-// std::vector<Function<void, std::vector<std::string>>> _dropCallbacks{};
-// handleWindowCloseEvent
-// std::vector<Function<void>> _windowCloseCallbacks{};
-// handleWindowFocusEvent
-// std::vector<Function<void, bool>> _windowFocusCallbacks{};
-// handleWindowIconifyEvent
-// std::vector<Function<void, bool>> _windowIconifyCallbacks{};
-// handleWindowPositionEvent
-// std::vector<Function<void, Vec2<int>>> _windowPositionCallbacks{};
-// handleWindowSizeEvent
-// std::vector<Function<void, Vec2<int>>> _windowSizeCallbacks{};
-// handleWindowMaximizeEvent
-// std::vector<Function<void, bool>> _windowMaximizeCallbacks{};
-// handleFramebufferSizeEvent
-// std::vector<Function<void, Vec2<int>>> _framebufferSizeCallbacks{};
-// handleWindowRefreshEvent
-// std::vector<Function<void>> _windowRefreshCallbacks{};
-// handleWindowContentScaleEvent
-// std::vector<Function<void, Vec2<decimal_t>>> _windowContentScaleCallbacks{};
+#pragma region CallbackRegistration
 
-void Window::handleCharEvent(GLFWwindow* window, unsigned int codepoint) {
-  if (auto win = getWindow(window)) {
-    auto key = glfwToKey(codepoint);
-    for (auto& f : win->_charCallbacks) {
-      f(key);
+namespace {
+
+/** Subscribes a function to the events of type TEvt which are published by a window. */
+template<typename TEvt, typename TFunc>
+EventHandle subscribeWindowEvent(EventBus& bus, const Window* window, TFunc fn) {
+  return bus.subscribe<TEvt>([window, fn = std::move(fn)](std::span<const TEvt> events) {
+    for (auto& event : events) {
+      if (event.window == window)
+        fn(event);
     }
-  }
+  });
+}
+
+} // namespace
+
+EventHandle Window::registerCharCallback(const Delegate<void(Key)>& callback) {
+  return subscribeWindowEvent<CharEvent>(*_eventBus, this, [callback](const CharEvent& event) {
+    callback(glfwToKey(static_cast<int>(event.codepoint)));
+  });
+}
+
+EventHandle Window::registerCharModsCallback(const Delegate<void(const KeyPress&)>& callback) {
+  return subscribeWindowEvent<CharModsEvent>(*_eventBus, this, [callback](const CharModsEvent& event) {
+    callback(KeyPress{glfwToKey(static_cast<int>(event.codepoint)), event.mods});
+  });
+}
+
+EventHandle Window::registerKeyCallback(const Delegate<void(const KeyPress&)>& callback) {
+  return subscribeWindowEvent<KeyEvent>(*_eventBus, this, [callback](const KeyEvent& event) {
+    callback(event.press);
+  });
+}
+
+EventHandle Window::registerMouseButtonCallback(const Delegate<void(const MousePress&)>& callback) {
+  return subscribeWindowEvent<MouseButtonEvent>(*_eventBus, this, [callback](const MouseButtonEvent& event) {
+    callback(event.press);
+  });
+}
+
+EventHandle Window::registerMouseScrollCallback(const Delegate<void(const Vec2<decimal_t>&)>& callback) {
+  return subscribeWindowEvent<MouseScrollEvent>(*_eventBus, this, [callback](const MouseScrollEvent& event) {
+    callback(Vec2<decimal_t>(event.x, event.y));
+  });
+}
+
+EventHandle Window::registerMousePositionCallback(const Delegate<void(const Vec2<decimal_t>&)>& callback) {
+  return subscribeWindowEvent<MousePositionEvent>(*_eventBus, this, [callback](const MousePositionEvent& event) {
+    callback(Vec2<decimal_t>(event.x, event.y));
+  });
+}
+
+EventHandle Window::registerCursorEnterCallback(const Delegate<void(bool)>& callback) {
+  return subscribeWindowEvent<CursorEnterEvent>(*_eventBus, this, [callback](const CursorEnterEvent& event) {
+    callback(event.entered);
+  });
+}
+
+EventHandle Window::registerDropCallback(const Delegate<void(std::vector<std::string>)>& callback) {
+  return subscribeWindowEvent<DropEvent>(*_eventBus, this, [callback](const DropEvent& event) {
+    auto paths = event.window->getDroppedPaths().subspan(event.first, event.count);
+    callback(std::vector<std::string>(paths.begin(), paths.end()));
+  });
+}
+
+EventHandle Window::registerWindowCloseCallback(const Delegate<void()>& callback) {
+  return subscribeWindowEvent<WindowCloseEvent>(*_eventBus, this, [callback](const WindowCloseEvent&) {
+    callback();
+  });
+}
+
+EventHandle Window::registerWindowFocusCallback(const Delegate<void(bool)>& callback) {
+  return subscribeWindowEvent<WindowFocusEvent>(*_eventBus, this, [callback](const WindowFocusEvent& event) {
+    callback(event.focused);
+  });
+}
+
+EventHandle Window::registerWindowIconifyCallback(const Delegate<void(bool)>& callback) {
+  return subscribeWindowEvent<WindowIconifyEvent>(*_eventBus, this, [callback](const WindowIconifyEvent& event) {
+    callback(event.iconified);
+  });
+}
+
+EventHandle Window::registerWindowPositionCallback(const Delegate<void(const Vec2<int>&)>& callback) {
+  return subscribeWindowEvent<WindowPositionEvent>(*_eventBus, this, [callback](const WindowPositionEvent& event) {
+    callback(Vec2<int>{event.x, event.y});
+  });
+}
+
+EventHandle Window::registerWindowSizeCallback(const Delegate<void(const Vec2<int>&)>& callback) {
+  return subscribeWindowEvent<WindowSizeEvent>(*_eventBus, this, [callback](const WindowSizeEvent& event) {
+    if (!event.framebuffer)
+      callback(Vec2<int>{event.width, event.height});
+  });
+}
+
+EventHandle Window::registerFramebufferSizeCallback(const Delegate<void(const Vec2<int>&)>& callback) {
+  return subscribeWindowEvent<WindowSizeEvent>(*_eventBus, this, [callback](const WindowSizeEvent& event) {
+    if (event.framebuffer)
+      callback(Vec2<int>{event.width, event.height});
+  });
+}
+
+EventHandle Window::registerWindowRefreshCallback(const Delegate<void()>& callback) {
+  return subscribeWindowEvent<WindowRefreshEvent>(*_eventBus, this, [callback](const WindowRefreshEvent&) {
+    callback();
+  });
+}
+
+EventHandle Window::registerWindowMaximizeCallback(const Delegate<void(bool)>& callback) {
+  return subscribeWindowEvent<WindowMaximizeEvent>(*_eventBus, this, [callback](const WindowMaximizeEvent& event) {
+    callback(event.maximized);
+  });
+}
+
+EventHandle Window::registerWindowContentScaleCallback(const Delegate<void(const Vec2<decimal_t>&)>& callback) {
+  return subscribeWindowEvent<WindowContentScaleEvent>(*_eventBus, this,
+    [callback](const WindowContentScaleEvent& event) {
+      callback(Vec2<decimal_t>(event.x, event.y));
+    });
+}
+
+#pragma endregion CallbackRegistration
+
+#pragma region GLFW event handlers
+
+void Window::handleCharEvent(GLFWwindow* window, unsigned int codepoint) {
+  if (auto win = getWindow(window))
+    win->_eventBus->publish(CharEvent{win, codepoint});
 }
 
 void Window::handleCharModsEvent(GLFWwindow* window, unsigned int codepoint, int mods) {
-  if (auto win = getWindow(window)) {
-    auto keyPress = KeyPress{glfwToKey(codepoint), mods};
-    for (auto& f : win->_charModsCallbacks) {
-      f(keyPress);
-    }
-  }
+  if (auto win = getWindow(window))
+    win->_eventBus->publish(CharModsEvent{win, codepoint, mods});
 }
 
 void Window::handleKeyEvent(GLFWwindow* window, int keycode, int scancode, int action, int mods) {
-  if (auto win = getWindow(window)) {
-    auto keyPress = KeyPress{glfwToKey(keycode), mods};
-    for (auto& f : win->_keyCallbacks) {
-      f(keyPress);
-    }
-  }
+  if (auto win = getWindow(window))
+    win->_eventBus->publish(KeyEvent{win, KeyPress{glfwToKey(keycode), mods}, toMouseAction(action)});
 }
 
 void Window::handleMouseButtonEvent(GLFWwindow* window, int button, int action, int mods) {
   if (auto win = getWindow(window)) {
     auto mousePress = MousePress{ams::toMouseButton(button), ams::toMouseAction(action), mods};
-    for (auto& f : win->_mouseButtonCallbacks) {
-      f(mousePress);
-    }
+    win->_eventBus->publish(MouseButtonEvent{win, mousePress});
   }
 }
 
 void Window::handleMouseScrollEvent(GLFWwindow* window, double xoffset, double yoffset) {
-  if (auto win = getWindow(window)) {
-    auto offset = Vec2<decimal_t>{xoffset, yoffset};
-    for (auto& f : win->_mouseScrollCallbacks) {
-      f(offset);
-    }
-  }
+  if (auto win = getWindow(window))
+    win->_eventBus->publish(MouseScrollEvent{win, xoffset, yoffset});
 }
 
 void Window::handleMousePositionEvent(GLFWwindow* window, double xpos, double ypos) {
-  if (auto win = getWindow(window)) {
-    auto pos = Vec2<decimal_t>{xpos, ypos};
-    for (auto& f : win->_mousePositionCallbacks) {
-      f(pos);
-    }
-  }
+  if (auto win = getWindow(window))
+    win->_eventBus->publish(MousePositionEvent{win, xpos, ypos});
 }
 
 void Window::handleCursorEnterEvent(GLFWwindow* window, int entered) {
-  if (auto win = getWindow(window)) {
-    bool enteredBool = entered == GLFW_TRUE;
-    for (auto& f : win->_cursorEnterCallbacks) {
-      f(enteredBool);
-    }
-  }
+  if (auto win = getWindow(window))
+    win->_eventBus->publish(CursorEnterEvent{win, entered == GLFW_TRUE});
 }
 
 void Window::handleDropEvent(GLFWwindow* window, int count, const char** paths) {
   if (auto win = getWindow(window)) {
-    std::vector<std::string> pathsVec;
-    for (int i = 0; i < count; i++) {
-      pathsVec.push_back(paths[i]);
-    }
-    for (auto& f : win->_dropCallbacks) {
-      f(pathsVec);
-    }
+    auto first = win->_droppedPaths.size();
+    win->_droppedPaths.insert(win->_droppedPaths.end(), paths, paths + count);
+    win->_eventBus->publish(DropEvent{win, first, static_cast<size_t>(count)});
   }
 }
 
 void Window::handleWindowCloseEvent(GLFWwindow* window) {
   if (auto win = getWindow(window)) {
     win->_isClosing = true;
-    for (auto& f : win->_windowCloseCallbacks) {
-      f();
-    }
+    win->_eventBus->publish(WindowCloseEvent{win});
   }
 }
 
 void Window::handleWindowFocusEvent(GLFWwindow* window, int focused) {
   if (auto win = getWindow(window)) {
-    bool focusedBool = focused == GLFW_TRUE;
-    win->_isFocused = focusedBool;
-    for (auto& f : win->_windowFocusCallbacks) {
-      f(focusedBool);
-    }
+    win->_isFocused = focused == GLFW_TRUE;
+    win->_eventBus->publish(WindowFocusEvent{win, win->_isFocused});
   }
 }
 
 void Window::handleWindowIconifyEvent(GLFWwindow* window, int iconified) {
   if (auto win = getWindow(window)) {
-    bool iconifiedBool = iconified == GLFW_TRUE;
-    win->_isIconified = iconifiedBool;
-    for (auto& f : win->_windowIconifyCallbacks) {
-      f(iconifiedBool);
-    }
+    win->_isIconified = iconified == GLFW_TRUE;
+    win->_eventBus->publish(WindowIconifyEvent{win, win->_isIconified});
   }
 }
 
 void Window::handleWindowPositionEvent(GLFWwindow* window, int xpos, int ypos) {
   if (auto win = getWindow(window)) {
-    auto pos = Vec2<int>{xpos, ypos};
-    win->_position = pos;
-    for (auto& f : win->_windowPositionCallbacks) {
-      f(pos);
-    }
+    win->_position = Vec2<int>{xpos, ypos};
+    win->_eventBus->publish(WindowPositionEvent{win, xpos, ypos});
   }
 }
 
@@ -471,50 +525,37 @@ void Window::handleWindowSizeEvent(GLFWwindow* window, int width, int height) {
     auto size = Vec2<int>{width, height};
     if (win->_size == size) return;
     win->_size = size;
-    for (auto& f : win->_windowSizeCallbacks) {
-      f(size);
-    }
+    win->_eventBus->publish(WindowSizeEvent{win, width, height, false});
   }
 }
 
 void Window::handleWindowMaximizeEvent(GLFWwindow* window, int maximized) {
   if (auto win = getWindow(window)) {
-    bool maximizedBool = maximized == GLFW_TRUE;
-    win->_isMaximized = maximizedBool;
-    for (auto& f : win->_windowMaximizeCallbacks) {
-      f(maximizedBool);
-    }
+    win->_isMaximized = maximized == GLFW_TRUE;
+    win->_eventBus->publish(WindowMaximizeEvent{win, win->_isMaximized});
   }
 }
 
 void Window::handleFramebufferSizeEvent(GLFWwindow* window, int width, int height) {
   if (auto win = getWindow(window)) {
-    auto size = Vec2<int>{width, height};
-    win->_framebufferSize = size;
-    for (auto& f : win->_framebufferSizeCallbacks) {
-      f(size);
-    }
+    win->_framebufferSize = Vec2<int>{width, height};
+    win->_eventBus->publish(WindowSizeEvent{win, width, height, true});
   }
 }
 
 void Window::handleWindowRefreshEvent(GLFWwindow* window) {
-  if (auto win = getWindow(window)) {
-    for (auto& f : win->_windowRefreshCallbacks) {
-      f();
-    }
-  }
+  if (auto win = getWindow(window))
+    win->_eventBus->publish(WindowRefreshEvent{win});
 }
 
 void Window::handleWindowContentScaleEvent(GLFWwindow* window, float xscale, float yscale) {
   if (auto win = getWindow(window)) {
-    auto scale = Vec2<decimal_t>{xscale, yscale};
-    win->_contentScale = scale;
-    for (auto& f : win->_windowContentScaleCallbacks) {
-      f(scale);
-    }
+    win->_contentScale = {xscale, yscale};
+    win->_eventBus->publish(WindowContentScaleEvent{win, xscale, yscale});
   }
 }
 
+#pragma endregion GLFW event handlers
 
 // the end :)
 } // ams
\ No newline at end of file
@@ -0,0 +1,128 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/game/internal/Archetype.hpp"
+#include "ams/game/Entity.hpp"
+#else
+import ams.game.internal.Archetype;
+import ams.game.Entity;
+#endif
+
+namespace ams::internal {
+
+Archetype::Archetype(ArchetypeSignature signature, std::span<const ComponentStorage* const> storages)
+: _signature(signature), _columns(signature.count())
+{
+  if constexpr (AMSExceptions)
+    if (storages.size() != _columns.size())
+      throw ArgumentException("Storage count does not match the archetype signature");
+  // lay the by-value columns out one after the other in each chunk
+  for (size_t i = 0; i < _columns.size(); ++i) {
+    auto* storage = storages[i];
+    if (storage == nullptr)
+      continue;
+    _chunkSize = (_chunkSize + storage->align - 1) / storage->align * storage->align;
+    _columns[i].storage = storage;
+    _columns[i].offset = _chunkSize;
+    _chunkSize += storage->size * RowsPerChunk;
+    if (storage->align > _chunkAlign)
+      _chunkAlign = storage->align;
+  }
+}
+
+Archetype::~Archetype() {
+  clear();
+}
+
+size_t Archetype::addRow(Entity* entity) {
+  while (!_freeRows.empty()) {
+    auto row = _freeRows.back();
+    _freeRows.pop_back();
+    // rows trimmed by removeRow() stay in the free list until they are popped
+    if (row >= _entities.size() || _entities[row] != nullptr)
+      continue;
+    _entities[row] = entity;
+    ++_size;
+    return row;
+  }
+  auto row = _entities.size();
+  if (_chunkSize != 0 && row / RowsPerChunk == _chunks.size())
+    _chunks.push_back(static_cast<std::byte*>(::operator new(_chunkSize, std::align_val_t(_chunkAlign))));
+  for (auto& column : _columns) {
+    if (column.storage == nullptr)
+      column.components.push_back(nullptr);
+  }
+  _entities.push_back(entity);
+  ++_size;
+  return row;
+}
+
+Component* Archetype::place(size_t row, size_t column, Component* component) {
+  auto& col = _columns[column];
+  if (col.storage == nullptr)
+    return col.components[row] = component;
+  return col.storage->relocate(cell(row, column), component);
+}
+
+void Archetype::reserve(size_t rows) {
+  for (auto& column : _columns) {
+    if (column.storage == nullptr)
+      column.components.reserve(rows);
+  }
+  _entities.reserve(rows);
+  if (_chunkSize == 0)
+    return;
+  auto chunks = (rows + RowsPerChunk - 1) / RowsPerChunk;
+  _chunks.reserve(chunks);
+  // rows are added in order, so the chunks they need can be allocated up front
+  while (_chunks.size() < chunks)
+    _chunks.push_back(static_cast<std::byte*>(::operator new(_chunkSize, std::align_val_t(_chunkAlign))));
+}
+
+void Archetype::removeRow(size_t row) {
+  _entities[row] = nullptr;
+  for (auto& column : _columns) {
+    if (column.storage == nullptr)
+      column.components[row] = nullptr;
+  }
+  --_size;
+  if (row + 1 != _entities.size()) {
+    _freeRows.push_back(row);
+    return;
+  }
+  // trim trailing free rows, so that iteration stops at the last Entity
+  _entities.pop_back();
+  while (!_entities.empty() && _entities.back() == nullptr)
+    _entities.pop_back();
+  for (auto& column : _columns) {
+    if (column.storage == nullptr)
+      column.components.resize(_entities.size());
+  }
+}
+
+void Archetype::clear() {
+  _entities.clear();
+  _freeRows.clear();
+  _size = 0;
+  for (auto& column : _columns)
+    column.components.clear();
+  for (auto* chunk : _chunks)
+    ::operator delete(chunk, std::align_val_t(_chunkAlign));
+  _chunks.clear();
+}
+
+} // ams::internal
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/game/internal/BehaviorDispatch.hpp"
+#else
+import ams.game.internal.BehaviorDispatch;
+#endif
+
+#include <limits>
+#include <utility>
+
+namespace ams::internal {
+
+static constexpr uint32_t InvalidGroup = std::numeric_limits<uint32_t>::max();
+
+bool BehaviorDispatchList::add(Behavior* behavior) {
+  auto* hooks = behavior->_hooks;
+  if (hooks == nullptr || hooks->get(_hook) == nullptr)
+    return false;
+  auto& behaviors = getGroup(hooks).behaviors;
+  behavior->_dispatchIndices[static_cast<size_t>(_hook)] = static_cast<uint32_t>(behaviors.size());
+  behaviors.push_back(behavior);
+  return true;
+}
+
+void BehaviorDispatchList::reserve(const BehaviorHooks* hooks, size_t count) {
+  if (hooks == nullptr || hooks->get(_hook) == nullptr)
+    return;
+  auto& behaviors = getGroup(hooks).behaviors;
+  behaviors.reserve(behaviors.size() + count);
+}
+
+BehaviorDispatchList::Group& BehaviorDispatchList::getGroup(const BehaviorHooks* hooks) {
+  if (hooks->type >= _groupIndices.size())
+    _groupIndices.resize(hooks->type + 1, InvalidGroup);
+  auto& groupIndex = _groupIndices[hooks->type];
+  if (groupIndex == InvalidGroup) {
+    groupIndex = static_cast<uint32_t>(_groups.size());
+    _groups.push_back({hooks, hooks->get(_hook), {}});
+  }
+  return _groups[groupIndex];
+}
+
+bool BehaviorDispatchList::setEnabled(Behavior* behavior, bool enabled) {
+  auto* group = find(behavior);
+  if (group == nullptr)
+    return false;
+  auto index = behavior->_dispatchIndices[static_cast<size_t>(_hook)];
+  if ((index < group->enabled) == enabled)
+    return false;
+  // the boundary moves over the Behavior's slot: it swaps with the first disabled or the last enabled Behavior
+  if (enabled) {
+    swap(*group, index, group->enabled);
+    ++group->enabled;
+  } else {
+    --group->enabled;
+    swap(*group, index, group->enabled);
+  }
+  return true;
+}
+
+bool BehaviorDispatchList::remove(Behavior* behavior) {
+  auto* group = find(behavior);
+  if (group == nullptr)
+    return false;
+  auto index = behavior->_dispatchIndices[static_cast<size_t>(_hook)];
+  // an enabled Behavior is first swapped to the end of the enabled range, which becomes the first disabled slot
+  if (index < group->enabled) {
+    --group->enabled;
+    swap(*group, index, group->enabled);
+    index = group->enabled;
+  }
+  swap(*group, index, group->behaviors.size() - 1);
+  group->behaviors.pop_back();
+  return true;
+}
+
+BehaviorDispatchList::Group* BehaviorDispatchList::find(Behavior* behavior) {
+  auto* hooks = behavior->_hooks;
+  if (hooks == nullptr || hooks->get(_hook) == nullptr || hooks->type >= _groupIndices.size())
+    return nullptr;
+  auto groupIndex = _groupIndices[hooks->type];
+  if (groupIndex == InvalidGroup)
+    return nullptr;
+  auto& group = _groups[groupIndex];
+  auto index = behavior->_dispatchIndices[static_cast<size_t>(_hook)];
+  if (index >= group.behaviors.size() || group.behaviors[index] != behavior)
+    return nullptr;
+  return &group;
+}
+
+void BehaviorDispatchList::swap(Group& group, size_t a, size_t b) {
+  auto& behaviors = group.behaviors;
+  std::swap(behaviors[a], behaviors[b]);
+  behaviors[a]->_dispatchIndices[static_cast<size_t>(_hook)] = static_cast<uint32_t>(a);
+  behaviors[b]->_dispatchIndices[static_cast<size_t>(_hook)] = static_cast<uint32_t>(b);
+}
+
+size_t BehaviorDispatchList::size() const {
+  size_t count = 0;
+  for (auto& group : _groups)
+    count += group.behaviors.size();
+  return count;
+}
+
+size_t BehaviorDispatchList::enabledSize() const {
+  size_t count = 0;
+  for (auto& group : _groups)
+    count += group.enabled;
+  return count;
+}
+
+void BehaviorDispatchList::clear() {
+  for (auto& group : _groups) {
+    group.behaviors.clear();
+    group.enabled = 0;
+  }
+}
+
+} // ams::internal
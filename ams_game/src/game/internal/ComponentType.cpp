@@ -0,0 +1,84 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/game/internal/ComponentType.hpp"
+#include "ams/game/Exceptions.hpp"
+#else
+import ams.game.internal.ComponentType;
+import ams.game.Exceptions;
+#endif
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <unordered_map>
+
+namespace ams::internal {
+
+namespace {
+
+constexpr size_t DerivedWordCount = (AMSMaxComponentTypes + 63) / 64;
+
+struct ComponentTypeRegistry {
+  std::mutex mutex;
+  std::unordered_map<uint64_t, ComponentTypeId> ids;
+  /** The types derived from each type. Written under the mutex, read without it. */
+  std::array<std::array<std::atomic<uint64_t>, DerivedWordCount>, AMSMaxComponentTypes> derived{};
+  
+  void setDerived(ComponentTypeId base, ComponentTypeId type) {
+    derived[base][type / 64].fetch_or(uint64_t(1) << (type % 64), std::memory_order_release);
+  }
+};
+
+ComponentTypeRegistry& getRegistry() {
+  static ComponentTypeRegistry registry;
+  return registry;
+}
+
+} // namespace
+
+ComponentTypeId registerComponentType(uint64_t hash, std::span<const ComponentTypeId> bases) {
+  auto& registry = getRegistry();
+  std::scoped_lock lock(registry.mutex);
+  auto [it, inserted] = registry.ids.try_emplace(hash, static_cast<ComponentTypeId>(registry.ids.size()));
+  if (!inserted)
+    return it->second;
+  auto id = it->second;
+  if (id >= AMSMaxComponentTypes) {
+    // the id would index past the end of every ComponentMask, so there is no id to fall back to
+    registry.ids.erase(it);
+    if constexpr (AMSExceptions)
+      throw Exception("Too many component types. Define AMS_MAX_COMPONENT_TYPES to raise the limit");
+    std::abort();
+  }
+  for (auto base : bases)
+    registry.setDerived(base, id);
+  return id;
+}
+
+ComponentTypeId findDerivedComponentType(ComponentTypeId base, const ComponentMask& mask) {
+  auto& derived = getRegistry().derived[base];
+  auto found = static_cast<ComponentTypeId>(AMSMaxComponentTypes);
+  mask.forEach([&](ComponentTypeId type) {
+    if (found == AMSMaxComponentTypes && ((derived[type / 64].load(std::memory_order_acquire) >> (type % 64)) & 1u))
+      found = type;
+  });
+  return found;
+}
+
+} // ams::internal
@@ -0,0 +1,166 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/game/internal/SystemScheduler.hpp"
+#else
+import ams.game.internal.SystemScheduler;
+#endif
+#include <algorithm>
+#include <stdexcept>
+
+namespace ams::internal {
+
+void SystemScheduler::add(System* system) {
+  _systems.push_back(system);
+  _dirty = true;
+}
+
+bool SystemScheduler::remove(System* system) {
+  auto it = std::find(_systems.begin(), _systems.end(), system);
+  if (it == _systems.end())
+    return false;
+  _systems.erase(it);
+  _dirty = true;
+  return true;
+}
+
+std::span<System* const> SystemScheduler::getOrder() {
+  if (_dirty)
+    build();
+  return _order;
+}
+
+void SystemScheduler::run(JobSystem& jobs) {
+  if (_dirty)
+    build();
+  _handles.assign(_order.size(), JobHandle());
+  for (size_t i = 0; i < _order.size(); ++i) {
+    auto* system = _order[i];
+    _waitList.clear();
+    for (auto dependency : _dependencies[i])
+      _waitList.push_back(_handles[dependency]);
+    if (system->_concurrent) {
+      _handles[i] = jobs.schedule([system] { runTimed(system); }, _waitList);
+    } else {
+      // a System without a declared access conflicts with every other, so everything before it is waited for
+      jobs.waitAll(_waitList);
+      runTimed(system);
+    }
+  }
+  jobs.waitAll(_handles);
+}
+
+void SystemScheduler::runTimed(System* system) {
+  auto start = clk_t::now();
+  system->onRun();
+  system->_lastRunTime = clk_t::now() - start;
+}
+
+bool SystemScheduler::canAdd(const System* system) const {
+  std::vector<const System*> systems(_systems.begin(), _systems.end());
+  systems.push_back(system);
+  std::vector<std::vector<bool>> constrained;
+  std::vector<size_t> sorted;
+  return sort(systems, constrained, sorted);
+}
+
+void SystemScheduler::build() {
+  auto count = _systems.size();
+  std::vector<std::vector<bool>> constrained;
+  std::vector<size_t> sorted;
+  if (!sort(std::span<const System* const>(_systems.data(), count), constrained, sorted)) {
+    // Scene::addSystem rejects cycles, so this is only reached if constraints changed after a System was added
+    if constexpr (AMSExceptions)
+      throw std::logic_error("The runBefore and runAfter constraints of the Systems form a cycle");
+  }
+  
+  _order.clear();
+  _dependencies.assign(count, {});
+  for (size_t i = 0; i < count; ++i) {
+    auto* system = _systems[sorted[i]];
+    _order.push_back(system);
+    for (size_t j = 0; j < i; ++j) {
+      auto* earlier = _systems[sorted[j]];
+      if (constrained[sorted[j]][sorted[i]] || !system->_concurrent || !earlier->_concurrent ||
+          accessConflicts(earlier->_reads, earlier->_writes, system->_reads, system->_writes))
+        _dependencies[i].push_back(static_cast<uint32_t>(j));
+    }
+  }
+  _dirty = false;
+}
+
+bool SystemScheduler::sort(std::span<const System* const> systems, std::vector<std::vector<bool>>& constrained,
+                           std::vector<size_t>& sorted) {
+  auto count = systems.size();
+  // explicit constraints, as edges between indices in systems
+  constrained.assign(count, std::vector<bool>(count, false));
+  std::vector<uint32_t> pending(count, 0);
+  auto indexOf = [systems](uint64_t type) {
+    auto it = std::find_if(systems.begin(), systems.end(), [type](const System* s) { return s->_type == type; });
+    return it == systems.end() ? -1 : static_cast<int64_t>(it - systems.begin());
+  };
+  auto addEdge = [&](size_t from, size_t to) {
+    if (from == to || constrained[from][to])
+      return;
+    constrained[from][to] = true;
+    ++pending[to];
+  };
+  for (size_t i = 0; i < count; ++i) {
+    for (auto type : systems[i]->_runBefore) {
+      if (auto j = indexOf(type); j >= 0)
+        addEdge(i, static_cast<size_t>(j));
+    }
+    for (auto type : systems[i]->_runAfter) {
+      if (auto j = indexOf(type); j >= 0)
+        addEdge(static_cast<size_t>(j), i);
+    }
+  }
+  
+  // topological sort which always picks the earliest added System among those which are ready
+  bool acyclic = true;
+  sorted.clear();
+  sorted.reserve(count);
+  std::vector<bool> placed(count, false);
+  while (sorted.size() < count) {
+    size_t next = count;
+    for (size_t i = 0; i < count; ++i) {
+      if (!placed[i] && pending[i] == 0) {
+        next = i;
+        break;
+      }
+    }
+    if (next == count) {
+      // ignore the constraints of the remaining Systems
+      acyclic = false;
+      for (size_t i = 0; i < count; ++i) {
+        if (!placed[i]) {
+          next = i;
+          break;
+        }
+      }
+    }
+    placed[next] = true;
+    sorted.push_back(next);
+    for (size_t j = 0; j < count; ++j) {
+      if (constrained[next][j] && pending[j] > 0)
+        --pending[j];
+    }
+  }
+  return acyclic;
+}
+
+} // ams::internal
@@ -0,0 +1,292 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "ams/game/internal/TransformHierarchy.hpp"
+#include "ams/game/Transform.hpp"
+#else
+import ams.game.internal.TransformHierarchy;
+import ams.game.Transform;
+#endif
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace ams::internal {
+
+void TransformHierarchy::add(Transform* transform) {
+  transform->m_hierarchy = this;
+  transform->m_hierarchySlot = static_cast<uint32_t>(_transforms.size());
+  transform->m_hierarchyIndex = InvalidIndex;
+  _transforms.push_back(transform);
+  markStructureDirty();
+}
+
+void TransformHierarchy::remove(Transform* transform) {
+  if (transform->m_hierarchy != this)
+    return;
+  auto slot = transform->m_hierarchySlot;
+  _transforms[slot] = _transforms.back();
+  _transforms[slot]->m_hierarchySlot = slot;
+  _transforms.pop_back();
+  // the order may still reference the Transform until it is rebuilt
+  if (transform->m_hierarchyIndex < _order.size())
+    _order[transform->m_hierarchyIndex] = nullptr;
+  transform->m_hierarchy = nullptr;
+  markStructureDirty();
+}
+
+void TransformHierarchy::clear() {
+  for (auto* transform : _transforms)
+    transform->m_hierarchy = nullptr;
+  _transforms.clear();
+  _order.clear();
+  _parents.clear();
+  _subtreeSizes.clear();
+  _world.clear();
+  _dirty.clear();
+  _dirtyCount = 0;
+  _structureDirty = false;
+  _moved.clear();
+  _movedCount = 0;
+  _interpolated.clear();
+  _interpolating = false;
+  _staleInterpolated.clear();
+  _interpolatedStale = true;
+  _changed.clear();
+  _allChanged = _trackChanges;
+}
+
+void TransformHierarchy::markDirty(Transform* transform) {
+  auto index = transform->m_hierarchyIndex;
+  // Transforms which are not ordered yet are covered by the next rebuild
+  if (index >= _order.size() || _order[index] != transform)
+    return;
+  _dirty[_dirtyCount.fetch_add(1, std::memory_order_relaxed)] = index;
+  if (!transform->m_moved) {
+    transform->m_moved = true;
+    _moved[_movedCount.fetch_add(1, std::memory_order_relaxed)] = index;
+  }
+}
+
+void TransformHierarchy::update() {
+  if (_structureDirty.exchange(false, std::memory_order_relaxed)) {
+    _allChanged = _trackChanges;
+    _changed.clear();
+    rebuild();
+    return;
+  }
+  auto count = _dirtyCount.exchange(0, std::memory_order_relaxed);
+  if (count == 0)
+    return;
+  std::sort(_dirty.begin(), _dirty.begin() + count);
+  // a dirty Transform inside a subtree which was already recomputed is skipped
+  uint32_t end = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    auto root = _dirty[i];
+    if (root < end)
+      continue;
+    end = root + _subtreeSizes[root];
+    updateRange(root, end);
+    _staleInterpolated.emplace_back(root, end);
+  }
+  // past one range per Transform, copying every world matrix at the next interpolate() is cheaper
+  if (_staleInterpolated.size() > _order.size()) {
+    _staleInterpolated.clear();
+    _interpolatedStale = true;
+  }
+}
+
+void TransformHierarchy::setTrackChanges(bool track) {
+  _trackChanges = track;
+  _allChanged = track;
+  _changed.clear();
+}
+
+const Matrix4& TransformHierarchy::getWorldMatrix(const Transform* transform) const {
+  auto index = transform->m_hierarchyIndex;
+  if (index < _order.size() && _order[index] == transform)
+    return _world[index];
+  return transform->m_modelMatrix;
+}
+
+void TransformHierarchy::storeStates() {
+  auto count = _movedCount.exchange(0, std::memory_order_relaxed);
+  for (uint32_t i = 0; i < count; ++i) {
+    auto* transform = _order[_moved[i]];
+    // removed since it moved
+    if (transform == nullptr)
+      continue;
+    transform->m_previousPosition = transform->m_position;
+    transform->m_previousRotation = transform->m_rotation;
+    transform->m_previousScale = transform->m_scale;
+    transform->m_hasPreviousState = true;
+    transform->m_moved = false;
+  }
+}
+
+void TransformHierarchy::interpolate(decimal_t alpha) {
+  auto count = _movedCount.load(std::memory_order_relaxed);
+  _interpolating = count > 0;
+  if (!_interpolating)
+    return;
+  // every matrix outside of the moved subtrees is the world matrix
+  if (_interpolatedStale || _interpolated.size() != _world.size()) {
+    _interpolated = _world;
+    _interpolatedStale = false;
+  } else {
+    for (auto [begin, end] : _staleInterpolated)
+      std::copy(_world.begin() + begin, _world.begin() + end, _interpolated.begin() + begin);
+  }
+  _staleInterpolated.clear();
+  std::sort(_moved.begin(), _moved.begin() + count);
+  // a moved Transform inside a subtree which was already interpolated is skipped
+  uint32_t end = 0;
+  for (uint32_t i = 0; i < count; ++i) {
+    auto root = _moved[i];
+    if (root < end)
+      continue;
+    end = root + _subtreeSizes[root];
+    interpolateRange(root, end, alpha);
+    _staleInterpolated.emplace_back(root, end);
+  }
+}
+
+void TransformHierarchy::interpolateRange(uint32_t begin, uint32_t end, decimal_t alpha) {
+  auto lerp = [alpha](decimal_t a, decimal_t b) { return a + (b - a) * alpha; };
+  _batch.clear();
+  for (auto i = begin; i < end; ++i) {
+    auto* transform = _order[i];
+    if (!transform->m_hasPreviousState) {
+      _batch.push_back(transform->m_position, transform->m_rotation, transform->m_scale);
+      continue;
+    }
+    auto& p0 = transform->m_previousPosition;
+    auto& p1 = transform->m_position;
+    auto& r0 = transform->m_previousRotation;
+    auto& r1 = transform->m_rotation;
+    auto& s0 = transform->m_previousScale;
+    auto& s1 = transform->m_scale;
+    // take the shortest arc, then renormalize. Between two fixed steps the angle is small enough for this to match a
+    // spherical interpolation.
+    auto sign = r0.x * r1.x + r0.y * r1.y + r0.z * r1.z + r0.w * r1.w < 0 ? -1.0 : 1.0;
+    Quaternion rotation(lerp(r0.x, sign * r1.x), lerp(r0.y, sign * r1.y), lerp(r0.z, sign * r1.z),
+                        lerp(r0.w, sign * r1.w));
+    auto length = std::sqrt(rotation.x * rotation.x + rotation.y * rotation.y + rotation.z * rotation.z +
+                            rotation.w * rotation.w);
+    if (length > 0) {
+      rotation.x /= length;
+      rotation.y /= length;
+      rotation.z /= length;
+      rotation.w /= length;
+    }
+    _batch.push_back(Vec3<decimal_t>(lerp(p0.x, p1.x), lerp(p0.y, p1.y), lerp(p0.z, p1.z)), rotation,
+                     Vec3<decimal_t>(lerp(s0.x, s1.x), lerp(s0.y, s1.y), lerp(s0.z, s1.z)));
+  }
+  composeTRS(_batch, std::span<Matrix4>(_interpolated).subspan(begin, end - begin));
+  // the parent of the subtree's root is outside of the range, where the interpolated matrix is the world matrix
+  for (auto i = begin; i < end; ++i) {
+    if (_parents[i] != InvalidIndex)
+      _interpolated[i] = _interpolated[i] * _interpolated[_parents[i]];
+  }
+}
+
+const Matrix4& TransformHierarchy::getInterpolatedWorldMatrix(const Transform* transform) const {
+  auto index = transform->m_hierarchyIndex;
+  if (index < _order.size() && _order[index] == transform)
+    return _interpolating ? _interpolated[index] : _world[index];
+  return transform->m_modelMatrix;
+}
+
+void TransformHierarchy::rebuild() {
+  _order.clear();
+  _parents.clear();
+  _subtreeSizes.clear();
+  _order.reserve(_transforms.size());
+  // iterative, so that deep hierarchies do not overflow the stack
+  std::vector<std::pair<Transform*, uint32_t>> stack;
+  for (auto* root : _transforms) {
+    if (root->m_parent != nullptr && root->m_parent->m_hierarchy == this)
+      continue;
+    stack.emplace_back(root, InvalidIndex);
+    while (!stack.empty()) {
+      auto [transform, parent] = stack.back();
+      stack.pop_back();
+      auto index = static_cast<uint32_t>(_order.size());
+      transform->m_hierarchyIndex = index;
+      _order.push_back(transform);
+      _parents.push_back(parent);
+      _subtreeSizes.push_back(1);
+      for (auto it = transform->m_children.rbegin(); it != transform->m_children.rend(); ++it) {
+        if ((*it)->m_hierarchy == this)
+          stack.emplace_back(*it, index);
+      }
+    }
+  }
+  // children come after their parents, so walking backwards accumulates each subtree before its root is reached
+  for (auto i = static_cast<uint32_t>(_order.size()); i-- > 0;) {
+    if (_parents[i] != InvalidIndex)
+      _subtreeSizes[_parents[i]] += _subtreeSizes[i];
+  }
+  _world.resize(_order.size());
+  _dirty.resize(_order.size());
+  _dirtyCount = 0;
+  // the moved Transforms are listed again at their new index, with the new ones, which have no state to keep yet
+  _moved.resize(_order.size());
+  _movedCount = 0;
+  for (uint32_t i = 0; i < _order.size(); ++i) {
+    auto* transform = _order[i];
+    if (transform->m_moved || !transform->m_hasPreviousState) {
+      transform->m_moved = true;
+      _moved[_movedCount++] = i;
+    }
+  }
+  _staleInterpolated.clear();
+  _interpolatedStale = true;
+  for (auto* transform : _order)
+    transform->m_dirty = true;
+  updateRange(0, static_cast<uint32_t>(_order.size()));
+}
+
+void TransformHierarchy::updateRange(uint32_t begin, uint32_t end) {
+  _batch.clear();
+  _batchTransforms.clear();
+  for (auto i = begin; i < end; ++i) {
+    auto* transform = _order[i];
+    if (transform->m_dirty) {
+      _batch.push_back(transform->m_position, transform->m_rotation, transform->m_scale);
+      _batchTransforms.push_back(transform);
+    }
+  }
+  if (!_batchTransforms.empty()) {
+    _batchMatrices.resize(_batchTransforms.size());
+    composeTRS(_batch, _batchMatrices);
+    for (size_t i = 0; i < _batchTransforms.size(); ++i) {
+      _batchTransforms[i]->m_modelMatrix = _batchMatrices[i];
+      _batchTransforms[i]->m_dirty = false;
+    }
+  }
+  for (auto i = begin; i < end; ++i) {
+    auto* transform = _order[i];
+    auto parent = _parents[i];
+    // row vectors: a point is transformed by its local matrix first, then by its parent's world matrix
+    _world[i] = parent == InvalidIndex ? transform->m_modelMatrix : transform->m_modelMatrix * _world[parent];
+  }
+  if (_trackChanges && !_allChanged)
+    _changed.insert(_changed.end(), _order.begin() + begin, _order.begin() + end);
+}
+
+} // ams::internal
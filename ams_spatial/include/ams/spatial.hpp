@@ -21,8 +21,16 @@
 #include "spatial/Vec.hpp"
 #include "spatial/Matrix.hpp"
 #include "spatial/Quaternion.hpp"
+#include "spatial/Bounds.hpp"
+#include "spatial/AABBTree.hpp"
+#include "spatial/TransformBatch.hpp"
+#include "spatial/TransformPoints.hpp"
 /*[exclude end]*/
 /*[export module ams.spatial]*/
 /*[export import ams.spatial.Vec]*/
 /*[export import ams.spatial.Quaternion]*/
 /*[export import ams.spatial.Matrix]*/
+/*[export import ams.spatial.TransformBatch]*/
+/*[export import ams.spatial.TransformPoints]*/
+/*[export import ams.spatial.Bounds]*/
+/*[export import ams.spatial.AABBTree]*/
@@ -0,0 +1,243 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+/*[exclude begin]*/
+#pragma once
+#include "Bounds.hpp"
+/*[exclude end]*/
+/*[ignore begin]*/
+#include "ams_spatial_export.hpp"
+/*[ignore end]*/
+/*[export module ams.spatial.AABBTree]*/
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+#include <vector>
+/*[import ams]*/
+/*[import ams.spatial.Bounds]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief A dynamic bounding volume hierarchy of axis aligned boxes.
+ * @details Each leaf, or proxy, stores a box and a user value. Leaves store their box grown by a margin, so a proxy
+ * which moves a little stays inside its leaf and moving it costs nothing; a proxy which leaves its box is removed and
+ * inserted again, descending along the cheapest surface area, and the tree is kept balanced with rotations.
+ * When many proxies change at once, rebuild() replaces the incremental updates: the tree is built again top down by
+ * splitting the proxies at the median of their longest axis, and subtrees above a size threshold are built in
+ * parallel on the ams::JobSystem.
+ * Queries only read the tree, so they may run concurrently with each other, but not with changes to the tree.
+ * Queries report proxies whose fat boxes match; callers which need exact results test their own boxes.
+ */
+class AMS_SPATIAL_EXPORT AABBTree {
+public:
+  static constexpr uint32_t NullProxy = std::numeric_limits<uint32_t>::max();
+  /** The number of proxies above which rebuild() builds subtrees in parallel. */
+  static constexpr size_t ParallelBuildThreshold = 4096;
+
+private:
+  struct Node {
+    /** The fat box of a leaf, or the union of the boxes of an inner node's children. */
+    AABB box{};
+    uint64_t value = 0;
+    /** The parent of the node, or the next free node when the node is free. */
+    uint32_t parent = NullProxy;
+    uint32_t left = NullProxy;
+    uint32_t right = NullProxy;
+    /** 0 for leaves, -1 for free nodes. */
+    int32_t height = -1;
+    
+    [[nodiscard]] bool isLeaf() const { return left == NullProxy; }
+  };
+  
+  std::vector<Node> mNodes{};
+  uint32_t mRoot = NullProxy;
+  uint32_t mFreeList = NullProxy;
+  size_t mProxyCount = 0;
+  decimal_t mMargin;
+
+public:
+  /**
+   * @param margin - The distance by which the boxes of the leaves are grown on every side.
+   */
+  explicit AABBTree(decimal_t margin = 0.1) : mMargin(margin) {}
+  
+  /**
+   * @brief Adds a proxy to the tree.
+   * @param box - The box of the proxy.
+   * @param value - A user value returned by getValue().
+   * @param link - false to only store the proxy. It is not visible to queries until the next rebuild().
+   * @return The proxy id, which is stable until the proxy is removed.
+   */
+  uint32_t insert(const AABB& box, uint64_t value, bool link = true);
+  
+  /**
+   * @brief Removes a proxy from the tree.
+   */
+  void remove(uint32_t proxy);
+  
+  /**
+   * @brief Updates the box of a proxy.
+   * @param proxy - The proxy id.
+   * @param box - The new box.
+   * @param link - false to only store the box. The proxy is not visible to queries until the next rebuild().
+   * @return true if the proxy left its fat box and was moved in the tree.
+   */
+  bool move(uint32_t proxy, const AABB& box, bool link = true);
+  
+  /**
+   * @brief Rebuilds the whole tree from its proxies, including those stored without linking them.
+   */
+  void rebuild();
+  
+  /**
+   * @brief Removes every proxy.
+   */
+  void clear();
+  
+  /**
+   * @brief Gets the user value of a proxy.
+   */
+  [[nodiscard]] uint64_t getValue(uint32_t proxy) const { return mNodes[proxy].value; }
+  
+  /**
+   * @brief Gets the fat box of a proxy.
+   */
+  [[nodiscard]] const AABB& getFatBox(uint32_t proxy) const { return mNodes[proxy].box; }
+  
+  /**
+   * @brief Gets the number of proxies.
+   */
+  [[nodiscard]] size_t size() const { return mProxyCount; }
+  
+  /**
+   * @brief Gets the height of the tree, 0 for a single proxy. Used to check the balance of the tree.
+   */
+  [[nodiscard]] int32_t height() const { return mRoot == NullProxy ? 0 : mNodes[mRoot].height; }
+  
+  /**
+   * @brief Calls a function with every proxy whose fat box intersects a box.
+   * @param box - The box.
+   * @param fn - The function to call. It receives the proxy id.
+   */
+  template<typename TFunc>
+  void query(const AABB& box, TFunc&& fn) const {
+    traverse([&box](const AABB& nodeBox) { return nodeBox.intersects(box); }, fn);
+  }
+  
+  /**
+   * @brief Calls a function with every proxy whose fat box intersects a sphere.
+   * @param center - The center of the sphere.
+   * @param radius - The radius of the sphere.
+   * @param fn - The function to call. It receives the proxy id.
+   */
+  template<typename TFunc>
+  void query(const Vec3<decimal_t>& center, decimal_t radius, TFunc&& fn) const {
+    traverse([&center, radius](const AABB& nodeBox) { return nodeBox.intersects(center, radius); }, fn);
+  }
+  
+  /**
+   * @brief Calls a function with every proxy whose fat box is at least partially inside a frustum.
+   * @param frustum - The frustum.
+   * @param fn - The function to call. It receives the proxy id.
+   */
+  template<typename TFunc>
+  void query(const Frustum& frustum, TFunc&& fn) const {
+    traverse([&frustum](const AABB& nodeBox) { return frustum.intersects(nodeBox); }, fn);
+  }
+  
+  /**
+   * @brief Calls a function with the proxies whose fat box is hit by a ray.
+   * @details The function returns the new length of the ray: returning the distance of an exact hit clips the ray so
+   * that only closer proxies are reported afterwards, returning maxDistance reports every proxy on the ray, and
+   * returning 0 stops the query.
+   * @param ray - The ray.
+   * @param maxDistance - The length of the ray.
+   * @param fn - The function to call. It receives the proxy id and the distance at which the ray enters its fat box,
+   * and returns a decimal_t.
+   */
+  template<typename TFunc>
+  void raycast(const Ray& ray, decimal_t maxDistance, TFunc&& fn) const {
+    if (mRoot == NullProxy)
+      return;
+    auto inverseDirection = ray.inverseDirection();
+    uint32_t stack[MaxDepth];
+    size_t count = 0;
+    stack[count++] = mRoot;
+    decimal_t distance;
+    while (count > 0 && maxDistance > 0) {
+      auto index = stack[--count];
+      auto& node = mNodes[index];
+      if (!ray.intersects(node.box, inverseDirection, maxDistance, distance))
+        continue;
+      if (node.isLeaf()) {
+        maxDistance = fn(index, distance);
+      } else {
+        stack[count++] = node.left;
+        stack[count++] = node.right;
+      }
+    }
+  }
+
+private:
+  /** Deeper than any tree balanced by rotations or built by rebuild() can get. */
+  static constexpr size_t MaxDepth = 128;
+  
+  template<typename TTest, typename TFunc>
+  void traverse(TTest&& test, TFunc& fn) const {
+    if (mRoot == NullProxy)
+      return;
+    uint32_t stack[MaxDepth];
+    size_t count = 0;
+    stack[count++] = mRoot;
+    while (count > 0) {
+      auto index = stack[--count];
+      auto& node = mNodes[index];
+      if (!test(node.box))
+        continue;
+      if (node.isLeaf()) {
+        fn(index);
+      } else {
+        stack[count++] = node.left;
+        stack[count++] = node.right;
+      }
+    }
+  }
+  
+  uint32_t allocateNode();
+  
+  void freeNode(uint32_t node);
+  
+  void insertLeaf(uint32_t leaf);
+  
+  void removeLeaf(uint32_t leaf);
+  
+  /** Restores the box and height of the ancestors of a node, rotating where they are unbalanced. */
+  void refitAncestors(uint32_t node);
+  
+  /** Rotates a node's taller child up if its children differ in height by more than one. Returns the subtree root. */
+  uint32_t balance(uint32_t node);
+  
+  /**
+   * Builds the subtree of a range of leaves and returns its root. The subtree of n leaves uses the n - 1 inner nodes
+   * listed in inner, so that subtrees can be built concurrently without allocating.
+   */
+  uint32_t build(std::span<uint32_t> leaves, std::span<const uint32_t> inner, uint32_t parent);
+};
+
+} // ams
@@ -0,0 +1,277 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+/*[exclude begin]*/
+#pragma once
+#include "Vec.hpp"
+#include "Matrix/Matrix4.hpp"
+/*[exclude end]*/
+/*[ignore begin]*/
+#include "ams_spatial_export.hpp"
+/*[ignore end]*/
+/*[export module ams.spatial.Bounds]*/
+#include <algorithm>
+#include <cmath>
+#include <limits>
+/*[import ams]*/
+/*[import ams.spatial.Vec]*/
+/*[import ams.spatial.Matrix4]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief An axis aligned bounding box, given by its minimum and maximum corners.
+ * @details A box whose minimum is greater than its maximum on any axis is empty. The default box is empty, so that
+ * merging points into it grows it from nothing.
+ */
+struct AABB {
+  Vec3<decimal_t> min{std::numeric_limits<decimal_t>::max()};
+  Vec3<decimal_t> max{std::numeric_limits<decimal_t>::lowest()};
+  
+  constexpr AABB() = default;
+  
+  constexpr AABB(const Vec3<decimal_t>& min, const Vec3<decimal_t>& max) : min(min), max(max) {}
+  
+  /**
+   * @brief Creates a box from its center and its half size along each axis.
+   */
+  static constexpr AABB fromCenter(const Vec3<decimal_t>& center, const Vec3<decimal_t>& extents) {
+    return {center - extents, center + extents};
+  }
+  
+  /**
+   * @brief Gets the smallest box which contains two boxes.
+   */
+  static constexpr AABB merge(const AABB& a, const AABB& b) {
+    return {{std::min(a.min.x, b.min.x), std::min(a.min.y, b.min.y), std::min(a.min.z, b.min.z)},
+            {std::max(a.max.x, b.max.x), std::max(a.max.y, b.max.y), std::max(a.max.z, b.max.z)}};
+  }
+  
+  [[nodiscard]] constexpr bool empty() const { return min.x > max.x || min.y > max.y || min.z > max.z; }
+  
+  [[nodiscard]] constexpr Vec3<decimal_t> center() const { return (min + max) * 0.5; }
+  
+  /**
+   * @brief Gets the half size of the box along each axis.
+   */
+  [[nodiscard]] constexpr Vec3<decimal_t> extents() const { return (max - min) * 0.5; }
+  
+  /**
+   * @brief Gets the surface area of the box, the cost metric of bounding volume hierarchies.
+   */
+  [[nodiscard]] constexpr decimal_t surfaceArea() const {
+    auto d = max - min;
+    return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+  }
+  
+  /**
+   * @brief Grows the box to contain a point.
+   */
+  constexpr AABB& expand(const Vec3<decimal_t>& point) {
+    min = {std::min(min.x, point.x), std::min(min.y, point.y), std::min(min.z, point.z)};
+    max = {std::max(max.x, point.x), std::max(max.y, point.y), std::max(max.z, point.z)};
+    return *this;
+  }
+  
+  /**
+   * @brief Gets the box grown by a margin on every side.
+   */
+  [[nodiscard]] constexpr AABB inflated(decimal_t margin) const {
+    return {min - margin, max + margin};
+  }
+  
+  [[nodiscard]] constexpr bool contains(const Vec3<decimal_t>& point) const {
+    return point.x >= min.x && point.x <= max.x && point.y >= min.y && point.y <= max.y &&
+           point.z >= min.z && point.z <= max.z;
+  }
+  
+  [[nodiscard]] constexpr bool contains(const AABB& other) const {
+    return other.min.x >= min.x && other.max.x <= max.x && other.min.y >= min.y && other.max.y <= max.y &&
+           other.min.z >= min.z && other.max.z <= max.z;
+  }
+  
+  [[nodiscard]] constexpr bool intersects(const AABB& other) const {
+    return other.min.x <= max.x && other.max.x >= min.x && other.min.y <= max.y && other.max.y >= min.y &&
+           other.min.z <= max.z && other.max.z >= min.z;
+  }
+  
+  /**
+   * @brief Gets the squared distance from a point to the box, which is 0 for points inside the box.
+   */
+  [[nodiscard]] constexpr decimal_t distanceSquared(const Vec3<decimal_t>& point) const {
+    auto dx = std::max({min.x - point.x, decimal_t(0), point.x - max.x});
+    auto dy = std::max({min.y - point.y, decimal_t(0), point.y - max.y});
+    auto dz = std::max({min.z - point.z, decimal_t(0), point.z - max.z});
+    return dx * dx + dy * dy + dz * dz;
+  }
+  
+  /**
+   * @brief Tests if the box intersects a sphere.
+   */
+  [[nodiscard]] constexpr bool intersects(const Vec3<decimal_t>& center, decimal_t radius) const {
+    return distanceSquared(center) <= radius * radius;
+  }
+  
+  /**
+   * @brief Gets the box which contains this box once transformed by a matrix.
+   * @details The matrix transforms row vectors, with the translation in its last row, like the world matrices of a
+   * ams::Transform. The result is exact for the corners of the box.
+   * @param matrix - The affine transform.
+   */
+  [[nodiscard]] constexpr AABB transformed(const Matrix4& matrix) const {
+    // the center is transformed as a point, and each extent spreads over the absolute values of the rotation
+    auto c = center();
+    auto e = extents();
+    decimal_t center[3]{}, extents[3]{};
+    for (int i = 0; i < 4; ++i) {
+      auto row = matrix[i];
+      for (int j = 0; j < 3; ++j) {
+        if (i == 3) {
+          center[j] += row[j];
+          continue;
+        }
+        center[j] += c[i] * row[j];
+        extents[j] += e[i] * (row[j] < 0 ? -row[j] : row[j]);
+      }
+    }
+    return fromCenter({center[0], center[1], center[2]}, {extents[0], extents[1], extents[2]});
+  }
+  
+  bool operator==(const AABB& other) const { return min == other.min && max == other.max; }
+};
+
+/**
+ * @brief A half line, given by its origin and its direction.
+ */
+struct Ray {
+  Vec3<decimal_t> origin{};
+  /** The direction of the ray. Distances along the ray are measured in multiples of its length. */
+  Vec3<decimal_t> direction{0, 0, 1};
+  
+  /**
+   * @brief Gets the point at a distance along the ray.
+   */
+  [[nodiscard]] constexpr Vec3<decimal_t> at(decimal_t distance) const { return origin + direction * distance; }
+  
+  /**
+   * @brief Intersects the ray with a box using the slab method.
+   * @param box - The box.
+   * @param inverseDirection - 1 / direction, per component. Precomputed when one ray is tested against many boxes.
+   * @param maxDistance - The length of the ray segment to test.
+   * @param distance - Receives the distance at which the ray enters the box, or 0 if its origin is inside the box.
+   * @return true if the segment hits the box.
+   */
+  [[nodiscard]] constexpr bool intersects(const AABB& box, const Vec3<decimal_t>& inverseDirection,
+                                          decimal_t maxDistance, decimal_t& distance) const {
+    decimal_t tMin = 0, tMax = maxDistance;
+    for (int i = 0; i < 3; ++i) {
+      auto t0 = (box.min[i] - origin[i]) * inverseDirection[i];
+      auto t1 = (box.max[i] - origin[i]) * inverseDirection[i];
+      if (t0 > t1)
+        std::swap(t0, t1);
+      // written so that a NaN, from a ray parallel to and touching a slab, keeps the current interval
+      tMin = t0 > tMin ? t0 : tMin;
+      tMax = t1 < tMax ? t1 : tMax;
+      if (tMin > tMax)
+        return false;
+    }
+    distance = tMin;
+    return true;
+  }
+  
+  /**
+   * @brief Gets 1 / direction, per component, for intersects().
+   */
+  [[nodiscard]] constexpr Vec3<decimal_t> inverseDirection() const {
+    return {1 / direction.x, 1 / direction.y, 1 / direction.z};
+  }
+};
+
+/**
+ * @brief A plane given by its unit normal and its signed distance, so that dot(normal, p) + distance is the signed
+ * distance of a point p to the plane.
+ */
+struct Plane {
+  Vec3<decimal_t> normal{0, 1, 0};
+  decimal_t distance = 0;
+  
+  [[nodiscard]] constexpr decimal_t signedDistance(const Vec3<decimal_t>& point) const {
+    return normal.x * point.x + normal.y * point.y + normal.z * point.z + distance;
+  }
+};
+
+/**
+ * @brief The six planes which bound the volume seen by a camera. Each plane faces into the volume.
+ */
+struct Frustum {
+  Plane planes[6]{};
+  
+  /**
+   * @brief Extracts the planes of a view projection matrix.
+   * @details The matrix transforms row vectors, so a point p is projected to p * matrix, and the volume is the one
+   * whose clip coordinates satisfy -w <= x, y, z <= w.
+   * @param matrix - The view projection matrix.
+   */
+  static Frustum fromMatrix(const Matrix4& matrix) {
+    Frustum frustum;
+    auto column = [&](int j) {
+      return Vec4<decimal_t>(matrix[0][j], matrix[1][j], matrix[2][j], matrix[3][j]);
+    };
+    auto w = column(3);
+    for (int axis = 0; axis < 3; ++axis) {
+      auto c = column(axis);
+      frustum.planes[axis * 2] = makePlane(w + c);
+      frustum.planes[axis * 2 + 1] = makePlane(w - c);
+    }
+    return frustum;
+  }
+  
+  /**
+   * @brief Tests if a box is at least partially inside the frustum. The test is conservative: a box near a corner of
+   * the frustum may be reported as intersecting although it is outside.
+   */
+  [[nodiscard]] constexpr bool intersects(const AABB& box) const {
+    for (auto& plane : planes) {
+      // the corner of the box furthest along the plane normal
+      Vec3<decimal_t> corner(plane.normal.x >= 0 ? box.max.x : box.min.x,
+                             plane.normal.y >= 0 ? box.max.y : box.min.y,
+                             plane.normal.z >= 0 ? box.max.z : box.min.z);
+      if (plane.signedDistance(corner) < 0)
+        return false;
+    }
+    return true;
+  }
+  
+  /**
+   * @brief Tests if a sphere is at least partially inside the frustum.
+   */
+  [[nodiscard]] constexpr bool intersects(const Vec3<decimal_t>& center, decimal_t radius) const {
+    for (auto& plane : planes) {
+      if (plane.signedDistance(center) < -radius)
+        return false;
+    }
+    return true;
+  }
+
+private:
+  static Plane makePlane(const Vec4<decimal_t>& v) {
+    auto length = std::sqrt(v.x * v.x + v.y * v.y + v.z * v.z);
+    return {{v.x / length, v.y / length, v.z / length}, v.w / length};
+  }
+};
+
+} // ams
@@ -22,20 +22,24 @@
 #include "Matrix/Matrix2.hpp"
 #include "Matrix/Matrix3.hpp"
 #include "Matrix/Matrix4.hpp"
+#include "Matrix/PackedMatrix.hpp"
 /*[exclude end]*/
 /*[ignore begin]*/
 #include <concepts>
 #include <stdexcept>
+#include <type_traits>
 #include "ams_spatial_export.hpp"
 /*[ignore end]*/
 /*[export module ams.spatial.Matrix]*/
 /*[import ams]*/
 /*[import ams.Array]*/
 /*[import ams.spatial.internal]*/
+/*[import ams.spatial.internal.simd]*/
 /*[import ams.spatial.Vec]*/
 /*[export import ams.spatial.Matrix2]*/
 /*[export import ams.spatial.Matrix3]*/
 /*[export import ams.spatial.Matrix4]*/
+/*[export import ams.spatial.PackedMatrix]*/
 
 /*[export]*/namespace ams {
 
@@ -185,7 +189,7 @@ constexpr Vec4<decimal_t> toQuaternion(const Matrix3& mat) {
   decimal_t trace = mat(0, 0) + mat(1, 1) + mat(2, 2);
   if (trace > 0) {
     decimal_t s = 0.5 / sqrt(trace + 1.0);
-    return {s * (mat(2, 1) - mat(1, 2)), s * (mat(0, 2) - mat(2, 0)), s * (mat(1, 0) - mat(0, 1)), 0.25 / s};
+    return {s * (mat(2, 1) - mat(1, 2)), s * (mat(0, 2) - mat(2, 0)), s * (mat(1, 0) - mat(0, 1)), decimal_t(0.25) / s};
   } else if (mat(0, 0) > mat(1, 1) && mat(0, 0) > mat(2, 2)) {
     decimal_t s = 2.0 * sqrt(1.0 + mat(0, 0) - mat(1, 1) - mat(2, 2));
     return {(mat(2, 1) - mat(1, 2)) / s, (mat(0, 1) + mat(1, 0)) / s, (mat(0, 2) + mat(2, 0)) / s,
@@ -974,7 +978,7 @@ constexpr bool inverse(Matrix3& mat) {
  */
 [[maybe_unused]]
 constexpr bool inverse(Matrix4& mat) {
-  decimal_t det = determinant(mat);
+  decimal_t det = std::is_constant_evaluated() ? determinant(mat) : simd::inverse4x4(mat.data(), mat.data());
   if (det == 0) {
     if (AMSExceptions)
       throw std::domain_error("Matrix4 is singular");
@@ -983,7 +987,8 @@ constexpr bool inverse(Matrix4& mat) {
       return false;
     }
   }
-  mat = adjoint(mat) / det;
+  if (std::is_constant_evaluated())
+    mat = adjoint(mat) / det;
   return true;
 }
 
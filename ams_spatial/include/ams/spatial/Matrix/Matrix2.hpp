@@ -50,8 +50,11 @@ struct Matrix4;
  * @brief A 2x2 matrix. This is a row-major matrix.
  */
 struct AMS_SPATIAL_EXPORT Matrix2 {
+public:
+  /** A row of the matrix. */
+  using row_t = decimal_t[2];
 protected:
-  Array<Array<decimal_t, 2>, 2> m{0};
+  alignas(4 * sizeof(decimal_t)) decimal_t m[2][2]{0};
 public:
   /**
    * @brief Construct a new Matrix2 object.
@@ -108,21 +111,46 @@ public:
   constexpr Matrix2(const V2T& row1, const V2T& row2)
     : m{row1.x, row1.y, row2.x, row2.y} {}
 
-  constexpr Array<decimal_t, 2>& operator[](int i) {
+  /**
+   * @brief Gets a row. The index is not checked.
+   */
+  constexpr row_t& operator[](int i) {
     return m[i];
   }
 
-  constexpr const Array<decimal_t, 2>& operator[](int i) const {
+  constexpr const row_t& operator[](int i) const {
     return m[i];
   }
 
+  /**
+   * @brief Gets the element at row i, column j. The indices are not checked.
+   */
+  constexpr decimal_t& operator()(int i, int j) {
+    return m[i][j];
+  }
+
   constexpr decimal_t operator()(int i, int j) const {
+    return m[i][j];
+  }
+
+  /**
+   * @brief Gets the element at row i, column j.
+   * @throws std::out_of_range if AMS_EXCEPTIONS is defined and an index is out of range.
+   */
+  [[nodiscard]] constexpr decimal_t at(int i, int j) const {
     if constexpr (AMSExceptions)
       if (i < 0 || i > 1 || j < 0 || j > 1)
         throw std::out_of_range("Matrix2 index out of range");
     return m[i][j];
   }
 
+  /**
+   * @brief Gets the 4 elements of the matrix, row after row.
+   */
+  [[nodiscard]] constexpr decimal_t* data() { return &m[0][0]; }
+
+  [[nodiscard]] constexpr const decimal_t* data() const { return &m[0][0]; }
+
   constexpr Matrix2& operator=(const Matrix2& other) = default;
 
   constexpr Matrix2& operator=(Matrix2&& other) noexcept = default;
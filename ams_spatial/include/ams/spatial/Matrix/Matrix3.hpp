@@ -56,8 +56,11 @@ struct Matrix4;
  * @brief a row-major 3x3 Matrix. Y is up, X is right, and Z is forward.
  */
 struct AMS_SPATIAL_EXPORT Matrix3 {
+public:
+  /** A row of the matrix. */
+  using row_t = decimal_t[3];
 protected:
-  Array<Array<decimal_t, 3>, 3> m{0};
+  alignas(16) decimal_t m[3][3]{0};
 public:
   /**
    * @brief Construct a new Matrix3 object
@@ -109,18 +112,46 @@ public:
   
   constexpr explicit Matrix3(const Quaternion& q);
 
-  constexpr Array<decimal_t, 3>& operator[](int i) {
+  /**
+   * @brief Gets a row. The index is not checked.
+   */
+  constexpr row_t& operator[](int i) {
     return m[i];
   }
 
-  constexpr Array<decimal_t, 3> operator[](int i) const {
+  constexpr const row_t& operator[](int i) const {
     return m[i];
   }
 
+  /**
+   * @brief Gets the element at row i, column j. The indices are not checked.
+   */
+  constexpr decimal_t& operator()(int i, int j) {
+    return m[i][j];
+  }
+
   constexpr decimal_t operator()(int i, int j) const {
     return m[i][j];
   }
 
+  /**
+   * @brief Gets the element at row i, column j.
+   * @throws std::out_of_range if AMS_EXCEPTIONS is defined and an index is out of range.
+   */
+  [[nodiscard]] constexpr decimal_t at(int i, int j) const {
+    if constexpr (AMSExceptions)
+      if (i < 0 || i > 2 || j < 0 || j > 2)
+        throw std::out_of_range("Matrix3 index out of range");
+    return m[i][j];
+  }
+
+  /**
+   * @brief Gets the 9 elements of the matrix, row after row.
+   */
+  [[nodiscard]] constexpr decimal_t* data() { return &m[0][0]; }
+
+  [[nodiscard]] constexpr const decimal_t* data() const { return &m[0][0]; }
+
   constexpr Matrix3& operator=(const Matrix3& m) = default;
 
   constexpr Matrix3& operator=(Matrix3&& m) noexcept = default;
@@ -20,6 +20,7 @@
 #include <ams/Array.hpp>
 #include "ams_spatial_export.hpp"
 #include "../Vec.hpp"
+#include "../internal/simd.hpp"
 /*[exclude end]*/
 /*[ignore begin]*/
 #include "ams_spatial_export.hpp"
@@ -28,9 +29,11 @@
 /*[export module ams.spatial.Matrix4]*/
 /*[import <concepts>]*/
 /*[import <stdexcept>]*/
+/*[import <type_traits>]*/
 /*[import ams]*/
 /*[import ams.Array]*/
 /*[import ams.spatial.internal]*/
+/*[import ams.spatial.internal.simd]*/
 /*[import ams.spatial.Vec]*/
 
 /*[export]*/ namespace ams {
@@ -61,10 +64,15 @@ struct Matrix3;
 
 /**
  * @brief 4x4 matrix. This is a row-major matrix.
+ * @details Products, vector transforms and inversion run on the 4-wide kernels of ams::simd at run time, and fall back
+ * to plain loops in constant expressions.
  */
 struct AMS_SPATIAL_EXPORT Matrix4 {
+public:
+  /** A row of the matrix. */
+  using row_t = decimal_t[4];
 protected:
-  Array<Array<decimal_t, 4>, 4> m{0};
+  alignas(32) decimal_t m[4][4]{0};
 public:
   constexpr Matrix4() = default;
 
@@ -113,24 +121,56 @@ public:
     return {m[0][i], m[1][i], m[2][i], m[3][i]};
   }
 
-  constexpr Array<decimal_t, 4>& operator[](int i) {
+  /**
+   * @brief Gets a row. The index is not checked.
+   */
+  constexpr row_t& operator[](int i) {
     return m[i];
   }
 
-  constexpr Array<decimal_t, 4> operator[](int i) const {
+  constexpr const row_t& operator[](int i) const {
     return m[i];
   }
 
+  /**
+   * @brief Gets the element at row i, column j. The indices are not checked.
+   */
+  constexpr decimal_t& operator()(int i, int j) {
+    return m[i][j];
+  }
+
   constexpr decimal_t operator()(int i, int j) const {
     return m[i][j];
   }
 
+  /**
+   * @brief Gets the element at row i, column j.
+   * @throws std::out_of_range if AMS_EXCEPTIONS is defined and an index is out of range.
+   */
+  [[nodiscard]] constexpr decimal_t at(int i, int j) const {
+    if constexpr (AMSExceptions)
+      if (i < 0 || i > 3 || j < 0 || j > 3)
+        throw std::out_of_range("Matrix4 index out of range");
+    return m[i][j];
+  }
+
+  /**
+   * @brief Gets the 16 elements of the matrix, row after row.
+   */
+  [[nodiscard]] constexpr decimal_t* data() { return &m[0][0]; }
+
+  [[nodiscard]] constexpr const decimal_t* data() const { return &m[0][0]; }
+
   constexpr Matrix4& operator=(const Matrix4& m) = default;
 
   constexpr Matrix4& operator=(Matrix4&& m) noexcept = default;
 
   constexpr Matrix4 operator*(const Matrix4& other) const {
     Matrix4 result;
+    if (!std::is_constant_evaluated()) {
+      simd::mul4x4(data(), other.data(), result.data());
+      return result;
+    }
     for (int i = 0; i < 4; i++) {
       for (int j = 0; j < 4; j++) {
         result.m[i][j] = this->m[i][0] * other.m[0][j] +
@@ -170,6 +210,12 @@ public:
 
   constexpr Matrix4 operator*(decimal_t scalar) const {
     Matrix4 result;
+    if (!std::is_constant_evaluated()) {
+      const auto s = simd::Pack4<decimal_t>::broadcast(scalar);
+      for (int i = 0; i < 4; i++)
+        (simd::Pack4<decimal_t>::load(m[i]) * s).store(result.m[i]);
+      return result;
+    }
     for (int i = 0; i < 4; i++) {
       for (int j = 0; j < 4; j++) {
         result.m[i][j] = this->m[i][j] * scalar;
@@ -250,6 +296,11 @@ public:
   }
 
   constexpr friend Vec4<decimal_t> operator*(const Vec4<decimal_t>& v4, const Matrix4& mat) {
+    if (!std::is_constant_evaluated()) {
+      Vec4<decimal_t> ret;
+      simd::transform4(&v4.x, mat.data(), &ret.x);
+      return ret;
+    }
     return {dot<decimal_t>(v4, mat.col(0)), dot<decimal_t>(v4, mat.col(1)), dot<decimal_t>(v4, mat.col(2)),
             dot<decimal_t>(v4, mat.col(3))};
   }
@@ -0,0 +1,111 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+/*[exclude begin]*/
+#pragma once
+#include <concepts>
+#include <cstddef>
+#include "ams_spatial_export.hpp"
+/*[exclude end]*/
+/*[ignore begin]*/
+#include "ams_spatial_export.hpp"
+/*[ignore end]*/
+/*[export module ams.spatial.PackedMatrix]*/
+/*[import <concepts>]*/
+/*[import <cstddef>]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief The order in which the elements of a matrix are laid out in memory.
+ */
+enum class StorageOrder {
+  /** Each row is contiguous. This is the layout of ams::Matrix2, ams::Matrix3 and ams::Matrix4. */
+  RowMajor,
+  /** Each column is contiguous. This is the layout of glm matrices. */
+  ColumnMajor
+};
+
+/**
+ * @brief A square matrix packed into flat, aligned storage in a chosen storage order.
+ * @details PackedMatrix is a transfer type: it is built from an ams::Matrix2, ams::Matrix3 or ams::Matrix4 (or any
+ * type with an operator()(row, col)) and copies its elements into a flat array, without padding, in the storage order.
+ * Elements are always addressed as (row, col), whatever the storage order.
+ * @tparam T - The element type.
+ * @tparam N - The number of rows and columns.
+ * @tparam TOrder - The storage order of the elements.
+ */
+template<typename T, size_t N, StorageOrder TOrder = StorageOrder::ColumnMajor>
+struct alignas(N * N * sizeof(T) >= 32 ? 32 : 16) PackedMatrix {
+  T elements[N * N]{};
+
+  constexpr PackedMatrix() = default;
+
+  /**
+   * @brief Packs a matrix.
+   * @tparam TMatrix - A matrix type with an operator()(row, col).
+   * @param matrix - The matrix to pack.
+   */
+  template<typename TMatrix>
+  requires requires(const TMatrix& mat) { { mat(0, 0) } -> std::convertible_to<T>; }
+  constexpr explicit PackedMatrix(const TMatrix& matrix) {
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = 0; j < N; j++)
+        elements[index(i, j)] = static_cast<T>(matrix(static_cast<int>(i), static_cast<int>(j)));
+  }
+
+  /**
+   * @brief Gets the offset of an element in data().
+   * @param row - The row of the element.
+   * @param col - The column of the element.
+   */
+  [[nodiscard]] static constexpr size_t index(size_t row, size_t col) {
+    if constexpr (TOrder == StorageOrder::RowMajor)
+      return row * N + col;
+    else
+      return col * N + row;
+  }
+
+  constexpr T& operator()(size_t row, size_t col) { return elements[index(row, col)]; }
+
+  constexpr T operator()(size_t row, size_t col) const { return elements[index(row, col)]; }
+
+  /**
+   * @brief Unpacks the matrix.
+   * @tparam TMatrix - A matrix type default-constructible and with a mutable operator[][].
+   */
+  template<typename TMatrix>
+  [[nodiscard]] constexpr TMatrix unpack() const {
+    TMatrix matrix;
+    for (size_t i = 0; i < N; i++)
+      for (size_t j = 0; j < N; j++)
+        matrix[static_cast<int>(i)][j] = elements[index(i, j)];
+    return matrix;
+  }
+
+  [[nodiscard]] constexpr T* data() { return elements; }
+
+  [[nodiscard]] constexpr const T* data() const { return elements; }
+
+  [[nodiscard]] static constexpr size_t size() { return N * N; }
+
+  [[nodiscard]] static constexpr size_t sizeBytes() { return N * N * sizeof(T); }
+
+  constexpr bool operator==(const PackedMatrix& other) const = default;
+};
+
+} // ams
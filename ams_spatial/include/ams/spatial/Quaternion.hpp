@@ -18,13 +18,16 @@
 /*[exclude begin]*/
 #pragma once
 #include "Vec.hpp"
+#include "internal/simd.hpp"
 /*[exclude end]*/
 /*[ignore begin]*/
 #include "ams_spatial_export.hpp"
 /*[ignore end]*/
 /*[export module ams.spatial.Quaternion]*/
 #include <cstdlib>
+#include <type_traits>
 /*[import ams]*/
+/*[import ams.spatial.internal.simd]*/
 /*[import ams.spatial.Vec]*/
 
 namespace ams {
@@ -95,6 +98,11 @@ public:
   }
 
   constexpr Quaternion operator*(const Quaternion& q) const {
+    if (!std::is_constant_evaluated()) {
+      Quaternion ret;
+      simd::quatMul4(&this->x, &q.x, &ret.x);
+      return ret;
+    }
     return {
       this->w * q.x + this->x * q.w + this->y * q.z - this->z * q.y,
       this->w * q.y - this->x * q.z + this->y * q.w + this->z * q.x,
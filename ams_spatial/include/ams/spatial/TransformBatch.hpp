@@ -0,0 +1,115 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+/*[exclude begin]*/
+#pragma once
+#include "Vec.hpp"
+#include "Quaternion.hpp"
+#include "Matrix/Matrix4.hpp"
+/*[exclude end]*/
+/*[ignore begin]*/
+#include "ams_spatial_export.hpp"
+/*[ignore end]*/
+/*[export module ams.spatial.TransformBatch]*/
+#include <initializer_list>
+#include <span>
+#include <vector>
+/*[import ams]*/
+/*[import ams.spatial.Vec]*/
+/*[import ams.spatial.Quaternion]*/
+/*[import ams.spatial.Matrix4]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief A batch of positions, rotations and scales stored as structure of arrays.
+ * @details Each component of each vector is stored in its own contiguous array, so that the SIMD kernels can load the
+ * same component of several transforms at once. See ams::composeTRS().
+ */
+class AMS_SPATIAL_EXPORT TransformBatch {
+private:
+  std::vector<decimal_t> mPositionX{}, mPositionY{}, mPositionZ{};
+  std::vector<decimal_t> mRotationX{}, mRotationY{}, mRotationZ{}, mRotationW{};
+  std::vector<decimal_t> mScaleX{}, mScaleY{}, mScaleZ{};
+
+public:
+  TransformBatch() = default;
+  
+  /**
+   * @brief Appends a transform to the batch.
+   * @param position - The translation.
+   * @param rotation - The rotation. It should be normalized.
+   * @param scale - The scale along each axis.
+   */
+  void push_back(const Vec3<decimal_t>& position, const Quaternion& rotation, const Vec3<decimal_t>& scale) {
+    mPositionX.push_back(position.x);
+    mPositionY.push_back(position.y);
+    mPositionZ.push_back(position.z);
+    mRotationX.push_back(rotation.x);
+    mRotationY.push_back(rotation.y);
+    mRotationZ.push_back(rotation.z);
+    mRotationW.push_back(rotation.w);
+    mScaleX.push_back(scale.x);
+    mScaleY.push_back(scale.y);
+    mScaleZ.push_back(scale.z);
+  }
+  
+  /**
+   * @brief Reserves space for a number of transforms.
+   */
+  void reserve(size_t size) {
+    forEachArray([size](auto& array) { array.reserve(size); });
+  }
+  
+  /**
+   * @brief Removes every transform from the batch.
+   */
+  void clear() {
+    forEachArray([](auto& array) { array.clear(); });
+  }
+  
+  /**
+   * @brief Gets the number of transforms in the batch.
+   */
+  [[nodiscard]] size_t size() const { return mPositionX.size(); }
+  
+  [[nodiscard]] bool empty() const { return mPositionX.empty(); }
+
+private:
+  template<typename TFunc>
+  void forEachArray(TFunc&& fn) {
+    for (auto* array : {&mPositionX, &mPositionY, &mPositionZ, &mRotationX, &mRotationY, &mRotationZ, &mRotationW,
+                        &mScaleX, &mScaleY, &mScaleZ})
+      fn(*array);
+  }
+
+  friend AMS_SPATIAL_EXPORT void composeTRS(const TransformBatch& batch, std::span<Matrix4> out);
+};
+
+/**
+ * @brief Builds the model matrix of every transform in a batch.
+ * @details Each matrix is the same as the one built by Matrix4::identity() followed by Matrix4::scale(),
+ * Matrix4::rotate() and Matrix4::translate(): the rows of the rotation are scaled by the scale, and the translation
+ * is stored in the last row. In double precision, the transforms are processed four at a time with AVX, two at a time
+ * with SSE2, or one at a time otherwise. AVX is used when AMS_ENABLE_AVX2 is on, which builds this function, and
+ * nothing else, for AVX2. In single precision (AMS_DECIMAL_FLOAT), they are processed four at a time with SSE.
+ * @param batch - The transforms.
+ * @param out - Receives one matrix per transform. Must hold at least batch.size() matrices.
+ */
+AMS_SPATIAL_EXPORT void composeTRS(const TransformBatch& batch, std::span<Matrix4> out);
+
+} // ams
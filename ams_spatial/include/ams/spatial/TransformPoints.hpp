@@ -0,0 +1,99 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+/*[exclude begin]*/
+#pragma once
+#include "Vec.hpp"
+#include "Matrix/Matrix4.hpp"
+/*[exclude end]*/
+/*[ignore begin]*/
+#include "ams_spatial_export.hpp"
+/*[ignore end]*/
+/*[export module ams.spatial.TransformPoints]*/
+#include <cstddef>
+#include <span>
+/*[import ams]*/
+/*[import ams.spatial.Vec]*/
+/*[import ams.spatial.Matrix4]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief The number of elements from which the batch transforms below split their work across the ams::JobSystem.
+ * Smaller batches run on the calling thread.
+ */
+inline constexpr size_t ParallelTransformThreshold = 32768;
+
+/**
+ * @brief The number of elements transformed by each job of a parallel batch transform.
+ */
+inline constexpr size_t ParallelTransformGrainSize = 8192;
+
+/**
+ * @brief Transforms points by a matrix, with w = 1.
+ * @details This is the same as multiplying Vec4(point, 1) by the matrix and dropping w, so the translation stored in
+ * the last row of the matrix is applied. Each point is transformed in one 4-wide ams::simd pack, and
+ * batches of at least ams::ParallelTransformThreshold points are split across the ams::JobSystem. out may be the same
+ * span as points, but the two must not partially overlap.
+ * @param points - The points to transform.
+ * @param matrix - The transform.
+ * @param out - Receives the transformed points. Must hold at least points.size() elements.
+ * @throws std::invalid_argument if AMS_EXCEPTIONS is defined and out is smaller than points. Otherwise, only the
+ * first out.size() points are transformed.
+ */
+AMS_SPATIAL_EXPORT void transformPoints(std::span<const Vec3<decimal_t>> points, const Matrix4& matrix,
+                                        std::span<Vec3<decimal_t>> out);
+
+/**
+ * @brief Transforms direction vectors by a matrix, with w = 0.
+ * @details This is the same as Vec3 * Matrix4: the translation of the matrix is ignored. See ams::transformPoints()
+ * for the threading and aliasing rules.
+ * @param vectors - The vectors to transform.
+ * @param matrix - The transform.
+ * @param out - Receives the transformed vectors. Must hold at least vectors.size() elements.
+ * @throws std::invalid_argument if AMS_EXCEPTIONS is defined and out is smaller than vectors.
+ */
+AMS_SPATIAL_EXPORT void transformVectors(std::span<const Vec3<decimal_t>> vectors, const Matrix4& matrix,
+                                         std::span<Vec3<decimal_t>> out);
+
+/**
+ * @brief Transforms surface normals by a matrix and normalizes them.
+ * @details Normals are transformed by the inverse transpose of the upper 3x3 of the matrix, so they stay perpendicular
+ * to their surface under non-uniform scale. Normals which end up with a length of 0 are left as the zero vector. See
+ * ams::transformPoints() for the threading and aliasing rules.
+ * @param normals - The normals to transform.
+ * @param matrix - The transform of the surface.
+ * @param out - Receives the transformed unit normals. Must hold at least normals.size() elements.
+ * @throws std::invalid_argument if AMS_EXCEPTIONS is defined and out is smaller than normals.
+ */
+AMS_SPATIAL_EXPORT void transformNormals(std::span<const Vec3<decimal_t>> normals, const Matrix4& matrix,
+                                         std::span<Vec3<decimal_t>> out);
+
+/**
+ * @brief Transforms points by a projective matrix and divides them by w.
+ * @details Each point is multiplied as Vec4(point, 1) and the x, y and z of the result are divided by its w. With a
+ * view-projection matrix, this gives normalized device coordinates. Points with w = 0 divide by zero. See
+ * ams::transformPoints() for the threading and aliasing rules.
+ * @param points - The points to project.
+ * @param matrix - The projective transform.
+ * @param out - Receives the projected points. Must hold at least points.size() elements.
+ * @throws std::invalid_argument if AMS_EXCEPTIONS is defined and out is smaller than points.
+ */
+AMS_SPATIAL_EXPORT void projectPoints(std::span<const Vec3<decimal_t>> points, const Matrix4& matrix,
+                                      std::span<Vec3<decimal_t>> out);
+
+} // ams
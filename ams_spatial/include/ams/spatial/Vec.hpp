@@ -33,6 +33,9 @@
 #include "Vec/Vec2.hpp"
 #include "Vec/Vec3.hpp"
 #include "Vec/Vec4.hpp"
+#include "Vec/Packet.hpp"
+#include "Vec/Vec3Packet.hpp"
+#include "Vec/QuaternionPacket.hpp"
 /*[exclude end]*/
 /*[import ams_spacial]*/
 /*[import ams]*/
@@ -40,6 +43,9 @@
 /*[export import ams.spatial.Vec2]*/
 /*[export import ams.spatial.Vec3]*/
 /*[export import ams.spatial.Vec4]*/
+/*[export import ams.spatial.Packet]*/
+/*[export import ams.spatial.Vec3Packet]*/
+/*[export import ams.spatial.QuaternionPacket]*/
 
 /*[export]*/ namespace ams {
 
@@ -0,0 +1,190 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*[exclude begin]*/
+#pragma once
+#include <ams/Math.hpp>
+#include "../internal/config.hpp"
+#include "../internal/simd.hpp"
+/*[exclude end]*/
+/*[export module ams.spatial.Packet]*/
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+/*[import ams]*/
+/*[import ams.spatial.internal]*/
+/*[import ams.spatial.internal.simd]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief N lanes of a floating point value, the scalar building block of ams::Vec3Packet and ams::QuaternionPacket.
+ * @details Every operation works lane by lane over a fixed-size aligned array, which compilers turn into vector
+ * instructions. Square roots go through the ams::simd kernels, since compilers may not vectorize std::sqrt on their
+ * own. Lane access is not bounds checked.
+ * @tparam T - any floating point type
+ * @tparam N - the number of lanes
+ */
+template<std::floating_point T, size_t N>
+struct alignas(std::min<size_t>(std::bit_ceil(N * sizeof(T)), 64)) Packet {
+  static constexpr size_t Width = N;
+  T v[N]{};
+
+  constexpr Packet() = default;
+
+  /**
+   * @brief Construct a new Packet with every lane set to the same value.
+   * @param s - the value of every lane
+   */
+  constexpr Packet(T s) {
+    for (size_t i = 0; i < N; ++i) v[i] = s;
+  }
+
+  /**
+   * @brief load N values
+   * @param p - the values, which need not be aligned
+   */
+  static constexpr Packet load(const T* p) {
+    Packet ret;
+    for (size_t i = 0; i < N; ++i) ret.v[i] = p[i];
+    return ret;
+  }
+
+  /**
+   * @brief store the N lanes
+   * @param p - the destination, which need not be aligned
+   */
+  constexpr void store(T* p) const {
+    for (size_t i = 0; i < N; ++i) p[i] = v[i];
+  }
+
+  constexpr T& operator[](size_t i) { return v[i]; }
+
+  constexpr T operator[](size_t i) const { return v[i]; }
+
+  /**
+   * @brief get the sum of all lanes
+   */
+  [[nodiscard]] constexpr T sum() const {
+    T ret = 0;
+    for (size_t i = 0; i < N; ++i) ret += v[i];
+    return ret;
+  }
+
+#pragma region operators
+
+  constexpr Packet operator-() const {
+    Packet ret;
+    for (size_t i = 0; i < N; ++i) ret.v[i] = -v[i];
+    return ret;
+  }
+
+  friend constexpr Packet operator+(const Packet& a, const Packet& b) {
+    Packet ret;
+    for (size_t i = 0; i < N; ++i) ret.v[i] = a.v[i] + b.v[i];
+    return ret;
+  }
+
+  friend constexpr Packet operator-(const Packet& a, const Packet& b) {
+    Packet ret;
+    for (size_t i = 0; i < N; ++i) ret.v[i] = a.v[i] - b.v[i];
+    return ret;
+  }
+
+  friend constexpr Packet operator*(const Packet& a, const Packet& b) {
+    Packet ret;
+    for (size_t i = 0; i < N; ++i) ret.v[i] = a.v[i] * b.v[i];
+    return ret;
+  }
+
+  friend constexpr Packet operator/(const Packet& a, const Packet& b) {
+    Packet ret;
+    for (size_t i = 0; i < N; ++i) ret.v[i] = a.v[i] / b.v[i];
+    return ret;
+  }
+
+  constexpr Packet& operator+=(const Packet& p) { return *this = *this + p; }
+
+  constexpr Packet& operator-=(const Packet& p) { return *this = *this - p; }
+
+  constexpr Packet& operator*=(const Packet& p) { return *this = *this * p; }
+
+  constexpr Packet& operator/=(const Packet& p) { return *this = *this / p; }
+
+  constexpr bool operator==(const Packet& p) const = default;
+
+#pragma endregion operators
+};
+
+/**
+ * @brief get the square root of each lane
+ * @tparam T - any floating point type
+ * @tparam N - the number of lanes
+ * @param p - the packet
+ * @return the square roots
+ */
+template<std::floating_point T, size_t N>
+constexpr Packet<T, N> sqrt(const Packet<T, N>& p) {
+  Packet<T, N> ret;
+  if (!std::is_constant_evaluated()) {
+    if constexpr (simd::Pack4<T>::Native && N % 4 == 0) {
+      for (size_t i = 0; i < N; i += 4)
+        sqrt(simd::Pack4<T>::load(p.v + i)).store(ret.v + i);
+      return ret;
+    }
+  }
+  for (size_t i = 0; i < N; ++i) ret.v[i] = ams::sqrt<T>(p.v[i]);
+  return ret;
+}
+
+/**
+ * @brief get the lane-wise minimum of two packets
+ */
+template<std::floating_point T, size_t N>
+constexpr Packet<T, N> min(const Packet<T, N>& a, const Packet<T, N>& b) {
+  Packet<T, N> ret;
+  for (size_t i = 0; i < N; ++i) ret.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+  return ret;
+}
+
+/**
+ * @brief get the lane-wise maximum of two packets
+ */
+template<std::floating_point T, size_t N>
+constexpr Packet<T, N> max(const Packet<T, N>& a, const Packet<T, N>& b) {
+  Packet<T, N> ret;
+  for (size_t i = 0; i < N; ++i) ret.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+  return ret;
+}
+
+/**
+ * @brief linearly interpolate between two packets, lane by lane
+ * @param a - the first packet
+ * @param b - the second packet
+ * @param t - the interpolation factor of each lane
+ * @return a + (b - a) * t
+ */
+template<std::floating_point T, size_t N>
+constexpr Packet<T, N> lerp(const Packet<T, N>& a, const Packet<T, N>& b,
+                            const std::type_identity_t<Packet<T, N>>& t) {
+  return a + (b - a) * t;
+}
+
+} // ams
@@ -0,0 +1,234 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*[exclude begin]*/
+#pragma once
+#include "../internal/config.hpp"
+#include "Packet.hpp"
+#include "Vec3Packet.hpp"
+/*[exclude end]*/
+/*[export module ams.spatial.QuaternionPacket]*/
+#include <algorithm>
+#include <cmath>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+/*[import ams]*/
+/*[import ams.spatial.internal]*/
+/*[import ams.spatial.Packet]*/
+/*[import ams.spatial.Vec3Packet]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief N quaternions stored as one ams::Packet per component, the packet counterpart of ams::Quaternion.
+ * @details Quaternions are gathered from and scattered to any 4d vector type, including ams::Quaternion. Products
+ * follow ams::Quaternion::operator*().
+ * @tparam T - any floating point type
+ * @tparam N - the number of lanes
+ */
+template<std::floating_point T = decimal_t, size_t N = 4>
+struct QuaternionPacket {
+  static constexpr size_t Width = N;
+  Packet<T, N> x, y, z, w;
+
+  /**
+   * @brief Construct a new QuaternionPacket with every lane set to the identity.
+   */
+  constexpr QuaternionPacket() : w(1) {}
+
+  constexpr QuaternionPacket(const Packet<T, N>& x, const Packet<T, N>& y, const Packet<T, N>& z,
+                             const Packet<T, N>& w) : x(x), y(y), z(z), w(w) {}
+
+  /**
+   * @brief Construct a new QuaternionPacket with every lane set to the same quaternion.
+   * @param q - the quaternion of every lane
+   */
+  template<Vec4T V4T>
+  constexpr explicit QuaternionPacket(const V4T& q)
+    : x(static_cast<T>(q.x)), y(static_cast<T>(q.y)), z(static_cast<T>(q.z)), w(static_cast<T>(q.w)) {}
+
+  /**
+   * @brief gather quaternions from an array
+   * @tparam V4T - any 4d vector type
+   * @param src - the first quaternion to gather
+   * @param count - the number of quaternions to gather, at most N. The remaining lanes are set to the identity.
+   * @return the packet
+   */
+  template<Vec4T V4T>
+  static constexpr QuaternionPacket gather(const V4T* src, size_t count = N) {
+    QuaternionPacket ret;
+    count = std::min(count, N);
+    for (size_t i = 0; i < count; ++i) {
+      ret.x.v[i] = static_cast<T>(src[i].x);
+      ret.y.v[i] = static_cast<T>(src[i].y);
+      ret.z.v[i] = static_cast<T>(src[i].z);
+      ret.w.v[i] = static_cast<T>(src[i].w);
+    }
+    return ret;
+  }
+
+  /**
+   * @brief scatter the lanes into an array of quaternions
+   * @tparam V4T - any 4d vector type
+   * @param dst - the first quaternion to write
+   * @param count - the number of lanes to write, at most N
+   */
+  template<Vec4T V4T>
+  constexpr void scatter(V4T* dst, size_t count = N) const {
+    count = std::min(count, N);
+    for (size_t i = 0; i < count; ++i) {
+      dst[i].x = x.v[i];
+      dst[i].y = y.v[i];
+      dst[i].z = z.v[i];
+      dst[i].w = w.v[i];
+    }
+  }
+
+  /**
+   * @brief get the vector part of each lane
+   */
+  [[nodiscard]] constexpr Vec3Packet<T, N> xyz() const { return {x, y, z}; }
+
+  /**
+   * @brief get the conjugate of each lane, which is its inverse when the lane is normalized
+   */
+  [[nodiscard]] constexpr QuaternionPacket conjugate() const { return {-x, -y, -z, w}; }
+
+#pragma region operators
+
+  constexpr QuaternionPacket operator-() const { return {-x, -y, -z, -w}; }
+
+  friend constexpr QuaternionPacket operator+(const QuaternionPacket& a, const QuaternionPacket& b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z, a.w + b.w};
+  }
+
+  friend constexpr QuaternionPacket operator-(const QuaternionPacket& a, const QuaternionPacket& b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z, a.w - b.w};
+  }
+
+  // the Hamilton product of each lane
+  friend constexpr QuaternionPacket operator*(const QuaternionPacket& a, const QuaternionPacket& b) {
+    return {
+      a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+      a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+      a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w,
+      a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z
+    };
+  }
+
+  friend constexpr QuaternionPacket operator*(const QuaternionPacket& a, const Packet<T, N>& s) {
+    return {a.x * s, a.y * s, a.z * s, a.w * s};
+  }
+
+  friend constexpr QuaternionPacket operator*(const Packet<T, N>& s, const QuaternionPacket& a) {
+    return a * s;
+  }
+
+  constexpr QuaternionPacket& operator*=(const QuaternionPacket& q) { return *this = *this * q; }
+
+  constexpr bool operator==(const QuaternionPacket& q) const = default;
+
+#pragma endregion operators
+};
+
+/**
+ * @brief get the dot product of each lane of two packets
+ */
+template<std::floating_point T, size_t N>
+constexpr Packet<T, N> dot(const QuaternionPacket<T, N>& a, const QuaternionPacket<T, N>& b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w;
+}
+
+/**
+ * @brief get the length of each lane of a packet
+ */
+template<std::floating_point T, size_t N>
+constexpr Packet<T, N> length(const QuaternionPacket<T, N>& q) {
+  return sqrt(dot(q, q));
+}
+
+/**
+ * @brief normalize each lane of a packet. Lanes with a length of 0 become the identity.
+ */
+template<std::floating_point T, size_t N>
+constexpr QuaternionPacket<T, N> normalize(const QuaternionPacket<T, N>& q) {
+  auto len = length(q);
+  QuaternionPacket<T, N> ret = q;
+  for (size_t i = 0; i < N; ++i) {
+    if (len.v[i] > 0) {
+      const T inv = 1 / len.v[i];
+      ret.x.v[i] *= inv;
+      ret.y.v[i] *= inv;
+      ret.z.v[i] *= inv;
+      ret.w.v[i] *= inv;
+    } else {
+      ret.w.v[i] = 1;
+    }
+  }
+  return ret;
+}
+
+/**
+ * @brief interpolate linearly between each lane of two packets of unit quaternions and normalize the result
+ * @details Each lane takes the shortest path: b is negated in the lanes where it lies in the other hemisphere from a.
+ * This is cheaper than ams::slerp(), but its angular speed is not constant.
+ * @param a - the first packet
+ * @param b - the second packet
+ * @param t - the interpolation factor of each lane. A scalar applies to every lane.
+ * @return the interpolated unit quaternions
+ */
+template<std::floating_point T, size_t N>
+constexpr QuaternionPacket<T, N> lerp(const QuaternionPacket<T, N>& a, const QuaternionPacket<T, N>& b,
+                                      const std::type_identity_t<Packet<T, N>>& t) {
+  const auto d = dot(a, b);
+  Packet<T, N> wb;
+  for (size_t i = 0; i < N; ++i) wb.v[i] = d.v[i] < 0 ? -t.v[i] : t.v[i];
+  return normalize(a * (Packet<T, N>(1) - t) + b * wb);
+}
+
+/**
+ * @brief interpolate spherically between each lane of two packets of unit quaternions
+ * @details Each lane takes the shortest path at a constant angular speed. Lanes which are almost equal fall back to
+ * ams::lerp().
+ * @param a - the first packet
+ * @param b - the second packet
+ * @param t - the interpolation factor of each lane. A scalar applies to every lane.
+ * @return the interpolated unit quaternions
+ */
+template<std::floating_point T, size_t N>
+QuaternionPacket<T, N> slerp(const QuaternionPacket<T, N>& a, const QuaternionPacket<T, N>& b,
+                             const std::type_identity_t<Packet<T, N>>& t) {
+  const auto d = dot(a, b);
+  Packet<T, N> wa, wb;
+  for (size_t i = 0; i < N; ++i) {
+    const T sign = d.v[i] < 0 ? -1 : 1;
+    const T cosTheta = std::min<T>(d.v[i] * sign, 1);
+    if (cosTheta > T(0.9995)) {
+      wa.v[i] = 1 - t.v[i];
+      wb.v[i] = t.v[i] * sign;
+      continue;
+    }
+    const T theta = std::acos(cosTheta);
+    const T sinTheta = std::sin(theta);
+    wa.v[i] = std::sin((1 - t.v[i]) * theta) / sinTheta;
+    wb.v[i] = std::sin(t.v[i] * theta) / sinTheta * sign;
+  }
+  return normalize(a * wa + b * wb);
+}
+
+} // ams
@@ -0,0 +1,279 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/*[exclude begin]*/
+#pragma once
+#include "../internal/config.hpp"
+#include "Packet.hpp"
+#include "Vec3.hpp"
+/*[exclude end]*/
+/*[export module ams.spatial.Vec3Packet]*/
+#include <algorithm>
+#include <concepts>
+#include <cstddef>
+#include <type_traits>
+#include <span>
+/*[import ams]*/
+/*[import ams.spatial.internal]*/
+/*[import ams.spatial.Packet]*/
+/*[import ams.spatial.Vec3]*/
+
+/*[export]*/ namespace ams {
+
+/**
+ * @brief N 3d vectors stored as one ams::Packet per component.
+ * @details A Vec3Packet holds the x of every lane, then every y, then every z, so an array of packets is an array of
+ * structures of arrays (AoSoA). Batch code gathers N ams::Vec3 into a packet, works on all of them with the same
+ * operators as Vec3, and scatters the results back.
+ * @tparam T - any floating point type
+ * @tparam N - the number of lanes
+ */
+template<std::floating_point T, size_t N>
+struct Vec3Packet {
+  static constexpr size_t Width = N;
+  Packet<T, N> x, y, z;
+
+  constexpr Vec3Packet() = default;
+
+  constexpr Vec3Packet(const Packet<T, N>& x, const Packet<T, N>& y, const Packet<T, N>& z) : x(x), y(y), z(z) {}
+
+  /**
+   * @brief Construct a new Vec3Packet with every lane set to the same vector.
+   * @param v - the vector of every lane
+   */
+  template<Vec3T V3T>
+  constexpr explicit Vec3Packet(const V3T& v)
+    : x(static_cast<T>(v.x)), y(static_cast<T>(v.y)), z(static_cast<T>(v.z)) {}
+
+  /**
+   * @brief gather vectors from an array of vectors
+   * @tparam V3T - any 3d vector type
+   * @param src - the first vector to gather
+   * @param count - the number of vectors to gather, at most N. The remaining lanes are set to 0.
+   * @return the packet
+   */
+  template<Vec3T V3T>
+  static constexpr Vec3Packet gather(const V3T* src, size_t count = N) {
+    Vec3Packet ret;
+    count = std::min(count, N);
+    for (size_t i = 0; i < count; ++i) {
+      ret.x.v[i] = static_cast<T>(src[i].x);
+      ret.y.v[i] = static_cast<T>(src[i].y);
+      ret.z.v[i] = static_cast<T>(src[i].z);
+    }
+    return ret;
+  }
+
+  /**
+   * @brief gather the vectors [offset, offset + N) of a span. Lanes past the end of the span are set to 0.
+   * @param src - the vectors
+   * @param offset - the index of the first vector to gather
+   * @return the packet
+   */
+  static constexpr Vec3Packet gather(std::span<const Vec3<T>> src, size_t offset = 0) {
+    return offset < src.size() ? gather(src.data() + offset, src.size() - offset) : Vec3Packet();
+  }
+
+  /**
+   * @brief scatter the lanes into an array of vectors
+   * @tparam V3T - any 3d vector type
+   * @param dst - the first vector to write
+   * @param count - the number of lanes to write, at most N
+   */
+  template<Vec3T V3T>
+  constexpr void scatter(V3T* dst, size_t count = N) const {
+    count = std::min(count, N);
+    for (size_t i = 0; i < count; ++i) {
+      dst[i].x = x.v[i];
+      dst[i].y = y.v[i];
+      dst[i].z = z.v[i];
+    }
+  }
+
+  /**
+   * @brief scatter the lanes into the vectors [offset, offset + N) of a span. Lanes past the end of the span are
+   * dropped.
+   * @param dst - the vectors
+   * @param offset - the index of the first vector to write
+   */
+  constexpr void scatter(std::span<Vec3<T>> dst, size_t offset = 0) const {
+    if (offset < dst.size())
+      scatter(dst.data() + offset, dst.size() - offset);
+  }
+
+  /**
+   * @brief get the vector of a lane
+   * @param lane - the lane, which is not bounds checked
+   */
+  [[nodiscard]] constexpr Vec3<T> get(size_t lane) const { return {x.v[lane], y.v[lane], z.v[lane]}; }
+
+  /**
+   * @brief set the vector of a lane
+   * @param lane - the lane, which is not bounds checked
+   * @param v - the vector
+   */
+  template<Vec3T V3T>
+  constexpr void set(size_t lane, const V3T& v) {
+    x.v[lane] = static_cast<T>(v.x);
+    y.v[lane] = static_cast<T>(v.y);
+    z.v[lane] = static_cast<T>(v.z);
+  }
+
+#pragma region operators
+
+  constexpr Vec3Packet operator-() const { return {-x, -y, -z}; }
+
+  friend constexpr Vec3Packet operator+(const Vec3Packet& a, const Vec3Packet& b) {
+    return {a.x + b.x, a.y + b.y, a.z + b.z};
+  }
+
+  friend constexpr Vec3Packet operator-(const Vec3Packet& a, const Vec3Packet& b) {
+    return {a.x - b.x, a.y - b.y, a.z - b.z};
+  }
+
+  friend constexpr Vec3Packet operator*(const Vec3Packet& a, const Vec3Packet& b) {
+    return {a.x * b.x, a.y * b.y, a.z * b.z};
+  }
+
+  friend constexpr Vec3Packet operator/(const Vec3Packet& a, const Vec3Packet& b) {
+    return {a.x / b.x, a.y / b.y, a.z / b.z};
+  }
+
+  // scales each lane by its own factor. A scalar converts to a Packet with every lane set to it.
+  friend constexpr Vec3Packet operator*(const Vec3Packet& a, const Packet<T, N>& s) {
+    return {a.x * s, a.y * s, a.z * s};
+  }
+
+  friend constexpr Vec3Packet operator*(const Packet<T, N>& s, const Vec3Packet& a) {
+    return a * s;
+  }
+
+  friend constexpr Vec3Packet operator/(const Vec3Packet& a, const Packet<T, N>& s) {
+    return {a.x / s, a.y / s, a.z / s};
+  }
+
+  constexpr Vec3Packet& operator+=(const Vec3Packet& v) { return *this = *this + v; }
+
+  constexpr Vec3Packet& operator-=(const Vec3Packet& v) { return *this = *this - v; }
+
+  constexpr Vec3Packet& operator*=(const Packet<T, N>& s) { return *this = *this * s; }
+
+  constexpr Vec3Packet& operator/=(const Packet<T, N>& s) { return *this = *this / s; }
+
+  constexpr bool operator==(const Vec3Packet& v) const = default;
+
+#pragma endregion operators
+};
+
+template<std::floating_point T>
+using Vec3x4 = Vec3Packet<T, 4>;
+
+template<std::floating_point T>
+using Vec3x8 = Vec3Packet<T, 8>;
+
+/**
+ * @brief get the dot product of each lane of two packets
+ * @param a - the first packet
+ * @param b - the second packet
+ * @return the dot products
+ */
+template<std::floating_point T, size_t N>
+constexpr Packet<T, N> dot(const Vec3Packet<T, N>& a, const Vec3Packet<T, N>& b) {
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/**
+ * @brief get the cross product of each lane of two packets
+ * @param a - the first packet
+ * @param b - the second packet
+ * @return the cross products
+ */
+template<std::floating_point T, size_t N>
+constexpr Vec3Packet<T, N> cross(const Vec3Packet<T, N>& a, const Vec3Packet<T, N>& b) {
+  return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+/**
+ * @brief get the length of each lane of a packet
+ * @param a - the packet
+ * @return the lengths
+ */
+template<std::floating_point T, size_t N>
+constexpr Packet<T, N> length(const Vec3Packet<T, N>& a) {
+  return sqrt(dot(a, a));
+}
+
+/**
+ * @brief normalize each lane of a packet. Lanes with a length of 0 stay 0.
+ * @param a - the packet
+ * @return the unit vectors
+ */
+template<std::floating_point T, size_t N>
+constexpr Vec3Packet<T, N> normalize(const Vec3Packet<T, N>& a) {
+  auto len = length(a);
+  Packet<T, N> inv;
+  for (size_t i = 0; i < N; ++i) inv.v[i] = len.v[i] > 0 ? 1 / len.v[i] : 0;
+  return a * inv;
+}
+
+/**
+ * @brief linearly interpolate between each lane of two packets
+ * @param a - the first packet
+ * @param b - the second packet
+ * @param t - the interpolation factor of each lane. A scalar applies to every lane.
+ * @return the interpolated vectors
+ */
+template<std::floating_point T, size_t N>
+constexpr Vec3Packet<T, N> lerp(const Vec3Packet<T, N>& a, const Vec3Packet<T, N>& b,
+                                const std::type_identity_t<Packet<T, N>>& t) {
+  return a + (b - a) * t;
+}
+
+/**
+ * @brief spherically interpolate between each lane of two packets of directions
+ * @details The angle between the directions is interpolated along with their length. Lanes whose directions are
+ * almost parallel or opposite, or where either has a length of 0, are interpolated linearly.
+ * @param a - the first packet
+ * @param b - the second packet
+ * @param t - the interpolation factor of each lane. A scalar applies to every lane.
+ * @return the interpolated vectors
+ */
+template<std::floating_point T, size_t N>
+Vec3Packet<T, N> slerp(const Vec3Packet<T, N>& a, const Vec3Packet<T, N>& b,
+                       const std::type_identity_t<Packet<T, N>>& t) {
+  const auto lengthA = length(a), lengthB = length(b);
+  const auto d = dot(a, b);
+  Packet<T, N> wa, wb;
+  for (size_t i = 0; i < N; ++i) {
+    const T lengths = lengthA.v[i] * lengthB.v[i];
+    const T cosTheta = lengths > 0 ? std::clamp<T>(d.v[i] / lengths, -1, 1) : 1;
+    const T theta = std::acos(cosTheta);
+    const T sinTheta = std::sin(theta);
+    if (sinTheta < T(1e-4)) {
+      wa.v[i] = 1 - t.v[i];
+      wb.v[i] = t.v[i];
+      continue;
+    }
+    // interpolate the length linearly and the direction along the arc
+    const T len = lengthA.v[i] + (lengthB.v[i] - lengthA.v[i]) * t.v[i];
+    wa.v[i] = std::sin((1 - t.v[i]) * theta) / sinTheta * len / lengthA.v[i];
+    wb.v[i] = std::sin(t.v[i] * theta) / sinTheta * len / lengthB.v[i];
+  }
+  return a * wa + b * wb;
+}
+
+} // ams
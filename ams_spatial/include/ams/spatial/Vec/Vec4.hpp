@@ -19,12 +19,15 @@
 #pragma once
 #include <ams/Math.hpp>
 #include "../internal/config.hpp"
+#include "../internal/simd.hpp"
 #include "Vec3.hpp"
 /*[exclude end]*/
 /*[export module ams.spatial.Vec4]*/
 #include <stdexcept>
+#include <type_traits>
 /*[import ams]*/
 /*[import ams.spatial.internal]*/
+/*[import ams.spatial.internal.simd]*/
 /*[import ams.spatial.Vec2]*/
 /*[import ams.spatial.Vec3]*/
 
@@ -78,18 +81,34 @@ struct Vec4 {
 
   // arithmetic operators
   constexpr Vec4<T> operator+(const Vec4<T>& other) const {
+    if constexpr (simd::Pack4<T>::Native) {
+      if (!std::is_constant_evaluated())
+        return fromPack(toPack() + simd::Pack4<T>::load(&other.x));
+    }
     return Vec4<T>(x + other.x, y + other.y, z + other.z, w + other.w);
   }
 
   constexpr Vec4<T> operator-(const Vec4<T>& other) const {
+    if constexpr (simd::Pack4<T>::Native) {
+      if (!std::is_constant_evaluated())
+        return fromPack(toPack() - simd::Pack4<T>::load(&other.x));
+    }
     return Vec4<T>(x - other.x, y - other.y, z - other.z, w - other.w);
   }
 
   constexpr Vec4<T> operator*(const Vec4<T>& other) const {
+    if constexpr (simd::Pack4<T>::Native) {
+      if (!std::is_constant_evaluated())
+        return fromPack(toPack() * simd::Pack4<T>::load(&other.x));
+    }
     return Vec4<T>(x * other.x, y * other.y, z * other.z, w * other.w);
   }
 
   constexpr Vec4<T> operator/(const Vec4<T>& other) const {
+    if constexpr (simd::Pack4<T>::Native) {
+      if (!std::is_constant_evaluated())
+        return fromPack(toPack() / simd::Pack4<T>::load(&other.x));
+    }
     return Vec4<T>(x / other.x, y / other.y, z / other.z, w / other.w);
   }
 
@@ -118,18 +137,34 @@ struct Vec4 {
   }
 
   constexpr Vec4<T> operator+(T scalar) const {
+    if constexpr (simd::Pack4<T>::Native) {
+      if (!std::is_constant_evaluated())
+        return fromPack(toPack() + simd::Pack4<T>::broadcast(scalar));
+    }
     return Vec4<T>(x + scalar, y + scalar, z + scalar, w + scalar);
   }
 
   constexpr Vec4<T> operator-(T scalar) const {
+    if constexpr (simd::Pack4<T>::Native) {
+      if (!std::is_constant_evaluated())
+        return fromPack(toPack() - simd::Pack4<T>::broadcast(scalar));
+    }
     return Vec4<T>(x - scalar, y - scalar, z - scalar, w - scalar);
   }
 
   constexpr Vec4<T> operator*(T scalar) const {
+    if constexpr (simd::Pack4<T>::Native) {
+      if (!std::is_constant_evaluated())
+        return fromPack(toPack() * simd::Pack4<T>::broadcast(scalar));
+    }
     return Vec4<T>(x * scalar, y * scalar, z * scalar, w * scalar);
   }
 
   constexpr Vec4<T> operator/(T scalar) const {
+    if constexpr (simd::Pack4<T>::Native) {
+      if (!std::is_constant_evaluated())
+        return fromPack(toPack() / simd::Pack4<T>::broadcast(scalar));
+    }
     return Vec4<T>(x / scalar, y / scalar, z / scalar, w / scalar);
   }
 
@@ -256,6 +291,17 @@ struct Vec4 {
   constexpr static Vec4<decimal_t> unit_z() { return {0, 0, 1, 0}; }
   constexpr static Vec4<decimal_t> unit_w() { return {0, 0, 0, 1}; }
 
+private:
+  // the lanes of the SIMD backend. Only used at run time, and only when simd::Pack4<T>::Native.
+  [[nodiscard]] simd::Pack4<T> toPack() const { return simd::Pack4<T>::load(&x); }
+  
+  static Vec4<T> fromPack(const simd::Pack4<T>& pack) {
+    Vec4<T> ret;
+    pack.store(&ret.x);
+    return ret;
+  }
+
+public:
 #pragma endregion operators
 #pragma region swizzle
 #ifdef AMS_VEC_SWIZZLE_METHODS
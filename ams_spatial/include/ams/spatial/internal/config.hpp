@@ -27,7 +27,16 @@
 
 /*[export]*/ namespace ams {
 
+/**
+ * @brief The floating point type of the spatial types, meshes and transforms.
+ * @details double by default. Building with AMS_DECIMAL_FLOAT (the CMake option of the same name) switches the whole
+ * engine to single precision, which halves the memory of vertices and matrices and doubles the lanes of SIMD kernels.
+ */
+#ifdef AMS_DECIMAL_FLOAT
+using decimal_t = float;
+#else
 using decimal_t = double;
+#endif
 
 // This concept constrains a type requiring it to have a default constructor
 // and public member fields x and y which are convertible to double.
@@ -0,0 +1,273 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+/*[module]*/
+/*[exclude begin]*/
+#pragma once
+/*[exclude end]*/
+/*[ignore begin]*/
+#include <cmath>
+#include <cstddef>
+/*[ignore end]*/
+/*[export module ams.spatial.internal.simd]*/
+
+// Selects the instruction set of the 4-wide kernels at compile time: SSE2 on x86, NEON on AArch64, and the scalar
+// fallback elsewhere or when AMS_SPATIAL_NO_SIMD is defined. Only the baseline of the target is used, never extensions
+// enabled by per-file flags such as the AVX2 of the batch kernels, because the inline functions of Vec4, Matrix4 and
+// Quaternion call these kernels and must compile to the same definition in every translation unit.
+#if !defined(AMS_SPATIAL_NO_SIMD)
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AMS_SPATIAL_SIMD_SSE2 1
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define AMS_SPATIAL_SIMD_NEON 1
+#endif
+#endif
+
+#if defined(AMS_SPATIAL_SIMD_SSE2)
+#define AMS_SPATIAL_SIMD_NS sse2
+#elif defined(AMS_SPATIAL_SIMD_NEON)
+#define AMS_SPATIAL_SIMD_NS neon
+#else
+#define AMS_SPATIAL_SIMD_NS scalar
+#endif
+
+/*[export]*/ namespace ams::simd {
+inline namespace AMS_SPATIAL_SIMD_NS {
+
+/**
+ * @brief Four lanes of T held in SIMD registers.
+ * @details The primary template is the scalar fallback, used for types and targets without a native specialization.
+ * Native tells whether the lanes map to vector registers; callers use it to keep the plain scalar code for types like
+ * integers, where going through memory would only add work. Loads and stores are unaligned.
+ * @tparam T - The lane type.
+ */
+template<typename T>
+struct Pack4 {
+  static constexpr bool Native = false;
+  T v[4];
+  
+  static Pack4 load(const T* p) { return {{p[0], p[1], p[2], p[3]}}; }
+  static Pack4 set(T a, T b, T c, T d) { return {{a, b, c, d}}; }
+  static Pack4 broadcast(T s) { return {{s, s, s, s}}; }
+  void store(T* p) const { p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; p[3] = v[3]; }
+  /** Stores the first three lanes, leaving p[3] untouched. */
+  void store3(T* p) const { p[0] = v[0]; p[1] = v[1]; p[2] = v[2]; }
+  [[nodiscard]] T sum() const { return (v[0] + v[1]) + (v[2] + v[3]); }
+  
+  friend Pack4 operator+(const Pack4& a, const Pack4& b) {
+    return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+  }
+  friend Pack4 operator-(const Pack4& a, const Pack4& b) {
+    return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+  }
+  friend Pack4 operator*(const Pack4& a, const Pack4& b) {
+    return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+  }
+  friend Pack4 operator/(const Pack4& a, const Pack4& b) {
+    return {{a.v[0] / b.v[0], a.v[1] / b.v[1], a.v[2] / b.v[2], a.v[3] / b.v[3]}};
+  }
+  friend Pack4 sqrt(const Pack4& a) {
+    return {{std::sqrt(a.v[0]), std::sqrt(a.v[1]), std::sqrt(a.v[2]), std::sqrt(a.v[3])}};
+  }
+};
+
+#if defined(AMS_SPATIAL_SIMD_SSE2)
+
+template<>
+struct Pack4<double> {
+  static constexpr bool Native = true;
+  __m128d lo, hi;
+  
+  static Pack4 load(const double* p) { return {_mm_loadu_pd(p), _mm_loadu_pd(p + 2)}; }
+  static Pack4 set(double a, double b, double c, double d) { return {_mm_setr_pd(a, b), _mm_setr_pd(c, d)}; }
+  static Pack4 broadcast(double s) { return {_mm_set1_pd(s), _mm_set1_pd(s)}; }
+  void store(double* p) const { _mm_storeu_pd(p, lo); _mm_storeu_pd(p + 2, hi); }
+  void store3(double* p) const { _mm_storeu_pd(p, lo); _mm_store_sd(p + 2, hi); }
+  [[nodiscard]] double sum() const {
+    __m128d pair = _mm_add_pd(lo, hi);
+    return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+  }
+  
+  friend Pack4 operator+(Pack4 a, Pack4 b) { return {_mm_add_pd(a.lo, b.lo), _mm_add_pd(a.hi, b.hi)}; }
+  friend Pack4 operator-(Pack4 a, Pack4 b) { return {_mm_sub_pd(a.lo, b.lo), _mm_sub_pd(a.hi, b.hi)}; }
+  friend Pack4 operator*(Pack4 a, Pack4 b) { return {_mm_mul_pd(a.lo, b.lo), _mm_mul_pd(a.hi, b.hi)}; }
+  friend Pack4 operator/(Pack4 a, Pack4 b) { return {_mm_div_pd(a.lo, b.lo), _mm_div_pd(a.hi, b.hi)}; }
+  friend Pack4 sqrt(Pack4 a) { return {_mm_sqrt_pd(a.lo), _mm_sqrt_pd(a.hi)}; }
+};
+
+#elif defined(AMS_SPATIAL_SIMD_NEON)
+
+template<>
+struct Pack4<double> {
+  static constexpr bool Native = true;
+  float64x2_t lo, hi;
+  
+  static Pack4 load(const double* p) { return {vld1q_f64(p), vld1q_f64(p + 2)}; }
+  static Pack4 set(double a, double b, double c, double d) {
+    const double lanes[4] = {a, b, c, d};
+    return load(lanes);
+  }
+  static Pack4 broadcast(double s) { return {vdupq_n_f64(s), vdupq_n_f64(s)}; }
+  void store(double* p) const { vst1q_f64(p, lo); vst1q_f64(p + 2, hi); }
+  void store3(double* p) const { vst1q_f64(p, lo); vst1q_lane_f64(p + 2, hi, 0); }
+  [[nodiscard]] double sum() const { return vaddvq_f64(vaddq_f64(lo, hi)); }
+  
+  friend Pack4 operator+(Pack4 a, Pack4 b) { return {vaddq_f64(a.lo, b.lo), vaddq_f64(a.hi, b.hi)}; }
+  friend Pack4 operator-(Pack4 a, Pack4 b) { return {vsubq_f64(a.lo, b.lo), vsubq_f64(a.hi, b.hi)}; }
+  friend Pack4 operator*(Pack4 a, Pack4 b) { return {vmulq_f64(a.lo, b.lo), vmulq_f64(a.hi, b.hi)}; }
+  friend Pack4 operator/(Pack4 a, Pack4 b) { return {vdivq_f64(a.lo, b.lo), vdivq_f64(a.hi, b.hi)}; }
+  friend Pack4 sqrt(Pack4 a) { return {vsqrtq_f64(a.lo), vsqrtq_f64(a.hi)}; }
+};
+
+#endif
+
+#if defined(AMS_SPATIAL_SIMD_SSE2)
+
+template<>
+struct Pack4<float> {
+  static constexpr bool Native = true;
+  __m128 v;
+  
+  static Pack4 load(const float* p) { return {_mm_loadu_ps(p)}; }
+  static Pack4 set(float a, float b, float c, float d) { return {_mm_setr_ps(a, b, c, d)}; }
+  static Pack4 broadcast(float s) { return {_mm_set1_ps(s)}; }
+  void store(float* p) const { _mm_storeu_ps(p, v); }
+  void store3(float* p) const {
+    _mm_storel_pi(reinterpret_cast<__m64*>(p), v);
+    _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+  }
+  [[nodiscard]] float sum() const {
+    __m128 pair = _mm_add_ps(v, _mm_movehl_ps(v, v));
+    return _mm_cvtss_f32(_mm_add_ss(pair, _mm_shuffle_ps(pair, pair, 1)));
+  }
+  
+  friend Pack4 operator+(Pack4 a, Pack4 b) { return {_mm_add_ps(a.v, b.v)}; }
+  friend Pack4 operator-(Pack4 a, Pack4 b) { return {_mm_sub_ps(a.v, b.v)}; }
+  friend Pack4 operator*(Pack4 a, Pack4 b) { return {_mm_mul_ps(a.v, b.v)}; }
+  friend Pack4 operator/(Pack4 a, Pack4 b) { return {_mm_div_ps(a.v, b.v)}; }
+  friend Pack4 sqrt(Pack4 a) { return {_mm_sqrt_ps(a.v)}; }
+};
+
+#elif defined(AMS_SPATIAL_SIMD_NEON)
+
+template<>
+struct Pack4<float> {
+  static constexpr bool Native = true;
+  float32x4_t v;
+  
+  static Pack4 load(const float* p) { return {vld1q_f32(p)}; }
+  static Pack4 set(float a, float b, float c, float d) {
+    const float lanes[4] = {a, b, c, d};
+    return load(lanes);
+  }
+  static Pack4 broadcast(float s) { return {vdupq_n_f32(s)}; }
+  void store(float* p) const { vst1q_f32(p, v); }
+  void store3(float* p) const { vst1_f32(p, vget_low_f32(v)); vst1q_lane_f32(p + 2, v, 2); }
+  [[nodiscard]] float sum() const { return vaddvq_f32(v); }
+  
+  friend Pack4 operator+(Pack4 a, Pack4 b) { return {vaddq_f32(a.v, b.v)}; }
+  friend Pack4 operator-(Pack4 a, Pack4 b) { return {vsubq_f32(a.v, b.v)}; }
+  friend Pack4 operator*(Pack4 a, Pack4 b) { return {vmulq_f32(a.v, b.v)}; }
+  friend Pack4 operator/(Pack4 a, Pack4 b) { return {vdivq_f32(a.v, b.v)}; }
+  friend Pack4 sqrt(Pack4 a) { return {vsqrtq_f32(a.v)}; }
+};
+
+#endif
+
+/**
+ * @brief Multiplies two row-major 4x4 matrices: out = a * b.
+ * @details Each row of the result is a linear combination of the rows of b, so no transpose is needed. out may alias
+ * a or b.
+ */
+template<typename T>
+inline void mul4x4(const T* a, const T* b, T* out) {
+  using P = Pack4<T>;
+  const P b0 = P::load(b), b1 = P::load(b + 4), b2 = P::load(b + 8), b3 = P::load(b + 12);
+  P rows[4];
+  for (int i = 0; i < 4; i++) {
+    const T* row = a + 4 * i;
+    rows[i] = (P::broadcast(row[0]) * b0 + P::broadcast(row[1]) * b1) +
+              (P::broadcast(row[2]) * b2 + P::broadcast(row[3]) * b3);
+  }
+  for (int i = 0; i < 4; i++)
+    rows[i].store(out + 4 * i);
+}
+
+/**
+ * @brief Transforms a row vector by a row-major 4x4 matrix: out = v * m. out may alias v.
+ */
+template<typename T>
+inline void transform4(const T* v, const T* m, T* out) {
+  using P = Pack4<T>;
+  P result = (P::broadcast(v[0]) * P::load(m) + P::broadcast(v[1]) * P::load(m + 4)) +
+             (P::broadcast(v[2]) * P::load(m + 8) + P::broadcast(v[3]) * P::load(m + 12));
+  result.store(out);
+}
+
+/**
+ * @brief Multiplies two quaternions stored as (x, y, z, w): out = a * b. out may alias a or b.
+ */
+template<typename T>
+inline void quatMul4(const T* a, const T* b, T* out) {
+  using P = Pack4<T>;
+  const T bx = b[0], by = b[1], bz = b[2], bw = b[3];
+  P result = (P::broadcast(a[3]) * P::set(bx, by, bz, bw) + P::broadcast(a[0]) * P::set(bw, -bz, by, -bx)) +
+             (P::broadcast(a[1]) * P::set(bz, bw, -bx, -by) + P::broadcast(a[2]) * P::set(-by, bx, bw, -bz));
+  result.store(out);
+}
+
+/**
+ * @brief Inverts a row-major 4x4 matrix by expanding it in 2x2 sub-determinants.
+ * @details This takes less than half the multiplications of the cofactor expansion, and shares the sub-determinants with
+ * the determinant itself. out is left untouched when the matrix is singular. out may alias m.
+ * @return The determinant of m.
+ */
+template<typename T>
+inline T inverse4x4(const T* m, T* out) {
+  using P = Pack4<T>;
+  const T a00 = m[0], a01 = m[1], a02 = m[2], a03 = m[3];
+  const T a10 = m[4], a11 = m[5], a12 = m[6], a13 = m[7];
+  const T a20 = m[8], a21 = m[9], a22 = m[10], a23 = m[11];
+  const T a30 = m[12], a31 = m[13], a32 = m[14], a33 = m[15];
+  // sub-determinants of the top (s) and bottom (c) pairs of rows
+  const T s0 = a00 * a11 - a10 * a01, s1 = a00 * a12 - a10 * a02, s2 = a00 * a13 - a10 * a03;
+  const T s3 = a01 * a12 - a11 * a02, s4 = a01 * a13 - a11 * a03, s5 = a02 * a13 - a12 * a03;
+  const T c0 = a20 * a31 - a30 * a21, c1 = a20 * a32 - a30 * a22, c2 = a20 * a33 - a30 * a23;
+  const T c3 = a21 * a32 - a31 * a22, c4 = a21 * a33 - a31 * a23, c5 = a22 * a33 - a32 * a23;
+  const T det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+  if (det == 0)
+    return det;
+  
+  const P v0 = P::set(a10, -a00, a30, -a20), v1 = P::set(a11, -a01, a31, -a21);
+  const P v2 = P::set(a12, -a02, a32, -a22), v3 = P::set(a13, -a03, a33, -a23);
+  const P k0 = P::set(c0, c0, s0, s0), k1 = P::set(c1, c1, s1, s1), k2 = P::set(c2, c2, s2, s2);
+  const P k3 = P::set(c3, c3, s3, s3), k4 = P::set(c4, c4, s4, s4), k5 = P::set(c5, c5, s5, s5);
+  const P invDet = P::broadcast(T(1) / det);
+  const P row0 = (v1 * k5 - v2 * k4 + v3 * k3) * invDet;
+  const P row1 = (v2 * k2 - v0 * k5 - v3 * k1) * invDet;
+  const P row2 = (v0 * k4 - v1 * k2 + v3 * k0) * invDet;
+  const P row3 = (v1 * k1 - v0 * k3 - v2 * k0) * invDet;
+  row0.store(out);
+  row1.store(out + 4);
+  row2.store(out + 8);
+  row3.store(out + 12);
+  return det;
+}
+
+} // AMS_SPATIAL_SIMD_NS
+} // ams::simd
@@ -0,0 +1,294 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "../../include/ams/spatial/AABBTree.hpp"
+#include <ams/JobSystem.hpp>
+#else
+import ams.spatial.AABBTree;
+import ams.JobSystem;
+#endif
+#include <algorithm>
+
+namespace ams {
+
+uint32_t AABBTree::insert(const AABB& box, uint64_t value, bool link) {
+  auto proxy = allocateNode();
+  auto& node = mNodes[proxy];
+  node.box = box.inflated(mMargin);
+  node.value = value;
+  node.height = 0;
+  ++mProxyCount;
+  if (link)
+    insertLeaf(proxy);
+  return proxy;
+}
+
+void AABBTree::remove(uint32_t proxy) {
+  if (proxy == mRoot || mNodes[proxy].parent != NullProxy)
+    removeLeaf(proxy);
+  freeNode(proxy);
+  --mProxyCount;
+}
+
+bool AABBTree::move(uint32_t proxy, const AABB& box, bool link) {
+  auto& node = mNodes[proxy];
+  bool linked = proxy == mRoot || node.parent != NullProxy;
+  if (linked && node.box.contains(box))
+    return false;
+  if (linked)
+    removeLeaf(proxy);
+  mNodes[proxy].box = box.inflated(mMargin);
+  if (link)
+    insertLeaf(proxy);
+  return true;
+}
+
+void AABBTree::rebuild() {
+  std::vector<uint32_t> leaves;
+  leaves.reserve(mProxyCount);
+  for (uint32_t i = 0; i < mNodes.size(); ++i) {
+    if (mNodes[i].height == 0)
+      leaves.push_back(i);
+    else if (mNodes[i].height > 0)
+      freeNode(i);
+  }
+  mRoot = NullProxy;
+  if (leaves.empty())
+    return;
+  // the inner nodes are allocated up front, since mNodes must not grow while subtrees are built concurrently
+  std::vector<uint32_t> inner(leaves.size() - 1);
+  for (auto& node : inner)
+    node = allocateNode();
+  mRoot = build(leaves, inner, NullProxy);
+}
+
+void AABBTree::clear() {
+  mNodes.clear();
+  mRoot = NullProxy;
+  mFreeList = NullProxy;
+  mProxyCount = 0;
+}
+
+uint32_t AABBTree::allocateNode() {
+  if (mFreeList == NullProxy) {
+    mNodes.emplace_back();
+    return static_cast<uint32_t>(mNodes.size() - 1);
+  }
+  auto node = mFreeList;
+  mFreeList = mNodes[node].parent;
+  mNodes[node] = Node{};
+  return node;
+}
+
+void AABBTree::freeNode(uint32_t node) {
+  mNodes[node].height = -1;
+  mNodes[node].left = NullProxy;
+  mNodes[node].right = NullProxy;
+  mNodes[node].parent = mFreeList;
+  mFreeList = node;
+}
+
+void AABBTree::insertLeaf(uint32_t leaf) {
+  if (mRoot == NullProxy) {
+    mRoot = leaf;
+    mNodes[leaf].parent = NullProxy;
+    return;
+  }
+  
+  // descend towards the sibling which grows the total surface area the least
+  auto box = mNodes[leaf].box;
+  auto index = mRoot;
+  while (!mNodes[index].isLeaf()) {
+    auto& node = mNodes[index];
+    auto area = node.box.surfaceArea();
+    auto combinedArea = AABB::merge(node.box, box).surfaceArea();
+    // making a new parent for this node and the leaf
+    auto cost = 2 * combinedArea;
+    // the minimum cost of pushing the leaf further down, paid by this node and its ancestors
+    auto inheritedCost = 2 * (combinedArea - area);
+    auto childCost = [&](uint32_t child) {
+      auto& childBox = mNodes[child].box;
+      auto merged = AABB::merge(childBox, box).surfaceArea();
+      return (mNodes[child].isLeaf() ? merged : merged - childBox.surfaceArea()) + inheritedCost;
+    };
+    auto leftCost = childCost(node.left);
+    auto rightCost = childCost(node.right);
+    if (cost < leftCost && cost < rightCost)
+      break;
+    index = leftCost < rightCost ? node.left : node.right;
+  }
+  
+  auto sibling = index;
+  auto oldParent = mNodes[sibling].parent;
+  auto newParent = allocateNode();
+  auto& parent = mNodes[newParent];
+  parent.parent = oldParent;
+  parent.box = AABB::merge(box, mNodes[sibling].box);
+  parent.height = mNodes[sibling].height + 1;
+  parent.left = sibling;
+  parent.right = leaf;
+  if (oldParent == NullProxy) {
+    mRoot = newParent;
+  } else if (mNodes[oldParent].left == sibling) {
+    mNodes[oldParent].left = newParent;
+  } else {
+    mNodes[oldParent].right = newParent;
+  }
+  mNodes[sibling].parent = newParent;
+  mNodes[leaf].parent = newParent;
+  refitAncestors(newParent);
+}
+
+void AABBTree::removeLeaf(uint32_t leaf) {
+  if (leaf == mRoot) {
+    mRoot = NullProxy;
+    return;
+  }
+  auto parent = mNodes[leaf].parent;
+  auto grandParent = mNodes[parent].parent;
+  auto sibling = mNodes[parent].left == leaf ? mNodes[parent].right : mNodes[parent].left;
+  mNodes[leaf].parent = NullProxy;
+  freeNode(parent);
+  mNodes[sibling].parent = grandParent;
+  if (grandParent == NullProxy) {
+    mRoot = sibling;
+    return;
+  }
+  if (mNodes[grandParent].left == parent)
+    mNodes[grandParent].left = sibling;
+  else
+    mNodes[grandParent].right = sibling;
+  refitAncestors(grandParent);
+}
+
+void AABBTree::refitAncestors(uint32_t node) {
+  while (node != NullProxy) {
+    node = balance(node);
+    auto& current = mNodes[node];
+    auto& left = mNodes[current.left];
+    auto& right = mNodes[current.right];
+    current.height = 1 + std::max(left.height, right.height);
+    current.box = AABB::merge(left.box, right.box);
+    node = current.parent;
+  }
+}
+
+uint32_t AABBTree::balance(uint32_t iA) {
+  auto& a = mNodes[iA];
+  if (a.isLeaf() || a.height < 2)
+    return iA;
+  auto iB = a.left;
+  auto iC = a.right;
+  auto& b = mNodes[iB];
+  auto& c = mNodes[iC];
+  auto difference = c.height - b.height;
+  if (difference > 1) {
+    // rotate c up: a takes the shorter child of c, c takes a
+    auto iF = c.left;
+    auto iG = c.right;
+    auto& f = mNodes[iF];
+    auto& g = mNodes[iG];
+    c.left = iA;
+    c.parent = a.parent;
+    a.parent = iC;
+    if (c.parent == NullProxy)
+      mRoot = iC;
+    else if (mNodes[c.parent].left == iA)
+      mNodes[c.parent].left = iC;
+    else
+      mNodes[c.parent].right = iC;
+    auto [iTall, iShort] = f.height > g.height ? std::pair(iF, iG) : std::pair(iG, iF);
+    c.right = iTall;
+    a.right = iShort;
+    mNodes[iShort].parent = iA;
+    a.box = AABB::merge(b.box, mNodes[iShort].box);
+    c.box = AABB::merge(a.box, mNodes[iTall].box);
+    a.height = 1 + std::max(b.height, mNodes[iShort].height);
+    c.height = 1 + std::max(a.height, mNodes[iTall].height);
+    return iC;
+  }
+  if (difference < -1) {
+    // rotate b up: a takes the shorter child of b, b takes a
+    auto iD = b.left;
+    auto iE = b.right;
+    auto& d = mNodes[iD];
+    auto& e = mNodes[iE];
+    b.left = iA;
+    b.parent = a.parent;
+    a.parent = iB;
+    if (b.parent == NullProxy)
+      mRoot = iB;
+    else if (mNodes[b.parent].left == iA)
+      mNodes[b.parent].left = iB;
+    else
+      mNodes[b.parent].right = iB;
+    auto [iTall, iShort] = d.height > e.height ? std::pair(iD, iE) : std::pair(iE, iD);
+    b.right = iTall;
+    a.left = iShort;
+    mNodes[iShort].parent = iA;
+    a.box = AABB::merge(c.box, mNodes[iShort].box);
+    b.box = AABB::merge(a.box, mNodes[iTall].box);
+    a.height = 1 + std::max(c.height, mNodes[iShort].height);
+    b.height = 1 + std::max(a.height, mNodes[iTall].height);
+    return iB;
+  }
+  return iA;
+}
+
+uint32_t AABBTree::build(std::span<uint32_t> leaves, std::span<const uint32_t> inner, uint32_t parent) {
+  if (leaves.size() == 1) {
+    mNodes[leaves[0]].parent = parent;
+    return leaves[0];
+  }
+  auto index = inner[0];
+  AABB centers;
+  for (auto leaf : leaves)
+    centers.expand(mNodes[leaf].box.center());
+  auto size = centers.max - centers.min;
+  int axis = size.x >= size.y && size.x >= size.z ? 0 : size.y >= size.z ? 1 : 2;
+  auto middle = leaves.size() / 2;
+  std::nth_element(leaves.begin(), leaves.begin() + static_cast<ptrdiff_t>(middle), leaves.end(),
+                   [this, axis](uint32_t a, uint32_t b) {
+    return mNodes[a].box.center()[axis] < mNodes[b].box.center()[axis];
+  });
+  
+  // the left subtree uses inner[1, middle) and the right subtree uses inner[middle, size - 1)
+  auto leftLeaves = leaves.first(middle);
+  auto rightLeaves = leaves.subspan(middle);
+  auto leftInner = inner.subspan(1, middle - 1);
+  auto rightInner = inner.subspan(middle);
+  uint32_t left, right;
+  if (leaves.size() > ParallelBuildThreshold) {
+    auto& jobs = JobSystem::getInstance();
+    auto job = jobs.schedule([&] { left = build(leftLeaves, leftInner, index); });
+    right = build(rightLeaves, rightInner, index);
+    jobs.wait(job);
+  } else {
+    left = build(leftLeaves, leftInner, index);
+    right = build(rightLeaves, rightInner, index);
+  }
+  
+  auto& node = mNodes[index];
+  node.parent = parent;
+  node.left = left;
+  node.right = right;
+  node.height = 1 + std::max(mNodes[left].height, mNodes[right].height);
+  node.box = AABB::merge(mNodes[left].box, mNodes[right].box);
+  return index;
+}
+
+} // ams
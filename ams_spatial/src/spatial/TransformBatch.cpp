@@ -0,0 +1,247 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "../../include/ams/spatial/TransformBatch.hpp"
+#else
+import ams.spatial.TransformBatch;
+#endif
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(AMS_DECIMAL_FLOAT)
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define AMS_SPATIAL_SSE 1
+#endif
+#elif defined(__AVX__)
+#include <immintrin.h>
+#define AMS_SPATIAL_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define AMS_SPATIAL_SSE2 1
+#endif
+
+namespace ams {
+
+namespace {
+
+static_assert(std::is_same_v<decimal_t, float> || std::is_same_v<decimal_t, double>,
+              "The SIMD kernels are written for float and double precision");
+
+/** Pointers to the arrays of a TransformBatch. */
+struct TRSArrays {
+  const decimal_t* px; const decimal_t* py; const decimal_t* pz;
+  const decimal_t* qx; const decimal_t* qy; const decimal_t* qz; const decimal_t* qw;
+  const decimal_t* sx; const decimal_t* sy; const decimal_t* sz;
+};
+
+/** Writes the 4 elements of a row. */
+inline decimal_t* rowOf(Matrix4& mat, int row) {
+  return mat[row];
+}
+
+void composeScalar(const TRSArrays& in, size_t begin, size_t end, Matrix4* out) {
+  for (size_t i = begin; i < end; ++i) {
+    const decimal_t x = in.qx[i], y = in.qy[i], z = in.qz[i], w = in.qw[i];
+    const decimal_t x2 = x * x, y2 = y * y, z2 = z * z;
+    const decimal_t xy = x * y, xz = x * z, yz = y * z;
+    const decimal_t wx = w * x, wy = w * y, wz = w * z;
+    const decimal_t sx = in.sx[i], sy = in.sy[i], sz = in.sz[i];
+    out[i] = Matrix4(
+      (1 - 2 * (y2 + z2)) * sx, 2 * (xy - wz) * sx, 2 * (xz + wy) * sx, 0,
+      2 * (xy + wz) * sy, (1 - 2 * (x2 + z2)) * sy, 2 * (yz - wx) * sy, 0,
+      2 * (xz - wy) * sz, 2 * (yz + wx) * sz, (1 - 2 * (x2 + y2)) * sz, 0,
+      in.px[i], in.py[i], in.pz[i], 1);
+  }
+}
+
+#if defined(AMS_SPATIAL_SSE)
+/** Transposes 4 lanes of 4 values, so that each output holds one row of one matrix, and stores them. */
+inline void storeRows(Matrix4* out, int row, __m128 a, __m128 b, __m128 c, __m128 d) {
+  _MM_TRANSPOSE4_PS(a, b, c, d);
+  _mm_storeu_ps(rowOf(out[0], row), a);
+  _mm_storeu_ps(rowOf(out[1], row), b);
+  _mm_storeu_ps(rowOf(out[2], row), c);
+  _mm_storeu_ps(rowOf(out[3], row), d);
+}
+
+size_t composeSIMD(const TRSArrays& in, size_t count, Matrix4* out) {
+  const __m128 one = _mm_set1_ps(1.0f);
+  const __m128 two = _mm_set1_ps(2.0f);
+  const __m128 zero = _mm_setzero_ps();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m128 x = _mm_loadu_ps(in.qx + i), y = _mm_loadu_ps(in.qy + i);
+    __m128 z = _mm_loadu_ps(in.qz + i), w = _mm_loadu_ps(in.qw + i);
+    __m128 x2 = _mm_mul_ps(x, x), y2 = _mm_mul_ps(y, y), z2 = _mm_mul_ps(z, z);
+    __m128 xy = _mm_mul_ps(x, y), xz = _mm_mul_ps(x, z), yz = _mm_mul_ps(y, z);
+    __m128 wx = _mm_mul_ps(w, x), wy = _mm_mul_ps(w, y), wz = _mm_mul_ps(w, z);
+    __m128 sx = _mm_loadu_ps(in.sx + i), sy = _mm_loadu_ps(in.sy + i), sz = _mm_loadu_ps(in.sz + i);
+    
+    storeRows(out + i, 0,
+      _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(y2, z2))), sx),
+      _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xy, wz)), sx),
+      _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xz, wy)), sx),
+      zero);
+    storeRows(out + i, 1,
+      _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(xy, wz)), sy),
+      _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(x2, z2))), sy),
+      _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(yz, wx)), sy),
+      zero);
+    storeRows(out + i, 2,
+      _mm_mul_ps(_mm_mul_ps(two, _mm_sub_ps(xz, wy)), sz),
+      _mm_mul_ps(_mm_mul_ps(two, _mm_add_ps(yz, wx)), sz),
+      _mm_mul_ps(_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(x2, y2))), sz),
+      zero);
+    storeRows(out + i, 3, _mm_loadu_ps(in.px + i), _mm_loadu_ps(in.py + i), _mm_loadu_ps(in.pz + i), one);
+  }
+  return i;
+}
+#elif defined(AMS_SPATIAL_AVX)
+/** Transposes 4 lanes of 4 values, so that each output holds one row of one matrix. */
+inline void transpose4(__m256d& a, __m256d& b, __m256d& c, __m256d& d) {
+  __m256d t0 = _mm256_unpacklo_pd(a, b); // a0 b0 a2 b2
+  __m256d t1 = _mm256_unpackhi_pd(a, b); // a1 b1 a3 b3
+  __m256d t2 = _mm256_unpacklo_pd(c, d); // c0 d0 c2 d2
+  __m256d t3 = _mm256_unpackhi_pd(c, d); // c1 d1 c3 d3
+  a = _mm256_permute2f128_pd(t0, t2, 0x20); // a0 b0 c0 d0
+  b = _mm256_permute2f128_pd(t1, t3, 0x20); // a1 b1 c1 d1
+  c = _mm256_permute2f128_pd(t0, t2, 0x31); // a2 b2 c2 d2
+  d = _mm256_permute2f128_pd(t1, t3, 0x31); // a3 b3 c3 d3
+}
+
+size_t composeSIMD(const TRSArrays& in, size_t count, Matrix4* out) {
+  const __m256d one = _mm256_set1_pd(1.0);
+  const __m256d two = _mm256_set1_pd(2.0);
+  const __m256d zero = _mm256_setzero_pd();
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    __m256d x = _mm256_loadu_pd(in.qx + i), y = _mm256_loadu_pd(in.qy + i);
+    __m256d z = _mm256_loadu_pd(in.qz + i), w = _mm256_loadu_pd(in.qw + i);
+    __m256d x2 = _mm256_mul_pd(x, x), y2 = _mm256_mul_pd(y, y), z2 = _mm256_mul_pd(z, z);
+    __m256d xy = _mm256_mul_pd(x, y), xz = _mm256_mul_pd(x, z), yz = _mm256_mul_pd(y, z);
+    __m256d wx = _mm256_mul_pd(w, x), wy = _mm256_mul_pd(w, y), wz = _mm256_mul_pd(w, z);
+    __m256d sx = _mm256_loadu_pd(in.sx + i), sy = _mm256_loadu_pd(in.sy + i), sz = _mm256_loadu_pd(in.sz + i);
+    
+    __m256d r0 = _mm256_mul_pd(_mm256_sub_pd(one, _mm256_mul_pd(two, _mm256_add_pd(y2, z2))), sx);
+    __m256d r1 = _mm256_mul_pd(_mm256_mul_pd(two, _mm256_sub_pd(xy, wz)), sx);
+    __m256d r2 = _mm256_mul_pd(_mm256_mul_pd(two, _mm256_add_pd(xz, wy)), sx);
+    __m256d r3 = zero;
+    transpose4(r0, r1, r2, r3);
+    _mm256_storeu_pd(rowOf(out[i], 0), r0);
+    _mm256_storeu_pd(rowOf(out[i + 1], 0), r1);
+    _mm256_storeu_pd(rowOf(out[i + 2], 0), r2);
+    _mm256_storeu_pd(rowOf(out[i + 3], 0), r3);
+    
+    r0 = _mm256_mul_pd(_mm256_mul_pd(two, _mm256_add_pd(xy, wz)), sy);
+    r1 = _mm256_mul_pd(_mm256_sub_pd(one, _mm256_mul_pd(two, _mm256_add_pd(x2, z2))), sy);
+    r2 = _mm256_mul_pd(_mm256_mul_pd(two, _mm256_sub_pd(yz, wx)), sy);
+    r3 = zero;
+    transpose4(r0, r1, r2, r3);
+    _mm256_storeu_pd(rowOf(out[i], 1), r0);
+    _mm256_storeu_pd(rowOf(out[i + 1], 1), r1);
+    _mm256_storeu_pd(rowOf(out[i + 2], 1), r2);
+    _mm256_storeu_pd(rowOf(out[i + 3], 1), r3);
+    
+    r0 = _mm256_mul_pd(_mm256_mul_pd(two, _mm256_sub_pd(xz, wy)), sz);
+    r1 = _mm256_mul_pd(_mm256_mul_pd(two, _mm256_add_pd(yz, wx)), sz);
+    r2 = _mm256_mul_pd(_mm256_sub_pd(one, _mm256_mul_pd(two, _mm256_add_pd(x2, y2))), sz);
+    r3 = zero;
+    transpose4(r0, r1, r2, r3);
+    _mm256_storeu_pd(rowOf(out[i], 2), r0);
+    _mm256_storeu_pd(rowOf(out[i + 1], 2), r1);
+    _mm256_storeu_pd(rowOf(out[i + 2], 2), r2);
+    _mm256_storeu_pd(rowOf(out[i + 3], 2), r3);
+    
+    r0 = _mm256_loadu_pd(in.px + i);
+    r1 = _mm256_loadu_pd(in.py + i);
+    r2 = _mm256_loadu_pd(in.pz + i);
+    r3 = one;
+    transpose4(r0, r1, r2, r3);
+    _mm256_storeu_pd(rowOf(out[i], 3), r0);
+    _mm256_storeu_pd(rowOf(out[i + 1], 3), r1);
+    _mm256_storeu_pd(rowOf(out[i + 2], 3), r2);
+    _mm256_storeu_pd(rowOf(out[i + 3], 3), r3);
+  }
+  return i;
+}
+#elif defined(AMS_SPATIAL_SSE2)
+/** Stores a row of 2 matrices from 2 lanes of 4 values. */
+inline void storeRows(Matrix4* out, int row, __m128d a, __m128d b, __m128d c, __m128d d) {
+  _mm_storeu_pd(rowOf(out[0], row), _mm_unpacklo_pd(a, b));
+  _mm_storeu_pd(rowOf(out[0], row) + 2, _mm_unpacklo_pd(c, d));
+  _mm_storeu_pd(rowOf(out[1], row), _mm_unpackhi_pd(a, b));
+  _mm_storeu_pd(rowOf(out[1], row) + 2, _mm_unpackhi_pd(c, d));
+}
+
+size_t composeSIMD(const TRSArrays& in, size_t count, Matrix4* out) {
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d two = _mm_set1_pd(2.0);
+  const __m128d zero = _mm_setzero_pd();
+  size_t i = 0;
+  for (; i + 2 <= count; i += 2) {
+    __m128d x = _mm_loadu_pd(in.qx + i), y = _mm_loadu_pd(in.qy + i);
+    __m128d z = _mm_loadu_pd(in.qz + i), w = _mm_loadu_pd(in.qw + i);
+    __m128d x2 = _mm_mul_pd(x, x), y2 = _mm_mul_pd(y, y), z2 = _mm_mul_pd(z, z);
+    __m128d xy = _mm_mul_pd(x, y), xz = _mm_mul_pd(x, z), yz = _mm_mul_pd(y, z);
+    __m128d wx = _mm_mul_pd(w, x), wy = _mm_mul_pd(w, y), wz = _mm_mul_pd(w, z);
+    __m128d sx = _mm_loadu_pd(in.sx + i), sy = _mm_loadu_pd(in.sy + i), sz = _mm_loadu_pd(in.sz + i);
+    
+    storeRows(out + i, 0,
+      _mm_mul_pd(_mm_sub_pd(one, _mm_mul_pd(two, _mm_add_pd(y2, z2))), sx),
+      _mm_mul_pd(_mm_mul_pd(two, _mm_sub_pd(xy, wz)), sx),
+      _mm_mul_pd(_mm_mul_pd(two, _mm_add_pd(xz, wy)), sx),
+      zero);
+    storeRows(out + i, 1,
+      _mm_mul_pd(_mm_mul_pd(two, _mm_add_pd(xy, wz)), sy),
+      _mm_mul_pd(_mm_sub_pd(one, _mm_mul_pd(two, _mm_add_pd(x2, z2))), sy),
+      _mm_mul_pd(_mm_mul_pd(two, _mm_sub_pd(yz, wx)), sy),
+      zero);
+    storeRows(out + i, 2,
+      _mm_mul_pd(_mm_mul_pd(two, _mm_sub_pd(xz, wy)), sz),
+      _mm_mul_pd(_mm_mul_pd(two, _mm_add_pd(yz, wx)), sz),
+      _mm_mul_pd(_mm_sub_pd(one, _mm_mul_pd(two, _mm_add_pd(x2, y2))), sz),
+      zero);
+    storeRows(out + i, 3, _mm_loadu_pd(in.px + i), _mm_loadu_pd(in.py + i), _mm_loadu_pd(in.pz + i), one);
+  }
+  return i;
+}
+#else
+size_t composeSIMD(const TRSArrays&, size_t, Matrix4*) {
+  return 0;
+}
+#endif
+
+} // namespace
+
+void composeTRS(const TransformBatch& batch, std::span<Matrix4> out) {
+  auto count = batch.size();
+  if (out.size() < count) {
+    if constexpr (AMSExceptions)
+      throw std::invalid_argument("Output span is smaller than the batch");
+    count = out.size();
+  }
+  const TRSArrays in{
+    batch.mPositionX.data(), batch.mPositionY.data(), batch.mPositionZ.data(),
+    batch.mRotationX.data(), batch.mRotationY.data(), batch.mRotationZ.data(), batch.mRotationW.data(),
+    batch.mScaleX.data(), batch.mScaleY.data(), batch.mScaleZ.data()
+  };
+  auto done = composeSIMD(in, count, out.data());
+  composeScalar(in, done, count, out.data());
+}
+
+} // ams
@@ -0,0 +1,134 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#ifndef AMS_MODULES
+#include "../../include/ams/spatial/TransformPoints.hpp"
+#include "../../include/ams/spatial/internal/simd.hpp"
+#include <ams/JobSystem.hpp>
+#else
+import ams.spatial.TransformPoints;
+import ams.spatial.internal.simd;
+import ams.JobSystem;
+#endif
+#include <cmath>
+#include <stdexcept>
+
+namespace ams {
+
+namespace {
+
+enum class Kind {
+  Point,
+  Vector,
+  Normal,
+  Projection
+};
+
+using Pack = simd::Pack4<decimal_t>;
+
+/**
+ * Transforms in[begin, end) into out. Each element is a row vector, so its image is the sum of the rows of the matrix
+ * scaled by its components: one pack holds the x, y, z and w of the result, and the matrix stays in four packs for
+ * the whole range. Each element is read before its result is written, so in and out may be the same array.
+ */
+template<Kind K>
+void transformRange(const Vec3<decimal_t>* in, Vec3<decimal_t>* out, size_t begin, size_t end, const Matrix4& m) {
+  const Pack row0 = Pack::load(m[0]), row1 = Pack::load(m[1]), row2 = Pack::load(m[2]);
+  const Pack row3 = Pack::load(m[3]);
+  for (size_t i = begin; i < end; ++i) {
+    Pack r = Pack::broadcast(in[i].x) * row0 + Pack::broadcast(in[i].y) * row1 + Pack::broadcast(in[i].z) * row2;
+    if constexpr (K == Kind::Point || K == Kind::Projection)
+      r = r + row3;
+    if constexpr (K == Kind::Projection) {
+      alignas(32) decimal_t clip[4];
+      r.store(clip);
+      r = r * Pack::broadcast(1 / clip[3]);
+    }
+    if constexpr (K == Kind::Normal) {
+      // the last column of the normal matrix is 0, so is w
+      const decimal_t lengthSquared = (r * r).sum();
+      if (lengthSquared > 0)
+        r = r * Pack::broadcast(1 / std::sqrt(lengthSquared));
+    }
+    r.store3(&out[i].x);
+  }
+}
+
+/** Checks the spans and runs transformRange() on the calling thread or across the JobSystem. */
+template<Kind K>
+void transformAll(std::span<const Vec3<decimal_t>> in, const Matrix4& matrix, std::span<Vec3<decimal_t>> out) {
+  auto count = in.size();
+  if (out.size() < count) {
+    if constexpr (AMSExceptions)
+      throw std::invalid_argument("Output span is smaller than the input span");
+    count = out.size();
+  }
+  if (count < ParallelTransformThreshold) {
+    transformRange<K>(in.data(), out.data(), 0, count, matrix);
+    return;
+  }
+  auto& jobs = JobSystem::getInstance();
+  jobs.wait(jobs.parallelFor(count, ParallelTransformGrainSize, [&](size_t begin, size_t end) {
+    transformRange<K>(in.data(), out.data(), begin, end, matrix);
+  }));
+}
+
+/**
+ * Builds the matrix which transforms normals: the cofactor matrix of the upper 3x3, which is the inverse transpose
+ * scaled by the determinant. The sign of the determinant is kept so that mirroring transforms do not flip the
+ * normals, and its magnitude is dropped since the normals are normalized afterwards.
+ */
+Matrix4 normalMatrix(const Matrix4& m) {
+  Matrix4 n;
+  n[0][0] = m[1][1] * m[2][2] - m[1][2] * m[2][1];
+  n[0][1] = m[1][2] * m[2][0] - m[1][0] * m[2][2];
+  n[0][2] = m[1][0] * m[2][1] - m[1][1] * m[2][0];
+  n[1][0] = m[0][2] * m[2][1] - m[0][1] * m[2][2];
+  n[1][1] = m[0][0] * m[2][2] - m[0][2] * m[2][0];
+  n[1][2] = m[0][1] * m[2][0] - m[0][0] * m[2][1];
+  n[2][0] = m[0][1] * m[1][2] - m[0][2] * m[1][1];
+  n[2][1] = m[0][2] * m[1][0] - m[0][0] * m[1][2];
+  n[2][2] = m[0][0] * m[1][1] - m[0][1] * m[1][0];
+  const decimal_t det = m[0][0] * n[0][0] + m[0][1] * n[0][1] + m[0][2] * n[0][2];
+  if (det < 0) {
+    for (int i = 0; i < 3; ++i)
+      for (int j = 0; j < 3; ++j)
+        n[i][j] = -n[i][j];
+  }
+  return n;
+}
+
+} // namespace
+
+void transformPoints(std::span<const Vec3<decimal_t>> points, const Matrix4& matrix, std::span<Vec3<decimal_t>> out) {
+  transformAll<Kind::Point>(points, matrix, out);
+}
+
+void transformVectors(std::span<const Vec3<decimal_t>> vectors, const Matrix4& matrix,
+                      std::span<Vec3<decimal_t>> out) {
+  transformAll<Kind::Vector>(vectors, matrix, out);
+}
+
+void transformNormals(std::span<const Vec3<decimal_t>> normals, const Matrix4& matrix,
+                      std::span<Vec3<decimal_t>> out) {
+  transformAll<Kind::Normal>(normals, normalMatrix(matrix), out);
+}
+
+void projectPoints(std::span<const Vec3<decimal_t>> points, const Matrix4& matrix, std::span<Vec3<decimal_t>> out) {
+  transformAll<Kind::Projection>(points, matrix, out);
+}
+
+} // ams
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cassert>
+
+#ifndef AMS_MODULES
+#include <iostream>
+#include <ams/Delegate.hpp>
+#include <ams/Function.hpp>
+#else
+import <iostream>
+import ams.Delegate;
+import ams.Function;
+#endif
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+using namespace ams;
+
+/**
+ * Compares ams::Function with ams::Delegate: constructing and copying callbacks which capture three pointers, which
+ * is more than std::function stores inline, and calling them with an argument passed by reference.
+ * usage: profile_Delegate [iteration count]
+ */
+
+struct Payload {
+  double values[8];
+};
+
+template<typename TFunc>
+double timeMs(TFunc&& fn) {
+  auto start = steady_clock::now();
+  fn();
+  return duration_cast<duration<double, std::milli>>(steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  double a = 1, b = 2, c = 3;
+  Payload payload{};
+  payload.values[0] = 1;
+  
+  std::vector<Function<double, const Payload&>> functions;
+  std::vector<Delegate<double(const Payload&)>> delegates;
+  functions.reserve(count);
+  delegates.reserve(count);
+  
+  auto functionMake = timeMs([&] {
+    for (size_t i = 0; i < count; i++)
+      functions.emplace_back([pa = &a, pb = &b, pc = &c](const Payload& p) { return *pa + *pb + *pc + p.values[0]; });
+  });
+  auto delegateMake = timeMs([&] {
+    for (size_t i = 0; i < count; i++)
+      delegates.emplace_back([pa = &a, pb = &b, pc = &c](const Payload& p) { return *pa + *pb + *pc + p.values[0]; });
+  });
+  
+  double functionSum = 0, delegateSum = 0;
+  auto functionCall = timeMs([&] {
+    for (auto& f : functions)
+      functionSum += f(payload);
+  });
+  auto delegateCall = timeMs([&] {
+    for (auto& d : delegates)
+      delegateSum += d(payload);
+  });
+  
+  auto functionCopy = timeMs([&] {
+    auto copy = functions;
+    functionSum += copy.back()(payload);
+  });
+  auto delegateCopy = timeMs([&] {
+    auto copy = delegates;
+    delegateSum += copy.back()(payload);
+  });
+  
+  std::cout << count << " callbacks" << std::endl
+            << "construct  Function: " << functionMake << " ms, Delegate: " << delegateMake << " ms" << std::endl
+            << "call       Function: " << functionCall << " ms, Delegate: " << delegateCall << " ms" << std::endl
+            << "copy       Function: " << functionCopy << " ms, Delegate: " << delegateCopy << " ms" << std::endl;
+  assert(functionSum == delegateSum);
+  return 0;
+}
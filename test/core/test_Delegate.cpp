@@ -0,0 +1,148 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#ifndef AMS_MODULES
+#include <ams/Delegate.hpp>
+#else
+import ams.Delegate;
+#endif
+
+#include <memory>
+#include <string>
+
+namespace {
+
+/** Counts its live copies, to check that targets are destroyed exactly once. */
+struct Tracked {
+  inline static int alive = 0;
+  int* calls;
+  explicit Tracked(int* calls) : calls(calls) { alive++; }
+  Tracked(const Tracked& other) : calls(other.calls) { alive++; }
+  Tracked(Tracked&& other) noexcept : calls(other.calls) { alive++; }
+  ~Tracked() { alive--; }
+  void operator()() { (*calls)++; }
+};
+
+struct Counter {
+  int total = 0;
+  int add(int value) { return total += value; }
+};
+
+} // namespace
+
+TEST(Delegate, DefaultConstructor) {
+  ams::Delegate<void()> d;
+  EXPECT_FALSE(d);
+  EXPECT_EQ(d.id(), 0);
+}
+
+TEST(Delegate, InvokeWithArgsAndReturn) {
+  ams::Delegate<int(int, int)> d = [](int a, int b) { return a + b; };
+  EXPECT_TRUE(d);
+  EXPECT_EQ(d(1, 2), 3);
+}
+
+TEST(Delegate, ForwardsReferences) {
+  std::string text = "abc";
+  ams::Delegate<void(std::string&)> append = [](std::string& s) { s += "d"; };
+  append(text);
+  EXPECT_EQ(text, "abcd");
+  ams::Delegate<const std::string*(const std::string&)> address = [](const std::string& s) { return &s; };
+  EXPECT_EQ(address(text), &text); // not copied
+}
+
+TEST(Delegate, CopiesShareTheId) {
+  int calls = 0;
+  ams::Delegate<void()> d = [&calls]() { calls++; };
+  ams::Delegate<void()> copy(d);
+  ams::Delegate<void()> other = [&calls]() { calls++; };
+  EXPECT_EQ(d, copy);
+  EXPECT_NE(d, other);
+  copy();
+  d();
+  EXPECT_EQ(calls, 2);
+  
+  ams::Delegate<void()> assigned;
+  assigned = d;
+  EXPECT_EQ(assigned, d);
+}
+
+TEST(Delegate, MoveEmptiesTheSource) {
+  int calls = 0;
+  ams::Delegate<void()> d = [&calls]() { calls++; };
+  auto id = d.id();
+  ams::Delegate<void()> moved(std::move(d));
+  EXPECT_FALSE(d);
+  EXPECT_EQ(moved.id(), id);
+  moved();
+  
+  ams::Delegate<void()> assigned;
+  assigned = std::move(moved);
+  EXPECT_FALSE(moved);
+  assigned();
+  EXPECT_EQ(calls, 2);
+}
+
+TEST(Delegate, DestroysTargets) {
+  int calls = 0;
+  {
+    ams::Delegate<void()> d = Tracked(&calls);
+    auto copy = d;
+    auto moved = std::move(copy);
+    moved();
+    d = nullptr;
+    EXPECT_EQ(Tracked::alive, 1);
+    d = moved;
+    EXPECT_EQ(Tracked::alive, 2);
+    d.reset();
+    EXPECT_FALSE(d);
+  }
+  EXPECT_EQ(Tracked::alive, 0);
+  EXPECT_EQ(calls, 1);
+}
+
+TEST(Delegate, MoveOnlyTargets) {
+  auto value = std::make_unique<int>(42);
+  ams::UniqueDelegate<int()> d = [value = std::move(value)]() { return *value; };
+  ams::UniqueDelegate<int()> moved = std::move(d);
+  EXPECT_EQ(moved(), 42);
+  EXPECT_FALSE(std::is_copy_constructible_v<ams::UniqueDelegate<int()>>);
+}
+
+TEST(Delegate, BindMemberFunction) {
+  Counter counter;
+  auto d = ams::Delegate<int(int)>::bind<&Counter::add>(&counter);
+  d(2);
+  EXPECT_EQ(d(3), 5);
+  EXPECT_EQ(counter.total, 5);
+}
+
+TEST(Delegate, CustomBufferSize) {
+  char large[48] = {};
+  large[47] = 7;
+  ams::Delegate<int(), 64> d = [large]() { return static_cast<int>(large[47]); };
+  EXPECT_EQ(d(), 7);
+}
+
+#ifdef AMS_EXCEPTIONS
+TEST(Delegate, InvokeEmptyThrows) {
+  ams::Delegate<void()> d;
+  EXPECT_THROW(d(), std::bad_function_call);
+}
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#ifndef AMS_MODULES
+#include <ams/IdAllocator.hpp>
+#include <ams/Function.hpp>
+#else
+import ams.IdAllocator;
+import ams.Function;
+#endif
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace ams;
+
+TEST(IdAllocator, IdsAreUniqueAcrossThreads) {
+  constexpr size_t threadCount = 8;
+  constexpr size_t idsPerThread = 20000;
+  std::vector<std::vector<uint64_t>> ids(threadCount);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < threadCount; t++) {
+    threads.emplace_back([&ids, t] {
+      ids[t].reserve(idsPerThread);
+      for (size_t i = 0; i < idsPerThread; i++)
+        ids[t].push_back(IdAllocator::next());
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  
+  std::vector<uint64_t> all;
+  for (auto& threadIds : ids)
+    all.insert(all.end(), threadIds.begin(), threadIds.end());
+  std::sort(all.begin(), all.end());
+  EXPECT_EQ(std::adjacent_find(all.begin(), all.end()), all.end());
+  EXPECT_NE(all.front(), 0);
+}
+
+TEST(IdAllocator, MixIsABijection) {
+  std::vector<uint64_t> mixed;
+  for (uint64_t i = 0; i < 4096; i++)
+    mixed.push_back(IdAllocator::mix(i));
+  std::sort(mixed.begin(), mixed.end());
+  EXPECT_EQ(std::adjacent_find(mixed.begin(), mixed.end()), mixed.end());
+  static_assert(IdAllocator::mix(0) == 0);
+}
+
+TEST(IdAllocator, FunctionIds) {
+  Function<void> a([] {});
+  Function<void> b([] {});
+  EXPECT_NE(a.id(), b.id());
+  Function<void> c(a);
+  EXPECT_EQ(a, c);
+}
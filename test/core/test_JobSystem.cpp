@@ -0,0 +1,123 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#ifndef AMS_MODULES
+#include <ams/JobSystem.hpp>
+#else
+import ams.JobSystem;
+#endif
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+using namespace ams;
+
+TEST(JobSystem, ScheduleAndWait) {
+  JobSystem jobs(2);
+  std::atomic<int> value = 0;
+  auto handle = jobs.schedule([&] { value = 42; });
+  handle.wait();
+  EXPECT_TRUE(handle.isComplete());
+  EXPECT_EQ(value, 42);
+}
+
+TEST(JobSystem, EmptyHandleIsComplete) {
+  JobHandle handle;
+  EXPECT_TRUE(handle.isComplete());
+  handle.wait();
+}
+
+TEST(JobSystem, NoWorkersRunsOnWaitingThread) {
+  JobSystem jobs(0);
+  EXPECT_EQ(jobs.getWorkerCount(), 0);
+  int value = 0;
+  auto handle = jobs.schedule([&] { value = 1; });
+  jobs.wait(handle);
+  EXPECT_EQ(value, 1);
+}
+
+TEST(JobSystem, Dependencies) {
+  JobSystem jobs(4);
+  std::vector<int> order;
+  std::mutex mutex;
+  auto record = [&](int i) {
+    std::scoped_lock lock(mutex);
+    order.push_back(i);
+  };
+  auto a = jobs.schedule([&] { record(0); });
+  auto b = jobs.schedule([&] { record(1); }, {a});
+  auto c = jobs.schedule([&] { record(2); }, {a, b});
+  c.wait();
+  ASSERT_EQ(order.size(), 3);
+  EXPECT_EQ(order[0], 0);
+  EXPECT_EQ(order[1], 1);
+  EXPECT_EQ(order[2], 2);
+}
+
+TEST(JobSystem, ParallelFor) {
+  JobSystem jobs(4);
+  std::vector<int> values(10000, 0);
+  auto handle = jobs.parallelFor(values.size(), 64, [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; i++)
+      values[i] = static_cast<int>(i);
+  });
+  handle.wait();
+  for (size_t i = 0; i < values.size(); i++)
+    EXPECT_EQ(values[i], static_cast<int>(i));
+}
+
+TEST(JobSystem, NestedWait) {
+  JobSystem jobs(2);
+  std::atomic<int> sum = 0;
+  auto outer = jobs.parallelFor(8, 1, [&](size_t begin, size_t end) {
+    auto inner = jobs.parallelFor(100, 10, [&](size_t b, size_t e) { sum += static_cast<int>(e - b); });
+    inner.wait(); // waiting inside a job runs other jobs instead of blocking the worker
+  });
+  outer.wait();
+  EXPECT_EQ(sum, 800);
+}
+
+TEST(JobSystem, Exceptions) {
+  JobSystem jobs(2);
+  std::atomic<bool> ran = false;
+  auto failed = jobs.schedule([] { throw std::runtime_error("job failed"); });
+  auto dependent = jobs.schedule([&] { ran = true; }, {failed});
+  EXPECT_THROW(failed.wait(), std::runtime_error);
+  EXPECT_TRUE(failed.isComplete());
+  // every waiter sees the exception, and the jobs which depend on the failed one do not run
+  EXPECT_THROW(jobs.wait(failed), std::runtime_error);
+  EXPECT_THROW(dependent.wait(), std::runtime_error);
+  EXPECT_FALSE(ran);
+  EXPECT_THROW(jobs.schedule([&] { ran = true; }, {failed}).wait(), std::runtime_error);
+  EXPECT_FALSE(ran);
+  
+  // a chunk which throws on the waiting thread completes, and the others still run
+  JobSystem inline0(0);
+  std::atomic<int> chunks = 0;
+  auto handle = inline0.parallelFor(8, 1, [&](size_t begin, size_t) {
+    chunks++;
+    if (begin == 3)
+      throw std::runtime_error("chunk failed");
+  });
+  EXPECT_THROW(handle.wait(), std::runtime_error);
+  EXPECT_EQ(chunks, 8);
+  EXPECT_NO_THROW(jobs.schedule([] {}).wait());
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#ifndef AMS_MODULES
+#include <ams/MappedFile.hpp>
+#else
+import ams.MappedFile;
+#endif
+
+#include <cstring>
+#include <fstream>
+
+using namespace ams;
+
+TEST(MappedFile, MapsContents) {
+  auto path = std::filesystem::temp_directory_path() / "ams_test_MappedFile.bin";
+  {
+    std::ofstream out(path, std::ios::binary);
+    out << "mapped contents";
+  }
+  MappedFile file(path);
+  ASSERT_EQ(file.size(), 15);
+  EXPECT_EQ(std::memcmp(file.data().data(), "mapped contents", 15), 0);
+  
+  MappedFile moved(std::move(file));
+  EXPECT_TRUE(file.empty());
+  EXPECT_EQ(moved.size(), 15);
+  moved.close();
+  EXPECT_TRUE(moved.empty());
+  std::filesystem::remove(path);
+}
+
+TEST(MappedFile, MissingFileThrows) {
+  EXPECT_THROW(MappedFile(std::filesystem::temp_directory_path() / "ams_test_missing.bin"), std::runtime_error);
+}
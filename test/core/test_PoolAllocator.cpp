@@ -0,0 +1,112 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#ifndef AMS_MODULES
+#include <ams/PoolAllocator.hpp>
+#else
+import ams.PoolAllocator;
+#endif
+
+#include <algorithm>
+#include <memory_resource>
+#include <set>
+#include <vector>
+
+using namespace ams;
+
+TEST(PoolAllocator, ReusesFreedBlocks) {
+  PoolAllocator pool(sizeof(int), alignof(int), 4);
+  auto* a = pool.allocate();
+  auto* b = pool.allocate();
+  EXPECT_NE(a, b);
+  EXPECT_EQ(pool.size(), 2);
+  pool.deallocate(a);
+  EXPECT_EQ(pool.allocate(), a);
+  EXPECT_EQ(pool.capacity(), 4);
+}
+
+TEST(PoolAllocator, BlocksAreAligned) {
+  PoolAllocator pool(24, 32, 8);
+  EXPECT_EQ(pool.getBlockSize(), 32);
+  std::set<void*> blocks;
+  for (int i = 0; i < 20; i++) {
+    auto* block = pool.allocate();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % 32, 0);
+    blocks.insert(block);
+  }
+  EXPECT_EQ(blocks.size(), 20);
+  EXPECT_EQ(pool.capacity(), 24);
+}
+
+namespace {
+struct Base {
+  virtual ~Base() = default;
+  int base = 1;
+};
+
+struct Derived : Base {
+  explicit Derived(int* destroyed) : destroyed(destroyed) {}
+  ~Derived() override { ++*destroyed; }
+  int* destroyed;
+};
+}
+
+TEST(PoolAllocator, MakeDeletesThroughBase) {
+  int destroyed = 0;
+  PoolAllocator pool(sizeof(Derived), alignof(Derived));
+  {
+    PoolPtr<Base> value = pool.make<Derived>(&destroyed);
+    EXPECT_EQ(value->base, 1);
+    EXPECT_EQ(pool.size(), 1);
+  }
+  EXPECT_EQ(destroyed, 1);
+  EXPECT_EQ(pool.size(), 0);
+}
+
+TEST(PoolAllocator, ReleaseIntoArena) {
+  std::pmr::monotonic_buffer_resource arena;
+  PoolAllocator small(8, 8, 16, &arena);
+  PoolAllocator large(64, 8, 16, &arena);
+  for (int i = 0; i < 100; i++) {
+    (void)small.allocate();
+    (void)large.allocate();
+  }
+  small.release();
+  large.release();
+  EXPECT_EQ(small.size(), 0);
+  EXPECT_EQ(large.capacity(), 0);
+  arena.release();
+  // the pools can be used again after the arena was released
+  EXPECT_NE(small.allocate(), nullptr);
+}
+
+TEST(PoolAllocator, ReserveRequestsOneChunk) {
+  PoolAllocator pool(16, 8, 4);
+  (void)pool.allocate();
+  pool.reserve(100);
+  EXPECT_EQ(pool.capacity(), 4 + 97);
+  std::vector<void*> blocks;
+  for (int i = 0; i < 100; i++)
+    blocks.push_back(pool.allocate());
+  EXPECT_EQ(pool.capacity(), 4 + 97);
+  std::sort(blocks.begin(), blocks.end());
+  EXPECT_EQ(std::adjacent_find(blocks.begin(), blocks.end()), blocks.end());
+  pool.reserve(0);
+  EXPECT_EQ(pool.size(), 101);
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#ifndef AMS_MODULES
+#include <ams/SlotMap.hpp>
+#else
+import ams.SlotMap;
+#endif
+
+#include <memory>
+
+using namespace ams;
+
+TEST(SlotMap, InsertGet) {
+  SlotMap<int> map;
+  auto a = map.insert(1);
+  auto b = map.insert(2);
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_TRUE(map.contains(a));
+  EXPECT_TRUE(map.contains(b));
+  EXPECT_EQ(*map.get(a), 1);
+  EXPECT_EQ(map[b], 2);
+}
+
+TEST(SlotMap, NullHandle) {
+  SlotMap<int> map;
+  map.insert(1);
+  SlotHandle handle;
+  EXPECT_TRUE(handle.isNull());
+  EXPECT_FALSE(map.contains(handle));
+  EXPECT_EQ(map.get(handle), nullptr);
+}
+
+TEST(SlotMap, EraseKeepsOthersValid) {
+  SlotMap<int> map;
+  auto a = map.insert(1);
+  auto b = map.insert(2);
+  auto c = map.insert(3);
+  EXPECT_TRUE(map.erase(a));
+  EXPECT_FALSE(map.erase(a));
+  EXPECT_EQ(map.size(), 2);
+  EXPECT_EQ(map[b], 2);
+  EXPECT_EQ(map[c], 3);
+}
+
+TEST(SlotMap, StaleHandleAfterReuse) {
+  SlotMap<int> map;
+  auto a = map.insert(1);
+  map.erase(a);
+  auto b = map.insert(2);
+  EXPECT_EQ(a.index, b.index); // the slot is reused
+  EXPECT_NE(a.generation, b.generation);
+  EXPECT_FALSE(map.contains(a));
+  EXPECT_EQ(map.get(a), nullptr);
+  if (AMSExceptions) {
+    EXPECT_ANY_THROW(map[a]);
+  }
+  EXPECT_EQ(map[b], 2);
+}
+
+TEST(SlotMap, DenseIteration) {
+  SlotMap<int> map;
+  std::vector<SlotHandle> handles;
+  for (int i = 0; i < 100; i++)
+    handles.push_back(map.insert(i));
+  for (int i = 0; i < 100; i += 2)
+    map.erase(handles[i]);
+  int sum = 0;
+  for (auto value : map)
+    sum += value;
+  EXPECT_EQ(map.size(), 50);
+  EXPECT_EQ(sum, 2500); // 1 + 3 + ... + 99
+  for (size_t i = 0; i < map.size(); i++)
+    EXPECT_EQ(map[map.handleAt(i)], map.data()[i]);
+}
+
+TEST(SlotMap, Clear) {
+  SlotMap<std::unique_ptr<int>> map;
+  auto a = map.insert(std::make_unique<int>(1));
+  map.clear();
+  EXPECT_TRUE(map.empty());
+  EXPECT_FALSE(map.contains(a));
+  auto b = map.insert(std::make_unique<int>(2));
+  EXPECT_EQ(*map[b], 2);
+}
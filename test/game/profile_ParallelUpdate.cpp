@@ -0,0 +1,110 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cassert>
+
+#ifndef AMS_MODULES
+#include <iostream>
+#include <ams/game.hpp>
+#include <ams/game/Util.hpp>
+#else
+import <iostream>
+import ams.game;
+import ams.game.Util;
+#endif
+
+#include <cmath>
+#include <string>
+
+using namespace std::chrono;
+using namespace ams;
+
+/**
+ * Compares single-threaded and parallel Scene updates.
+ * usage: profile_ParallelUpdate [entity count] [frame count]
+ */
+
+class BenchApplication : public Application {
+private:
+  size_t _frameCount;
+  size_t _frame = 0;
+  time_point<clk_t> _frameStart;
+public:
+  clk_t::duration total{};
+  
+  BenchApplication(const std::string& name, size_t frameCount) : Application(name), _frameCount(frameCount) {}
+
+protected:
+  void onFrameStart() override {
+    _frameStart = clk_t::now();
+  }
+  
+  void onFrameEnd() override {
+    total += clk_t::now() - _frameStart;
+    if (++_frame >= _frameCount)
+      stop();
+  }
+};
+
+class Mover : public Behavior {
+AMSBehavior(Mover)
+private:
+  decimal_t _phase = 0;
+public:
+  using Access = ComponentAccess<Read<>, Write<Transform>>;
+  
+  void onStart() override {
+    _phase = static_cast<decimal_t>(getId() % 628) / 100;
+  }
+  
+  void onUpdate() override {
+    auto* transform = entity->getTransform();
+    _phase += 0.01;
+    transform->setPosition(std::cos(_phase), std::sin(_phase), _phase);
+    transform->setScale(1 + std::sin(_phase) * 0.5, 1, 1);
+    transform->updateModelMatrix();
+  }
+};
+
+double runFrames(size_t entityCount, size_t frameCount, bool parallel) {
+  BenchApplication app("ParallelUpdate", frameCount);
+  auto* pScene = app.createScene("BenchScene");
+  for (size_t i = 0; i < entityCount; i++)
+    pScene->createEntity()->addComponent<Mover>();
+  pScene->setParallelUpdate(parallel);
+  app.setCurrentScene(pScene->getName());
+  app.setVsyncTime(0);
+  app.run();
+  auto frameMs = duration_cast<duration<double, std::milli>>(app.total).count() / static_cast<double>(frameCount);
+  app.exit();
+  return frameMs;
+}
+
+int main(int argc, char** argv) {
+  size_t entityCount = argc > 1 ? std::stoul(argv[1]) : 100000;
+  size_t frameCount = argc > 2 ? std::stoul(argv[2]) : 200;
+  
+  auto serialMs = runFrames(entityCount, frameCount, false);
+  auto parallelMs = runFrames(entityCount, frameCount, true);
+  
+  std::cout << entityCount << " entities, " << frameCount << " frames, "
+            << JobSystem::getInstance().getWorkerCount() << " workers" << std::endl
+            << "single-threaded: " << serialMs << " ms/frame" << std::endl
+            << "parallel:        " << parallelMs << " ms/frame" << std::endl
+            << "speedup:         " << serialMs / parallelMs << "x" << std::endl;
+  assert(parallelMs > 0);
+  return 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cassert>
+
+#ifndef AMS_MODULES
+#include <iostream>
+#include <ams/game.hpp>
+#include <ams/game/Mesh.hpp>
+#include <ams/game/Util.hpp>
+#else
+import <iostream>
+import ams.game;
+import ams.game.Mesh;
+import ams.game.Util;
+#endif
+
+#include <cmath>
+#include <filesystem>
+#include <string>
+#include <type_traits>
+
+using namespace std::chrono;
+using namespace ams;
+
+/**
+ * Measures the memory and throughput of mesh loading and transform updates in the precision of decimal_t.
+ * Build it once with AMS_DECIMAL_FLOAT=OFF and once with AMS_DECIMAL_FLOAT=ON to compare double and float.
+ * usage: profile_Precision [vertex count] [entity count] [frame count]
+ */
+
+template<typename TFunc>
+double timeMs(TFunc&& fn) {
+  auto start = clk_t::now();
+  fn();
+  return duration_cast<duration<double, std::milli>>(clk_t::now() - start).count();
+}
+
+Mesh makeGrid(size_t vertexCount) {
+  auto side = static_cast<size_t>(std::sqrt(static_cast<double>(vertexCount)));
+  Mesh::vertices_t vertices;
+  Mesh::normals_t normals;
+  Mesh::uvs_t uvs;
+  for (size_t i = 0; i < side * side; i++) {
+    auto u = static_cast<decimal_t>(i % side) / static_cast<decimal_t>(side);
+    auto v = static_cast<decimal_t>(i / side) / static_cast<decimal_t>(side);
+    vertices.emplace_back(u, std::sin(u * 10) * v, v);
+    normals.emplace_back(0, 1, 0);
+    uvs.emplace_back(u, v);
+  }
+  return {vertices, normals, {}, uvs};
+}
+
+int main(int argc, char** argv) {
+  size_t vertexCount = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  size_t entityCount = argc > 2 ? std::stoul(argv[2]) : 100000;
+  size_t frameCount = argc > 3 ? std::stoul(argv[3]) : 100;
+  
+  // mesh load
+  auto path = std::filesystem::temp_directory_path() / "profile_Precision.ams";
+  Mesh::saveToFile(makeGrid(vertexCount), path);
+  auto loadStart = clk_t::now();
+  auto mesh = Mesh::fromFile(path);
+  auto loadMs = duration_cast<duration<double, std::milli>>(clk_t::now() - loadStart).count();
+  auto meshBytes = mesh.getVertexCount() * sizeof(Mesh::vertex_elem_t) +
+                   mesh.getNormalCount() * sizeof(Mesh::normal_elem_t) + mesh.getUVCount() * sizeof(Mesh::uv_elem_t);
+  auto fileBytes = std::filesystem::file_size(path);
+  std::filesystem::remove(path);
+  
+  // transform update: every Transform moves every frame
+  Application app;
+  auto* pScene = app.createScene("BenchScene");
+  std::vector<Transform*> transforms;
+  for (size_t i = 0; i < entityCount; i++)
+    transforms.push_back(pScene->createEntity()->getTransform());
+  pScene->updateTransforms();
+  auto updateMs = timeMs([&] {
+    for (size_t frame = 0; frame < frameCount; frame++) {
+      auto phase = static_cast<decimal_t>(frame) / 100;
+      for (auto* transform : transforms)
+        transform->setPosition(std::cos(phase), std::sin(phase), phase);
+      pScene->updateTransforms();
+    }
+  }) / static_cast<double>(frameCount);
+  auto matrixBytes = pScene->getWorldMatrices().size() * sizeof(Matrix4);
+  
+  std::cout << "decimal_t: " << (std::is_same_v<decimal_t, float> ? "float" : "double") << std::endl
+            << "mesh: " << mesh.getVertexCount() << " vertices, " << meshBytes / 1024 << " KiB in memory, "
+            << fileBytes / 1024 << " KiB on disk, loaded in " << loadMs << " ms" << std::endl
+            << "transforms: " << entityCount << " entities, " << matrixBytes / 1024 << " KiB of world matrices, "
+            << updateMs << " ms/frame" << std::endl;
+  assert(mesh.getVertexCount() > 0);
+  app.exit();
+  return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <cassert>
+
+#ifndef AMS_MODULES
+#include <iostream>
+#include <ams/game.hpp>
+#include <ams/game/Util.hpp>
+#else
+import <iostream>
+import ams.game;
+import ams.game.Util;
+#endif
+
+#include <filesystem>
+#include <string>
+
+using namespace std::chrono;
+using namespace ams;
+namespace fs = std::filesystem;
+
+/**
+ * Measures capturing, saving and loading a scene snapshot, against building the same Scene Entity by Entity.
+ * usage: profile_SceneSnapshot [entity count]
+ */
+
+class Health : public Component {
+public:
+  struct SnapshotState {
+    int32_t health;
+    float armor;
+  };
+  
+  int32_t health = 100;
+  float armor = 0;
+  
+  using Component::Component;
+  
+  void saveSnapshot(SnapshotState& state) const { state = {health, armor}; }
+  void loadSnapshot(const SnapshotState& state) { health = state.health; armor = state.armor; }
+};
+
+template<> struct ams::StoreByValue<Health> : std::true_type {};
+
+template<typename TFunc>
+double measureMs(TFunc&& fn) {
+  auto start = clk_t::now();
+  fn();
+  return duration_cast<duration<double, std::milli>>(clk_t::now() - start).count();
+}
+
+/** Builds a forest of Entities in which every 8th Entity is a root, and every other Entity has a Health. */
+void build(Scene* scene, size_t entityCount) {
+  Transform* root = nullptr;
+  for (size_t i = 0; i < entityCount; i++) {
+    auto name = "Entity_" + std::to_string(i);
+    auto* entity = scene->createEntity(name, EntityCfg::Default, i % 8 == 0 ? nullptr : root);
+    if (i % 8 == 0)
+      root = entity->getTransform();
+    entity->getTransform()->setPosition(static_cast<decimal_t>(i), 0, 0);
+    if (i % 2 == 0)
+      entity->addComponent<Health>()->health = static_cast<int32_t>(i);
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t entityCount = argc > 1 ? std::stoul(argv[1]) : 100000;
+  SceneSnapshot::registerComponent<Health>();
+  auto path = fs::temp_directory_path() / "ams_profile_snapshot.bin";
+  
+  Application app("SceneSnapshot");
+  auto* pSource = app.createScene("Source");
+  auto buildMs = measureMs([&] { build(pSource, entityCount); });
+  std::vector<std::byte> snapshot;
+  auto captureMs = measureMs([&] { snapshot = SceneSnapshot::capture(*pSource); });
+  auto saveMs = measureMs([&] { SceneSnapshot::save(*pSource, path); });
+  auto* pLoaded = app.createScene("Loaded");
+  size_t loaded = 0;
+  auto loadMs = measureMs([&] { loaded = SceneSnapshot::load(*pLoaded, path); });
+  
+  std::cout << entityCount << " entities, " << snapshot.size() / 1024 << " KiB" << std::endl
+            << "build:   " << buildMs << " ms" << std::endl
+            << "capture: " << captureMs << " ms" << std::endl
+            << "save:    " << saveMs << " ms" << std::endl
+            << "load:    " << loadMs << " ms" << std::endl;
+  assert(loaded == entityCount);
+  fs::remove(path);
+  app.exit();
+  return 0;
+}
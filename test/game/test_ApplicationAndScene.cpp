@@ -11,7 +11,10 @@ import ams.game.Util;
 #endif
 
 #include <gtest/gtest.h>
+#include <atomic>
 #include <chrono>
+#include <thread>
+#include <vector>
 
 
 using std::to_string;
@@ -42,6 +45,35 @@ protected:
   }
 };
 
+/** Stalls its first frame, and records the fixed steps and the interpolation factor of its first two frames. */
+class TestStallApplication : public Application {
+private:
+  milliseconds stall;
+  int frame = 0;
+public:
+  std::vector<uint32_t> fixedSteps{};
+  std::vector<decimal_t> alphas{};
+  
+  TestStallApplication(const std::string& name, const milliseconds& stall) : Application(name), stall(stall) {}
+
+protected:
+  void onFrameStart() override {
+    fixedSteps.push_back(0);
+    if (frame == 0)
+      std::this_thread::sleep_for(stall);
+  }
+  
+  void onFixedFrameEnd() override {
+    ++fixedSteps.back();
+  }
+  
+  void onFrameEnd() override {
+    alphas.push_back(getInterpolationAlpha());
+    if (++frame == 2)
+      stop();
+  }
+};
+
 class TestBehaviorVirtMethods : public Behavior {
 AMSBehavior(TestBehaviorVirtMethods)
 private:
@@ -130,3 +162,106 @@ TEST(Application, AppWindow) {
   app.exit();
 }
 
+
+TEST(Application, AppLoadSceneAsync) {
+  TestApplication app("TestApp", 300ms);
+  auto* pPrevious = app.getCurrentScene();
+  pPrevious->createEntity()->addComponent<TestBehaviorVirtMethods>(); // destroyed in the background
+  auto previousName = pPrevious->getName(); // pPrevious is not used after the switch
+  
+  std::atomic<std::thread::id> builderThread;
+  EXPECT_TRUE(app.loadSceneAsync("LoadedScene", {[&](Scene* pScene) {
+    builderThread = std::this_thread::get_id();
+    for (int i = 0; i < 100; i++)
+      pScene->createEntity()->addComponent<TestBehaviorVirtMethods>();
+  }}));
+  EXPECT_TRUE(app.isLoadingScene());
+#ifdef AMS_EXCEPTIONS
+  EXPECT_ANY_THROW(app.loadSceneAsync("OtherScene", {[](Scene*) {}}));
+#else
+  EXPECT_FALSE(app.loadSceneAsync("OtherScene", {[](Scene*) {}}));
+#endif
+  // the current scene can not change until the loaded scene replaces it
+#ifdef AMS_EXCEPTIONS
+  EXPECT_ANY_THROW(app.setCurrentScene(previousName));
+#else
+  EXPECT_EQ(app.setCurrentScene(previousName), nullptr);
+#endif
+  EXPECT_EQ(app.getCurrentScene(), pPrevious);
+  app.run();
+  
+  EXPECT_FALSE(app.isLoadingScene());
+  EXPECT_NE(builderThread.load(), std::this_thread::get_id());
+  auto* pScene = app.getCurrentScene();
+  ASSERT_NE(pScene, nullptr);
+  EXPECT_EQ(pScene->getName(), "LoadedScene");
+  Scene* pRemoved = nullptr;
+  EXPECT_FALSE(app.tryGetScene(previousName, pRemoved)); // removed at the switch
+  int updated = 0;
+  pScene->forEach<TestBehaviorVirtMethods>([&](TestBehaviorVirtMethods* pComp) {
+    EXPECT_TRUE(pComp->testWasEnabled);
+    updated += pComp->testUpdate > 0;
+  });
+  EXPECT_EQ(updated, 100);
+  app.exit();
+}
+
+TEST(Application, AppMaxFixedStepsDropsLag) {
+  TestStallApplication app("TestApp", 200ms);
+  app.setMaxFixedSteps(3);
+  // the stall is worth 12 fixed steps, far more than the frame may run
+  ASSERT_GT(duration_cast<time_unit>(200ms), app.getFixedFrameTime() * (app.getMaxFixedSteps() + 1));
+  app.run();
+  ASSERT_EQ(app.fixedSteps.size(), 2);
+  EXPECT_EQ(app.fixedSteps[0], 3);
+  // the lag left after the stalled frame is less than one step, so the next frame does not catch up
+  EXPECT_GE(app.alphas[0], 0);
+  EXPECT_LT(app.alphas[0], 1);
+  EXPECT_LE(app.fixedSteps[1], 1);
+  app.exit();
+}
+
+TEST(Application, AppSceneChangeEvent) {
+  Application app;
+  auto* pDefault = app.getCurrentScene();
+  auto* pScene = app.createScene("TestScene");
+  std::vector<SceneChangeEvent> changes;
+  auto handle = app.getEventBus().subscribe<SceneChangeEvent>([&](std::span<const SceneChangeEvent> events) {
+    changes.insert(changes.end(), events.begin(), events.end());
+  });
+  app.setCurrentScene(pScene->getName());
+  EXPECT_TRUE(changes.empty()); // delivered when the bus is dispatched
+  app.getEventBus().dispatch();
+  ASSERT_EQ(changes.size(), 1);
+  EXPECT_EQ(changes[0].previous, pDefault->getId());
+  EXPECT_EQ(changes[0].current, pScene->getId());
+  EXPECT_TRUE(app.getEventBus().unsubscribe(handle));
+  app.exit();
+}
+
+TEST(Application, AppWindowCallbacks) {
+  Application app;
+  auto* pWindow = app.getWindow();
+  ASSERT_EQ(pWindow->getEventBus(), &app.getEventBus());
+  int refreshCount = 0;
+  std::vector<Vec2<int>> sizes;
+  std::vector<Vec2<int>> framebufferSizes;
+  auto refreshHandle = pWindow->registerWindowRefreshCallback({[&]() { ++refreshCount; }});
+  pWindow->registerWindowSizeCallback({[&](const Vec2<int>& size) { sizes.push_back(size); }});
+  pWindow->registerFramebufferSizeCallback({[&](const Vec2<int>& size) { framebufferSizes.push_back(size); }});
+  app.getEventBus().publish(WindowRefreshEvent{pWindow});
+  app.getEventBus().publish(WindowRefreshEvent{nullptr}); // another window
+  app.getEventBus().publish(WindowSizeEvent{pWindow, 640, 480, true});
+  EXPECT_EQ(refreshCount, 0); // delivered when the bus is dispatched
+  app.getEventBus().dispatch();
+  EXPECT_EQ(refreshCount, 1);
+  EXPECT_TRUE(sizes.empty());
+  ASSERT_EQ(framebufferSizes.size(), 1);
+  EXPECT_EQ(framebufferSizes[0], Vec2<int>(640, 480));
+  EXPECT_TRUE(pWindow->unregisterCallback(refreshHandle));
+  EXPECT_FALSE(pWindow->unregisterCallback(refreshHandle));
+  app.getEventBus().publish(WindowRefreshEvent{pWindow});
+  app.getEventBus().dispatch();
+  EXPECT_EQ(refreshCount, 1);
+  app.exit();
+}
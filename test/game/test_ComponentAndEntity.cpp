@@ -18,9 +18,11 @@
 #ifndef AMS_MODULES
 #include <ams/game.hpp>
 #include <ams/game/Util.hpp>
+#include <ams/game/Components/MeshComponent.hpp>
 #else
 import ams.game;
 import ams.game.Util;
+import ams.game.MeshComponent;
 #endif
 
 #include <gtest/gtest.h>
@@ -82,6 +84,145 @@ public:
   }
 };
 
+class TestBehaviorFixedUpdate : public Behavior {
+  AMSBehavior(TestBehaviorFixedUpdate)
+  void onLateUpdate() override { // private overrides are dispatched too
+    testLateUpdate++;
+  }
+public:
+  int testFixedUpdate = 0;
+  int testLateUpdate = 0;
+  void onFixedUpdate() override {
+    testFixedUpdate++;
+  }
+};
+
+class TestBehaviorParallel : public Behavior {
+  AMSBehavior(TestBehaviorParallel)
+public:
+  using Access = ComponentAccess<Read<>, Write<Transform>>;
+  std::atomic_int testUpdate = 0;
+  void onUpdate() override {
+    entity->getTransform()->translate(1, 0, 0);
+    testUpdate++;
+  }
+};
+
+class TestBehaviorSpawner : public Behavior {
+  AMSBehavior(TestBehaviorSpawner)
+public:
+  using Access = ComponentAccess<>;
+  void onUpdate() override {
+    auto& commands = entity->getScene()->getCommandBuffer();
+    commands.createEntity("Spawned", [](ams::Entity* pEntity) {
+      pEntity->addComponent<TestBehaviorVirtMethods>();
+    });
+    commands.destroyEntity(entity->getHandle());
+  }
+};
+
+class TestBehaviorSelfRemove : public Behavior {
+  AMSBehavior(TestBehaviorSelfRemove)
+public:
+  void onUpdate() override {
+    entity->removeComponent<TestBehaviorSelfRemove>(); // deferred to the next sync point
+    entity->addComponent<Camera>();
+  }
+};
+
+class TestBehaviorSelfDisable : public Behavior {
+  AMSBehavior(TestBehaviorSelfDisable)
+public:
+  int testUpdate = 0;
+  int testDisabled = 0;
+  void onDisable() override { testDisabled++; }
+  void onUpdate() override {
+    testUpdate++;
+    setEnabled(false); // applied at the next sync point
+  }
+};
+
+
+class TestSystemMove : public System {
+public:
+  using Access = ComponentAccess<Read<>, Write<Transform>>;
+  std::atomic_int runs = 0;
+  
+  TestSystemMove() : System(SystemPhase::FixedUpdate) {}
+  
+  void onRun() override {
+    getScene()->query<Transform>().each([](Transform& transform) { transform.translate(1, 0, 0); });
+    runs++;
+  }
+};
+
+class TestSystemCheck : public System {
+public:
+  using Access = ComponentAccess<Read<Transform>>;
+  std::atomic_int runs = 0;
+  std::atomic_int mismatches = 0;
+  
+  TestSystemCheck() : System(SystemPhase::FixedUpdate) { runAfter<TestSystemMove>(); }
+  
+  void onRun() override {
+    auto* pMove = getScene()->getSystem<TestSystemMove>();
+    getScene()->query<Transform>().each([&](Transform& transform) {
+      if (transform.getPosition().x != pMove->runs)
+        mismatches++;
+    });
+    runs++;
+  }
+};
+
+class TestSystemMainThread : public System {
+public:
+  int runs = 0;
+  
+  TestSystemMainThread() : System(SystemPhase::Render) {}
+  
+  void onRun() override { runs++; }
+};
+
+class TestSystemCycle : public System {
+public:
+  TestSystemCycle() : System(SystemPhase::FixedUpdate) {
+    runAfter<TestSystemCheck>();
+    runBefore<TestSystemMove>();
+  }
+  
+  void onRun() override {}
+};
+
+class TestSnapshotComponent : public Component {
+public:
+  struct SnapshotState {
+    int32_t health;
+    float speed;
+  };
+  
+  int32_t health = 100;
+  float speed = 1.0f;
+  
+  using Component::Component;
+  
+  void saveSnapshot(SnapshotState& state) const { state = {health, speed}; }
+  void loadSnapshot(const SnapshotState& state) { health = state.health; speed = state.speed; }
+};
+
+template<> struct ams::StoreByValue<TestSnapshotComponent> : std::true_type {};
+
+class TestBaseComponent : public Component {
+public:
+  using ComponentBases = ComponentBaseList<TestBaseComponent, Component>;
+  
+  using Component::Component;
+};
+
+class TestDerivedComponent final : public TestBaseComponent {
+public:
+  int value = 0;
+  using TestBaseComponent::TestBaseComponent;
+};
 
 TEST(Entity, SceneCreateEntity) {
   Application app;
@@ -89,6 +230,14 @@ TEST(Entity, SceneCreateEntity) {
   auto* pEntity = pScene->createEntity();
   EXPECT_NE(pEntity, nullptr);
   EXPECT_EQ(pEntity->getName(), "Object_" + to_string(pEntity->getId()));
+  
+  // a null parent makes a root Entity with either overload
+  auto* pRoot = pScene->createEntity("Root", nullptr);
+  EXPECT_EQ(pRoot->getTransform()->getParent(), nullptr);
+  auto* pChild = pScene->createEntity("Child", EntityCfg::Camera, pRoot->getTransform());
+  EXPECT_EQ(pChild->getTransform()->getParent(), pRoot->getTransform());
+  EXPECT_TRUE(pChild->hasComponent<Camera>());
+  EXPECT_EQ(pScene->getEntity(pChild->getHandle()), pChild);
 }
 
 TEST(Entity, SceneCreateCamera) {
@@ -142,6 +291,637 @@ TEST(Entity, AddExtraTransformFails) {
   app.exit();
 }
 
+TEST(Entity, StaleHandle) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  auto* pEntity = pScene->createEntity();
+  auto handle = pEntity->getHandle();
+  EXPECT_TRUE(pScene->isValid(handle));
+  EXPECT_EQ(pScene->getEntity(handle), pEntity);
+  
+  pEntity->destroy();
+  EXPECT_FALSE(pScene->isValid(handle));
+  EXPECT_EQ(pScene->getEntity(handle), nullptr);
+  EXPECT_FALSE(pScene->destroyEntity(handle));
+  
+  auto* pOther = pScene->createEntity(); // reuses the destroyed Entity's slot
+  EXPECT_FALSE(pScene->isValid(handle));
+  EXPECT_TRUE(pScene->isValid(pOther->getHandle()));
+  EXPECT_TRUE(pScene->destroyEntity(pOther->getHandle()));
+}
+
+TEST(Entity, GetComponentByType) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  auto* pEntity = pScene->createEntity();
+  auto* pCamera = pEntity->addComponent<Camera>();
+  auto* pBehavior = pEntity->addComponent<TestBehaviorVirtMethods>();
+  
+  EXPECT_EQ(pEntity->getComponent<Transform>(), pEntity->getTransform());
+  EXPECT_EQ(pEntity->getComponent<Camera>(), pCamera);
+  EXPECT_EQ(pEntity->getComponent<TestBehaviorVirtMethods>(), pBehavior);
+  EXPECT_EQ(pEntity->getComponent<Behavior>(), pBehavior); // base types are still found
+  EXPECT_TRUE(pEntity->hasComponent<Camera>());
+  EXPECT_TRUE(pEntity->hasComponent<Behavior>());
+  EXPECT_FALSE(pEntity->hasComponent<MeshComponent>());
+}
+
+TEST(Entity, GetComponentByBaseType) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  auto* pEntity = pScene->createEntity();
+  // the derived type is registered before its base
+  pEntity->addComponent<TestDerivedComponent>()->value = 7;
+  auto* pBase = pEntity->getComponent<TestBaseComponent>();
+  ASSERT_NE(pBase, nullptr);
+  EXPECT_EQ(static_cast<TestDerivedComponent*>(pBase)->value, 7);
+  EXPECT_EQ(pBase, pEntity->getComponent<TestDerivedComponent>());
+  EXPECT_EQ(pEntity->getComponent<Component>(), pEntity->getTransform());
+  EXPECT_TRUE(pEntity->hasComponent<TestBaseComponent>());
+  EXPECT_FALSE(pScene->createEntity()->hasComponent<TestBaseComponent>());
+  EXPECT_TRUE(pEntity->removeComponent<TestBaseComponent>());
+  EXPECT_FALSE(pEntity->hasComponent<TestDerivedComponent>());
+}
+
+TEST(Entity, ArchetypeColumns) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  std::vector<TestBehaviorVirtMethods*> behaviors;
+  for (int i = 0; i < 10; i++) {
+    auto* pEntity = pScene->createEntity();
+    if (i % 2 == 0)
+      pEntity->addComponent<Camera>();
+    behaviors.push_back(pEntity->addComponent<TestBehaviorVirtMethods>());
+  }
+  pScene->createEntity()->destroy();
+  
+  int transforms = 0;
+  pScene->forEach<Transform>([&](Transform* pTransform) {
+    EXPECT_NE(pTransform, nullptr);
+    transforms++;
+  });
+  EXPECT_EQ(transforms, 10);
+  
+  std::vector<TestBehaviorVirtMethods*> visited;
+  pScene->forEach<TestBehaviorVirtMethods>([&](TestBehaviorVirtMethods* pComp) { visited.push_back(pComp); });
+  EXPECT_EQ(visited.size(), behaviors.size());
+  for (auto* pComp : behaviors)
+    EXPECT_NE(std::find(visited.begin(), visited.end(), pComp), visited.end());
+}
+
+TEST(Entity, ComponentsStoredByValue) {
+  static_assert(ams::internal::IsStoredByValue<TestSnapshotComponent>);
+  static_assert(!ams::internal::IsStoredByValue<Transform> && !ams::internal::IsStoredByValue<Camera>);
+  static_assert(!ams::internal::IsStoredByValue<TestBehaviorVirtMethods>);
+  static_assert(!ams::internal::IsStoredByValue<TestBaseComponent>);
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  std::vector<ams::Entity*> entities;
+  for (int i = 0; i < 200; i++) {
+    auto* pEntity = pScene->createEntity();
+    auto* pComp = pEntity->addComponent<TestSnapshotComponent>();
+    auto id = pComp->getId();
+    pComp->health = i;
+    // moves the component to the row of another archetype
+    pEntity->addComponent<Camera>();
+    pComp = pEntity->getComponent<TestSnapshotComponent>();
+    EXPECT_EQ(pComp->health, i);
+    EXPECT_EQ(pComp->getId(), id);
+    EXPECT_EQ(pComp->getEntity(), pEntity);
+    entities.push_back(pEntity);
+  }
+  // a second component of the same type takes over the row when the first one is removed
+  auto* pExtra = entities[3]->addComponent<TestSnapshotComponent>();
+  pExtra->health = 1000;
+  EXPECT_TRUE(entities[3]->removeComponent<TestSnapshotComponent>());
+  EXPECT_EQ(entities[3]->getComponent<TestSnapshotComponent>()->health, 1000);
+  EXPECT_TRUE(entities[5]->removeComponent<Camera>());
+  EXPECT_EQ(entities[5]->getComponent<TestSnapshotComponent>()->health, 5);
+  entities[7]->destroy();
+
+  int visited = 0, sum = 0;
+  pScene->query<TestSnapshotComponent>().each([&](ams::Entity& entity, TestSnapshotComponent& comp) {
+    EXPECT_EQ(comp.getEntity(), &entity);
+    EXPECT_EQ(entity.getComponent<TestSnapshotComponent>(), &comp);
+    visited++;
+    sum += comp.health;
+  });
+  EXPECT_EQ(visited, 199);
+  EXPECT_EQ(sum, 199 * 200 / 2 - 3 + 1000 - 7);
+
+  // the row freed by the destroyed Entity is reused
+  auto* pEntity = pScene->createEntity();
+  pEntity->addComponents<TestSnapshotComponent, Camera>();
+  EXPECT_EQ((pScene->query<TestSnapshotComponent, Camera>().size()), 199);
+}
+
+TEST(Entity, ComponentAddresses) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  auto* pEntity = pScene->createEntity();
+  auto* pBase = pEntity->addComponent<TestBaseComponent>();
+  auto* pValue = pEntity->addComponent<TestSnapshotComponent>();
+  auto valueId = pValue->getId();
+  pEntity->addComponent<Camera>();
+  // only the component which opted into StoreByValue moved to the row of the new archetype
+  EXPECT_EQ(pEntity->getComponent<TestBaseComponent>(), pBase);
+  EXPECT_NE(pEntity->getComponent<TestSnapshotComponent>(), pValue);
+  EXPECT_EQ(pEntity->getComponent<TestSnapshotComponent>()->getId(), valueId);
+  EXPECT_TRUE(pEntity->removeComponent<Camera>());
+  EXPECT_EQ(pEntity->getComponent<TestBaseComponent>(), pBase);
+}
+
+TEST(Entity, RemoveComponent) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  auto* pEntity = pScene->createEntity();
+  pEntity->addComponents<Camera, TestBehaviorVirtMethods>();
+  
+  EXPECT_TRUE(pEntity->removeComponent<Camera>());
+  EXPECT_FALSE(pEntity->hasComponent<Camera>());
+  EXPECT_FALSE(pEntity->removeComponent<Camera>());
+  EXPECT_TRUE(pEntity->removeComponent<Behavior>()); // base types are still found
+  EXPECT_FALSE(pEntity->hasComponent<TestBehaviorVirtMethods>());
+  
+  int cameras = 0, transforms = 0;
+  pScene->forEach<Camera>([&](Camera*) { cameras++; });
+  pScene->forEach<Transform>([&](Transform*) { transforms++; });
+  EXPECT_EQ(cameras, 0);
+  EXPECT_EQ(transforms, 1);
+}
+
+TEST(Scene, Query) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  // made before any matching archetype exists, so it must pick them up as they are created
+  auto cameras = pScene->query<Transform, Camera>();
+  EXPECT_TRUE(cameras.empty());
+  
+  std::vector<ams::Entity*> entities;
+  for (int i = 0; i < 6; i++) {
+    auto* pEntity = pScene->createEntity();
+    pEntity->addComponent<Camera>();
+    if (i % 2 == 0)
+      pEntity->addComponent<TestBehaviorVirtMethods>();
+    entities.push_back(pEntity);
+  }
+  EXPECT_EQ(cameras.size(), 6);
+  EXPECT_EQ((pScene->query<Camera, TestBehaviorVirtMethods>().size()), 3);
+  
+  int visited = 0;
+  cameras.each([&](ams::Entity& entity, Transform& transform, Camera& camera) {
+    EXPECT_EQ(entity.getTransform(), &transform);
+    EXPECT_EQ(entity.getComponent<Camera>(), &camera);
+    visited++;
+  });
+  EXPECT_EQ(visited, 6);
+  
+  entities[0]->removeComponent<Camera>();
+  entities[1]->destroy();
+  visited = 0;
+  cameras.each([&](Transform&, Camera&) { visited++; });
+  EXPECT_EQ(visited, 4);
+  EXPECT_EQ((pScene->query<Camera, TestBehaviorVirtMethods>().size()), 2);
+}
+
+TEST(Scene, CommandBuffer) {
+  TestApplication app("TestApp", 300ms);
+  auto* pScene = app.createScene("TestScene");
+  pScene->setParallelUpdate(true);
+  for (int i = 0; i < 100; i++)
+    pScene->createEntity()->addComponent<TestBehaviorSpawner>();
+  auto* pEntity = pScene->createEntity();
+  pEntity->addComponent<TestBehaviorSelfRemove>();
+  app.setCurrentScene(pScene->getName());
+  app.setVsyncTime(65);
+  app.run();
+  
+  // every spawner is updated once, then destroyed at the sync point which creates its replacement
+  int spawners = 0, spawned = 0;
+  pScene->forEach<TestBehaviorSpawner>([&](TestBehaviorSpawner*) { spawners++; });
+  pScene->forEach<TestBehaviorVirtMethods>([&](TestBehaviorVirtMethods* pComp) {
+    EXPECT_EQ(pComp->getEntity()->getName(), "Spawned");
+    spawned++;
+  });
+  EXPECT_EQ(spawners, 0);
+  EXPECT_EQ(spawned, 100);
+  EXPECT_FALSE(pEntity->hasComponent<TestBehaviorSelfRemove>());
+  EXPECT_TRUE(pEntity->hasComponent<Camera>());
+  app.exit();
+}
+
+TEST(Transform, WorldMatrixPropagation) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  auto* pParent = pScene->createEntity()->getTransform();
+  auto* pChild = pScene->createEntity("Child", pParent)->getTransform();
+  auto* pGrandChild = pScene->createEntity("GrandChild", pChild)->getTransform();
+  pParent->setPosition(1, 2, 3);
+  pChild->setPosition(1, 0, 0);
+  pGrandChild->setPosition(0, 1, 0);
+  pScene->updateTransforms();
+  
+  EXPECT_FALSE(pGrandChild->isDirty());
+  EXPECT_EQ(pScene->getWorldMatrices().size(), 3);
+  // parents come before their children
+  EXPECT_EQ(&pScene->getWorldMatrices()[0], &pParent->getWorldMatrix());
+  EXPECT_DOUBLE_EQ(pGrandChild->getWorldMatrix()(3, 0), 2);
+  EXPECT_DOUBLE_EQ(pGrandChild->getWorldMatrix()(3, 1), 3);
+  EXPECT_DOUBLE_EQ(pGrandChild->getWorldMatrix()(3, 2), 3);
+  EXPECT_DOUBLE_EQ(pGrandChild->getModelMatrix()(3, 1), 1);
+  
+  // only the moved subtree is recomputed, and recomputing does not accumulate
+  pChild->translate(1, 0, 0);
+  EXPECT_TRUE(pChild->isDirty());
+  EXPECT_FALSE(pParent->isDirty());
+  pScene->updateTransforms();
+  pScene->updateTransforms();
+  EXPECT_DOUBLE_EQ(pChild->getWorldMatrix()(3, 0), 3);
+  EXPECT_DOUBLE_EQ(pGrandChild->getWorldMatrix()(3, 0), 3);
+  EXPECT_DOUBLE_EQ(pParent->getWorldMatrix()(3, 0), 1);
+  
+  // destroying a parent orphans its children
+  pChild->getEntity()->destroy();
+  pScene->updateTransforms();
+  EXPECT_EQ(pGrandChild->getParent(), nullptr);
+  EXPECT_DOUBLE_EQ(pGrandChild->getWorldMatrix()(3, 1), 1);
+}
+
+TEST(Transform, Interpolation) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  auto* pParent = pScene->createEntity()->getTransform();
+  auto* pChild = pScene->createEntity("Child", pParent)->getTransform();
+  pChild->setPosition(0, 1, 0);
+  pScene->updateTransforms();
+  
+  pScene->storeTransformStates();
+  pParent->setPosition(10, 0, 0);
+  auto* pNew = pScene->createEntity()->getTransform();
+  pNew->setPosition(0, 0, 4);
+  pScene->updateTransforms();
+  pScene->interpolateTransforms(0.25);
+  
+  EXPECT_DOUBLE_EQ(pParent->getInterpolatedWorldMatrix()(3, 0), 2.5);
+  EXPECT_DOUBLE_EQ(pChild->getInterpolatedWorldMatrix()(3, 0), 2.5);
+  EXPECT_DOUBLE_EQ(pChild->getInterpolatedWorldMatrix()(3, 1), 1);
+  // created after the states were stored, so it is not interpolated
+  EXPECT_DOUBLE_EQ(pNew->getInterpolatedWorldMatrix()(3, 2), 4);
+  EXPECT_DOUBLE_EQ(pParent->getWorldMatrix()(3, 0), 10);
+  
+  // nothing moved since the states were stored, so the world matrices are used as is
+  pScene->storeTransformStates();
+  pScene->interpolateTransforms(0.5);
+  EXPECT_EQ(pScene->getInterpolatedWorldMatrices().data(), pScene->getWorldMatrices().data());
+  
+  // only the moved subtree is interpolated, every other Transform keeps its world matrix
+  auto* pStatic = pScene->createEntity()->getTransform();
+  pStatic->setPosition(0, 5, 0);
+  pScene->updateTransforms();
+  pScene->storeTransformStates();
+  pChild->setPosition(0, 3, 0);
+  pScene->updateTransforms();
+  pScene->interpolateTransforms(0.5);
+  EXPECT_DOUBLE_EQ(pChild->getInterpolatedWorldMatrix()(3, 1), 2);
+  EXPECT_DOUBLE_EQ(pStatic->getInterpolatedWorldMatrix()(3, 1), 5);
+  EXPECT_DOUBLE_EQ(pParent->getInterpolatedWorldMatrix()(3, 0), 10);
+  
+  // the subtree interpolated last time is reset to its world matrices
+  pScene->storeTransformStates();
+  pStatic->setPosition(0, 7, 0);
+  pScene->updateTransforms();
+  pScene->interpolateTransforms(0.5);
+  EXPECT_DOUBLE_EQ(pChild->getInterpolatedWorldMatrix()(3, 1), 3);
+  EXPECT_DOUBLE_EQ(pStatic->getInterpolatedWorldMatrix()(3, 1), 6);
+  
+  // a Transform moved before the last of several stores only interpolates from that store
+  pScene->storeTransformStates();
+  pChild->setPosition(0, 9, 0);
+  pScene->updateTransforms();
+  pScene->storeTransformStates();
+  pStatic->setPosition(0, 9, 0);
+  pScene->updateTransforms();
+  pScene->interpolateTransforms(0.5);
+  EXPECT_DOUBLE_EQ(pChild->getInterpolatedWorldMatrix()(3, 1), 9);
+  EXPECT_DOUBLE_EQ(pStatic->getInterpolatedWorldMatrix()(3, 1), 8);
+  
+  app.setMaxFixedSteps(0);
+  EXPECT_EQ(app.getMaxFixedSteps(), 1);
+}
+
+TEST(Behavior, DispatchOverriddenHooks) {
+  using VirtTraits = internal::BehaviorTraits<TestBehaviorVirtMethods>;
+  using FixedTraits = internal::BehaviorTraits<TestBehaviorFixedUpdate>;
+  static_assert(VirtTraits::overridesUpdate && !VirtTraits::overridesFixedUpdate && !VirtTraits::overridesLateUpdate);
+  static_assert(!FixedTraits::overridesUpdate && FixedTraits::overridesFixedUpdate && FixedTraits::overridesLateUpdate);
+  
+  TestApplication app("TestApp", 500ms);
+  auto* pScene = app.createScene("TestScene");
+  auto* pEntity = pScene->createEntity();
+  auto[pVirt, pFixed] = pEntity->addComponents<TestBehaviorVirtMethods, TestBehaviorFixedUpdate>();
+  app.setCurrentScene(pScene->getName());
+  app.setVsyncTime(65);
+  app.run();
+  
+  EXPECT_GT(pVirt->testUpdate, 0);
+  EXPECT_GT(pFixed->testFixedUpdate, 0);
+  EXPECT_GT(pFixed->testLateUpdate, 0);
+  app.exit();
+}
+
+TEST(Behavior, ParallelUpdate) {
+  TestApplication app("TestApp", 500ms);
+  auto* pScene = app.createScene("TestScene");
+  pScene->setParallelUpdate(true);
+  EXPECT_TRUE(pScene->isParallelUpdate());
+  std::vector<TestBehaviorParallel*> parallel;
+  std::vector<TestBehaviorVirtMethods*> serial;
+  for (int i = 0; i < 1000; i++) {
+    auto* pEntity = pScene->createEntity();
+    parallel.push_back(pEntity->addComponent<TestBehaviorParallel>());
+    if (i % 10 == 0)
+      serial.push_back(pEntity->addComponent<TestBehaviorVirtMethods>());
+  }
+  app.setCurrentScene(pScene->getName());
+  app.setVsyncTime(65);
+  app.run();
+  
+  for (auto* pComp : parallel) {
+    EXPECT_GT(pComp->testUpdate, 0);
+    EXPECT_EQ(pComp->getEntity()->getTransform()->getPosition().x, pComp->testUpdate.load());
+  }
+  for (auto* pComp : serial)
+    EXPECT_GT(pComp->testUpdate, 0);
+  app.exit();
+}
+
+TEST(Behavior, EnableDisable) {
+  TestApplication app("TestApp", 300ms);
+  auto* pScene = app.createScene("TestScene");
+  auto* pDisabled = pScene->createEntity()->addComponent<TestBehaviorVirtMethods>();
+  auto* pSelf = pScene->createEntity()->addComponent<TestBehaviorSelfDisable>();
+  pDisabled->setEnabled(false);
+  EXPECT_TRUE(pDisabled->testWasDisabled);
+  // disabling a Behavior while updating leaves the Components of its Entity in place
+  std::vector<TestSnapshotComponent*> stored;
+  for (int i = 0; i < 3; i++) {
+    auto* pEntity = pScene->createEntity();
+    pEntity->addComponent<TestBehaviorSelfDisable>();
+    stored.push_back(pEntity->addComponent<TestSnapshotComponent>());
+  }
+  
+  // Behaviors disabled before they are registered are not started until they are enabled
+  Prefab prefab;
+  prefab.add<TestBehaviorVirtMethods>();
+  auto entities = pScene->instantiate(prefab, 3, {[](ams::Entity* pEntity, size_t i) {
+    if (i > 0)
+      pEntity->getComponent<TestBehaviorVirtMethods>()->setEnabled(false);
+  }});
+  auto* pEnabled = entities[0]->getComponent<TestBehaviorVirtMethods>();
+  auto* pNeverStarted = entities[1]->getComponent<TestBehaviorVirtMethods>();
+  auto* pLateStarted = entities[2]->getComponent<TestBehaviorVirtMethods>();
+  EXPECT_TRUE(pEnabled->testWasStarted);
+  EXPECT_FALSE(pNeverStarted->testWasEnabled);
+  EXPECT_FALSE(pLateStarted->testWasStarted);
+  pLateStarted->setEnabled(true);
+  EXPECT_TRUE(pLateStarted->testWasEnabled);
+  EXPECT_TRUE(pLateStarted->testWasStarted);
+  
+  app.setCurrentScene(pScene->getName());
+  app.setVsyncTime(65);
+  app.run();
+  
+  EXPECT_EQ(pDisabled->testUpdate, 0);
+  EXPECT_EQ(pNeverStarted->testUpdate, 0);
+  EXPECT_FALSE(pNeverStarted->testWasStarted);
+  EXPECT_GT(pEnabled->testUpdate, 0);
+  EXPECT_GT(pLateStarted->testUpdate, 0);
+  EXPECT_EQ(pSelf->testUpdate, 1);
+  EXPECT_EQ(pSelf->testDisabled, 1);
+  EXPECT_FALSE(pSelf->isEnabled());
+  for (auto* pComp : stored) {
+    EXPECT_EQ(pComp->getEntity()->getComponent<TestSnapshotComponent>(), pComp);
+    EXPECT_FALSE(pComp->getEntity()->getComponent<TestBehaviorSelfDisable>()->isEnabled());
+  }
+  
+  pDisabled->testWasEnabled = false;
+  pDisabled->setEnabled(true);
+  EXPECT_TRUE(pDisabled->testWasEnabled);
+  app.exit();
+}
+
+TEST(Scene, Systems) {
+  TestApplication app("TestApp", 300ms);
+  auto* pScene = app.createScene("TestScene");
+  for (int i = 0; i < 100; i++)
+    pScene->createEntity();
+  // added out of order, so that only the runAfter constraint puts the check after the move
+  auto* pCheck = pScene->addSystem<TestSystemCheck>();
+  auto* pMove = pScene->addSystem<TestSystemMove>();
+  auto* pMain = pScene->addSystem<TestSystemMainThread>();
+  EXPECT_TRUE(pCheck->isConcurrent());
+  EXPECT_FALSE(pMain->isConcurrent());
+  EXPECT_EQ(pScene->getSystem<TestSystemMove>(), pMove);
+  EXPECT_THROW(pScene->addSystem<TestSystemMove>(), std::invalid_argument);
+  EXPECT_THROW(pScene->addSystem<TestSystemCycle>(), std::invalid_argument);
+  EXPECT_EQ(pScene->getSystem<TestSystemCycle>(), nullptr);
+  
+  auto order = pScene->getSystems(SystemPhase::FixedUpdate);
+  ASSERT_EQ(order.size(), 2);
+  EXPECT_EQ(order[0], pMove);
+  EXPECT_EQ(order[1], pCheck);
+  
+  app.setCurrentScene(pScene->getName());
+  app.run();
+  EXPECT_GT(pMove->runs, 0);
+  EXPECT_EQ(pCheck->runs, pMove->runs);
+  EXPECT_EQ(pCheck->mismatches, 0);
+  EXPECT_GT(pMain->runs, 0);
+  EXPECT_GT(pMove->getLastRunTime().count(), 0);
+  
+  EXPECT_TRUE(pScene->removeSystem<TestSystemMainThread>());
+  EXPECT_EQ(pScene->getSystem<TestSystemMainThread>(), nullptr);
+  EXPECT_TRUE(pScene->getSystems(SystemPhase::Render).empty());
+  app.exit();
+}
+
+TEST(Scene, Snapshot) {
+  SceneSnapshot::registerComponent<TestSnapshotComponent>();
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  auto* pRoot = pScene->createEntity("Root", EntityCfg::Default, nullptr);
+  pRoot->getTransform()->setPosition(1, 2, 3);
+  auto* pChild = pScene->createEntity("Child", pRoot->getTransform());
+  pChild->getTransform()->setScale(2, 2, 2);
+  auto* pComp = pChild->addComponent<TestSnapshotComponent>();
+  pComp->health = 42;
+  pComp->speed = 2.5f;
+  pChild->addComponent<Camera>(); // not registered, so not stored
+  
+  auto path = fs::temp_directory_path() / "ams_test_snapshot.bin";
+  SceneSnapshot::save(*pScene, path);
+  auto* pLoaded = app.createScene("LoadedScene");
+  EXPECT_EQ(SceneSnapshot::load(*pLoaded, path), 2);
+  fs::remove(path);
+  
+  ams::Entity* pLoadedRoot = nullptr;
+  ams::Entity* pLoadedChild = nullptr;
+  pLoaded->forEach<Transform>([&](Transform* transform) {
+    auto* pEntity = transform->getEntity();
+    (pEntity->getName() == "Root" ? pLoadedRoot : pLoadedChild) = pEntity;
+  });
+  ASSERT_NE(pLoadedRoot, nullptr);
+  ASSERT_NE(pLoadedChild, nullptr);
+  EXPECT_EQ(pLoadedChild->getTransform()->getParent(), pLoadedRoot->getTransform());
+  EXPECT_EQ(pLoadedRoot->getTransform()->getPosition(), Vec3<decimal_t>(1, 2, 3));
+  EXPECT_EQ(pLoadedChild->getTransform()->getScale(), Vec3<decimal_t>(2, 2, 2));
+  auto* pLoadedComp = pLoadedChild->getComponent<TestSnapshotComponent>();
+  ASSERT_NE(pLoadedComp, nullptr);
+  EXPECT_EQ(pLoadedComp->health, 42);
+  EXPECT_EQ(pLoadedComp->speed, 2.5f);
+  EXPECT_FALSE(pLoadedChild->hasComponent<Camera>());
+  EXPECT_FALSE(pLoadedRoot->hasComponent<TestSnapshotComponent>());
+  
+  // in memory, appended next to the existing Entities
+  auto snapshot = SceneSnapshot::capture(*pLoaded);
+  EXPECT_EQ(snapshot.size() % SceneSnapshot::BlockAlignment, 0);
+  EXPECT_EQ(SceneSnapshot::restore(*pLoaded, snapshot), 2);
+  EXPECT_EQ(pLoaded->query<TestSnapshotComponent>().size(), 2);
+  
+  snapshot[0] = std::byte{0};
+  EXPECT_THROW(SceneSnapshot::restore(*pLoaded, snapshot), std::runtime_error);
+  app.exit();
+}
+
+TEST(Scene, Instantiate) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  Prefab prefab("Enemy");
+  prefab.add<TestSnapshotComponent>({7, 3.0f}).add<TestBehaviorVirtMethods>().setScale(Vec3<decimal_t>(2, 2, 2));
+  EXPECT_EQ(prefab.getComponentCount(), 2);
+  
+  auto entities = pScene->instantiate(prefab, 500, {[](ams::Entity* pEntity, size_t i) {
+    pEntity->getTransform()->setPosition(static_cast<decimal_t>(i), 0, 0);
+    if (i % 2 == 0)
+      pEntity->addComponent<Camera>();
+  }});
+  ASSERT_EQ(entities.size(), 500);
+  for (size_t i = 0; i < entities.size(); i++) {
+    auto* pEntity = entities[i];
+    EXPECT_EQ(pEntity->getName(), "Enemy");
+    EXPECT_EQ(pEntity->getTransform()->getPosition().x, static_cast<decimal_t>(i));
+    EXPECT_EQ(pEntity->getTransform()->getScale(), Vec3<decimal_t>(2, 2, 2));
+    auto* pComp = pEntity->getComponent<TestSnapshotComponent>();
+    ASSERT_NE(pComp, nullptr);
+    EXPECT_EQ(pComp->health, 7);
+    EXPECT_EQ(pComp->speed, 3.0f);
+    auto* pBehavior = pEntity->getComponent<TestBehaviorVirtMethods>();
+    ASSERT_NE(pBehavior, nullptr);
+    EXPECT_TRUE(pBehavior->testWasEnabled);
+    EXPECT_TRUE(pBehavior->testWasStarted);
+  }
+  EXPECT_EQ(pScene->query<TestSnapshotComponent>().size(), 500);
+  EXPECT_EQ((pScene->query<TestBehaviorVirtMethods, Camera>().size()), 250);
+  
+  entities[0]->destroy();
+  EXPECT_EQ(pScene->query<TestSnapshotComponent>().size(), 499);
+  EXPECT_EQ(pScene->instantiate(Prefab(), 3).size(), 3);
+}
+
+TEST(Scene, InstantiateDestroyInInit) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  pScene->setSpatialIndexEnabled(true);
+  Prefab prefab("Enemy");
+  prefab.add<TestSnapshotComponent>({7, 3.0f}).add<TestBehaviorVirtMethods>();
+  
+  // init destroys some instances as they are created, and the first one later on
+  EntityHandle first;
+  auto entities = pScene->instantiate(prefab, 10, {[&](ams::Entity* pEntity, size_t i) {
+    if (i == 0)
+      first = pEntity->getHandle();
+    if (i == 5)
+      pScene->destroyEntity(first);
+    if (i % 3 == 1)
+      pEntity->destroy();
+  }});
+  ASSERT_EQ(entities.size(), 6);
+  for (auto* pEntity : entities) {
+    EXPECT_TRUE(pScene->isValid(pEntity->getHandle()));
+    auto* pBehavior = pEntity->getComponent<TestBehaviorVirtMethods>();
+    ASSERT_NE(pBehavior, nullptr);
+    EXPECT_TRUE(pBehavior->testWasStarted);
+  }
+  EXPECT_EQ(pScene->query<TestSnapshotComponent>().size(), 6);
+  EXPECT_EQ(pScene->getSpatialIndex().size(), 6);
+}
+
+TEST(Scene, SpatialIndex) {
+  Application app;
+  auto* pScene = app.createScene("TestScene");
+  std::vector<ams::Entity*> entities;
+  for (int i = 0; i < 10; i++) {
+    entities.push_back(pScene->createEntity());
+    entities.back()->getTransform()->setPosition(static_cast<decimal_t>(i * 10), 0, 0);
+  }
+  pScene->setSpatialIndexEnabled(true);
+  auto& index = pScene->getSpatialIndex();
+  EXPECT_EQ(index.size(), 10);
+  
+  auto countInRadius = [&](const Vec3<decimal_t>& center, decimal_t radius) {
+    size_t count = 0;
+    index.queryRadius(center, radius, [&](EntityHandle) { count++; });
+    return count;
+  };
+  EXPECT_EQ(countInRadius({0, 0, 0}, 15), 2);
+  EXPECT_EQ(countInRadius({45, 0, 0}, 1), 0);
+  
+  // custom bounds are transformed by the world matrix
+  index.setLocalBounds(entities[4], {{-1, -1, -1}, {1, 1, 1}});
+  entities[4]->getTransform()->setScale(10, 10, 10);
+  pScene->updateTransforms();
+  EXPECT_EQ(countInRadius({45, 0, 0}, 1), 1);
+  decimal_t distance = 0;
+  auto hit = index.raycast({{40, 100, 0}, {0, -1, 0}}, 1000, &distance);
+  EXPECT_EQ(hit, entities[4]->getHandle());
+  EXPECT_DOUBLE_EQ(distance, 90);
+  EXPECT_TRUE(index.raycast({{40, 100, 0}, {0, 1, 0}}, 1000).isNull());
+  
+  // moved Entities are refit at the next sync point
+  entities[9]->getTransform()->setPosition(0, 0, 1);
+  EXPECT_EQ(countInRadius({0, 0, 0}, 2), 1);
+  pScene->updateTransforms();
+  EXPECT_EQ(countInRadius({0, 0, 0}, 2), 2);
+  
+  // destroyed Entities are removed
+  auto handle = entities[0]->getHandle();
+  entities[0]->destroy();
+  pScene->updateTransforms();
+  EXPECT_EQ(index.size(), 9);
+  EXPECT_EQ(index.getBounds(handle), nullptr);
+  EXPECT_EQ(countInRadius({0, 0, 0}, 2), 1);
+  
+  // created Entities are indexed as they are created, and take the bounds of their mesh when it is added
+  auto* pMeshed = pScene->createEntity();
+  pMeshed->getTransform()->setPosition(200, 0, 0);
+  EXPECT_EQ(index.size(), 10);
+  pScene->updateTransforms();
+  EXPECT_EQ(countInRadius({200, 0, 0}, 0.1), 1);
+  auto* pMesh = pMeshed->addComponent<MeshComponent>()->getMesh();
+  pScene->updateTransforms();
+  auto expected = pMesh->getBounds();
+  expected.min += Vec3<decimal_t>(200, 0, 0);
+  expected.max += Vec3<decimal_t>(200, 0, 0);
+  ASSERT_NE(index.getBounds(pMeshed->getHandle()), nullptr);
+  EXPECT_EQ(*index.getBounds(pMeshed->getHandle()), expected);
+  pMeshed->removeComponent<MeshComponent>();
+  pScene->updateTransforms();
+  EXPECT_EQ(index.getBounds(pMeshed->getHandle())->max, Vec3<decimal_t>(200, 0, 0)); // a point again
+  
+  pScene->setSpatialIndexEnabled(false);
+  EXPECT_EQ(index.size(), 0);
+}
+
 TEST(Entities, 100AddComponentPerfTest) {
   TestApplication app("TestApp", 1000ms);
   auto* pScene = app.createScene("TestScene");
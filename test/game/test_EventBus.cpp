@@ -0,0 +1,133 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <gtest/gtest.h>
+
+#ifndef AMS_MODULES
+#include "ams/game/EventBus.hpp"
+#else
+import ams.game.EventBus;
+#endif
+
+#include <thread>
+#include <vector>
+
+using namespace ams;
+
+struct TestEvent {
+  int value;
+};
+
+struct OtherTestEvent {
+  double value;
+};
+
+TEST(EventBus, DispatchesInBatches) {
+  EventBus bus;
+  std::vector<int> received;
+  int calls = 0;
+  bus.subscribe<TestEvent>([&](std::span<const TestEvent> events) {
+    calls++;
+    for (auto& event : events)
+      received.push_back(event.value);
+  });
+  for (int i = 0; i < 1000; i++)
+    bus.publish(TestEvent{i});
+  bus.publish(OtherTestEvent{1.0});
+  EXPECT_TRUE(received.empty()); // nothing is delivered before the dispatch
+  EXPECT_EQ(bus.pending<TestEvent>(), 1000);
+  
+  EXPECT_EQ(bus.dispatch(), 1001);
+  EXPECT_EQ(calls, 1);
+  ASSERT_EQ(received.size(), 1000);
+  for (int i = 0; i < 1000; i++)
+    EXPECT_EQ(received[i], i);
+  EXPECT_EQ(bus.dispatch(), 0);
+  EXPECT_EQ(calls, 1); // handlers are not called without events
+}
+
+TEST(EventBus, SubscribeAndUnsubscribeDuringDispatch) {
+  EventBus bus;
+  int first = 0, second = 0, late = 0;
+  EventHandle secondHandle;
+  bus.subscribe<TestEvent>([&](std::span<const TestEvent> events) {
+    first += static_cast<int>(events.size());
+    bus.unsubscribe(secondHandle);
+    bus.subscribe<TestEvent>([&](std::span<const TestEvent> events) { late += static_cast<int>(events.size()); });
+    bus.publish(TestEvent{0}); // queued for the next dispatch
+  });
+  secondHandle = bus.subscribe<TestEvent>([&](std::span<const TestEvent> events) {
+    second += static_cast<int>(events.size());
+  });
+  
+  bus.publish(TestEvent{0});
+  bus.publish(TestEvent{0});
+  EXPECT_EQ(bus.dispatch<TestEvent>(), 2);
+  EXPECT_EQ(first, 2);
+  EXPECT_EQ(second, 0);
+  EXPECT_EQ(late, 0);
+  EXPECT_FALSE(bus.unsubscribe(secondHandle));
+  
+  EXPECT_EQ(bus.dispatch<TestEvent>(), 1);
+  EXPECT_EQ(first, 3);
+  EXPECT_EQ(late, 1);
+  EXPECT_FALSE(bus.unsubscribe(EventHandle{}));
+}
+
+TEST(EventBus, RingBufferWrapsAndGrows) {
+  EventBus bus;
+  std::vector<int> received;
+  bus.subscribe<TestEvent>([&](std::span<const TestEvent> events) {
+    for (auto& event : events)
+      received.push_back(event.value);
+  });
+  int next = 0;
+  for (int round = 0; round < 10; round++) {
+    received.clear();
+    auto count = 50 + round * 20;
+    for (int i = 0; i < count; i++)
+      bus.publish(TestEvent{next + i});
+    bus.dispatch();
+    ASSERT_EQ(received.size(), count);
+    for (int i = 0; i < count; i++)
+      EXPECT_EQ(received[i], next + i);
+    next += count;
+  }
+  bus.publish(TestEvent{0});
+  bus.clear();
+  EXPECT_EQ(bus.dispatch(), 0);
+}
+
+TEST(EventBus, PublishFromThreads) {
+  EventBus bus;
+  long long sum = 0;
+  bus.subscribe<TestEvent>([&](std::span<const TestEvent> events) {
+    for (auto& event : events)
+      sum += event.value;
+  });
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; t++) {
+    threads.emplace_back([&bus]() {
+      for (int i = 1; i <= 1000; i++)
+        bus.publish(TestEvent{i});
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+  EXPECT_EQ(bus.dispatch(), 4000);
+  EXPECT_EQ(sum, 4 * 500500);
+}
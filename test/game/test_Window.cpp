@@ -70,7 +70,7 @@ TEST(Window, WindowUpdateCycle) {
   Display display(Display::getDisplays()[0]);
   Window window(display, TestCfgAllFalse);
   int updateCount = 0;
-  Function<void> callback = { [&updateCount]() { updateCount++; } };
+  Delegate<void()> callback = { [&updateCount]() { updateCount++; } };
   window.registerWindowRefreshCallback(callback);
   window.update();
   EXPECT_EQ(updateCount, 1);
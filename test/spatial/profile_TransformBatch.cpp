@@ -0,0 +1,81 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cassert>
+
+#ifndef AMS_MODULES
+#include <iostream>
+#include <ams/spatial.hpp>
+#else
+import <iostream>
+import ams.spatial;
+#endif
+
+#include <chrono>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+using namespace ams;
+
+/**
+ * Compares building model matrices one at a time with Matrix4::scale(), rotate() and translate() against composeTRS().
+ * usage: profile_TransformBatch [transform count] [pass count]
+ */
+
+int main(int argc, char** argv) {
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 50000;
+  size_t passCount = argc > 2 ? std::stoul(argv[2]) : 100;
+  
+  std::vector<Vec3<decimal_t>> positions, scales;
+  std::vector<Quaternion> rotations;
+  TransformBatch batch;
+  batch.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    auto t = static_cast<decimal_t>(i);
+    positions.emplace_back(t, -t, t * 0.5);
+    rotations.emplace_back(Vec3<decimal_t>(1, t, 2), t * 0.01);
+    scales.emplace_back(1 + t * 0.001, 1, 2);
+    batch.push_back(positions.back(), rotations.back(), scales.back());
+  }
+  std::vector<Matrix4> matrices(count);
+  
+  auto start = steady_clock::now();
+  for (size_t pass = 0; pass < passCount; pass++) {
+    for (size_t i = 0; i < count; i++) {
+      auto& mat = matrices[i];
+      mat = Matrix4::identity();
+      mat.scale(scales[i]);
+      mat.rotate(rotations[i]);
+      mat.translate(positions[i]);
+    }
+  }
+  auto scalarMs = duration_cast<duration<double, std::milli>>(steady_clock::now() - start).count() / passCount;
+  auto checksum = matrices[count / 2][1][1];
+  
+  start = steady_clock::now();
+  for (size_t pass = 0; pass < passCount; pass++)
+    composeTRS(batch, matrices);
+  auto batchMs = duration_cast<duration<double, std::milli>>(steady_clock::now() - start).count() / passCount;
+  
+  std::cout << count << " transforms, " << passCount << " passes" << std::endl
+            << "per matrix:  " << scalarMs << " ms/pass" << std::endl
+            << "composeTRS:  " << batchMs << " ms/pass" << std::endl
+            << "speedup:     " << scalarMs / batchMs << "x" << std::endl;
+  assert(std::abs(matrices[count / 2][1][1] - checksum) < 1e-9);
+  return 0;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2022 - Anthony Sorge
+ * Permission is hereby granted, free of charge, to any person obtaining a copy of this software and associated
+ * documentation files (the "Software"), to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions 
+ * of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED, INCLUDING 
+ * BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON INFRINGEMENT. 
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER 
+ * IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE 
+ * OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+#include <cassert>
+
+#ifndef AMS_MODULES
+#include <iostream>
+#include <ams/spatial.hpp>
+#include <ams/JobSystem.hpp>
+#else
+import <iostream>
+import ams.spatial;
+import ams.JobSystem;
+#endif
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <span>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+using namespace ams;
+
+/**
+ * Compares transforming points one at a time with Vec4 * Matrix4 against the batch kernels, on the calling thread
+ * and split across the JobSystem, and reports the throughput of each in millions of points per second.
+ * usage: profile_TransformPoints [point count] [pass count]
+ */
+
+template<typename TFunc>
+double timePasses(size_t passCount, TFunc&& fn) {
+  auto start = steady_clock::now();
+  for (size_t pass = 0; pass < passCount; pass++)
+    fn();
+  return duration_cast<duration<double, std::milli>>(steady_clock::now() - start).count() / passCount;
+}
+
+int main(int argc, char** argv) {
+  size_t count = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  size_t passCount = argc > 2 ? std::stoul(argv[2]) : 20;
+  
+  std::vector<Vec3<decimal_t>> points, out(count);
+  points.reserve(count);
+  for (size_t i = 0; i < count; i++) {
+    auto t = static_cast<decimal_t>(i % 1000);
+    points.emplace_back(t, -t, t * 0.5);
+  }
+  auto mat = Matrix4::identity();
+  mat.scale(Vec3<decimal_t>(2, 1, 0.5));
+  mat.rotate(Quaternion(Vec3<decimal_t>(1, 2, 3), 0.5));
+  mat.translate(Vec3<decimal_t>(1, 2, 3));
+  
+  auto perPointMs = timePasses(passCount, [&] {
+    for (size_t i = 0; i < count; i++) {
+      auto v = Vec4<decimal_t>(points[i].x, points[i].y, points[i].z, 1) * mat;
+      out[i] = Vec3<decimal_t>(v.x, v.y, v.z);
+    }
+  });
+  auto checksum = out[count / 2];
+  
+  // a single thread: batches below the threshold never leave the calling thread
+  auto singleMs = timePasses(passCount, [&] {
+    for (size_t begin = 0; begin < count; begin += ParallelTransformThreshold - 1) {
+      auto size = std::min(count - begin, ParallelTransformThreshold - 1);
+      transformPoints(std::span(points).subspan(begin, size), mat, std::span(out).subspan(begin, size));
+    }
+  });
+  auto parallelMs = timePasses(passCount, [&] { transformPoints(points, mat, out); });
+  auto vectorMs = timePasses(passCount, [&] { transformVectors(points, mat, out); });
+  auto normalMs = timePasses(passCount, [&] { transformNormals(points, mat, out); });
+  auto projectMs = timePasses(passCount, [&] { projectPoints(points, mat, out); });
+  transformPoints(points, mat, out);
+  
+  auto report = [count](const char* name, double ms) {
+    std::cout << name << ms << " ms/pass, " << count / ms / 1000 << " Mpoints/s" << std::endl;
+  };
+  std::cout << count << " points, " << passCount << " passes, "
+            << JobSystem::getInstance().getWorkerCount() << " workers" << std::endl;
+  report("per point:            ", perPointMs);
+  report("transformPoints (1t): ", singleMs);
+  report("transformPoints:      ", parallelMs);
+  report("transformVectors:     ", vectorMs);
+  report("transformNormals:     ", normalMs);
+  report("projectPoints:        ", projectMs);
+  std::cout << "speedup (1t):         " << perPointMs / singleMs << "x" << std::endl
+            << "speedup:              " << perPointMs / parallelMs << "x" << std::endl;
+  assert(std::abs(out[count / 2].x - checksum.x) < 1e-6);
+  return 0;
+}
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+#ifndef AMS_MODULES
+#include <ams/spatial/AABBTree.hpp>
+#else
+import ams.spatial.AABBTree;
+#endif
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace {
+
+using ams::AABB;
+using ams::AABBTree;
+using ams::decimal_t;
+using Vec3 = ams::Vec3<decimal_t>;
+
+std::vector<AABB> randomBoxes(size_t count, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<decimal_t> position(-100, 100);
+  std::uniform_real_distribution<decimal_t> size(0, 2);
+  std::vector<AABB> boxes;
+  for (size_t i = 0; i < count; ++i)
+    boxes.push_back(AABB::fromCenter({position(rng), position(rng), position(rng)}, Vec3(size(rng))));
+  return boxes;
+}
+
+/** Checks that a query reports every box matched by a linear scan. The tree may report extra boxes. */
+void expectQueryMatches(const AABBTree& tree, const std::vector<AABB>& boxes, const std::vector<uint32_t>& proxies,
+                        const AABB& region) {
+  std::vector<uint64_t> found;
+  tree.query(region, [&](uint32_t proxy) {
+    if (boxes[tree.getValue(proxy)].intersects(region))
+      found.push_back(tree.getValue(proxy));
+  });
+  std::vector<uint64_t> expected;
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    if (proxies[i] != AABBTree::NullProxy && boxes[i].intersects(region))
+      expected.push_back(i);
+  }
+  std::sort(found.begin(), found.end());
+  EXPECT_EQ(found, expected);
+}
+
+TEST(Bounds, Transformed) {
+  AABB box({-1, -1, -1}, {1, 1, 1});
+  auto mat = ams::Matrix4::identity();
+  mat.scale(Vec3(2, 1, 1));
+  mat.translate(Vec3(5, 0, 0));
+  auto result = box.transformed(mat);
+  EXPECT_NEAR(result.min.x, 3, 1e-12);
+  EXPECT_NEAR(result.max.x, 7, 1e-12);
+  EXPECT_NEAR(result.max.y, 1, 1e-12);
+}
+
+TEST(Bounds, RayAndSphere) {
+  AABB box({-1, -1, -1}, {1, 1, 1});
+  ams::Ray ray{{-5, 0, 0}, {1, 0, 0}};
+  decimal_t distance = -1;
+  EXPECT_TRUE(ray.intersects(box, ray.inverseDirection(), 100, distance));
+  EXPECT_DOUBLE_EQ(distance, 4);
+  EXPECT_FALSE(ray.intersects(box, ray.inverseDirection(), 3, distance));
+  ams::Ray miss{{-5, 2, 0}, {1, 0, 0}};
+  EXPECT_FALSE(miss.intersects(box, miss.inverseDirection(), 100, distance));
+  EXPECT_TRUE(box.intersects(Vec3(3, 0, 0), 2.0));
+  EXPECT_FALSE(box.intersects(Vec3(3, 3, 0), 2.0));
+}
+
+TEST(Bounds, Frustum) {
+  // the identity projects the cube [-1, 1] onto itself
+  auto frustum = ams::Frustum::fromMatrix(ams::Matrix4::identity());
+  EXPECT_TRUE(frustum.intersects(AABB({0.5, 0.5, 0.5}, {2, 2, 2})));
+  EXPECT_FALSE(frustum.intersects(AABB({1.5, 0, 0}, {2, 1, 1})));
+  EXPECT_TRUE(frustum.intersects(Vec3(1.5, 0, 0), 1.0));
+}
+
+TEST(AABBTree, QueriesMatchLinearScan) {
+  auto boxes = randomBoxes(2000, 1);
+  AABBTree tree;
+  std::vector<uint32_t> proxies;
+  for (size_t i = 0; i < boxes.size(); ++i)
+    proxies.push_back(tree.insert(boxes[i], i));
+  EXPECT_EQ(tree.size(), boxes.size());
+  // balanced by rotations: far below the 2000 of a degenerate tree
+  EXPECT_LT(tree.height(), 32);
+  for (auto& region : randomBoxes(20, 2))
+    expectQueryMatches(tree, boxes, proxies, region.inflated(10));
+  
+  // move every box, remove a third
+  std::mt19937 rng(3);
+  std::uniform_real_distribution<decimal_t> offset(-5, 5);
+  for (size_t i = 0; i < boxes.size(); ++i) {
+    if (i % 3 == 0) {
+      tree.remove(proxies[i]);
+      proxies[i] = AABBTree::NullProxy;
+      continue;
+    }
+    Vec3 delta(offset(rng), offset(rng), offset(rng));
+    boxes[i] = {boxes[i].min + delta, boxes[i].max + delta};
+    tree.move(proxies[i], boxes[i]);
+  }
+  for (auto& region : randomBoxes(20, 4))
+    expectQueryMatches(tree, boxes, proxies, region.inflated(10));
+}
+
+TEST(AABBTree, SmallMovesStayInFatBox) {
+  AABBTree tree(0.5);
+  auto proxy = tree.insert(AABB({0, 0, 0}, {1, 1, 1}), 7);
+  EXPECT_FALSE(tree.move(proxy, AABB({0.2, 0, 0}, {1.2, 1, 1})));
+  EXPECT_TRUE(tree.move(proxy, AABB({2, 0, 0}, {3, 1, 1})));
+  EXPECT_EQ(tree.getValue(proxy), 7);
+}
+
+TEST(AABBTree, SphereAndRay) {
+  AABBTree tree(0);
+  for (int i = 0; i < 10; ++i)
+    tree.insert(AABB::fromCenter({static_cast<decimal_t>(i * 10), 0, 0}, Vec3(1)), i);
+  std::vector<uint64_t> found;
+  tree.query(Vec3(20, 0, 0), 10.5, [&](uint32_t proxy) { found.push_back(tree.getValue(proxy)); });
+  std::sort(found.begin(), found.end());
+  EXPECT_EQ(found, (std::vector<uint64_t>{1, 2, 3}));
+  
+  // clipping the ray at each hit finds the closest box last
+  uint64_t closest = 0;
+  decimal_t closestDistance = 0;
+  tree.raycast({{-5, 0, 0}, {1, 0, 0}}, 1000, [&](uint32_t proxy, decimal_t distance) {
+    closest = tree.getValue(proxy);
+    closestDistance = distance;
+    return distance;
+  });
+  EXPECT_EQ(closest, 0);
+  EXPECT_DOUBLE_EQ(closestDistance, 4);
+}
+
+TEST(AABBTree, Rebuild) {
+  // above the threshold, so that subtrees are built in parallel
+  auto boxes = randomBoxes(AABBTree::ParallelBuildThreshold * 4, 5);
+  AABBTree tree;
+  std::vector<uint32_t> proxies;
+  for (size_t i = 0; i < boxes.size(); ++i)
+    proxies.push_back(tree.insert(boxes[i], i, false));
+  tree.rebuild();
+  // the median split builds a complete tree
+  EXPECT_EQ(tree.height(), 14);
+  for (auto& region : randomBoxes(20, 6))
+    expectQueryMatches(tree, boxes, proxies, region.inflated(10));
+  
+  // incremental changes after a rebuild
+  tree.remove(proxies[0]);
+  proxies[0] = AABBTree::NullProxy;
+  boxes[1] = AABB({500, 500, 500}, {501, 501, 501});
+  tree.move(proxies[1], boxes[1]);
+  expectQueryMatches(tree, boxes, proxies, AABB({499, 499, 499}, {502, 502, 502}));
+  tree.clear();
+  EXPECT_EQ(tree.size(), 0);
+  tree.rebuild();
+  EXPECT_EQ(tree.height(), 0);
+}
+
+} // namespace
@@ -3,6 +3,9 @@
 //
 
 #include <gtest/gtest.h>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
 #ifndef AMS_MODULES
 #include <ams/spatial/Matrix.hpp>
 #include <ams/spatial/Quaternion.hpp>
@@ -295,12 +298,63 @@ TEST(Matrix4, MultiplyVector) {
   // EXPECT_EQ(v2[3], 1354);
 }
 
+TEST(Matrix4, SimdMatchesConstexpr) {
+  constexpr ams::Matrix4 a(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+  constexpr ams::Matrix4 b(2, 0, 1, 3, -1, 4, 2, 0, 0.5, 1, -3, 2, 7, -2, 1, 1);
+  // the constexpr results take the scalar path, the others the SIMD kernels
+  constexpr ams::Matrix4 product = a * b;
+  constexpr ams::Matrix4 scaled = a * 0.5;
+  constexpr ams::Vec4<ams::decimal_t> v(1, -2, 3, 0.5);
+  constexpr ams::Vec4<ams::decimal_t> transformed = v * a;
+  ams::Matrix4 simdProduct = a * b;
+  ams::Matrix4 simdScaled = a * 0.5;
+  ams::Vec4<ams::decimal_t> simdTransformed = v * a;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      EXPECT_DOUBLE_EQ(simdProduct(i, j), product(i, j));
+      EXPECT_DOUBLE_EQ(simdScaled(i, j), scaled(i, j));
+    }
+    EXPECT_DOUBLE_EQ(simdTransformed[i], transformed[i]);
+  }
+  
+  // aliasing the output with an operand
+  simdProduct = a;
+  simdProduct *= b;
+  EXPECT_DOUBLE_EQ(simdProduct(3, 1), product(3, 1));
+}
+
+TEST(Matrix4, Inverse) {
+  constexpr ams::Matrix4 m(2, 0, 1, 3, -1, 4, 2, 0, 0.5, 1, -3, 2, 7, -2, 1, 1);
+  // the cofactor expansion, evaluated at compile time
+  constexpr ams::Matrix4 expected = [] {
+    ams::Matrix4 inv(2, 0, 1, 3, -1, 4, 2, 0, 0.5, 1, -3, 2, 7, -2, 1, 1);
+    ams::inverse(inv);
+    return inv;
+  }();
+  constexpr double tolerance = std::numeric_limits<ams::decimal_t>::epsilon() * 64;
+  ams::Matrix4 inv = m;
+  EXPECT_TRUE(ams::inverse(inv));
+  auto identity = m * inv;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      EXPECT_NEAR(inv(i, j), expected(i, j), tolerance);
+      EXPECT_NEAR(identity(i, j), i == j ? 1 : 0, tolerance);
+    }
+  }
+  
+  ams::Matrix4 singular(1, 2, 3, 4, 2, 4, 6, 8, 0, 1, 0, 1, 1, 0, 1, 0);
+  if constexpr (ams::AMSExceptions)
+    EXPECT_THROW(ams::inverse(singular), std::domain_error);
+  else
+    EXPECT_FALSE(ams::inverse(singular));
+}
+
 TEST(Matrix4, M4Perspective) {
   ams::Matrix4 m;
-  auto fov = ams::radians(45.0);
-  auto aspect = 1.0;
-  auto near = 0.1;
-  auto far = 100.0;
+  ams::decimal_t fov = ams::radians(45.0);
+  ams::decimal_t aspect = 1.0;
+  ams::decimal_t near = 0.1;
+  ams::decimal_t far = 100.0;
   m.setPerspective(fov, aspect, near, far);
   EXPECT_NEAR(m[0][0], 2.4142135623730949, 1e-5);
   EXPECT_NEAR(m[0][1], 0.0, 1e-5);
@@ -348,4 +402,39 @@ TEST(Matrix4, GLMImplicitMat4) {
   EXPECT_EQ(m2[3][3], 16);
 }
 
-}
\ No newline at end of file
+TEST(Matrix4, FlatStorage) {
+  using namespace ams;
+  Matrix4 m(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(m.data()) % 32, 0);
+  for (int i = 0; i < 16; i++)
+    EXPECT_EQ(m.data()[i], i + 1);
+  const Matrix4& cm = m;
+  EXPECT_EQ(&cm[2][1], &m(2, 1));
+  m(2, 1) = 42;
+  EXPECT_EQ(cm[2][1], 42);
+  EXPECT_EQ(cm.at(2, 1), 42);
+  EXPECT_THROW((void) cm.at(4, 0), std::out_of_range);
+}
+
+TEST(Matrix4, PackedMatrix) {
+  using namespace ams;
+  Matrix4 m(1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16);
+  PackedMatrix<float, 4> columnMajor(m);
+  PackedMatrix<float, 4, StorageOrder::RowMajor> rowMajor(m);
+  glm::mat4 g = m;
+  for (int i = 0; i < 4; i++) {
+    for (int j = 0; j < 4; j++) {
+      // column-major packing has the memory layout of glm::mat4
+      EXPECT_EQ(columnMajor.data()[i * 4 + j], g[i][j]);
+      EXPECT_EQ(columnMajor(i, j), m[i][j]);
+      EXPECT_EQ(rowMajor.data()[i * 4 + j], m[i][j]);
+    }
+  }
+  auto unpacked = columnMajor.unpack<Matrix4>();
+  for (int i = 0; i < 16; i++)
+    EXPECT_EQ(unpacked.data()[i], m.data()[i]);
+  PackedMatrix<double, 3> packed3(Matrix3(1, 2, 3, 4, 5, 6, 7, 8, 9));
+  EXPECT_EQ(packed3.data()[1], 4);
+}
+
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#ifndef AMS_MODULES
+#include <ams/spatial/Vec.hpp>
+#include <ams/spatial/Quaternion.hpp>
+#else
+import ams.spatial.Vec;
+import ams.spatial.Quaternion;
+#endif
+#include <cmath>
+#include <numbers>
+#include <vector>
+
+namespace {
+
+using Vec3f = ams::Vec3<float>;
+
+std::vector<Vec3f> makeVectors(size_t count) {
+  std::vector<Vec3f> vectors;
+  for (size_t i = 0; i < count; ++i) {
+    auto t = static_cast<float>(i);
+    vectors.emplace_back(t - 3, 2 * t + 1, 0.5f * t);
+  }
+  return vectors;
+}
+
+TEST(Packet, Arithmetic) {
+  float values[8] = {1, 4, 9, 16, 25, 36, 49, 64};
+  auto p = ams::Packet<float, 8>::load(values);
+  auto root = sqrt(p);
+  for (size_t i = 0; i < 8; ++i)
+    EXPECT_FLOAT_EQ(root[i], static_cast<float>(i + 1));
+  EXPECT_FLOAT_EQ((p * 2.0f - p).sum(), 204);
+  EXPECT_EQ(ams::lerp(p, p * 3.0f, 0.5f), p * 2.0f);
+}
+
+TEST(Vec3Packet, GatherScatter) {
+  auto vectors = makeVectors(11);
+  auto packet = ams::Vec3x8<float>::gather(vectors, 8);
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(packet.get(i).x, vectors[8 + i].x);
+    EXPECT_EQ(packet.get(i).z, vectors[8 + i].z);
+  }
+  // lanes past the end of the span are zero and are not written back
+  EXPECT_EQ(packet.x[3], 0);
+  std::vector<Vec3f> out(11);
+  (-packet).scatter(out, 8);
+  EXPECT_EQ(out[7].x, 0);
+  EXPECT_EQ(out[10].y, -vectors[10].y);
+}
+
+TEST(Vec3Packet, MatchesVec3) {
+  auto a = makeVectors(8);
+  auto b = makeVectors(16);
+  auto pa = ams::Vec3x8<float>::gather(a.data());
+  auto pb = ams::Vec3x8<float>::gather(b.data() + 8);
+  auto d = ams::dot(pa, pb);
+  auto c = ams::cross(pa, pb);
+  auto len = ams::length(pa);
+  auto n = ams::normalize(pa);
+  auto l = ams::lerp(pa, pb, 0.25f);
+  for (size_t i = 0; i < 8; ++i) {
+    const auto& va = a[i];
+    const auto& vb = b[8 + i];
+    EXPECT_FLOAT_EQ(d[i], va.x * vb.x + va.y * vb.y + va.z * vb.z);
+    EXPECT_FLOAT_EQ(c.x[i], va.y * vb.z - va.z * vb.y);
+    EXPECT_FLOAT_EQ(c.z[i], va.x * vb.y - va.y * vb.x);
+    const float expectedLength = std::sqrt(va.x * va.x + va.y * va.y + va.z * va.z);
+    EXPECT_FLOAT_EQ(len[i], expectedLength);
+    EXPECT_NEAR(n.y[i], va.y / expectedLength, 1e-6);
+    EXPECT_FLOAT_EQ(l.x[i], va.x + (vb.x - va.x) * 0.25f);
+  }
+}
+
+TEST(Vec3Packet, NormalizeZero) {
+  auto n = ams::normalize(ams::Vec3x4<double>());
+  EXPECT_EQ(n, ams::Vec3x4<double>());
+}
+
+TEST(Vec3Packet, Slerp) {
+  ams::Vec3x4<double> a(ams::Vec3<double>(1, 0, 0)), b(ams::Vec3<double>(0, 2, 0));
+  auto mid = ams::slerp(a, b, 0.5);
+  for (size_t i = 0; i < 4; ++i) {
+    // halfway along the arc, halfway between the lengths
+    EXPECT_NEAR(mid.x[i], 1.5 * std::numbers::sqrt2 / 2, 1e-12);
+    EXPECT_NEAR(mid.y[i], 1.5 * std::numbers::sqrt2 / 2, 1e-12);
+    EXPECT_NEAR(mid.z[i], 0, 1e-12);
+  }
+}
+
+TEST(QuaternionPacket, MultiplyMatchesQuaternion) {
+  std::vector<ams::Quaternion> a, b;
+  for (int i = 0; i < 4; ++i) {
+    a.emplace_back(ams::Vec3<ams::decimal_t>(1, i, 2), 0.3 * (i + 1));
+    b.emplace_back(ams::Vec3<ams::decimal_t>(i, 1, -1), 0.2 * (i + 2));
+  }
+  auto product = ams::QuaternionPacket<>::gather(a.data()) * ams::QuaternionPacket<>::gather(b.data());
+  std::vector<ams::Quaternion> out(4);
+  product.scatter(out.data());
+  for (int i = 0; i < 4; ++i) {
+    auto expected = a[i] * b[i];
+    EXPECT_NEAR(out[i].x, expected.x, 1e-6);
+    EXPECT_NEAR(out[i].y, expected.y, 1e-6);
+    EXPECT_NEAR(out[i].z, expected.z, 1e-6);
+    EXPECT_NEAR(out[i].w, expected.w, 1e-6);
+  }
+}
+
+TEST(QuaternionPacket, Slerp) {
+  using Packet = ams::QuaternionPacket<double, 4>;
+  const double angle = std::numbers::pi / 2;
+  // rotations of 0 and 90 degrees around z, the second one in the other hemisphere
+  Packet a;
+  Packet b(ams::Vec4<double>(0, 0, -std::sin(angle / 2), -std::cos(angle / 2)));
+  ams::Packet<double, 4> t;
+  for (size_t i = 0; i < 4; ++i)
+    t[i] = static_cast<double>(i) / 3;
+  auto s = ams::slerp(a, b, t);
+  auto l = ams::lerp(a, b, t);
+  auto len = ams::length(s);
+  for (size_t i = 0; i < 4; ++i) {
+    // the shortest path rotates by t * 90 degrees at a constant speed
+    EXPECT_NEAR(s.z[i], std::sin(t[i] * angle / 2), 1e-12);
+    EXPECT_NEAR(s.w[i], std::cos(t[i] * angle / 2), 1e-12);
+    EXPECT_NEAR(len[i], 1, 1e-12);
+    EXPECT_NEAR(ams::length(l)[i], 1, 1e-12);
+    EXPECT_GE(l.w[i], 0);
+  }
+  EXPECT_NEAR(l.z[3], s.z[3], 1e-12);
+}
+
+} // namespace
@@ -40,6 +40,21 @@ TEST(Quaternion, Multiply) {
   EXPECT_EQ(q3.w, -6);
 }
 
+TEST(Quaternion, MultiplyUnit) {
+  const ams::Quaternion a(0.1, -0.7, 0.3, 0.6);
+  const ams::Quaternion b(-0.4, 0.2, 0.8, -0.1);
+  auto product = a * b;
+  EXPECT_DOUBLE_EQ(product.x, a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y);
+  EXPECT_DOUBLE_EQ(product.y, a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x);
+  EXPECT_DOUBLE_EQ(product.z, a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w);
+  EXPECT_DOUBLE_EQ(product.w, a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z);
+  
+  // aliasing the output with an operand
+  auto q = a;
+  q *= b;
+  EXPECT_DOUBLE_EQ(q.w, product.w);
+}
+
 TEST(Quaternion, Identity) {
   ams::Quaternion q = ams::Quaternion::identity();
   EXPECT_EQ(q.x, 0);
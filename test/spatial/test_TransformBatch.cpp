@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#ifndef AMS_MODULES
+#include <ams/spatial/TransformBatch.hpp>
+#else
+import ams.spatial.TransformBatch;
+#endif
+#include <vector>
+
+namespace {
+
+ams::Matrix4 composeReference(const ams::Vec3<ams::decimal_t>& position, const ams::Quaternion& rotation,
+                              const ams::Vec3<ams::decimal_t>& scale) {
+  auto mat = ams::Matrix4::identity();
+  mat.scale(scale);
+  mat.rotate(rotation);
+  mat.translate(position);
+  return mat;
+}
+
+TEST(TransformBatch, PushBack) {
+  ams::TransformBatch batch;
+  EXPECT_TRUE(batch.empty());
+  batch.push_back({1, 2, 3}, ams::Quaternion::identity(), {1, 1, 1});
+  batch.push_back({4, 5, 6}, ams::Quaternion::identity(), {2, 2, 2});
+  EXPECT_EQ(batch.size(), 2);
+  batch.clear();
+  EXPECT_TRUE(batch.empty());
+}
+
+TEST(TransformBatch, ComposeTRS) {
+  // not a multiple of the SIMD width, so that the scalar tail is covered too
+  constexpr int count = 7;
+  ams::TransformBatch batch;
+  std::vector<ams::Matrix4> expected;
+  for (int i = 0; i < count; ++i) {
+    ams::Vec3<ams::decimal_t> position(i, -2.0 * i, 0.5 * i);
+    ams::Quaternion rotation(ams::Vec3<ams::decimal_t>(1, i, 2), 0.3 * (i + 1));
+    ams::Vec3<ams::decimal_t> scale(1 + i, 2, 0.5 + i);
+    batch.push_back(position, rotation, scale);
+    expected.push_back(composeReference(position, rotation, scale));
+  }
+  std::vector<ams::Matrix4> result(count);
+  ams::composeTRS(batch, result);
+  for (int i = 0; i < count; ++i) {
+    for (int row = 0; row < 4; ++row) {
+      for (int col = 0; col < 4; ++col)
+        EXPECT_NEAR(result[i][row][col], expected[i][row][col], 1e-12) << i << ": [" << row << "][" << col << "]";
+    }
+  }
+}
+
+TEST(TransformBatch, ComposeTRSOutputTooSmall) {
+  ams::TransformBatch batch;
+  batch.push_back({1, 2, 3}, ams::Quaternion::identity(), {1, 1, 1});
+  batch.push_back({4, 5, 6}, ams::Quaternion::identity(), {1, 1, 1});
+  std::vector<ams::Matrix4> result(1);
+  EXPECT_THROW(ams::composeTRS(batch, result), std::invalid_argument);
+}
+
+} // namespace
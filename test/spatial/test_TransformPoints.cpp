@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#ifndef AMS_MODULES
+#include <ams/spatial/TransformPoints.hpp>
+#include <ams/spatial/Matrix.hpp>
+#include <ams/spatial/Quaternion.hpp>
+#else
+import ams.spatial.TransformPoints;
+import ams.spatial.Matrix;
+import ams.spatial.Quaternion;
+#endif
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+using Vec3d = ams::Vec3<ams::decimal_t>;
+
+constexpr ams::decimal_t Tolerance = std::numeric_limits<ams::decimal_t>::epsilon() * 1024;
+
+ams::Matrix4 makeTransform() {
+  auto mat = ams::Matrix4::identity();
+  mat.scale(Vec3d(2, 0.5, 3));
+  mat.rotate(ams::Quaternion(Vec3d(1, 2, 3), 0.7));
+  mat.translate(Vec3d(4, -5, 6));
+  return mat;
+}
+
+std::vector<Vec3d> makePoints(size_t count = 11) {
+  std::vector<Vec3d> points;
+  for (size_t i = 0; i < count; ++i) {
+    auto t = static_cast<ams::decimal_t>(i % 97);
+    points.emplace_back(t * 0.25 - 1, 2 - t * 0.5, t * 0.125 + 0.5);
+  }
+  return points;
+}
+
+void expectNear(const Vec3d& actual, const Vec3d& expected, size_t i) {
+  EXPECT_NEAR(actual.x, expected.x, Tolerance) << i;
+  EXPECT_NEAR(actual.y, expected.y, Tolerance) << i;
+  EXPECT_NEAR(actual.z, expected.z, Tolerance) << i;
+}
+
+TEST(TransformPoints, Points) {
+  auto mat = makeTransform();
+  auto points = makePoints();
+  std::vector<Vec3d> result(points.size());
+  ams::transformPoints(points, mat, result);
+  for (size_t i = 0; i < points.size(); ++i) {
+    auto expected = ams::Vec4<ams::decimal_t>(points[i].x, points[i].y, points[i].z, 1) * mat;
+    expectNear(result[i], Vec3d(expected.x, expected.y, expected.z), i);
+  }
+}
+
+TEST(TransformPoints, Vectors) {
+  auto mat = makeTransform();
+  auto vectors = makePoints();
+  std::vector<Vec3d> result(vectors.size());
+  ams::transformVectors(vectors, mat, result);
+  for (size_t i = 0; i < vectors.size(); ++i)
+    expectNear(result[i], vectors[i] * mat, i);
+}
+
+TEST(TransformPoints, NormalsStayPerpendicular) {
+  auto mat = makeTransform();
+  // the normal of the plane spanned by two tangents
+  Vec3d tangent(1, 0, 0), bitangent(0, 1, 1);
+  std::vector<Vec3d> normals{ams::cross(tangent, bitangent)};
+  std::vector<Vec3d> result(1);
+  ams::transformNormals(normals, mat, result);
+  auto t = tangent * mat, b = bitangent * mat;
+  EXPECT_NEAR(ams::dot(result[0], t), 0, Tolerance * 16);
+  EXPECT_NEAR(ams::dot(result[0], b), 0, Tolerance * 16);
+  EXPECT_NEAR(ams::dot(result[0], result[0]), 1, Tolerance);
+  // same side of the surface as the transformed cross product
+  EXPECT_GT(ams::dot(result[0], ams::cross(t, b)), 0);
+}
+
+TEST(TransformPoints, Project) {
+  ams::Matrix4 mat;
+  ams::perspective(mat, 1.2, 1.5, 0.1, 100);
+  auto points = makePoints();
+  for (auto& p : points)
+    p.z -= 10;
+  std::vector<Vec3d> result(points.size());
+  ams::projectPoints(points, mat, result);
+  for (size_t i = 0; i < points.size(); ++i) {
+    auto clip = ams::Vec4<ams::decimal_t>(points[i].x, points[i].y, points[i].z, 1) * mat;
+    expectNear(result[i], Vec3d(clip.x / clip.w, clip.y / clip.w, clip.z / clip.w), i);
+  }
+}
+
+TEST(TransformPoints, InPlaceAndParallel) {
+  auto mat = makeTransform();
+  auto points = makePoints(ams::ParallelTransformThreshold + 3);
+  auto expected = points;
+  for (auto& p : expected) {
+    auto v = ams::Vec4<ams::decimal_t>(p.x, p.y, p.z, 1) * mat;
+    p = Vec3d(v.x, v.y, v.z);
+  }
+  ams::transformPoints(points, mat, points);
+  for (size_t i = 0; i < points.size(); i += 1021)
+    expectNear(points[i], expected[i], i);
+  expectNear(points.back(), expected.back(), points.size() - 1);
+}
+
+TEST(TransformPoints, OutputTooSmall) {
+  auto points = makePoints();
+  std::vector<Vec3d> result(points.size() - 1);
+  EXPECT_THROW(ams::transformPoints(points, makeTransform(), result), std::invalid_argument);
+}
+
+} // namespace
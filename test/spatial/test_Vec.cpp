@@ -1049,6 +1049,19 @@ TEST(Vec4, Div) {
   EXPECT_EQ(v3.w, 4 / 8);
 }
 
+TEST(Vec4, SimdMatchesConstexpr) {
+  constexpr ams::Vec4<double> a(1.5, -2, 3, 4.25);
+  constexpr ams::Vec4<double> b(0.5, 4, -1, 2);
+  constexpr ams::Vec4<double> expected[] = {a + b, a - b, a * b, a / b, a + 2.0, a - 2.0, a * 2.0, a / 2.0};
+  ams::Vec4<double> actual[] = {a + b, a - b, a * b, a / b, a + 2.0, a - 2.0, a * 2.0, a / 2.0};
+  for (int i = 0; i < 8; i++) {
+    for (int j = 0; j < 4; j++)
+      EXPECT_DOUBLE_EQ(actual[i][j], expected[i][j]);
+  }
+  // integers keep the scalar path
+  EXPECT_EQ(ams::Vec4<int>(1, 2, 3, 4) * 2, ams::Vec4<int>(2, 4, 6, 8));
+}
+
 TEST(Vec4, Mod) {
   ams::Vec4<int> v1{1, 2, 3, 4};
   ams::Vec4<int> v2{5, 6, 7, 8};